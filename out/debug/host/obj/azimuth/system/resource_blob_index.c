@@ -0,0 +1,513 @@
+// File generated by src/azimuth/system/generate_blob_index.sh
+#include <stddef.h>
+const struct resource_entry {
+  const char *name;
+  size_t offset, length;
+} resource_index[] = {
+  {.name="music/music01.txt", .offset=0, .length=2195},
+  {.name="music/music02.txt", .offset=2195, .length=3489},
+  {.name="music/music03.txt", .offset=5684, .length=3206},
+  {.name="music/music04.txt", .offset=8890, .length=3956},
+  {.name="music/music05.txt", .offset=12846, .length=5957},
+  {.name="music/music06.txt", .offset=18803, .length=3605},
+  {.name="music/music07.txt", .offset=22408, .length=16714},
+  {.name="music/music08.txt", .offset=39122, .length=5292},
+  {.name="music/music09.txt", .offset=44414, .length=6497},
+  {.name="music/music10.txt", .offset=50911, .length=2718},
+  {.name="music/music11.txt", .offset=53629, .length=2199},
+  {.name="music/music12.txt", .offset=55828, .length=610},
+  {.name="music/music13.txt", .offset=56438, .length=3146},
+  {.name="music/music14.txt", .offset=59584, .length=593},
+  {.name="music/music15.txt", .offset=60177, .length=3356},
+  {.name="music/music16.txt", .offset=63533, .length=4062},
+  {.name="music/music17.txt", .offset=67595, .length=317},
+  {.name="music/music18.txt", .offset=67912, .length=349},
+  {.name="music/music19.txt", .offset=68261, .length=2917},
+  {.name="music/music20.txt", .offset=71178, .length=715},
+  {.name="music/music21.txt", .offset=71893, .length=367},
+  {.name="music/music22.txt", .offset=72260, .length=3062},
+  {.name="rooms/planet.bin", .offset=75322, .length=2462475},
+  {.name="rooms/planet.txt", .offset=2537797, .length=39295},
+  {.name="rooms/room000.txt", .offset=2577092, .length=10014},
+  {.name="rooms/room001.txt", .offset=2587106, .length=7244},
+  {.name="rooms/room002.txt", .offset=2594350, .length=8262},
+  {.name="rooms/room003.txt", .offset=2602612, .length=2488},
+  {.name="rooms/room004.txt", .offset=2605100, .length=8475},
+  {.name="rooms/room005.txt", .offset=2613575, .length=13037},
+  {.name="rooms/room006.txt", .offset=2626612, .length=4578},
+  {.name="rooms/room007.txt", .offset=2631190, .length=3626},
+  {.name="rooms/room008.txt", .offset=2634816, .length=1864},
+  {.name="rooms/room009.txt", .offset=2636680, .length=1449},
+  {.name="rooms/room010.txt", .offset=2638129, .length=1978},
+  {.name="rooms/room011.txt", .offset=2640107, .length=4347},
+  {.name="rooms/room012.txt", .offset=2644454, .length=3161},
+  {.name="rooms/room013.txt", .offset=2647615, .length=3209},
+  {.name="rooms/room014.txt", .offset=2650824, .length=2593},
+  {.name="rooms/room015.txt", .offset=2653417, .length=1695},
+  {.name="rooms/room016.txt", .offset=2655112, .length=1777},
+  {.name="rooms/room017.txt", .offset=2656889, .length=1980},
+  {.name="rooms/room018.txt", .offset=2658869, .length=4107},
+  {.name="rooms/room019.txt", .offset=2662976, .length=2103},
+  {.name="rooms/room020.txt", .offset=2665079, .length=4193},
+  {.name="rooms/room021.txt", .offset=2669272, .length=1949},
+  {.name="rooms/room022.txt", .offset=2671221, .length=4722},
+  {.name="rooms/room023.txt", .offset=2675943, .length=3448},
+  {.name="rooms/room024.txt", .offset=2679391, .length=4858},
+  {.name="rooms/room025.txt", .offset=2684249, .length=1796},
+  {.name="rooms/room026.txt", .offset=2686045, .length=6257},
+  {.name="rooms/room027.txt", .offset=2692302, .length=1726},
+  {.name="rooms/room028.txt", .offset=2694028, .length=2319},
+  {.name="rooms/room029.txt", .offset=2696347, .length=5242},
+  {.name="rooms/room030.txt", .offset=2701589, .length=2762},
+  {.name="rooms/room031.txt", .offset=2704351, .length=2115},
+  {.name="rooms/room032.txt", .offset=2706466, .length=1941},
+  {.name="rooms/room033.txt", .offset=2708407, .length=3725},
+  {.name="rooms/room034.txt", .offset=2712132, .length=2594},
+  {.name="rooms/room035.txt", .offset=2714726, .length=2985},
+  {.name="rooms/room036.txt", .offset=2717711, .length=2551},
+  {.name="rooms/room037.txt", .offset=2720262, .length=2395},
+  {.name="rooms/room038.txt", .offset=2722657, .length=4662},
+  {.name="rooms/room039.txt", .offset=2727319, .length=1545},
+  {.name="rooms/room040.txt", .offset=2728864, .length=2628},
+  {.name="rooms/room041.txt", .offset=2731492, .length=4999},
+  {.name="rooms/room042.txt", .offset=2736491, .length=2018},
+  {.name="rooms/room043.txt", .offset=2738509, .length=1877},
+  {.name="rooms/room044.txt", .offset=2740386, .length=2673},
+  {.name="rooms/room045.txt", .offset=2743059, .length=2264},
+  {.name="rooms/room046.txt", .offset=2745323, .length=4725},
+  {.name="rooms/room047.txt", .offset=2750048, .length=2818},
+  {.name="rooms/room048.txt", .offset=2752866, .length=3872},
+  {.name="rooms/room049.txt", .offset=2756738, .length=4506},
+  {.name="rooms/room050.txt", .offset=2761244, .length=2683},
+  {.name="rooms/room051.txt", .offset=2763927, .length=7454},
+  {.name="rooms/room052.txt", .offset=2771381, .length=2887},
+  {.name="rooms/room053.txt", .offset=2774268, .length=5805},
+  {.name="rooms/room054.txt", .offset=2780073, .length=15405},
+  {.name="rooms/room055.txt", .offset=2795478, .length=3184},
+  {.name="rooms/room056.txt", .offset=2798662, .length=7099},
+  {.name="rooms/room057.txt", .offset=2805761, .length=8747},
+  {.name="rooms/room058.txt", .offset=2814508, .length=9058},
+  {.name="rooms/room059.txt", .offset=2823566, .length=2652},
+  {.name="rooms/room060.txt", .offset=2826218, .length=16906},
+  {.name="rooms/room061.txt", .offset=2843124, .length=2691},
+  {.name="rooms/room062.txt", .offset=2845815, .length=9122},
+  {.name="rooms/room063.txt", .offset=2854937, .length=8877},
+  {.name="rooms/room064.txt", .offset=2863814, .length=7564},
+  {.name="rooms/room065.txt", .offset=2871378, .length=2055},
+  {.name="rooms/room066.txt", .offset=2873433, .length=9835},
+  {.name="rooms/room067.txt", .offset=2883268, .length=9676},
+  {.name="rooms/room068.txt", .offset=2892944, .length=2879},
+  {.name="rooms/room069.txt", .offset=2895823, .length=3207},
+  {.name="rooms/room070.txt", .offset=2899030, .length=3215},
+  {.name="rooms/room071.txt", .offset=2902245, .length=5020},
+  {.name="rooms/room072.txt", .offset=2907265, .length=2482},
+  {.name="rooms/room073.txt", .offset=2909747, .length=2829},
+  {.name="rooms/room074.txt", .offset=2912576, .length=3040},
+  {.name="rooms/room075.txt", .offset=2915616, .length=8350},
+  {.name="rooms/room076.txt", .offset=2923966, .length=2112},
+  {.name="rooms/room077.txt", .offset=2926078, .length=3690},
+  {.name="rooms/room078.txt", .offset=2929768, .length=6178},
+  {.name="rooms/room079.txt", .offset=2935946, .length=2663},
+  {.name="rooms/room080.txt", .offset=2938609, .length=5206},
+  {.name="rooms/room081.txt", .offset=2943815, .length=3576},
+  {.name="rooms/room082.txt", .offset=2947391, .length=2978},
+  {.name="rooms/room083.txt", .offset=2950369, .length=4898},
+  {.name="rooms/room084.txt", .offset=2955267, .length=7781},
+  {.name="rooms/room085.txt", .offset=2963048, .length=3427},
+  {.name="rooms/room086.txt", .offset=2966475, .length=3446},
+  {.name="rooms/room087.txt", .offset=2969921, .length=2396},
+  {.name="rooms/room088.txt", .offset=2972317, .length=5758},
+  {.name="rooms/room089.txt", .offset=2978075, .length=2331},
+  {.name="rooms/room090.txt", .offset=2980406, .length=2231},
+  {.name="rooms/room091.txt", .offset=2982637, .length=2426},
+  {.name="rooms/room092.txt", .offset=2985063, .length=2544},
+  {.name="rooms/room093.txt", .offset=2987607, .length=2853},
+  {.name="rooms/room094.txt", .offset=2990460, .length=2752},
+  {.name="rooms/room095.txt", .offset=2993212, .length=3146},
+  {.name="rooms/room096.txt", .offset=2996358, .length=3450},
+  {.name="rooms/room097.txt", .offset=2999808, .length=3194},
+  {.name="rooms/room098.txt", .offset=3003002, .length=3283},
+  {.name="rooms/room099.txt", .offset=3006285, .length=3666},
+  {.name="rooms/room100.txt", .offset=3009951, .length=7913},
+  {.name="rooms/room101.txt", .offset=3017864, .length=2544},
+  {.name="rooms/room102.txt", .offset=3020408, .length=3442},
+  {.name="rooms/room103.txt", .offset=3023850, .length=3314},
+  {.name="rooms/room104.txt", .offset=3027164, .length=6180},
+  {.name="rooms/room105.txt", .offset=3033344, .length=3230},
+  {.name="rooms/room106.txt", .offset=3036574, .length=6258},
+  {.name="rooms/room107.txt", .offset=3042832, .length=4299},
+  {.name="rooms/room108.txt", .offset=3047131, .length=3794},
+  {.name="rooms/room109.txt", .offset=3050925, .length=4756},
+  {.name="rooms/room110.txt", .offset=3055681, .length=4938},
+  {.name="rooms/room111.txt", .offset=3060619, .length=2474},
+  {.name="rooms/room112.txt", .offset=3063093, .length=4140},
+  {.name="rooms/room113.txt", .offset=3067233, .length=4686},
+  {.name="rooms/room114.txt", .offset=3071919, .length=5264},
+  {.name="rooms/room115.txt", .offset=3077183, .length=3937},
+  {.name="rooms/room116.txt", .offset=3081120, .length=2920},
+  {.name="rooms/room117.txt", .offset=3084040, .length=2241},
+  {.name="rooms/room118.txt", .offset=3086281, .length=3918},
+  {.name="rooms/room119.txt", .offset=3090199, .length=3712},
+  {.name="rooms/room120.txt", .offset=3093911, .length=6781},
+  {.name="rooms/room121.txt", .offset=3100692, .length=6332},
+  {.name="rooms/room122.txt", .offset=3107024, .length=4988},
+  {.name="rooms/room123.txt", .offset=3112012, .length=6209},
+  {.name="rooms/room124.txt", .offset=3118221, .length=5238},
+  {.name="rooms/room125.txt", .offset=3123459, .length=6203},
+  {.name="rooms/room126.txt", .offset=3129662, .length=2381},
+  {.name="rooms/room127.txt", .offset=3132043, .length=2612},
+  {.name="rooms/room128.txt", .offset=3134655, .length=5855},
+  {.name="rooms/room129.txt", .offset=3140510, .length=3458},
+  {.name="rooms/room130.txt", .offset=3143968, .length=5137},
+  {.name="rooms/room131.txt", .offset=3149105, .length=1231},
+  {.name="rooms/room132.txt", .offset=3150336, .length=1840},
+  {.name="rooms/room133.txt", .offset=3152176, .length=1872},
+  {.name="rooms/room134.txt", .offset=3154048, .length=7739},
+  {.name="rooms/room135.txt", .offset=3161787, .length=4338},
+  {.name="rooms/room136.txt", .offset=3166125, .length=2147},
+  {.name="rooms/room137.txt", .offset=3168272, .length=5475},
+  {.name="rooms/room138.txt", .offset=3173747, .length=2891},
+  {.name="rooms/room139.txt", .offset=3176638, .length=3295},
+  {.name="rooms/room140.txt", .offset=3179933, .length=4444},
+  {.name="rooms/room141.txt", .offset=3184377, .length=3603},
+  {.name="rooms/room142.txt", .offset=3187980, .length=3421},
+  {.name="rooms/room143.txt", .offset=3191401, .length=4445},
+  {.name="rooms/room144.txt", .offset=3195846, .length=3063},
+  {.name="rooms/room145.txt", .offset=3198909, .length=2579},
+  {.name="rooms/room146.txt", .offset=3201488, .length=7053},
+  {.name="rooms/room147.txt", .offset=3208541, .length=3857},
+  {.name="rooms/room148.txt", .offset=3212398, .length=2726},
+  {.name="rooms/room149.txt", .offset=3215124, .length=7724},
+  {.name="rooms/room150.txt", .offset=3222848, .length=3090},
+  {.name="rooms/room151.txt", .offset=3225938, .length=9530},
+  {.name="rooms/room152.txt", .offset=3235468, .length=6106},
+  {.name="rooms/room153.txt", .offset=3241574, .length=6483},
+  {.name="rooms/room154.txt", .offset=3248057, .length=9719},
+  {.name="rooms/room155.txt", .offset=3257776, .length=2525},
+  {.name="rooms/room156.txt", .offset=3260301, .length=3375},
+  {.name="rooms/room157.txt", .offset=3263676, .length=13678},
+  {.name="rooms/room158.txt", .offset=3277354, .length=4252},
+  {.name="rooms/room159.txt", .offset=3281606, .length=4065},
+  {.name="rooms/room160.txt", .offset=3285671, .length=2408},
+  {.name="rooms/room161.txt", .offset=3288079, .length=3156},
+  {.name="rooms/room162.txt", .offset=3291235, .length=4379},
+  {.name="rooms/room163.txt", .offset=3295614, .length=2821},
+  {.name="rooms/room164.txt", .offset=3298435, .length=9593},
+  {.name="rooms/room165.txt", .offset=3308028, .length=4398},
+  {.name="rooms/room166.txt", .offset=3312426, .length=6666},
+  {.name="rooms/room167.txt", .offset=3319092, .length=4309},
+  {.name="rooms/room168.txt", .offset=3323401, .length=4483},
+  {.name="rooms/room169.txt", .offset=3327884, .length=13509},
+  {.name="rooms/room170.txt", .offset=3341393, .length=3282},
+  {.name="rooms/room171.txt", .offset=3344675, .length=12460},
+  {.name="rooms/room172.txt", .offset=3357135, .length=10467},
+  {.name="rooms/room173.txt", .offset=3367602, .length=7015},
+  {.name="rooms/room174.txt", .offset=3374617, .length=5975},
+  {.name="rooms/room175.txt", .offset=3380592, .length=4368},
+  {.name="rooms/room176.txt", .offset=3384960, .length=14369},
+  {.name="rooms/room177.txt", .offset=3399329, .length=7239},
+  {.name="rooms/room178.txt", .offset=3406568, .length=4511},
+  {.name="rooms/room179.txt", .offset=3411079, .length=11829},
+  {.name="rooms/room180.txt", .offset=3422908, .length=3306},
+  {.name="rooms/room181.txt", .offset=3426214, .length=9733},
+  {.name="rooms/room182.txt", .offset=3435947, .length=9180},
+  {.name="rooms/room183.txt", .offset=3445127, .length=6067},
+  {.name="rooms/room184.txt", .offset=3451194, .length=6085},
+  {.name="rooms/room185.txt", .offset=3457279, .length=3235},
+  {.name="rooms/room186.txt", .offset=3460514, .length=2045},
+  {.name="rooms/room187.txt", .offset=3462559, .length=6807},
+  {.name="rooms/room188.txt", .offset=3469366, .length=5063},
+  {.name="rooms/room189.txt", .offset=3474429, .length=12918},
+  {.name="rooms/room190.txt", .offset=3487347, .length=8623},
+  {.name="rooms/room191.txt", .offset=3495970, .length=4260},
+  {.name="rooms/room192.txt", .offset=3500230, .length=6647},
+  {.name="rooms/room193.txt", .offset=3506877, .length=7935},
+  {.name="rooms/room194.txt", .offset=3514812, .length=3168},
+  {.name="rooms/room195.txt", .offset=3517980, .length=4015},
+  {.name="rooms/room196.txt", .offset=3521995, .length=6044},
+  {.name="rooms/room197.txt", .offset=3528039, .length=7221},
+  {.name="rooms/room198.txt", .offset=3535260, .length=5823},
+  {.name="rooms/room199.txt", .offset=3541083, .length=9477},
+  {.name="rooms/room200.txt", .offset=3550560, .length=6947},
+  {.name="rooms/room201.txt", .offset=3557507, .length=10722},
+  {.name="rooms/room202.txt", .offset=3568229, .length=14104},
+  {.name="rooms/room203.txt", .offset=3582333, .length=4815},
+  {.name="rooms/room204.txt", .offset=3587148, .length=16727},
+  {.name="rooms/room205.txt", .offset=3603875, .length=5820},
+  {.name="rooms/room206.txt", .offset=3609695, .length=5674},
+  {.name="rooms/room207.txt", .offset=3615369, .length=5140},
+  {.name="rooms/room208.txt", .offset=3620509, .length=2467},
+  {.name="rooms/room209.txt", .offset=3622976, .length=2419},
+  {.name="rooms/room210.txt", .offset=3625395, .length=7360},
+  {.name="rooms/room211.txt", .offset=3632755, .length=6908},
+  {.name="rooms/room212.txt", .offset=3639663, .length=5318},
+  {.name="rooms/room213.txt", .offset=3644981, .length=10078},
+  {.name="rooms/room214.txt", .offset=3655059, .length=8806},
+  {.name="rooms/room215.txt", .offset=3663865, .length=2665},
+  {.name="rooms/room216.txt", .offset=3666530, .length=4274},
+  {.name="rooms/room217.txt", .offset=3670804, .length=5642},
+  {.name="rooms/room218.txt", .offset=3676446, .length=6254},
+  {.name="rooms/room219.txt", .offset=3682700, .length=5327},
+  {.name="rooms/room220.txt", .offset=3688027, .length=5738},
+  {.name="rooms/room221.txt", .offset=3693765, .length=4806},
+  {.name="rooms/room222.txt", .offset=3698571, .length=7643},
+  {.name="rooms/room223.txt", .offset=3706214, .length=6102},
+  {.name="rooms/room224.txt", .offset=3712316, .length=5702},
+  {.name="rooms/room225.txt", .offset=3718018, .length=1694},
+  {.name="rooms/room226.txt", .offset=3719712, .length=7810},
+  {.name="rooms/room227.txt", .offset=3727522, .length=3212},
+  {.name="rooms/room228.txt", .offset=3730734, .length=2280},
+  {.name="rooms/room229.txt", .offset=3733014, .length=2423},
+  {.name="rooms/room230.txt", .offset=3735437, .length=2596},
+  {.name="rooms/room231.txt", .offset=3738033, .length=2965},
+  {.name="rooms/room232.txt", .offset=3740998, .length=3049},
+  {.name="rooms/room233.txt", .offset=3744047, .length=4003},
+  {.name="rooms/room234.txt", .offset=3748050, .length=4656},
+  {.name="rooms/room235.txt", .offset=3752706, .length=3464},
+  {.name="rooms/room236.txt", .offset=3756170, .length=1442},
+  {.name="rooms/room237.txt", .offset=3757612, .length=4391},
+  {.name="rooms/room238.txt", .offset=3762003, .length=2214},
+  {.name="rooms/room239.txt", .offset=3764217, .length=3523},
+  {.name="rooms/room240.txt", .offset=3767740, .length=3613},
+  {.name="rooms/room241.txt", .offset=3771353, .length=4320},
+  {.name="rooms/room242.txt", .offset=3775673, .length=3373},
+  {.name="rooms/room243.txt", .offset=3779046, .length=3088},
+  {.name="rooms/room244.txt", .offset=3782134, .length=3375},
+  {.name="rooms/room245.txt", .offset=3785509, .length=2750},
+  {.name="rooms/room246.txt", .offset=3788259, .length=6764},
+  {.name="rooms/room247.txt", .offset=3795023, .length=2957},
+  {.name="rooms/room248.txt", .offset=3797980, .length=3661},
+  {.name="rooms/room249.txt", .offset=3801641, .length=3740},
+  {.name="rooms/room250.txt", .offset=3805381, .length=4791},
+  {.name="rooms/room251.txt", .offset=3810172, .length=5212},
+  {.name="rooms/room252.txt", .offset=3815384, .length=1818},
+  {.name="rooms/room253.txt", .offset=3817202, .length=4378},
+  {.name="rooms/room254.txt", .offset=3821580, .length=6532},
+  {.name="rooms/room255.txt", .offset=3828112, .length=11964},
+  {.name="rooms/room256.txt", .offset=3840076, .length=2696},
+  {.name="rooms/room257.txt", .offset=3842772, .length=10929},
+  {.name="rooms/room258.txt", .offset=3853701, .length=5242},
+  {.name="rooms/room259.txt", .offset=3858943, .length=3361},
+  {.name="rooms/room260.txt", .offset=3862304, .length=1189},
+  {.name="rooms/room261.txt", .offset=3863493, .length=10161},
+  {.name="rooms/room262.txt", .offset=3873654, .length=8086},
+  {.name="rooms/room263.txt", .offset=3881740, .length=8888},
+  {.name="rooms/room264.txt", .offset=3890628, .length=11394},
+  {.name="rooms/room265.txt", .offset=3902022, .length=3226},
+  {.name="rooms/room266.txt", .offset=3905248, .length=8061},
+  {.name="rooms/room267.txt", .offset=3913309, .length=8791},
+  {.name="rooms/room268.txt", .offset=3922100, .length=8529},
+  {.name="rooms/room269.txt", .offset=3930629, .length=13300},
+  {.name="rooms/room270.txt", .offset=3943929, .length=1722},
+  {.name="rooms/room271.txt", .offset=3945651, .length=14521},
+  {.name="rooms/room272.txt", .offset=3960172, .length=8104},
+  {.name="rooms/room273.txt", .offset=3968276, .length=9064},
+  {.name="rooms/room274.txt", .offset=3977340, .length=5573},
+  {.name="rooms/room275.txt", .offset=3982913, .length=5906},
+  {.name="rooms/room276.txt", .offset=3988819, .length=3535},
+  {.name="rooms/room277.txt", .offset=3992354, .length=4584},
+  {.name="rooms/room278.txt", .offset=3996938, .length=5528},
+  {.name="rooms/room279.txt", .offset=4002466, .length=9336},
+  {.name="rooms/room280.txt", .offset=4011802, .length=2617},
+  {.name="rooms/room281.txt", .offset=4014419, .length=9786},
+  {.name="rooms/room282.txt", .offset=4024205, .length=13588},
+  {.name="rooms/room283.txt", .offset=4037793, .length=4730},
+  {.name="rooms/room284.txt", .offset=4042523, .length=4288},
+  {.name="rooms/room285.txt", .offset=4046811, .length=9004},
+  {.name="rooms/room286.txt", .offset=4055815, .length=11517},
+  {.name="rooms/room287.txt", .offset=4067332, .length=8606},
+  {.name="rooms/room288.txt", .offset=4075938, .length=4306},
+  {.name="rooms/room289.txt", .offset=4080244, .length=2511},
+  {.name="rooms/room290.txt", .offset=4082755, .length=4376},
+  {.name="rooms/room291.txt", .offset=4087131, .length=6638},
+  {.name="rooms/room292.txt", .offset=4093769, .length=4283},
+  {.name="rooms/room293.txt", .offset=4098052, .length=10089},
+  {.name="rooms/room294.txt", .offset=4108141, .length=2851},
+  {.name="rooms/room295.txt", .offset=4110992, .length=1639},
+  {.name="rooms/room296.txt", .offset=4112631, .length=1662},
+  {.name="rooms/room297.txt", .offset=4114293, .length=4882},
+  {.name="rooms/room298.txt", .offset=4119175, .length=4570},
+  {.name="rooms/room299.txt", .offset=4123745, .length=2184},
+  {.name="rooms/room300.txt", .offset=4125929, .length=2399},
+  {.name="rooms/room301.txt", .offset=4128328, .length=3236},
+  {.name="rooms/room302.txt", .offset=4131564, .length=2291},
+  {.name="rooms/room303.txt", .offset=4133855, .length=2348},
+  {.name="rooms/room304.txt", .offset=4136203, .length=1922},
+  {.name="rooms/room305.txt", .offset=4138125, .length=6557},
+  {.name="rooms/room306.txt", .offset=4144682, .length=5752},
+  {.name="rooms/room307.txt", .offset=4150434, .length=8965},
+  {.name="rooms/room308.txt", .offset=4159399, .length=9498},
+  {.name="rooms/room309.txt", .offset=4168897, .length=6244},
+  {.name="rooms/room310.txt", .offset=4175141, .length=11348},
+  {.name="rooms/room311.txt", .offset=4186489, .length=10632},
+  {.name="rooms/room312.txt", .offset=4197121, .length=4673},
+  {.name="rooms/room313.txt", .offset=4201794, .length=6756},
+  {.name="rooms/room314.txt", .offset=4208550, .length=4322},
+  {.name="rooms/room315.txt", .offset=4212872, .length=4117},
+  {.name="rooms/room316.txt", .offset=4216989, .length=4801},
+  {.name="rooms/room317.txt", .offset=4221790, .length=8690},
+  {.name="rooms/room318.txt", .offset=4230480, .length=3469},
+  {.name="rooms/room319.txt", .offset=4233949, .length=6703},
+  {.name="rooms/room320.txt", .offset=4240652, .length=11559},
+  {.name="rooms/room321.txt", .offset=4252211, .length=11261},
+  {.name="rooms/room322.txt", .offset=4263472, .length=5314},
+  {.name="rooms/room323.txt", .offset=4268786, .length=8557},
+  {.name="rooms/room324.txt", .offset=4277343, .length=4080},
+  {.name="rooms/room325.txt", .offset=4281423, .length=9179},
+  {.name="rooms/room326.txt", .offset=4290602, .length=4304},
+  {.name="rooms/room327.txt", .offset=4294906, .length=6105},
+  {.name="rooms/room328.txt", .offset=4301011, .length=2427},
+  {.name="rooms/room329.txt", .offset=4303438, .length=5383},
+  {.name="rooms/room330.txt", .offset=4308821, .length=6745},
+  {.name="rooms/room331.txt", .offset=4315566, .length=8271},
+  {.name="rooms/room332.txt", .offset=4323837, .length=8166},
+  {.name="rooms/room333.txt", .offset=4332003, .length=3707},
+  {.name="rooms/room334.txt", .offset=4335710, .length=3963},
+  {.name="rooms/room335.txt", .offset=4339673, .length=3614},
+  {.name="rooms/room336.txt", .offset=4343287, .length=7252},
+  {.name="rooms/room337.txt", .offset=4350539, .length=6371},
+  {.name="rooms/room338.txt", .offset=4356910, .length=7888},
+  {.name="rooms/room339.txt", .offset=4364798, .length=7456},
+  {.name="rooms/room340.txt", .offset=4372254, .length=10775},
+  {.name="rooms/room341.txt", .offset=4383029, .length=4408},
+  {.name="rooms/room342.txt", .offset=4387437, .length=5013},
+  {.name="rooms/room343.txt", .offset=4392450, .length=3368},
+  {.name="rooms/room344.txt", .offset=4395818, .length=10059},
+  {.name="rooms/room345.txt", .offset=4405877, .length=2298},
+  {.name="rooms/room346.txt", .offset=4408175, .length=8301},
+  {.name="rooms/room347.txt", .offset=4416476, .length=8060},
+  {.name="rooms/room348.txt", .offset=4424536, .length=10971},
+  {.name="rooms/room349.txt", .offset=4435507, .length=2947},
+  {.name="rooms/room350.txt", .offset=4438454, .length=2733},
+  {.name="rooms/room351.txt", .offset=4441187, .length=5346},
+  {.name="rooms/room352.txt", .offset=4446533, .length=3893},
+  {.name="rooms/room353.txt", .offset=4450426, .length=10165},
+  {.name="rooms/room354.txt", .offset=4460591, .length=11783},
+  {.name="rooms/room355.txt", .offset=4472374, .length=4291},
+  {.name="rooms/room356.txt", .offset=4476665, .length=5433},
+  {.name="rooms/room357.txt", .offset=4482098, .length=5129},
+  {.name="rooms/room358.txt", .offset=4487227, .length=7824},
+  {.name="rooms/room359.txt", .offset=4495051, .length=7348},
+  {.name="rooms/room360.txt", .offset=4502399, .length=5360},
+  {.name="rooms/room361.txt", .offset=4507759, .length=5847},
+  {.name="rooms/room362.txt", .offset=4513606, .length=4571},
+  {.name="rooms/room363.txt", .offset=4518177, .length=3574},
+  {.name="rooms/room364.txt", .offset=4521751, .length=3375},
+  {.name="rooms/room365.txt", .offset=4525126, .length=5186},
+  {.name="rooms/room366.txt", .offset=4530312, .length=5613},
+  {.name="rooms/room367.txt", .offset=4535925, .length=10653},
+  {.name="rooms/room368.txt", .offset=4546578, .length=5140},
+  {.name="rooms/room369.txt", .offset=4551718, .length=2876},
+  {.name="rooms/room370.txt", .offset=4554594, .length=8221},
+  {.name="rooms/room371.txt", .offset=4562815, .length=12797},
+  {.name="rooms/room372.txt", .offset=4575612, .length=11780},
+  {.name="rooms/room373.txt", .offset=4587392, .length=8675},
+  {.name="rooms/room374.txt", .offset=4596067, .length=12208},
+  {.name="rooms/room375.txt", .offset=4608275, .length=13802},
+  {.name="rooms/room376.txt", .offset=4622077, .length=3963},
+  {.name="rooms/room377.txt", .offset=4626040, .length=14987},
+  {.name="rooms/room378.txt", .offset=4641027, .length=9508},
+  {.name="rooms/room379.txt", .offset=4650535, .length=9902},
+  {.name="rooms/room380.txt", .offset=4660437, .length=4549},
+  {.name="rooms/room381.txt", .offset=4664986, .length=14061},
+  {.name="rooms/room382.txt", .offset=4679047, .length=11065},
+  {.name="rooms/room383.txt", .offset=4690112, .length=6769},
+  {.name="rooms/room384.txt", .offset=4696881, .length=1823},
+  {.name="rooms/room385.txt", .offset=4698704, .length=13018},
+  {.name="rooms/room386.txt", .offset=4711722, .length=3144},
+  {.name="rooms/room387.txt", .offset=4714866, .length=2522},
+  {.name="rooms/room388.txt", .offset=4717388, .length=11056},
+  {.name="rooms/room389.txt", .offset=4728444, .length=4374},
+  {.name="rooms/room390.txt", .offset=4732818, .length=6237},
+  {.name="rooms/room391.txt", .offset=4739055, .length=9418},
+  {.name="rooms/room392.txt", .offset=4748473, .length=5741},
+  {.name="rooms/room393.txt", .offset=4754214, .length=4745},
+  {.name="rooms/room394.txt", .offset=4758959, .length=6042},
+  {.name="rooms/room395.txt", .offset=4765001, .length=2219},
+  {.name="rooms/room396.txt", .offset=4767220, .length=3088},
+  {.name="rooms/room397.txt", .offset=4770308, .length=4696},
+  {.name="rooms/room398.txt", .offset=4775004, .length=6471},
+  {.name="rooms/room399.txt", .offset=4781475, .length=11167},
+  {.name="rooms/room400.txt", .offset=4792642, .length=1902},
+  {.name="rooms/room401.txt", .offset=4794544, .length=2324},
+  {.name="rooms/room402.txt", .offset=4796868, .length=1417},
+  {.name="rooms/room403.txt", .offset=4798285, .length=2594},
+  {.name="rooms/room404.txt", .offset=4800879, .length=1631},
+  {.name="rooms/room405.txt", .offset=4802510, .length=2398},
+  {.name="rooms/room406.txt", .offset=4804908, .length=2466},
+  {.name="rooms/room407.txt", .offset=4807374, .length=6570},
+  {.name="rooms/room408.txt", .offset=4813944, .length=5093},
+  {.name="rooms/room409.txt", .offset=4819037, .length=4036},
+  {.name="rooms/room410.txt", .offset=4823073, .length=6358},
+  {.name="rooms/room411.txt", .offset=4829431, .length=2630},
+  {.name="rooms/room412.txt", .offset=4832061, .length=11710},
+  {.name="rooms/room413.txt", .offset=4843771, .length=3704},
+  {.name="rooms/room414.txt", .offset=4847475, .length=2288},
+  {.name="rooms/room415.txt", .offset=4849763, .length=6829},
+  {.name="rooms/room416.txt", .offset=4856592, .length=9646},
+  {.name="rooms/room417.txt", .offset=4866238, .length=8326},
+  {.name="rooms/room418.txt", .offset=4874564, .length=2608},
+  {.name="rooms/room419.txt", .offset=4877172, .length=5886},
+  {.name="rooms/room420.txt", .offset=4883058, .length=6966},
+  {.name="rooms/room421.txt", .offset=4890024, .length=5648},
+  {.name="rooms/room422.txt", .offset=4895672, .length=3376},
+  {.name="rooms/room423.txt", .offset=4899048, .length=5820},
+  {.name="rooms/room424.txt", .offset=4904868, .length=3855},
+  {.name="rooms/room425.txt", .offset=4908723, .length=2786},
+  {.name="rooms/room426.txt", .offset=4911509, .length=8289},
+  {.name="rooms/room427.txt", .offset=4919798, .length=4724},
+  {.name="rooms/room428.txt", .offset=4924522, .length=6613},
+  {.name="rooms/room429.txt", .offset=4931135, .length=10493},
+  {.name="rooms/room430.txt", .offset=4941628, .length=1754},
+  {.name="rooms/room431.txt", .offset=4943382, .length=4559},
+  {.name="rooms/room432.txt", .offset=4947941, .length=7651},
+  {.name="rooms/room433.txt", .offset=4955592, .length=3166},
+  {.name="rooms/room434.txt", .offset=4958758, .length=4966},
+  {.name="rooms/room435.txt", .offset=4963724, .length=4404},
+  {.name="rooms/room436.txt", .offset=4968128, .length=7499},
+  {.name="rooms/room437.txt", .offset=4975627, .length=17129},
+  {.name="rooms/room438.txt", .offset=4992756, .length=4277},
+  {.name="rooms/room439.txt", .offset=4997033, .length=1938},
+  {.name="rooms/room440.txt", .offset=4998971, .length=8711},
+  {.name="rooms/room441.txt", .offset=5007682, .length=10000},
+  {.name="rooms/room442.txt", .offset=5017682, .length=7113},
+  {.name="rooms/room443.txt", .offset=5024795, .length=6776},
+  {.name="rooms/room444.txt", .offset=5031571, .length=5100},
+  {.name="rooms/room445.txt", .offset=5036671, .length=4595},
+  {.name="rooms/room446.txt", .offset=5041266, .length=2420},
+  {.name="rooms/room447.txt", .offset=5043686, .length=2429},
+  {.name="rooms/room448.txt", .offset=5046115, .length=4946},
+  {.name="rooms/room449.txt", .offset=5051061, .length=2426},
+  {.name="rooms/room450.txt", .offset=5053487, .length=1772},
+  {.name="rooms/room451.txt", .offset=5055259, .length=2684},
+  {.name="rooms/room452.txt", .offset=5057943, .length=2829},
+  {.name="rooms/room453.txt", .offset=5060772, .length=2270},
+  {.name="rooms/room454.txt", .offset=5063042, .length=3347},
+  {.name="rooms/room455.txt", .offset=5066389, .length=3336},
+  {.name="rooms/room456.txt", .offset=5069725, .length=4150},
+  {.name="rooms/room457.txt", .offset=5073875, .length=2276},
+  {.name="rooms/room458.txt", .offset=5076151, .length=3623},
+  {.name="rooms/room459.txt", .offset=5079774, .length=5628},
+  {.name="rooms/room460.txt", .offset=5085402, .length=2400},
+  {.name="rooms/room461.txt", .offset=5087802, .length=2491},
+  {.name="rooms/room462.txt", .offset=5090293, .length=1406},
+  {.name="rooms/room463.txt", .offset=5091699, .length=2075},
+  {.name="rooms/room464.txt", .offset=5093774, .length=3665},
+  {.name="rooms/room465.txt", .offset=5097439, .length=4190},
+  {.name="rooms/room466.txt", .offset=5101629, .length=1783},
+  {.name="rooms/room467.txt", .offset=5103412, .length=2430},
+  {.name="rooms/room468.txt", .offset=5105842, .length=2303},
+  {.name="rooms/room469.txt", .offset=5108145, .length=4288},
+  {.name="rooms/room470.txt", .offset=5112433, .length=5984},
+  {.name="rooms/room471.txt", .offset=5118417, .length=2141},
+  {.name="rooms/room472.txt", .offset=5120558, .length=2469},
+  {.name="rooms/room473.txt", .offset=5123027, .length=2229},
+  {.name="rooms/room474.txt", .offset=5125256, .length=4950},
+  {.name="rooms/room475.txt", .offset=5130206, .length=1564},
+  {.name="rooms/room476.txt", .offset=5131770, .length=2413},
+  {.name="rooms/room477.txt", .offset=5134183, .length=1726},
+  {.name="rooms/room478.txt", .offset=5135909, .length=2952},
+  {.name="rooms/room479.txt", .offset=5138861, .length=2400},
+  {.name="rooms/room480.txt", .offset=5141261, .length=6512},
+};
+const size_t resource_index_size = 505;
@@ -31,13 +31,17 @@
 #include "azimuth/gui/event.h"
 #include "azimuth/gui/screen.h"
 #include "azimuth/state/dialog.h"
+#include "azimuth/state/interpolate.h"
 #include "azimuth/state/planet.h"
 #include "azimuth/state/player.h"
+#include "azimuth/state/room_builder.h"
 #include "azimuth/state/save.h"
 #include "azimuth/state/space.h"
 #include "azimuth/tick/script.h"
 #include "azimuth/tick/space.h"
 #include "azimuth/util/misc.h"
+#include "azimuth/util/profile.h"
+#include "azimuth/view/hud.h"
 #include "azimuth/view/space.h"
 
 /*===========================================================================*/
@@ -48,6 +52,17 @@ static const char save_success_paragraph[] =
   "Shields refilled and $Ggame saved$W.";
 
 static az_space_state_t state;
+// Positions of moving objects as of the tick before last, and as of the last
+// tick, for drawing frames in between ticks (see az_frame_clock_ticks):
+static az_space_positions_t previous_positions, current_positions;
+// We keep one room builder (and its worker thread) around for the life of the
+// program, rather than making a new one for each game.
+static az_room_builder_t *room_builder = NULL;
+
+#if AZ_PROFILING
+// Whether to draw the profiler overlay (toggled with Cmd/Ctrl-P):
+static bool show_profiler = false;
+#endif
 
 static void position_ship_at_save_point_if_any(void) {
   const az_room_t *room = &state.planet->rooms[state.ship.player.current_room];
@@ -69,16 +84,20 @@ static void begin_saved_game(
   assert(saved_game_index < AZ_ARRAY_SIZE(saved_games->games));
   const az_saved_game_t *saved_game = &saved_games->games[saved_game_index];
 
+  if (room_builder == NULL) room_builder = az_create_room_builder();
+  else az_cancel_room_build(room_builder);
+
   AZ_ZERO_OBJECT(&state);
   state.planet = planet;
   state.prefs = prefs;
+  state.room_builder = room_builder;
   state.save_file_index = saved_game_index;
   state.mode = AZ_MODE_NORMAL;
 
   if (saved_game->present) {
     // Resume saved game:
     state.ship.player = saved_game->player;
-    az_enter_room(&state, &planet->rooms[state.ship.player.current_room]);
+    az_enter_room(&state, az_get_room(planet, state.ship.player.current_room));
     position_ship_at_save_point_if_any();
     az_after_entering_room(&state);
     state.console_help_message_cooldown = 10.0;
@@ -121,66 +140,94 @@ az_space_action_t az_space_event_loop(
     const az_planet_t *planet, az_saved_games_t *saved_games,
     az_preferences_t *prefs, int saved_game_index) {
   begin_saved_game(planet, saved_games, prefs, saved_game_index);
+  az_reset_frame_clock();
 
   while (true) {
-    // If we just finished the game intro, start us on the first room.
-    if (state.intro && state.sync_vm.script == NULL) {
-      state.intro = false;
-      save_current_game(saved_games);
-      az_enter_room(&state, &planet->rooms[planet->start_room]);
-      position_ship_at_save_point_if_any();
-      az_after_entering_room(&state);
-    }
+    // Tick the state as many times as we need to keep up with real time
+    // (which may be zero times, if we're drawing faster than we tick).
+    double blend;
+    const int num_ticks = az_frame_clock_ticks(&blend);
+    for (int tick = 0; tick < num_ticks; ++tick) {
+      // If we just finished the game intro, start us on the first room.
+      if (state.intro && state.sync_vm.script == NULL) {
+        state.intro = false;
+        save_current_game(saved_games);
+        az_enter_room(&state, az_get_room(planet, planet->start_room));
+        position_ship_at_save_point_if_any();
+        az_after_entering_room(&state);
+      }
 
-    // Tick the state and redraw the screen.
-    update_held_controls(prefs->key_for_control);
-    az_tick_space_state(&state, AZ_FRAME_TIME_SECONDS);
-    az_tick_audio(&state.soundboard);
-    az_start_screen_redraw(); {
-      az_space_draw_screen(&state);
-    } az_finish_screen_redraw();
-    AZ_ZERO_OBJECT(&state.ship.controls);
+      az_save_space_positions(&state, &previous_positions);
+      update_held_controls(prefs->key_for_control);
+      az_tick_space_state(&state, AZ_FRAME_TIME_SECONDS);
+      az_tick_audio(&state.soundboard);
+      AZ_ZERO_OBJECT(&state.ship.controls);
 
-    // Check the current mode; we may need to do something before we move on to
-    // handling events.
-    if (state.victory) {
-      az_victory_event_loop(saved_games, &state.ship.player);
-      return AZ_SA_VICTORY;
-    } else if (state.mode == AZ_MODE_GAME_OVER) {
-      // If we're at the end of the game over animation, exit this controller
-      // and signal that we should transition to the game over screen
-      // controller.
-      if (state.game_over_mode.step == AZ_GOS_FADE_OUT &&
-          state.game_over_mode.progress >= 1.0) {
-        return AZ_SA_GAME_OVER;
-      }
-    } else if (state.mode == AZ_MODE_PAUSING) {
-      // If we're at the end of the pausing fade-out, directly engage the
-      // paused screen controller, and once it's done, either resume the game
-      // or exit to the title screen, as appropriate.
-      if (state.pausing_mode.step == AZ_PSS_FADE_OUT &&
-          state.pausing_mode.fade_alpha == 1.0) {
-        switch (az_paused_event_loop(planet, prefs, &state.ship)) {
-          case AZ_PA_RESUME:
-            state.pausing_mode.step = AZ_PSS_FADE_IN;
-            break;
-          case AZ_PA_EXIT_TO_TITLE:
-            return AZ_SA_EXIT_TO_TITLE;
+      // Check the current mode; we may need to do something before we move
+      // on.  We do this after every tick, since some of these modes (such as
+      // AZ_CSS_SAVE) only last for a single tick.
+      if (state.victory) {
+        az_victory_event_loop(saved_games, &state.ship.player);
+        return AZ_SA_VICTORY;
+      } else if (state.mode == AZ_MODE_GAME_OVER) {
+        // If we're at the end of the game over animation, exit this
+        // controller and signal that we should transition to the game over
+        // screen controller.
+        if (state.game_over_mode.step == AZ_GOS_FADE_OUT &&
+            state.game_over_mode.progress >= 1.0) {
+          return AZ_SA_GAME_OVER;
         }
+      } else if (state.mode == AZ_MODE_PAUSING) {
+        // If we're at the end of the pausing fade-out, directly engage the
+        // paused screen controller, and once it's done, either resume the
+        // game or exit to the title screen, as appropriate.
+        if (state.pausing_mode.step == AZ_PSS_FADE_OUT &&
+            state.pausing_mode.fade_alpha == 1.0) {
+          switch (az_paused_event_loop(planet, prefs, &state.ship)) {
+            case AZ_PA_RESUME:
+              state.pausing_mode.step = AZ_PSS_FADE_IN;
+              break;
+            case AZ_PA_EXIT_TO_TITLE:
+              return AZ_SA_EXIT_TO_TITLE;
+          }
+          // Don't try to catch up on the time spent paused.
+          az_reset_frame_clock();
+          break;
+        }
+      } else if (state.mode == AZ_MODE_CONSOLE &&
+                 state.console_mode.step == AZ_CSS_SAVE) {
+        // If we need to save the game, do so.
+        const bool ok = save_current_game(saved_games);
+        if (ok) az_set_message(&state, save_success_paragraph);
+        else az_set_message(&state, save_failed_paragraph);
       }
-    } else if (state.mode == AZ_MODE_CONSOLE &&
-               state.console_mode.step == AZ_CSS_SAVE) {
-      // If we need to save the game, do so.
-      const bool ok = save_current_game(saved_games);
-      if (ok) az_set_message(&state, save_success_paragraph);
-      else az_set_message(&state, save_failed_paragraph);
     }
 
+    // Redraw the screen, with moving objects partway between where they were
+    // on the last two ticks.  (There's always been at least one tick by now,
+    // since the first call to az_frame_clock_ticks after a reset returns 1.)
+    az_interpolate_space_positions(&state, &previous_positions, blend,
+                                   &current_positions);
+    az_start_screen_redraw(); {
+      az_space_draw_screen(&state);
+#if AZ_PROFILING
+      if (show_profiler) az_draw_profile_overlay();
+#endif
+    } az_finish_screen_redraw_at_display_rate();
+    AZ_PROFILE_END_FRAME();
+    az_restore_space_positions(&state, &current_positions);
+
     // Handle the event queue.
     az_event_t event;
     while (az_poll_event(&event)) {
       switch (event.kind) {
         case AZ_EVENT_KEY_DOWN:
+#if AZ_PROFILING
+          if (event.key.command && event.key.id == AZ_KEY_P) {
+            show_profiler = !show_profiler;
+            break;
+          }
+#endif
           if (state.skip.allowed && !state.skip.active) {
             assert(state.sync_vm.script != NULL);
             if (prefs->key_for_control[AZ_CONTROL_PAUSE] == event.key.id) {
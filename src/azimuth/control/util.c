@@ -23,6 +23,7 @@
 
 #include <assert.h>
 #include <stdbool.h>
+#include <stdio.h>
 #include <stdlib.h>
 
 #if !defined(__WINDOWS__) && !defined(__APPLE__)
@@ -33,8 +34,12 @@
 
 #include "azimuth/gui/audio.h"
 #include "azimuth/state/save.h"
+#include "azimuth/state/sound.h"
 #include "azimuth/system/resource.h"
+#include "azimuth/tick/script.h"
 #include "azimuth/util/prefs.h"
+#include "azimuth/util/profile.h"
+#include "azimuth/util/rw.h"
 #include "azimuth/util/string.h"
 #include "azimuth/view/prefs.h"
 
@@ -155,4 +160,39 @@ bool az_save_saved_games(const az_saved_games_t *saved_games) {
   return success;
 }
 
+void az_load_sound_datas(void) {
+  char *data_dir = az_get_app_data_directory();
+  if (data_dir == NULL) {
+    az_init_sound_datas(NULL);
+    return;
+  }
+  char *cache_path = az_strprintf("%s/sounds.cache", data_dir);
+  SDL_free(data_dir);
+  az_init_sound_datas(cache_path);
+  free(cache_path);
+}
+
+#if AZ_PROFILING
+void az_save_profile_history(void) {
+  if (az_profile_history_size() == 0) return;
+  char *data_dir = az_get_app_data_directory();
+  if (data_dir == NULL) return;
+  char *csv_path = az_strprintf("%s/profile.csv", data_dir);
+  char *script_path = az_strprintf("%s/script_profile.txt", data_dir);
+  SDL_free(data_dir);
+  if (!az_write_profile_csv(csv_path)) {
+    fprintf(stderr, "WARNING: Failed to write %s\n", csv_path);
+  }
+  az_writer_t writer;
+  bool ok = az_file_writer(script_path, &writer);
+  if (ok) {
+    ok = az_write_script_profile(&writer);
+    az_wclose(&writer);
+  }
+  if (!ok) fprintf(stderr, "WARNING: Failed to write %s\n", script_path);
+  free(script_path);
+  free(csv_path);
+}
+#endif
+
 /*===========================================================================*/
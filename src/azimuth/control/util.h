@@ -26,6 +26,7 @@
 #include "azimuth/state/planet.h"
 #include "azimuth/state/save.h"
 #include "azimuth/util/prefs.h"
+#include "azimuth/util/profile.h"
 #include "azimuth/view/prefs.h"
 
 /*===========================================================================*/
@@ -40,6 +41,17 @@ void az_load_saved_games(const az_planet_t *planet,
                          az_saved_games_t *saved_games);
 bool az_save_saved_games(const az_saved_games_t *saved_games);
 
+// Render all sound effects (see az_init_sound_datas), reusing any that were
+// saved in the sound cache file in the app data directory by a previous run.
+void az_load_sound_datas(void);
+
+#if AZ_PROFILING
+// Write the profiler's recent frame history to profile.csv in the app data
+// directory, and the script VM's profile to script_profile.txt.  This takes
+// no arguments and returns nothing so that it can be registered with atexit.
+void az_save_profile_history(void);
+#endif
+
 /*===========================================================================*/
 
 #endif // AZIMUTH_CONTROL_UTIL_H_
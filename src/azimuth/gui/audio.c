@@ -20,139 +20,95 @@
 #include "azimuth/gui/audio.h"
 
 #include <assert.h>
+#include <math.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include <SDL.h>
 
 #include "azimuth/util/audio.h"
 #include "azimuth/util/misc.h"
+#include "azimuth/util/mixer.h"
 #include "azimuth/util/music.h"
+#include "azimuth/util/music_stream.h"
 #include "azimuth/util/sound.h"
+#include "azimuth/util/thread.h"
 #include "azimuth/util/vector.h"
 #include "azimuth/util/warning.h"
 
 /*===========================================================================*/
 // Constants:
 
-// We use 16-bit mono at 22050 samples/sec and a buffer size of 1024 samples.
+// We output 16-bit stereo at 48000 frames/sec, resampling music and sound
+// effects up from AZ_AUDIO_RATE, with a buffer size of 2048 frames.  The rate
+// can be any rate of at least AZ_AUDIO_RATE (e.g. 44100), and the number of
+// channels can be 1 for mono; if the device wants something else, SDL will
+// convert our output for it.
 #define AUDIO_FORMAT AUDIO_S16SYS
-#define AUDIO_CHANNELS 1
-AZ_STATIC_ASSERT(AZ_AUDIO_RATE == 22050);
-#define AUDIO_BUFFERSIZE 1024
+#define OUTPUT_RATE 48000
+#define OUTPUT_CHANNELS 2
+#define AUDIO_BUFFERSIZE 2048
 
-// Values controlling global_music_volume and global_sound_volume:
-#define VOLUME_SHIFT 8
-#define MAX_VOLUME (1 << VOLUME_SHIFT)
-// How many sound effects we can play simultaneously:
-#define MAX_SIMULTANEOUS_SOUNDS 16
+// Voice stealing priorities (see az_start_mixer_voice).  Persisted sounds
+// win over one-shot sounds, since they are typically tied to something still
+// going on in the game (and would otherwise restart the next frame).
+#define ONESHOT_PRIORITY 0
+#define PERSIST_PRIORITY 1
 
 /*===========================================================================*/
 // Globals:
 
-// All of these globals are protected by the SDL audio mutex.  Any reads/writes
-// outside of audio_callback() must be wrapped in calls to SDL_LockAudio() and
-// SDL_UnlockAudio().
+// The game thread talks to the audio callback only through this queue, so
+// that neither one ever has to wait on the other.  The game thread is the
+// only producer, and audio_callback() is the only consumer.
+static az_audio_queue_t command_queue;
 
-static int global_music_volume = MAX_VOLUME; // 0 to MAX_VOLUME
-static int global_sound_volume = MAX_VOLUME; // 0 to MAX_VOLUME
+// Music is rendered ahead of time into this stream by music_thread, so that
+// the audio callback only has to mix it.  The audio callback is the stream's
+// only consumer.
+static az_music_stream_t music_stream;
+static az_thread_t *music_thread = NULL;
 
-static az_music_synth_t music_synth;
-static int music_fade_volume = 0; // 0 to MAX_VOLUME
-static int music_fade_slowdown = 0;
-static int music_fade_counter = 0;
-static const az_music_t *next_music = NULL;
-static int next_music_flag = 0;
+// All of the rest of these globals are owned by the audio thread, and should
+// only be accessed from within audio_callback() (or while the audio device is
+// closed).
 
-static struct {
-  const az_sound_data_t *data;
-  size_t sample_index;
-  int volume; // 0 to MAX_VOLUME
-  bool loop, persisted, paused, finished;
-} active_sounds[MAX_SIMULTANEOUS_SOUNDS];
+static float global_music_volume = 1.0f; // 0 to 1
+static float global_sound_volume = 1.0f; // 0 to 1
 
-static void audio_callback(void *userdata, Uint8 *bytes, int numbytes) {
-  assert(numbytes % sizeof(int16_t) == 0);
-  const int num_samples = numbytes / sizeof(int16_t);
-  int16_t *samples = (int16_t*)bytes;
+static az_mixer_t mixer;
 
-  if (next_music != NULL && music_fade_volume == 0) {
-    az_reset_music_synth(&music_synth, next_music, next_music_flag);
-    music_fade_volume = MAX_VOLUME;
-    music_fade_slowdown = 0;
-    music_fade_counter = 0;
-    next_music = NULL;
-    next_music_flag = 0;
-  }
-  az_synthesize_music(&music_synth, samples, num_samples);
-
-  for (int i = 0; i < num_samples; ++i) {
-    int sound_sample = 0;
-    AZ_ARRAY_LOOP(sound, active_sounds) {
-      if (sound->data == NULL) continue;
-      if (sound->paused || sound->finished) {
-        assert(sound->persisted);
-        continue;
-      }
-      assert(sound->data->num_samples > 0);
-      assert(sound->sample_index < sound->data->num_samples);
-      sound_sample += (sound->data->samples[sound->sample_index] *
-                       sound->volume) >> VOLUME_SHIFT;
-      ++sound->sample_index;
-      if (sound->sample_index >= sound->data->num_samples) {
-        if (sound->loop) {
-          assert(sound->persisted);
-          sound->sample_index = 0;
-        } else if (sound->persisted) {
-          sound->finished = true;
-        } else AZ_ZERO_OBJECT(sound);
-      }
-    }
-    int sample = (global_music_volume * (int)samples[i]) >> VOLUME_SHIFT;
-    sample = (music_fade_volume * sample) >> VOLUME_SHIFT;
-    sample += (global_sound_volume * sound_sample) >> VOLUME_SHIFT;
-    samples[i] = az_imin(az_imax(INT16_MIN, sample), INT16_MAX);
-
-    // Fade out music, if applicable:
-    if (music_fade_slowdown > 0 && music_fade_volume > 0) {
-      assert(music_fade_counter > 0);
-      assert(music_fade_counter <= music_fade_slowdown);
-      --music_fade_counter;
-      if (music_fade_counter == 0) {
-        music_fade_counter = music_fade_slowdown;
-        --music_fade_volume;
-        if (music_fade_volume == 0 && music_synth.music != NULL) {
-          az_reset_music_synth(&music_synth, NULL, 0);
-        }
-      }
-    }
-  }
-}
+static const az_music_t *current_music = NULL; // what music_stream plays
+static float music_fade_volume = 0.0f; // 0 to 1
+static float music_fade_step = 0.0f; // how much to fade per output frame
+static const az_music_t *next_music = NULL;
+static int next_music_flag = 0;
 
 /*===========================================================================*/
 // Music:
 
 static void tick_music(const az_soundboard_t *soundboard) {
   if (soundboard->change_current_music_flag) {
-    music_synth.flag = soundboard->new_current_music_flag;
+    az_set_stream_music_flag(&music_stream, soundboard->new_current_music_flag);
   }
   if (soundboard->change_music) {
-    if (soundboard->next_music == music_synth.music) {
-      music_fade_slowdown = 0;
+    if (soundboard->next_music == current_music) {
+      music_fade_step = 0.0f;
       next_music = NULL;
       next_music_flag = 0;
       if (soundboard->change_next_music_flag) {
-        music_synth.flag = soundboard->new_next_music_flag;
+        az_set_stream_music_flag(&music_stream,
+                                 soundboard->new_next_music_flag);
       }
     } else {
-      music_fade_slowdown =
-        (int)((soundboard->music_fade_out_seconds * AZ_AUDIO_RATE) /
-              MAX_VOLUME);
+      music_fade_step = 1.0f /
+        fmaxf(1.0f, (float)(soundboard->music_fade_out_seconds *
+                            mixer.output_rate));
       next_music = soundboard->next_music;
       next_music_flag = (soundboard->change_next_music_flag ?
                          soundboard->new_next_music_flag : 0);
     }
-    music_fade_counter = music_fade_slowdown;
   } else assert(!soundboard->change_next_music_flag);
 }
 
@@ -164,65 +120,130 @@ static void tick_sounds(const az_soundboard_t *soundboard) {
   // status based on the soundboard.
   bool already_active[soundboard->num_persists];
   memset(already_active, 0, sizeof(bool) * soundboard->num_persists);
-  AZ_ARRAY_LOOP(sound, active_sounds) {
-    if (sound->data == NULL) continue;
-    if (!sound->persisted) {
-      assert(!sound->loop);
+  AZ_ARRAY_LOOP(voice, mixer.voices) {
+    if (voice->data == NULL) continue;
+    if (!voice->persisted) {
+      assert(!voice->loop);
       continue;
     }
     // Check if this sound is in the soundboard's persists array.  If not, we
     // will implicitly halt and reset the sound.
     bool reset = true;
     for (int i = 0; i < soundboard->num_persists; ++i) {
-      if (soundboard->persists[i].sound_data != sound->data) continue;
+      if (soundboard->persists[i].sound_data != voice->data) continue;
       if (!soundboard->persists[i].reset) {
         reset = false;
         already_active[i] = true;
-        sound->volume = (int)(soundboard->persists[i].volume * MAX_VOLUME);
-        sound->paused = !soundboard->persists[i].play;
+        voice->volume = soundboard->persists[i].volume;
+        voice->paused = !soundboard->persists[i].play;
       }
       break;
     }
     // If we're supposed to reset this sound, halt it.
-    if (reset) AZ_ZERO_OBJECT(sound);
+    if (reset) AZ_ZERO_OBJECT(voice);
   }
 
   // Second, go through the soundboard and start playing any new persistent
-  // sounds that need to be started.
+  // sounds that need to be started.  If all voices are busy, these will take
+  // over the oldest one-shot sound.
   for (int i = 0; i < soundboard->num_persists; ++i) {
     if (already_active[i] || !soundboard->persists[i].play) continue;
     if (soundboard->persists[i].sound_data->num_samples == 0) continue;
-    bool success = false;
-    AZ_ARRAY_LOOP(sound, active_sounds) {
-      if (sound->data != NULL) continue;
-      sound->data = soundboard->persists[i].sound_data;
-      sound->sample_index = 0;
-      sound->volume = (int)(soundboard->persists[i].volume * MAX_VOLUME);
-      sound->loop = soundboard->persists[i].loop;
-      sound->persisted = true;
-      sound->paused = false;
-      success = true;
-      break;
-    }
-    if (!success) AZ_WARNING_ONCE("Could not play persistent sound\n");
+    az_mixer_voice_t *voice = az_start_mixer_voice(
+        &mixer, soundboard->persists[i].sound_data, PERSIST_PRIORITY);
+    if (voice == NULL) continue;
+    voice->volume = soundboard->persists[i].volume;
+    voice->loop = soundboard->persists[i].loop;
+    voice->persisted = true;
   }
 
-  // Third, start playing any new one-shot sounds.
+  // Third, start playing any new one-shot sounds.  If all voices are busy,
+  // each of these will cut off the oldest one-shot sound.
   for (int i = 0; i < soundboard->num_oneshots; ++i) {
     if (soundboard->oneshots[i].sound_data->num_samples == 0) continue;
-    bool success = false;
-    AZ_ARRAY_LOOP(sound, active_sounds) {
-      if (sound->data != NULL) continue;
-      sound->data = soundboard->oneshots[i].sound_data;
-      sound->sample_index = 0;
-      sound->volume = (int)(soundboard->oneshots[i].volume * MAX_VOLUME);
-      sound->loop = false;
-      sound->persisted = false;
-      sound->paused = false;
-      success = true;
-      break;
+    az_mixer_voice_t *voice = az_start_mixer_voice(
+        &mixer, soundboard->oneshots[i].sound_data, ONESHOT_PRIORITY);
+    if (voice == NULL) continue;
+    voice->volume = soundboard->oneshots[i].volume;
+    voice->pan = soundboard->oneshots[i].pan;
+  }
+}
+
+/*===========================================================================*/
+// Audio callback:
+
+// The soundboard being rebuilt from queued commands, up until the next
+// AZ_AUDIO_CMD_END_FRAME:
+static az_soundboard_t pending_soundboard;
+
+// Apply all commands that the game thread has sent since the last callback.
+static void drain_command_queue(void) {
+  az_audio_command_t command;
+  while (az_pop_audio_command(&command_queue, &command)) {
+    switch (command.kind) {
+      case AZ_AUDIO_CMD_END_FRAME:
+        tick_music(&pending_soundboard);
+        tick_sounds(&pending_soundboard);
+        AZ_ZERO_OBJECT(&pending_soundboard);
+        break;
+      case AZ_AUDIO_CMD_MUSIC_VOLUME:
+        global_music_volume = fminf(fmaxf(0.0f, command.volume), 1.0f);
+        break;
+      case AZ_AUDIO_CMD_SOUND_VOLUME:
+        global_sound_volume = fminf(fmaxf(0.0f, command.volume), 1.0f);
+        break;
+      default:
+        az_apply_audio_command(&command, &pending_soundboard);
+        break;
+    }
+  }
+}
+
+// Mix one block of output (at most AZ_MIXER_BLOCK_FRAMES frames).
+static void mix_block(int16_t *samples, int num_frames) {
+  if (next_music != NULL && music_fade_volume == 0.0f) {
+    current_music = next_music;
+    az_change_stream_music(&music_stream, current_music, next_music_flag);
+    music_fade_volume = 1.0f;
+    music_fade_step = 0.0f;
+    next_music = NULL;
+    next_music_flag = 0;
+  }
+
+  float mix[AZ_MIXER_BLOCK_FRAMES * AZ_MIXER_MAX_CHANNELS];
+  const int num_samples = num_frames * mixer.num_channels;
+  memset(mix, 0, num_samples * sizeof(float));
+  int16_t music_samples[AZ_MIXER_BLOCK_FRAMES];
+  const int num_music_samples = az_music_samples_needed(&mixer, num_frames);
+  az_read_music_stream(&music_stream, music_samples, num_music_samples);
+  az_mix_music(&mixer, music_samples, global_music_volume * music_fade_volume,
+               -global_music_volume * music_fade_step, mix, num_frames);
+  az_mix_voices(&mixer, global_sound_volume, mix, num_frames);
+  az_soft_clip_mix(mix, samples, num_samples);
+
+  // Fade out music, if applicable:
+  if (music_fade_step > 0.0f && music_fade_volume > 0.0f) {
+    music_fade_volume =
+      fmaxf(0.0f, music_fade_volume - music_fade_step * num_frames);
+    if (music_fade_volume == 0.0f && current_music != NULL) {
+      current_music = NULL;
+      az_change_stream_music(&music_stream, NULL, 0);
     }
-    if (!success) AZ_WARNING_ONCE("Could not play sound effect\n");
+  }
+}
+
+static void audio_callback(void *userdata, Uint8 *bytes, int numbytes) {
+  const int frame_size = sizeof(int16_t) * mixer.num_channels;
+  assert(numbytes % frame_size == 0);
+  int num_frames = numbytes / frame_size;
+  int16_t *samples = (int16_t*)bytes;
+
+  drain_command_queue();
+  while (num_frames > 0) {
+    const int block_frames = az_imin(num_frames, AZ_MIXER_BLOCK_FRAMES);
+    mix_block(samples, block_frames);
+    samples += block_frames * mixer.num_channels;
+    num_frames -= block_frames;
   }
 }
 
@@ -232,13 +253,26 @@ static void tick_sounds(const az_soundboard_t *soundboard) {
 static bool audio_system_initialized = false;
 static bool audio_system_paused = false;
 
+static void stop_music_thread(void) {
+  az_stop_music_stream(&music_stream);
+  az_join_thread(music_thread);
+  music_thread = NULL;
+  az_destroy_music_stream(&music_stream);
+}
+
 void az_init_audio(void) {
   assert(!audio_system_initialized);
 
+  az_init_mixer(&mixer, OUTPUT_RATE, OUTPUT_CHANNELS);
+  az_init_music_stream(&music_stream);
+  music_thread = az_start_thread(az_run_music_stream, &music_stream);
+  // Functions registered with atexit are called in reverse order, so this
+  // way the audio device is closed before the music thread is stopped.
+  atexit(stop_music_thread);
   SDL_AudioSpec audio_spec = {
-    .freq = AZ_AUDIO_RATE,
+    .freq = OUTPUT_RATE,
     .format = AUDIO_FORMAT,
-    .channels = AUDIO_CHANNELS,
+    .channels = OUTPUT_CHANNELS,
     .samples = AUDIO_BUFFERSIZE,
     .callback = &audio_callback
   };
@@ -250,35 +284,33 @@ void az_init_audio(void) {
   audio_system_initialized = true;
 }
 
-static int to_int_volume(float volume) {
-  return az_imin(az_imax(0, (int)(volume * (float)MAX_VOLUME)), MAX_VOLUME);
+static void push_volume_command(az_audio_command_kind_t kind, float volume) {
+  const az_audio_command_t command = { .kind = kind, .volume = volume };
+  if (!az_push_audio_command(&command_queue, &command)) {
+    AZ_WARNING_ONCE("Audio command queue is full; dropped volume change\n");
+  }
 }
 
 void az_set_global_music_volume(float volume) {
   assert(audio_system_initialized);
   assert(!audio_system_paused);
-  const int new_volume = to_int_volume(volume);
-  SDL_LockAudio(); {
-    global_music_volume = new_volume;
-  } SDL_UnlockAudio();
+  push_volume_command(AZ_AUDIO_CMD_MUSIC_VOLUME, volume);
 }
 
 void az_set_global_sound_volume(float volume) {
   assert(audio_system_initialized);
   assert(!audio_system_paused);
-  const int new_volume = to_int_volume(volume);
-  SDL_LockAudio(); {
-    global_sound_volume = new_volume;
-  } SDL_UnlockAudio();
+  push_volume_command(AZ_AUDIO_CMD_SOUND_VOLUME, volume);
 }
 
 void az_tick_audio(az_soundboard_t *soundboard) {
   assert(audio_system_initialized);
   assert(!audio_system_paused);
-  SDL_LockAudio(); {
-    tick_music(soundboard);
-    tick_sounds(soundboard);
-  } SDL_UnlockAudio();
+  // If the audio callback has fallen far enough behind that the queue is
+  // full, drop this frame's sounds rather than wait for it.
+  if (!az_push_soundboard(&command_queue, soundboard)) {
+    AZ_WARNING_ONCE("Audio command queue is full; dropped a frame\n");
+  }
   AZ_ZERO_OBJECT(soundboard);
 }
 
@@ -21,6 +21,7 @@
 
 #include <assert.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #include <SDL.h>
 #include <SDL_opengl.h>
@@ -28,6 +29,7 @@
 #include "azimuth/constants.h"
 #include "azimuth/gui/audio.h"
 #include "azimuth/util/misc.h"
+#include "azimuth/util/thread.h"
 #include "azimuth/util/warning.h"
 
 /*===========================================================================*/
@@ -52,6 +54,13 @@ static float current_screen_scale = 1.0f;
 static float current_screen_xoffset = 0;
 static float current_screen_yoffset = 0;
 static double nanoseconds_per_count = 1000000000;
+// The refresh period of the display we're on (or of a 60 Hz display, if we
+// can't tell):
+static uint64_t display_frame_nanos = AZ_FRAME_TIME_NANOS;
+
+// When sleeping until a given time, we stop sleeping this long before the
+// deadline and spin for the rest, since sleeps can overshoot:
+#define SPIN_WAIT_NANOS 1500000u
 
 // Get the current time in nanoseconds, as measured from some unspecified zero
 // point.  Not guaranteed to be monotonic.
@@ -63,11 +72,11 @@ static uint64_t az_current_time_nanos(void) {
 // then return the time at which the sleep ended.  Return the current time
 // immediately without sleeping if it is already past the requested time.
 static uint64_t az_sleep_until(uint64_t time) {
-  const uint64_t now = az_current_time_nanos();
+  uint64_t now = az_current_time_nanos();
   if (time <= now) return now;
-  const Uint32 milliseconds = (time - now) / 1000000;
-  if (milliseconds > 0) SDL_Delay(milliseconds);
-  return az_current_time_nanos();
+  if (time - now > SPIN_WAIT_NANOS) az_sleep_ns(time - now - SPIN_WAIT_NANOS);
+  while ((now = az_current_time_nanos()) < time) {}
+  return now;
 }
 
 void az_register_gl_init_func(az_init_func_t func) {
@@ -154,6 +163,9 @@ void az_set_fullscreen(bool fullscreen) {
   display_index = SDL_GetWindowDisplayIndex(window);
   SDL_GetDesktopDisplayMode(display_index, &display_mode);
   SDL_SetWindowDisplayMode(window, &display_mode);
+  display_frame_nanos = (display_mode.refresh_rate > 0 ?
+                         1000000000u / display_mode.refresh_rate :
+                         AZ_FRAME_TIME_NANOS);
   if(0 != SDL_SetWindowFullscreen(window, fullscreen ? SDL_WINDOW_FULLSCREEN : 0)) {
       AZ_FATAL("SDL_SetWindowFullscreen failed: %s\n", SDL_GetError());
   }
@@ -239,6 +251,51 @@ void az_finish_screen_redraw(void) {
   sync_time = az_sleep_until(sync_time) + AZ_FRAME_TIME_NANOS;
 }
 
+void az_finish_screen_redraw_at_display_rate(void) {
+  assert(sdl_initialized);
+  assert(display_initialized);
+  SDL_GL_SwapWindow(window);
+  // Vsync should already hold us to the display's refresh rate, but if it
+  // isn't working, don't draw frames faster than the display can show them.
+  static uint64_t sync_time = 0;
+  sync_time = az_sleep_until(sync_time) + display_frame_nanos;
+}
+
+/*===========================================================================*/
+
+// Don't run more than this many ticks per frame; if we fall further behind
+// than this (e.g. because the machine is too slow, or because we were
+// stopped in a debugger), slow the game down rather than trying to catch up.
+#define MAX_TICKS_PER_FRAME 4
+
+static bool frame_clock_started = false;
+static uint64_t frame_clock_last_time;
+static uint64_t frame_clock_accumulated; // nanoseconds not yet ticked
+
+void az_reset_frame_clock(void) {
+  frame_clock_started = false;
+}
+
+int az_frame_clock_ticks(double *blend_out) {
+  const uint64_t now = az_current_time_nanos();
+  if (!frame_clock_started) {
+    // Always run one tick right after a reset.
+    frame_clock_started = true;
+    frame_clock_accumulated = AZ_FRAME_TIME_NANOS;
+  } else if (now > frame_clock_last_time) {
+    frame_clock_accumulated += now - frame_clock_last_time;
+  }
+  frame_clock_last_time = now;
+  int num_ticks = frame_clock_accumulated / AZ_FRAME_TIME_NANOS;
+  if (num_ticks > MAX_TICKS_PER_FRAME) {
+    num_ticks = MAX_TICKS_PER_FRAME;
+    frame_clock_accumulated = num_ticks * (uint64_t)AZ_FRAME_TIME_NANOS;
+  }
+  frame_clock_accumulated -= num_ticks * (uint64_t)AZ_FRAME_TIME_NANOS;
+  *blend_out = frame_clock_accumulated / (double)AZ_FRAME_TIME_NANOS;
+  return num_ticks;
+}
+
 void az_gl_scissor(int x, int y, int width, int height) {
   glScissor(
     (current_screen_scale * x) + current_screen_xoffset,
@@ -50,10 +50,28 @@ void az_set_fullscreen(bool fullscreen);
 bool az_has_mousefocus(void);
 
 // Call this functions just before and just after drawing a frame to the screen
-// with OpenGL.
+// with OpenGL.  az_finish_screen_redraw holds the frame rate to 60 Hz, for
+// controllers that tick once per frame.
 void az_start_screen_redraw(void);
 void az_finish_screen_redraw(void);
 
+// Use this instead of az_finish_screen_redraw in controllers that tick at a
+// fixed rate using az_frame_clock_ticks.  Rather than holding the frame rate
+// to 60 Hz, this lets us draw as fast as the display refreshes.
+void az_finish_screen_redraw_at_display_rate(void);
+
+// For controllers that tick at a fixed rate (once per AZ_FRAME_TIME_SECONDS)
+// but draw at the display's rate: call this once per frame, before drawing,
+// to get the number of ticks to run (possibly zero) to catch up with real
+// time.  The fraction of a tick left over, from 0 to 1, is stored in
+// *blend_out, for interpolating between the last two ticks when drawing.
+int az_frame_clock_ticks(double *blend_out);
+
+// Forget about time elapsed since the last call to az_frame_clock_ticks, so
+// that the next call returns exactly one tick.  Call this when starting a
+// controller loop, or when returning to it from another controller.
+void az_reset_frame_clock(void);
+
 // Wrapper for glScissor() that applies virtual-resolution scaling factor & offsets
 void az_gl_scissor(int x, int y, int width, int height);
 
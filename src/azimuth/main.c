@@ -30,7 +30,6 @@
 #include "azimuth/state/music.h" // for az_init_music_datas
 #include "azimuth/state/planet.h"
 #include "azimuth/state/save.h"
-#include "azimuth/state/sound.h" // for az_init_sound_datas
 #include "azimuth/state/wall.h" // for az_init_wall_datas
 #include "azimuth/system/resource.h"
 #include "azimuth/util/misc.h" // for AZ_ASSERT_UNREACHABLE
@@ -57,7 +56,7 @@ typedef enum {
 } az_controller_t;
 
 int main(int argc, char **argv) {
-  az_init_sound_datas();
+  az_load_sound_datas();
   az_init_baddie_datas();
   az_init_wall_datas();
   az_register_gl_init_func(az_init_portrait_drawing);
@@ -70,6 +69,9 @@ int main(int argc, char **argv) {
   az_load_preferences(&preferences);
   az_load_saved_games(&planet, &saved_games);
   az_init_gui(preferences.fullscreen_on_startup, true);
+#if AZ_PROFILING
+  atexit(az_save_profile_history);
+#endif
   az_set_global_music_volume(preferences.music_volume);
   az_set_global_sound_volume(preferences.sound_volume);
 
@@ -1199,7 +1199,8 @@ static az_baddie_data_t baddie_datas[] = {
   [AZ_BAD_HORNET] = {
     .max_health = 3.0, .color = {192, 192, 0, 255},
     .hurt_sound = AZ_SND_HURT_ZIPPER, .death_sound = AZ_SND_KILL_DRAGONFLY,
-    .death_style = AZ_DEATH_EMBERS, .static_properties = AZ_BADF_WATER_BOUNCE,
+    .death_style = AZ_DEATH_EMBERS,
+    .static_properties = (AZ_BADF_NAVIGATES | AZ_BADF_WATER_BOUNCE),
     .potential_pickups = ~AZ_PUPF_LARGE_SHIELDS,
     .main_body = { .polygon = AZ_INIT_POLYGON(dragonfly_vertices),
                    .impact_damage = 5.0 }
@@ -1330,6 +1331,7 @@ static az_baddie_data_t baddie_datas[] = {
     .potential_pickups = ~(AZ_PUPF_NOTHING | AZ_PUPF_SMALL_SHIELDS),
     .color = {160, 160, 160, 255},
     .hurt_sound = AZ_SND_HURT_TURRET, .death_sound = AZ_SND_KILL_TURRET,
+    .static_properties = AZ_BADF_NAVIGATES,
     .main_body = { .polygon = AZ_INIT_POLYGON(turret_vertices),
                    .impact_damage = 10.0 },
     DECL_COMPONENTS(security_drone_components)
@@ -1626,7 +1628,7 @@ static az_baddie_data_t baddie_datas[] = {
     .max_health = 8.0, .color = {128, 255, 0, 255},
     .hurt_sound = AZ_SND_HURT_ZIPPER, .death_sound = AZ_SND_KILL_DRAGONFLY,
     .death_style = AZ_DEATH_EMBERS, .potential_pickups = AZ_PUPF_ALL,
-    .static_properties = AZ_BADF_WATER_BOUNCE,
+    .static_properties = (AZ_BADF_NAVIGATES | AZ_BADF_WATER_BOUNCE),
     .main_body = { .polygon = AZ_INIT_POLYGON(dragonfly_vertices),
                    .impact_damage = 12.0 }
   },
@@ -1671,6 +1673,7 @@ static az_baddie_data_t baddie_datas[] = {
     .hurt_sound = AZ_SND_HURT_ZIPPER, .death_sound = AZ_SND_KILL_DRAGONFLY,
     .death_style = AZ_DEATH_EMBERS,
     .color = {192, 96, 0, 255}, .potential_pickups = AZ_PUPF_ALL,
+    .static_properties = AZ_BADF_NAVIGATES,
     .main_body = { .polygon = AZ_INIT_POLYGON(nightshade_body_vertices),
                    .impact_damage = 15.0 },
     DECL_COMPONENTS(nightshade_components)
@@ -2042,6 +2045,7 @@ static void init_component_data(az_component_data_t *component) {
     assert(component->bounding_radius == 0.0);
     component->bounding_radius =
       polygon_bounding_radius(component->polygon);
+    az_compile_polygon(&component->polygon);
   } else assert(component->bounding_radius > 0.0);
 }
 
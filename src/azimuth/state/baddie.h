@@ -189,6 +189,9 @@ typedef uint_fast16_t az_baddie_flags_t;
 #define AZ_BADF_INVINCIBLE     ((az_baddie_flags_t)(1u << 4))
 // KAMIKAZE: baddie dies when it hits the ship
 #define AZ_BADF_KAMIKAZE       ((az_baddie_flags_t)(1u << 5))
+// NAVIGATES: when flying or drifting towards a goal, baddie steers around
+// walls using the room's navigation grid (see az_navigate_towards)
+#define AZ_BADF_NAVIGATES      ((az_baddie_flags_t)(1u << 13))
 // NO_HOMING_BEAM: homing beam ignores this baddie
 #define AZ_BADF_NO_HOMING_BEAM ((az_baddie_flags_t)(1u << 6))
 // NO_HOMING_PHASE: homing phase ignores this baddie
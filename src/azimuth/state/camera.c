@@ -101,6 +101,20 @@ void az_shake_camera(az_camera_t *camera, double horz, double vert) {
   camera->shake_vert = fmax(camera->shake_vert, vert);
 }
 
+// How far a sound at the edge of the screen (or beyond) is panned:
+#define MAX_SOUND_PAN 0.75
+
+float az_camera_pan(const az_camera_t *camera, az_vector_t position) {
+  // The camera is rotated so that the direction of its center from the origin
+  // points up the screen, so rightwards is a quarter turn clockwise from that.
+  const az_vector_t rightwards =
+    az_vpolar(1.0, az_vtheta(camera->center) - AZ_HALF_PI);
+  const double offset =
+    az_vdot(az_vsub(position, camera->center), rightwards) /
+    (0.5 * AZ_SCREEN_WIDTH);
+  return (float)(MAX_SOUND_PAN * fmin(fmax(offset, -1.0), 1.0));
+}
+
 bool az_ray_intersects_camera_rectangle(
     const az_camera_t *camera, az_vector_t start, az_vector_t delta) {
   az_vector_t vertices[4] = {
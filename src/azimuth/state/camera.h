@@ -76,6 +76,11 @@ void az_track_camera_towards(az_camera_t *camera, az_vector_t goal,
 // Apply shake to the camera.
 void az_shake_camera(az_camera_t *camera, double horz, double vert);
 
+// Return the stereo pan (from -1 for left to 1 for right) for a sound coming
+// from the given position, based on where the position is on screen.  Sounds
+// are never panned all the way to one side, even from far offscreen.
+float az_camera_pan(const az_camera_t *camera, az_vector_t position);
+
 // Determine if a ray, travelling delta from start, will intersect the
 // rectangular view of the camera.
 bool az_ray_intersects_camera_rectangle(
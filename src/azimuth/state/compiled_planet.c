@@ -0,0 +1,708 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#include "azimuth/state/compiled_planet.h"
+
+#include <assert.h>
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "azimuth/constants.h"
+#include "azimuth/state/planet.h"
+#include "azimuth/state/room.h"
+#include "azimuth/state/script.h"
+#include "azimuth/state/upgrade.h"
+#include "azimuth/state/wall.h"
+#include "azimuth/util/misc.h"
+#include "azimuth/util/string.h"
+
+/*===========================================================================*/
+
+// Image layout (all integers are little-endian):
+//   header:  "AZPLANET", u32 version, u32 image size, u32 number of rooms,
+//            u32 offset of planet basis, u32 offset of each room
+//   basis:   start room, on_start script, zones, hints, paragraphs
+//   rooms:   header fields, on_start script, then each object spec in turn
+// Strings are stored as a u32 length followed by the characters and a NUL.
+// Scripts are stored as an i32 instruction count (-1 for no script) followed
+// by a u32 opcode and f64 immediate for each instruction.
+
+#define IMAGE_MAGIC "AZPLANET"
+#define IMAGE_MAGIC_SIZE 8
+// Increment this whenever the image layout changes:
+#define IMAGE_VERSION 1
+#define INSTRUCTION_SIZE 12
+
+/*===========================================================================*/
+
+typedef struct {
+  unsigned char *data;
+  size_t size, capacity;
+} az_image_t;
+
+static void reserve_bytes(az_image_t *image, size_t count) {
+  if (image->size + count <= image->capacity) return;
+  size_t capacity = (image->capacity == 0 ? 65536 : image->capacity);
+  while (capacity < image->size + count) capacity *= 2;
+  unsigned char *data = realloc(image->data, capacity);
+  if (data == NULL) AZ_FATAL("Out of memory.\n");
+  image->data = data;
+  image->capacity = capacity;
+}
+
+static void put_bytes(az_image_t *image, const void *bytes, size_t count) {
+  reserve_bytes(image, count);
+  memcpy(image->data + image->size, bytes, count);
+  image->size += count;
+}
+
+static void set_u32(az_image_t *image, size_t offset, uint32_t value) {
+  assert(offset + 4 <= image->size);
+  for (int i = 0; i < 4; ++i) {
+    image->data[offset + i] = (unsigned char)(value >> (8 * i));
+  }
+}
+
+static void put_u32(az_image_t *image, uint32_t value) {
+  reserve_bytes(image, 4);
+  image->size += 4;
+  set_u32(image, image->size - 4, value);
+}
+
+static void put_int(az_image_t *image, int value) {
+  put_u32(image, (uint32_t)value);
+}
+
+static void put_f64(az_image_t *image, double value) {
+  uint64_t bits;
+  AZ_STATIC_ASSERT(sizeof(bits) == sizeof(value));
+  memcpy(&bits, &value, sizeof(bits));
+  put_u32(image, (uint32_t)bits);
+  put_u32(image, (uint32_t)(bits >> 32));
+}
+
+static void put_vector(az_image_t *image, az_vector_t value) {
+  put_f64(image, value.x);
+  put_f64(image, value.y);
+}
+
+static void put_string(az_image_t *image, const char *string) {
+  const size_t length = strlen(string);
+  put_u32(image, length);
+  put_bytes(image, string, length + 1);
+}
+
+static void put_script(az_image_t *image, const az_script_t *script) {
+  if (script == NULL) {
+    put_int(image, -1);
+    return;
+  }
+  put_int(image, script->num_instructions);
+  for (int i = 0; i < script->num_instructions; ++i) {
+    put_u32(image, script->instructions[i].opcode);
+    put_f64(image, script->instructions[i].immediate);
+  }
+}
+
+static int node_subkind_index(const az_node_spec_t *node) {
+  switch (node->kind) {
+    case AZ_NODE_NOTHING:
+    case AZ_NODE_TRACTOR:
+      return 0;
+    case AZ_NODE_CONSOLE: return node->subkind.console;
+    case AZ_NODE_UPGRADE: return node->subkind.upgrade;
+    case AZ_NODE_DOODAD_FG:
+    case AZ_NODE_DOODAD_BG:
+      return node->subkind.doodad;
+    case AZ_NODE_FAKE_WALL_FG:
+    case AZ_NODE_FAKE_WALL_BG:
+      return az_wall_data_index(node->subkind.fake_wall);
+    case AZ_NODE_MARKER: return node->subkind.marker;
+    case AZ_NODE_SECRET: return node->subkind.secret;
+  }
+  AZ_ASSERT_UNREACHABLE();
+}
+
+static void put_room(az_image_t *image, const az_room_t *room) {
+  put_int(image, room->zone_key);
+  put_u32(image, room->properties);
+  put_int(image, room->marker_flag);
+  put_f64(image, room->camera_bounds.min_r);
+  put_f64(image, room->camera_bounds.r_span);
+  put_f64(image, room->camera_bounds.min_theta);
+  put_f64(image, room->camera_bounds.theta_span);
+  put_int(image, room->background_pattern);
+  put_script(image, room->on_start);
+  put_int(image, room->num_baddies);
+  put_int(image, room->num_doors);
+  put_int(image, room->num_gravfields);
+  put_int(image, room->num_nodes);
+  put_int(image, room->num_walls);
+  for (int i = 0; i < room->num_baddies; ++i) {
+    const az_baddie_spec_t *baddie = &room->baddies[i];
+    put_int(image, baddie->kind);
+    put_vector(image, baddie->position);
+    put_f64(image, baddie->angle);
+    put_int(image, baddie->uuid_slot);
+    AZ_ARRAY_LOOP(cargo_slot, baddie->cargo_slots) put_int(image, *cargo_slot);
+    put_script(image, baddie->on_kill);
+  }
+  for (int i = 0; i < room->num_doors; ++i) {
+    const az_door_spec_t *door = &room->doors[i];
+    put_int(image, door->kind);
+    put_vector(image, door->position);
+    put_f64(image, door->angle);
+    put_int(image, door->destination);
+    put_int(image, door->uuid_slot);
+    put_script(image, door->on_open);
+  }
+  for (int i = 0; i < room->num_gravfields; ++i) {
+    const az_gravfield_spec_t *gravfield = &room->gravfields[i];
+    put_int(image, gravfield->kind);
+    put_vector(image, gravfield->position);
+    put_f64(image, gravfield->angle);
+    put_f64(image, gravfield->strength);
+    if (az_is_trapezoidal(gravfield->kind)) {
+      put_f64(image, gravfield->size.trapezoid.front_offset);
+      put_f64(image, gravfield->size.trapezoid.front_semiwidth);
+      put_f64(image, gravfield->size.trapezoid.rear_semiwidth);
+      put_f64(image, gravfield->size.trapezoid.semilength);
+    } else {
+      put_f64(image, gravfield->size.sector.sweep_degrees);
+      put_f64(image, gravfield->size.sector.inner_radius);
+      put_f64(image, gravfield->size.sector.thickness);
+    }
+    put_int(image, gravfield->uuid_slot);
+    put_script(image, gravfield->on_enter);
+  }
+  for (int i = 0; i < room->num_nodes; ++i) {
+    const az_node_spec_t *node = &room->nodes[i];
+    put_int(image, node->kind);
+    put_int(image, node_subkind_index(node));
+    put_vector(image, node->position);
+    put_f64(image, node->angle);
+    put_int(image, node->uuid_slot);
+    put_script(image, node->on_use);
+  }
+  for (int i = 0; i < room->num_walls; ++i) {
+    const az_wall_spec_t *wall = &room->walls[i];
+    put_int(image, wall->kind);
+    put_int(image, az_wall_data_index(wall->data));
+    put_vector(image, wall->position);
+    put_f64(image, wall->angle);
+    put_int(image, wall->uuid_slot);
+  }
+}
+
+void az_compile_planet(const az_planet_t *planet, char **image_out,
+                       size_t *size_out) {
+  assert(planet != NULL);
+  az_image_t image = {.data = NULL};
+  // Header (the offsets get filled in below, once we know them):
+  put_bytes(&image, IMAGE_MAGIC, IMAGE_MAGIC_SIZE);
+  put_u32(&image, IMAGE_VERSION);
+  const size_t image_size_offset = image.size;
+  put_u32(&image, 0);
+  put_int(&image, planet->num_rooms);
+  const size_t basis_offset_offset = image.size;
+  put_u32(&image, 0);
+  const size_t room_table_offset = image.size;
+  for (int i = 0; i < planet->num_rooms; ++i) put_u32(&image, 0);
+  // Planet basis:
+  set_u32(&image, basis_offset_offset, image.size);
+  put_int(&image, planet->start_room);
+  put_script(&image, planet->on_start);
+  put_int(&image, planet->num_zones);
+  for (int i = 0; i < planet->num_zones; ++i) {
+    const az_zone_t *zone = &planet->zones[i];
+    put_bytes(&image, &zone->color.r, 1);
+    put_bytes(&image, &zone->color.g, 1);
+    put_bytes(&image, &zone->color.b, 1);
+    put_string(&image, zone->name);
+  }
+  put_int(&image, planet->num_hints);
+  for (int i = 0; i < planet->num_hints; ++i) {
+    const az_hint_t *hint = &planet->hints[i];
+    put_u32(&image, hint->properties);
+    put_u32(&image, hint->prereq1);
+    put_u32(&image, hint->prereq2);
+    put_u32(&image, hint->result);
+    put_int(&image, hint->target_room);
+  }
+  put_int(&image, planet->num_paragraphs);
+  for (int i = 0; i < planet->num_paragraphs; ++i) {
+    put_string(&image, planet->paragraphs[i]);
+  }
+  // Rooms:
+  for (int i = 0; i < planet->num_rooms; ++i) {
+    set_u32(&image, room_table_offset + 4 * i, image.size);
+    put_room(&image, &planet->rooms[i]);
+  }
+  set_u32(&image, image_size_offset, image.size);
+  *image_out = (char *)image.data;
+  *size_out = image.size;
+}
+
+/*===========================================================================*/
+
+typedef struct {
+  const unsigned char *image;
+  size_t size, position;
+  jmp_buf jump;
+} az_load_image_t;
+
+#define FAIL() longjmp(loader->jump, 1)
+
+static uint32_t decode_u32(const unsigned char *bytes) {
+  return ((uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) |
+          ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24));
+}
+
+static double decode_f64(const unsigned char *bytes) {
+  const uint64_t bits =
+    (uint64_t)decode_u32(bytes) | ((uint64_t)decode_u32(bytes + 4) << 32);
+  double value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+static void seek_to(az_load_image_t *loader, uint32_t offset) {
+  if (offset > loader->size) FAIL();
+  loader->position = offset;
+}
+
+// Return a pointer to the next count bytes of the image and advance past
+// them, or fail if the image isn't that long.
+static const unsigned char *get_bytes(az_load_image_t *loader, size_t count) {
+  if (count > loader->size - loader->position) FAIL();
+  const unsigned char *bytes = loader->image + loader->position;
+  loader->position += count;
+  return bytes;
+}
+
+static uint32_t get_u32(az_load_image_t *loader) {
+  return decode_u32(get_bytes(loader, 4));
+}
+
+// Read an integer, failing unless it is between min and max inclusive.
+static int get_int(az_load_image_t *loader, int min, int max) {
+  const int value = (int32_t)get_u32(loader);
+  if (value < min || value > max) FAIL();
+  return value;
+}
+
+static double get_f64(az_load_image_t *loader) {
+  return decode_f64(get_bytes(loader, 8));
+}
+
+static az_vector_t get_vector(az_load_image_t *loader) {
+  const double x = get_f64(loader);
+  return (az_vector_t){x, get_f64(loader)};
+}
+
+static char *get_string(az_load_image_t *loader) {
+  const uint32_t length = get_u32(loader);
+  if (length >= loader->size) FAIL();
+  const unsigned char *bytes = get_bytes(loader, length + 1);
+  if (bytes[length] != '\0') FAIL();
+  char *string = AZ_ALLOC(length + 1, char);
+  memcpy(string, bytes, length + 1);
+  return string;
+}
+
+static az_script_t *get_script(az_load_image_t *loader) {
+  const int num_instructions =
+    get_int(loader, -1, INT32_MAX / INSTRUCTION_SIZE);
+  if (num_instructions < 0) return NULL;
+  if (num_instructions == 0) FAIL();
+  const unsigned char *bytes =
+    get_bytes(loader, num_instructions * INSTRUCTION_SIZE);
+  for (int i = 0; i < num_instructions; ++i) {
+    if (decode_u32(bytes + i * INSTRUCTION_SIZE) > AZ_OP_ERROR) FAIL();
+  }
+  az_script_t *script = AZ_ALLOC(1, az_script_t);
+  script->num_instructions = num_instructions;
+  script->instructions = AZ_ALLOC(num_instructions, az_instruction_t);
+  for (int i = 0; i < num_instructions; ++i) {
+    const unsigned char *instruction = bytes + i * INSTRUCTION_SIZE;
+    script->instructions[i].opcode = (az_opcode_t)decode_u32(instruction);
+    script->instructions[i].immediate = decode_f64(instruction + 4);
+  }
+  az_compile_script(script);
+  return script;
+}
+
+// In each of the get_*_spec functions below, the script is read last, so that
+// a spec that fails to load partway through never owns a script.
+
+static void get_baddie_spec(az_load_image_t *loader, az_baddie_spec_t *baddie) {
+  baddie->kind = (az_baddie_kind_t)get_int(loader, 1, AZ_NUM_BADDIE_KINDS);
+  baddie->position = get_vector(loader);
+  baddie->angle = get_f64(loader);
+  baddie->uuid_slot = get_int(loader, 0, AZ_NUM_UUID_SLOTS);
+  AZ_ARRAY_LOOP(cargo_slot, baddie->cargo_slots) {
+    *cargo_slot = get_int(loader, 0, AZ_NUM_UUID_SLOTS);
+  }
+  baddie->on_kill = get_script(loader);
+}
+
+static void get_door_spec(az_load_image_t *loader, az_door_spec_t *door) {
+  door->kind = (az_door_kind_t)get_int(loader, 1, AZ_NUM_DOOR_KINDS);
+  door->position = get_vector(loader);
+  door->angle = get_f64(loader);
+  door->destination = get_int(loader, 0, AZ_MAX_NUM_ROOMS - 1);
+  door->uuid_slot = get_int(loader, 0, AZ_NUM_UUID_SLOTS);
+  door->on_open = get_script(loader);
+}
+
+static void get_gravfield_spec(az_load_image_t *loader,
+                               az_gravfield_spec_t *gravfield) {
+  gravfield->kind =
+    (az_gravfield_kind_t)get_int(loader, 1, AZ_NUM_GRAVFIELD_KINDS);
+  gravfield->position = get_vector(loader);
+  gravfield->angle = get_f64(loader);
+  gravfield->strength = get_f64(loader);
+  if (az_is_trapezoidal(gravfield->kind)) {
+    gravfield->size.trapezoid.front_offset = get_f64(loader);
+    gravfield->size.trapezoid.front_semiwidth = get_f64(loader);
+    gravfield->size.trapezoid.rear_semiwidth = get_f64(loader);
+    gravfield->size.trapezoid.semilength = get_f64(loader);
+    if (gravfield->size.trapezoid.semilength <= 0.0 ||
+        gravfield->size.trapezoid.front_semiwidth < 0.0 ||
+        gravfield->size.trapezoid.rear_semiwidth < 0.0) FAIL();
+  } else {
+    gravfield->size.sector.sweep_degrees = get_f64(loader);
+    gravfield->size.sector.inner_radius = get_f64(loader);
+    gravfield->size.sector.thickness = get_f64(loader);
+    if (gravfield->size.sector.inner_radius < 0.0 ||
+        gravfield->size.sector.thickness <= 0.0) FAIL();
+  }
+  gravfield->uuid_slot = get_int(loader, 0, AZ_NUM_UUID_SLOTS);
+  gravfield->on_enter = get_script(loader);
+}
+
+static void get_node_spec(az_load_image_t *loader, az_node_spec_t *node) {
+  node->kind = (az_node_kind_t)get_int(loader, 1, AZ_NUM_NODE_KINDS);
+  switch (node->kind) {
+    case AZ_NODE_NOTHING:
+      AZ_ASSERT_UNREACHABLE();
+    case AZ_NODE_TRACTOR:
+      get_int(loader, 0, 0);
+      break;
+    case AZ_NODE_CONSOLE:
+      node->subkind.console =
+        (az_console_kind_t)get_int(loader, 0, AZ_NUM_CONSOLE_KINDS - 1);
+      break;
+    case AZ_NODE_UPGRADE:
+      node->subkind.upgrade =
+        (az_upgrade_t)get_int(loader, 0, AZ_NUM_UPGRADES - 1);
+      break;
+    case AZ_NODE_DOODAD_FG:
+    case AZ_NODE_DOODAD_BG:
+      node->subkind.doodad =
+        (az_doodad_kind_t)get_int(loader, 0, AZ_NUM_DOODAD_KINDS - 1);
+      break;
+    case AZ_NODE_FAKE_WALL_FG:
+    case AZ_NODE_FAKE_WALL_BG:
+      node->subkind.fake_wall =
+        az_get_wall_data(get_int(loader, 0, AZ_NUM_WALL_DATAS - 1));
+      break;
+    case AZ_NODE_MARKER:
+      node->subkind.marker = get_int(loader, INT32_MIN, INT32_MAX);
+      break;
+    case AZ_NODE_SECRET:
+      node->subkind.secret = get_int(loader, 0, INT32_MAX);
+      break;
+  }
+  node->position = get_vector(loader);
+  node->angle = get_f64(loader);
+  node->uuid_slot = get_int(loader, 0, AZ_NUM_UUID_SLOTS);
+  node->on_use = get_script(loader);
+}
+
+static void get_wall_spec(az_load_image_t *loader, az_wall_spec_t *wall) {
+  wall->kind = (az_wall_kind_t)get_int(loader, 1, AZ_NUM_WALL_KINDS);
+  wall->data = az_get_wall_data(get_int(loader, 0, AZ_NUM_WALL_DATAS - 1));
+  wall->position = get_vector(loader);
+  wall->angle = get_f64(loader);
+  wall->uuid_slot = get_int(loader, 0, AZ_NUM_UUID_SLOTS);
+}
+
+// Read the header fields of a room (those that are kept resident even when
+// room bodies are loaded lazily) into the zeroed room object.
+static void get_room_header(az_load_image_t *loader, az_room_t *room) {
+  room->zone_key = get_int(loader, 0, AZ_MAX_NUM_ZONES - 1);
+  room->properties = (az_room_flags_t)get_u32(loader);
+  room->marker_flag = get_int(loader, 0, AZ_MAX_NUM_FLAGS - 1);
+  room->camera_bounds.min_r = get_f64(loader);
+  room->camera_bounds.r_span = get_f64(loader);
+  room->camera_bounds.min_theta = get_f64(loader);
+  room->camera_bounds.theta_span = get_f64(loader);
+  if (room->camera_bounds.min_r < 0.0 || room->camera_bounds.r_span < 0.0 ||
+      room->camera_bounds.theta_span < 0.0) FAIL();
+  room->background_pattern =
+    (az_background_pattern_t)get_int(loader, 0, AZ_NUM_BG_PATTERNS - 1);
+}
+
+// Read the rest of a room, following its header.  On failure, the room may be
+// left partially loaded, but it will still be safe to pass to
+// az_destroy_room.
+static void get_room_body(az_load_image_t *loader, az_room_t *room) {
+  room->on_start = get_script(loader);
+  const int num_baddies = get_int(loader, 0, AZ_MAX_NUM_BADDIES);
+  const int num_doors = get_int(loader, 0, AZ_MAX_NUM_DOORS);
+  const int num_gravfields = get_int(loader, 0, AZ_MAX_NUM_GRAVFIELDS);
+  const int num_nodes = get_int(loader, 0, AZ_MAX_NUM_NODES);
+  const int num_walls = get_int(loader, 0, AZ_MAX_NUM_WALLS);
+  room->baddies = AZ_ALLOC(num_baddies, az_baddie_spec_t);
+  room->doors = AZ_ALLOC(num_doors, az_door_spec_t);
+  room->gravfields = AZ_ALLOC(num_gravfields, az_gravfield_spec_t);
+  room->nodes = AZ_ALLOC(num_nodes, az_node_spec_t);
+  room->walls = AZ_ALLOC(num_walls, az_wall_spec_t);
+  while (room->num_baddies < num_baddies) {
+    get_baddie_spec(loader, &room->baddies[room->num_baddies++]);
+  }
+  while (room->num_doors < num_doors) {
+    get_door_spec(loader, &room->doors[room->num_doors++]);
+  }
+  while (room->num_gravfields < num_gravfields) {
+    get_gravfield_spec(loader, &room->gravfields[room->num_gravfields++]);
+  }
+  while (room->num_nodes < num_nodes) {
+    get_node_spec(loader, &room->nodes[room->num_nodes++]);
+  }
+  while (room->num_walls < num_walls) {
+    get_wall_spec(loader, &room->walls[room->num_walls++]);
+  }
+}
+
+// Load the planet basis and the room headers, and (if load_bodies is true)
+// the rest of each room too.  Returns a pointer to the room offset table.
+static const unsigned char *get_planet(az_load_image_t *loader,
+                                       bool load_bodies,
+                                       az_planet_t *planet) {
+  // Header:
+  if (memcmp(get_bytes(loader, IMAGE_MAGIC_SIZE), IMAGE_MAGIC,
+             IMAGE_MAGIC_SIZE) != 0 ||
+      get_u32(loader) != IMAGE_VERSION ||
+      get_u32(loader) != loader->size) FAIL();
+  const int num_rooms = get_int(loader, 1, AZ_MAX_NUM_ROOMS);
+  const uint32_t basis_offset = get_u32(loader);
+  const unsigned char *room_table = get_bytes(loader, 4 * num_rooms);
+  // Planet basis:
+  seek_to(loader, basis_offset);
+  planet->start_room = get_int(loader, 0, num_rooms - 1);
+  planet->on_start = get_script(loader);
+  if (planet->on_start == NULL) FAIL();
+  const int num_zones = get_int(loader, 1, AZ_MAX_NUM_ZONES);
+  planet->zones = AZ_ALLOC(num_zones, az_zone_t);
+  while (planet->num_zones < num_zones) {
+    const unsigned char *rgb = get_bytes(loader, 3);
+    az_zone_t *zone = &planet->zones[planet->num_zones];
+    zone->color = (az_color_t){rgb[0], rgb[1], rgb[2], 255};
+    zone->name = get_string(loader);
+    zone->entering_message = az_strprintf("Entering: $X%02x%02x%02x%s",
+                                          rgb[0], rgb[1], rgb[2], zone->name);
+    ++planet->num_zones;
+  }
+  const int num_hints = get_int(loader, 0, AZ_MAX_NUM_HINTS);
+  planet->hints = AZ_ALLOC(num_hints, az_hint_t);
+  while (planet->num_hints < num_hints) {
+    az_hint_t *hint = &planet->hints[planet->num_hints++];
+    hint->properties = (az_hint_flags_t)get_u32(loader);
+    hint->prereq1 = get_int(loader, 0,
+        (hint->properties & AZ_HINTF_PREREQ1_IS_FLAG ?
+         AZ_MAX_NUM_FLAGS : AZ_NUM_UPGRADES) - 1);
+    hint->prereq2 = get_int(loader, 0,
+        (hint->properties & AZ_HINTF_PREREQ2_IS_FLAG ?
+         AZ_MAX_NUM_FLAGS : AZ_NUM_UPGRADES) - 1);
+    hint->result = get_int(loader, 0,
+        (hint->properties & AZ_HINTF_RESULT_IS_FLAG ?
+         AZ_MAX_NUM_FLAGS : AZ_NUM_UPGRADES) - 1);
+    hint->target_room = get_int(loader, 0, num_rooms - 1);
+  }
+  const int num_paragraphs = get_int(loader, 0, AZ_MAX_NUM_PARAGRAPHS);
+  planet->paragraphs = AZ_ALLOC(num_paragraphs, char*);
+  while (planet->num_paragraphs < num_paragraphs) {
+    planet->paragraphs[planet->num_paragraphs] = get_string(loader);
+    ++planet->num_paragraphs;
+  }
+  // Rooms:
+  planet->num_rooms = num_rooms;
+  planet->rooms = AZ_ALLOC(num_rooms, az_room_t);
+  for (int i = 0; i < num_rooms; ++i) {
+    seek_to(loader, decode_u32(room_table + 4 * i));
+    get_room_header(loader, &planet->rooms[i]);
+    if (planet->rooms[i].zone_key >= num_zones) FAIL();
+    if (load_bodies) get_room_body(loader, &planet->rooms[i]);
+  }
+  return room_table;
+}
+
+#undef FAIL
+
+bool az_load_compiled_planet(const char *image, size_t size,
+                             az_planet_t *planet_out) {
+  assert(planet_out != NULL);
+  AZ_ZERO_OBJECT(planet_out);
+  az_load_image_t loader = {
+    .image = (const unsigned char *)image, .size = size, .position = 0
+  };
+  if (setjmp(loader.jump) != 0) {
+    az_destroy_planet(planet_out);
+    return false;
+  }
+  get_planet(&loader, true, planet_out);
+  return true;
+}
+
+/*===========================================================================*/
+
+// Enough to hold a room and all of its neighbors, plus a few more.
+#define ROOM_CACHE_SIZE (AZ_MAX_NUM_DOORS + 4)
+
+typedef struct {
+  az_room_key_t key; // -1 if this slot is empty
+  uint64_t last_used;
+  uint64_t loaded_at; // the value of the clock when the room was loaded
+  az_room_t room;
+} az_room_cache_slot_t;
+
+struct az_room_cache {
+  az_rmapping_t mapping;
+  const unsigned char *room_table;
+  uint64_t clock;
+  // The keys passed to the two most recent az_get_cached_room calls (or -1).
+  // These rooms are never evicted, since the space state may still hold
+  // pointers to their scripts.
+  az_room_key_t recent_keys[2];
+  az_room_cache_slot_t slots[ROOM_CACHE_SIZE];
+};
+
+bool az_open_compiled_planet(az_rmapping_t *mapping, az_planet_t *planet_out) {
+  assert(planet_out != NULL);
+  AZ_ZERO_OBJECT(planet_out);
+  az_load_image_t loader = {
+    .image = (const unsigned char *)mapping->data, .size = mapping->size,
+    .position = 0
+  };
+  if (setjmp(loader.jump) != 0) {
+    az_destroy_planet(planet_out);
+    return false;
+  }
+  const unsigned char *room_table = get_planet(&loader, false, planet_out);
+  az_room_cache_t *cache = AZ_ALLOC(1, az_room_cache_t);
+  cache->mapping = *mapping;
+  AZ_ZERO_OBJECT(mapping);
+  cache->room_table = room_table;
+  AZ_ARRAY_LOOP(key, cache->recent_keys) *key = -1;
+  AZ_ARRAY_LOOP(slot, cache->slots) slot->key = -1;
+  planet_out->room_cache = cache;
+  return true;
+}
+
+// Find the cache slot holding the given room, loading the room into the cache
+// (and evicting the least recently used unpinned room) if necessary.
+static az_room_t *cache_room(const az_planet_t *planet,
+                             az_room_key_t room_key) {
+  az_room_cache_t *cache = planet->room_cache;
+  assert(room_key >= 0 && room_key < planet->num_rooms);
+  az_room_cache_slot_t *victim = NULL;
+  AZ_ARRAY_LOOP(slot, cache->slots) {
+    if (slot->key == room_key) {
+      slot->last_used = ++cache->clock;
+      return &slot->room;
+    }
+    if (slot->key >= 0 && (slot->key == cache->recent_keys[0] ||
+                           slot->key == cache->recent_keys[1])) continue;
+    // Empty slots have a last_used of zero, so they get picked first.
+    if (victim == NULL || slot->last_used < victim->last_used) victim = slot;
+  }
+  assert(victim != NULL);
+  az_destroy_room(&victim->room);
+  victim->key = room_key;
+  victim->last_used = victim->loaded_at = ++cache->clock;
+  az_load_image_t loader = {
+    .image = (const unsigned char *)cache->mapping.data,
+    .size = cache->mapping.size,
+    .position = decode_u32(cache->room_table + 4 * room_key)
+  };
+  if (setjmp(loader.jump) != 0) {
+    AZ_FATAL("Failed to load room %03d from compiled planet.\n", room_key);
+  }
+  get_room_header(&loader, &victim->room);
+  get_room_body(&loader, &victim->room);
+  return &victim->room;
+}
+
+const az_room_t *az_get_cached_room(const az_planet_t *planet,
+                                    az_room_key_t room_key) {
+  az_room_cache_t *cache = planet->room_cache;
+  assert(cache != NULL);
+  if (cache->recent_keys[0] != room_key) {
+    cache->recent_keys[1] = cache->recent_keys[0];
+    cache->recent_keys[0] = room_key;
+  }
+  return cache_room(planet, room_key);
+}
+
+const az_room_t *az_peek_cached_room(const az_planet_t *planet,
+                                     az_room_key_t room_key) {
+  assert(planet->room_cache != NULL);
+  return cache_room(planet, room_key);
+}
+
+void az_prefetch_cached_rooms(const az_planet_t *planet,
+                              az_room_key_t room_key) {
+  assert(planet->room_cache != NULL);
+  // Copy out the door destinations first, since loading the other rooms
+  // could evict this one (if it isn't one of the recently gotten rooms).
+  const az_room_t *room = cache_room(planet, room_key);
+  const int num_doors = room->num_doors;
+  az_room_key_t destinations[AZ_MAX_NUM_DOORS];
+  for (int i = 0; i < num_doors; ++i) {
+    destinations[i] = room->doors[i].destination;
+  }
+  for (int i = 0; i < num_doors; ++i) {
+    if (destinations[i] < planet->num_rooms) {
+      cache_room(planet, destinations[i]);
+    }
+  }
+}
+
+uint64_t az_cached_room_generation(const az_planet_t *planet,
+                                   az_room_key_t room_key) {
+  assert(planet->room_cache != NULL);
+  AZ_ARRAY_LOOP(slot, planet->room_cache->slots) {
+    if (slot->key == room_key) return slot->loaded_at;
+  }
+  return 0;
+}
+
+void az_destroy_room_cache(az_room_cache_t *cache) {
+  if (cache == NULL) return;
+  AZ_ARRAY_LOOP(slot, cache->slots) az_destroy_room(&slot->room);
+  az_runmap(&cache->mapping);
+  free(cache);
+}
+
+/*===========================================================================*/
@@ -0,0 +1,79 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#pragma once
+#ifndef AZIMUTH_STATE_COMPILED_PLANET_H_
+#define AZIMUTH_STATE_COMPILED_PLANET_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "azimuth/state/planet.h"
+#include "azimuth/util/rw.h"
+
+/*===========================================================================*/
+
+// A compiled planet is a binary image of all the data that az_read_planet
+// would otherwise parse out of rooms/planet.txt and the room files, including
+// pre-parsed scripts.  It is generated from the text files at build time (see
+// src/planetc), and az_read_planet uses it in preference to the text files
+// when the resource reader provides it as rooms/planet.bin.
+//
+// All integers in the image are little-endian and all references within it
+// are byte offsets from the start of the image, so the image can be read in
+// place from the embedded resource blob or from a memory-mapped file.  Each
+// room can be located directly via a table of offsets in the header.
+
+// Serialize the planet as a compiled planet image.  The image is newly
+// allocated; the caller must free() it.
+void az_compile_planet(const az_planet_t *planet, char **image_out,
+                       size_t *size_out);
+
+// Load a planet from a compiled planet image, which need not be aligned.
+// Returns true on success, or false if the image is malformed or was produced
+// by an incompatible version of the game.  Wall data must already have been
+// initialized (see az_init_wall_datas).
+bool az_load_compiled_planet(const char *image, size_t size,
+                             az_planet_t *planet_out);
+
+// Like az_load_compiled_planet, but only load the planet basis and the room
+// headers (zone, properties, marker flag, camera bounds, and background),
+// and give the planet a room cache from which the rest of each room is loaded
+// on demand (see az_get_room).  On success, this takes ownership of the
+// mapping, which the cache keeps until the planet is destroyed.
+bool az_open_compiled_planet(az_rmapping_t *mapping, az_planet_t *planet_out);
+
+// Implementations of az_get_room, az_peek_room, az_prefetch_neighbor_rooms,
+// and az_room_generation for planets that have a room cache.
+const az_room_t *az_get_cached_room(const az_planet_t *planet,
+                                    az_room_key_t room_key);
+const az_room_t *az_peek_cached_room(const az_planet_t *planet,
+                                     az_room_key_t room_key);
+void az_prefetch_cached_rooms(const az_planet_t *planet,
+                              az_room_key_t room_key);
+uint64_t az_cached_room_generation(const az_planet_t *planet,
+                                   az_room_key_t room_key);
+
+// Free a room cache, including any rooms loaded into it.  Does nothing if
+// given NULL.
+void az_destroy_room_cache(az_room_cache_t *cache);
+
+/*===========================================================================*/
+
+#endif // AZIMUTH_STATE_COMPILED_PLANET_H_
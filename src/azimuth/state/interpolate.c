@@ -0,0 +1,127 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#include "azimuth/state/interpolate.h"
+
+#include <assert.h>
+#include <stdbool.h>
+
+#include "azimuth/state/baddie.h"
+#include "azimuth/state/projectile.h"
+#include "azimuth/state/space.h"
+#include "azimuth/state/uid.h"
+#include "azimuth/util/misc.h"
+#include "azimuth/util/vector.h"
+
+/*===========================================================================*/
+
+// If an object moves farther than this in one tick, it must have been moved
+// deliberately (e.g. teleported), so don't interpolate its motion:
+#define MAX_INTERPOLATION_DISTANCE 100.0
+
+static bool blend_motion(az_vector_t previous_position, double previous_angle,
+                         double blend, az_vector_t *position,
+                         double *angle) {
+  if (az_vdist(previous_position, *position) > MAX_INTERPOLATION_DISTANCE) {
+    return false;
+  }
+  *position = az_vadd(previous_position,
+                      az_vmul(az_vsub(*position, previous_position), blend));
+  if (angle != NULL) {
+    *angle = az_mod2pi(previous_angle +
+                       blend * az_mod2pi(*angle - previous_angle));
+  }
+  return true;
+}
+
+void az_save_space_positions(const az_space_state_t *state,
+                             az_space_positions_t *positions_out) {
+  positions_out->room = state->ship.player.current_room;
+  positions_out->camera_center = state->camera.center;
+  positions_out->ship_position = state->ship.position;
+  positions_out->ship_angle = state->ship.angle;
+  for (int i = 0; i < AZ_MAX_NUM_BADDIES; ++i) {
+    const az_baddie_t *baddie = &state->baddies[i];
+    positions_out->baddies[i].uid =
+      (baddie->kind == AZ_BAD_NOTHING ? AZ_NULL_UID : baddie->uid);
+    positions_out->baddies[i].position = baddie->position;
+    positions_out->baddies[i].angle = baddie->angle;
+  }
+  for (int i = 0; i < AZ_MAX_NUM_PROJECTILES; ++i) {
+    const az_projectile_t *proj = &state->projectiles[i];
+    positions_out->projectiles[i].kind = proj->kind;
+    positions_out->projectiles[i].age = proj->age;
+    positions_out->projectiles[i].position = proj->position;
+    positions_out->projectiles[i].angle = proj->angle;
+  }
+}
+
+void az_interpolate_space_positions(az_space_state_t *state,
+                                    const az_space_positions_t *previous,
+                                    double blend,
+                                    az_space_positions_t *current_out) {
+  assert(blend >= 0.0 && blend <= 1.0);
+  az_save_space_positions(state, current_out);
+  // If we changed rooms, the objects in the two rooms have nothing to do with
+  // each other (even if they happen to have the same UIDs).
+  if (previous->room != current_out->room) return;
+  blend_motion(previous->camera_center, 0.0, blend, &state->camera.center,
+               NULL);
+  blend_motion(previous->ship_position, previous->ship_angle, blend,
+               &state->ship.position, &state->ship.angle);
+  for (int i = 0; i < AZ_MAX_NUM_BADDIES; ++i) {
+    az_baddie_t *baddie = &state->baddies[i];
+    if (baddie->kind == AZ_BAD_NOTHING) continue;
+    if (previous->baddies[i].uid != baddie->uid) continue;
+    blend_motion(previous->baddies[i].position, previous->baddies[i].angle,
+                 blend, &baddie->position, &baddie->angle);
+  }
+  // Projectiles don't have UIDs, but a projectile that has been replaced by
+  // a new one since the last tick will be younger than the old one was.
+  AZ_POOL_LOOP(proj, state->projectiles, &state->projectile_pool) {
+    const int i = proj - state->projectiles;
+    if (proj->kind == AZ_PROJ_NOTHING) continue;
+    if (previous->projectiles[i].kind != proj->kind ||
+        previous->projectiles[i].age > proj->age) continue;
+    blend_motion(previous->projectiles[i].position,
+                 previous->projectiles[i].angle, blend, &proj->position,
+                 &proj->angle);
+  }
+}
+
+void az_restore_space_positions(az_space_state_t *state,
+                                const az_space_positions_t *current) {
+  assert(current->room == state->ship.player.current_room);
+  state->camera.center = current->camera_center;
+  state->ship.position = current->ship_position;
+  state->ship.angle = current->ship_angle;
+  for (int i = 0; i < AZ_MAX_NUM_BADDIES; ++i) {
+    az_baddie_t *baddie = &state->baddies[i];
+    if (baddie->kind == AZ_BAD_NOTHING) continue;
+    baddie->position = current->baddies[i].position;
+    baddie->angle = current->baddies[i].angle;
+  }
+  AZ_POOL_LOOP(proj, state->projectiles, &state->projectile_pool) {
+    const int i = proj - state->projectiles;
+    proj->position = current->projectiles[i].position;
+    proj->angle = current->projectiles[i].angle;
+  }
+}
+
+/*===========================================================================*/
@@ -0,0 +1,78 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#pragma once
+#ifndef AZIMUTH_STATE_INTERPOLATE_H_
+#define AZIMUTH_STATE_INTERPOLATE_H_
+
+#include "azimuth/state/baddie.h"
+#include "azimuth/state/projectile.h"
+#include "azimuth/state/room.h"
+#include "azimuth/state/space.h"
+#include "azimuth/state/uid.h"
+#include "azimuth/util/vector.h"
+
+/*===========================================================================*/
+
+// When we draw frames faster than we tick the space state, we draw each frame
+// with the camera and the moving objects that matter most (the ship, baddies,
+// and projectiles) partway between where they were on the last two ticks.
+// This records those positions, so that they can be interpolated between and
+// put back afterwards.  Objects that were added or removed between the two
+// ticks (or that jumped too far, e.g. by going through a door) just appear at
+// their current positions.
+typedef struct {
+  az_room_key_t room;
+  az_vector_t camera_center;
+  az_vector_t ship_position;
+  double ship_angle;
+  struct {
+    az_uid_t uid; // AZ_NULL_UID if the baddie slot is empty
+    az_vector_t position;
+    double angle;
+  } baddies[AZ_MAX_NUM_BADDIES];
+  struct {
+    az_proj_kind_t kind;
+    double age;
+    az_vector_t position;
+    double angle;
+  } projectiles[AZ_MAX_NUM_PROJECTILES];
+} az_space_positions_t;
+
+// Record the current positions of the interpolated objects.  Call this just
+// before each tick.
+void az_save_space_positions(const az_space_state_t *state,
+                             az_space_positions_t *positions_out);
+
+// Save the current positions into *current_out, and then move each object
+// that is still around from the previous positions to be the given fraction
+// (from 0 to 1) of the way from its previous position to its current one.
+void az_interpolate_space_positions(az_space_state_t *state,
+                                    const az_space_positions_t *previous,
+                                    double blend,
+                                    az_space_positions_t *current_out);
+
+// Put objects back where they were before az_interpolate_space_positions
+// moved them, given the positions it saved.  Call this right after drawing.
+void az_restore_space_positions(az_space_state_t *state,
+                                const az_space_positions_t *current);
+
+/*===========================================================================*/
+
+#endif // AZIMUTH_STATE_INTERPOLATE_H_
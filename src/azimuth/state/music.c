@@ -119,9 +119,8 @@ static void destroy_drums(void) {
 
 void az_get_drum_kit(int *num_drums_out, const az_sound_data_t **drums_out) {
   if (!drums_initialized) {
-    for (int i = 0; i < AZ_ARRAY_SIZE(drum_specs); ++i) {
-      az_create_sound_data(&drum_specs[i], &drum_datas[i]);
-    }
+    az_create_sound_datas(AZ_ARRAY_SIZE(drum_specs), drum_specs, drum_datas,
+                          NULL);
     atexit(destroy_drums);
     drums_initialized = true;
   }
@@ -0,0 +1,212 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#include "azimuth/state/nav_grid.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "azimuth/state/room.h"
+#include "azimuth/state/wall.h"
+#include "azimuth/state/wall_grid.h"
+#include "azimuth/util/misc.h"
+#include "azimuth/util/vector.h"
+
+/*===========================================================================*/
+
+// Cells are never smaller than this, so that small rooms don't get chopped up
+// into cells much smaller than a typical baddie.
+#define MIN_CELL_SIZE 20.0
+
+static az_vector_t cell_center(const az_nav_grid_t *grid, int col, int row) {
+  return az_vadd(grid->layout.min_corner,
+                 (az_vector_t){(col + 0.5) * grid->layout.cell_size,
+                               (row + 0.5) * grid->layout.cell_size});
+}
+
+// Determine whether any wall comes within half a cell of the cell's center.
+static void compute_cell(az_nav_grid_t *grid, const az_wall_t *walls,
+                         const az_wall_grid_t *wall_grid, int col, int row) {
+  const double radius = 0.5 * grid->layout.cell_size;
+  const az_vector_t center = cell_center(grid, col, row);
+  az_wall_set_t candidates;
+  az_wall_grid_sweep(wall_grid, radius, center, AZ_VZERO, &candidates);
+  bool blocked = false;
+  for (int i = az_wall_set_next(&candidates, 0); i >= 0;
+       i = az_wall_set_next(&candidates, i + 1)) {
+    if (walls[i].kind == AZ_WALL_NOTHING) continue;
+    if (az_circle_touches_wall(&walls[i], radius, center)) {
+      blocked = true;
+      break;
+    }
+  }
+  grid->blocked[row][col] = blocked;
+}
+
+static void compute_wall_cells(az_nav_grid_t *grid, const az_wall_t *walls,
+                               const az_wall_grid_t *wall_grid, int index) {
+  assert(grid->wall_cells[index].present);
+  for (int row = grid->wall_cells[index].min_row;
+       row <= grid->wall_cells[index].max_row; ++row) {
+    for (int col = grid->wall_cells[index].min_col;
+         col <= grid->wall_cells[index].max_col; ++col) {
+      compute_cell(grid, walls, wall_grid, col, row);
+    }
+  }
+}
+
+void az_build_nav_grid(az_nav_grid_t *grid, const az_wall_t *walls,
+                       const az_wall_grid_t *wall_grid) {
+  AZ_ZERO_OBJECT(grid);
+  az_layout_grid_for_walls(walls, AZ_NAV_GRID_MAX_CELLS, MIN_CELL_SIZE,
+                           &grid->layout);
+  // Only cells that some wall overlaps can be blocked.  Since each cell's
+  // blocking circle lies within the cell, these are the cells that overlap
+  // the wall's bounding box.
+  for (int i = 0; i < AZ_MAX_NUM_WALLS; ++i) {
+    if (walls[i].kind == AZ_WALL_NOTHING) continue;
+    az_grid_wall_cells(&grid->layout, &walls[i], &grid->wall_cells[i]);
+    compute_wall_cells(grid, walls, wall_grid, i);
+  }
+}
+
+void az_update_nav_grid(az_nav_grid_t *grid, const az_wall_t *walls,
+                        const az_wall_grid_t *wall_grid, int index) {
+  assert(index >= 0);
+  assert(index < AZ_MAX_NUM_WALLS);
+  const az_wall_t *wall = &walls[index];
+  if (wall->kind != AZ_WALL_NOTHING &&
+      !az_grid_covers_wall(&grid->layout, wall)) {
+    az_build_nav_grid(grid, walls, wall_grid);
+    return;
+  }
+  // Recompute the cells that the wall used to cover (now that it has moved
+  // away from them), and then the ones it covers now.
+  if (grid->wall_cells[index].present) {
+    compute_wall_cells(grid, walls, wall_grid, index);
+    grid->wall_cells[index].present = false;
+  }
+  if (wall->kind != AZ_WALL_NOTHING) {
+    az_grid_wall_cells(&grid->layout, wall, &grid->wall_cells[index]);
+    compute_wall_cells(grid, walls, wall_grid, index);
+  }
+}
+
+bool az_nav_grid_cell(const az_nav_grid_t *grid, az_vector_t position,
+                      int *col_out, int *row_out) {
+  if (grid->layout.num_cols == 0) return false;
+  const az_vector_t offset = az_vsub(position, grid->layout.min_corner);
+  const double col = floor(offset.x / grid->layout.cell_size);
+  const double row = floor(offset.y / grid->layout.cell_size);
+  if (col < 0.0 || col >= grid->layout.num_cols ||
+      row < 0.0 || row >= grid->layout.num_rows) return false;
+  *col_out = (int)col;
+  *row_out = (int)row;
+  return true;
+}
+
+bool az_nav_grid_line_is_clear(const az_nav_grid_t *grid, az_vector_t start,
+                               az_vector_t end) {
+  if (grid->layout.num_cols == 0) return true;
+  int start_col = -1, start_row = -1, end_col = -1, end_row = -1;
+  az_nav_grid_cell(grid, start, &start_col, &start_row);
+  az_nav_grid_cell(grid, end, &end_col, &end_row);
+  // Sample the segment every quarter of a cell.
+  const az_vector_t delta = az_vsub(end, start);
+  const int num_steps =
+    (int)ceil(az_vnorm(delta) / (0.25 * grid->layout.cell_size));
+  for (int i = 1; i < num_steps; ++i) {
+    int col, row;
+    if (!az_nav_grid_cell(grid, az_vadd(start, az_vmul(delta, (double)i /
+                                                       num_steps)),
+                          &col, &row)) continue;
+    if ((col == start_col && row == start_row) ||
+        (col == end_col && row == end_row)) continue;
+    if (grid->blocked[row][col]) return false;
+  }
+  return true;
+}
+
+/*===========================================================================*/
+
+void az_build_flow_field(const az_nav_grid_t *grid, az_vector_t goal,
+                         az_flow_field_t *field_out) {
+  assert(grid->layout.num_cols > 0);
+  memset(field_out->dist, 0xff, sizeof(field_out->dist));
+  field_out->goal_col = az_grid_col(&grid->layout, goal.x);
+  field_out->goal_row = az_grid_row(&grid->layout, goal.y);
+  // Do a breadth-first search outwards from the goal cell (which we start
+  // from even if it is blocked, since the goal may be right next to a wall).
+  static const int dcols[] = {1, 0, -1, 0}, drows[] = {0, 1, 0, -1};
+  int queue[AZ_NAV_GRID_MAX_CELLS * AZ_NAV_GRID_MAX_CELLS];
+  int queue_start = 0, queue_end = 0;
+  field_out->dist[field_out->goal_row][field_out->goal_col] = 0;
+  queue[queue_end++] =
+    field_out->goal_row * AZ_NAV_GRID_MAX_CELLS + field_out->goal_col;
+  while (queue_start < queue_end) {
+    const int col = queue[queue_start] % AZ_NAV_GRID_MAX_CELLS;
+    const int row = queue[queue_start] / AZ_NAV_GRID_MAX_CELLS;
+    ++queue_start;
+    const uint16_t next_dist = field_out->dist[row][col] + 1;
+    for (int i = 0; i < AZ_ARRAY_SIZE(dcols); ++i) {
+      const int ncol = col + dcols[i], nrow = row + drows[i];
+      if (ncol < 0 || ncol >= grid->layout.num_cols ||
+          nrow < 0 || nrow >= grid->layout.num_rows) continue;
+      if (grid->blocked[nrow][ncol]) continue;
+      if (field_out->dist[nrow][ncol] != AZ_FLOW_UNREACHABLE) continue;
+      field_out->dist[nrow][ncol] = next_dist;
+      queue[queue_end++] = nrow * AZ_NAV_GRID_MAX_CELLS + ncol;
+    }
+  }
+}
+
+bool az_flow_field_direction(const az_nav_grid_t *grid,
+                             const az_flow_field_t *field,
+                             az_vector_t position, az_vector_t *direction_out) {
+  int col, row;
+  if (!az_nav_grid_cell(grid, position, &col, &row)) return false;
+  if (col == field->goal_col && row == field->goal_row) return false;
+  // Head for whichever neighboring cell is closest to the goal, cutting
+  // diagonally only where neither of the cells beside the diagonal is
+  // blocked.  (If we're in a blocked cell, e.g. because we're right up against
+  // a wall, then any reachable neighbor is an improvement.)
+  uint16_t best_dist = field->dist[row][col];
+  int best_col = -1, best_row = -1;
+  for (int nrow = row - 1; nrow <= row + 1; ++nrow) {
+    if (nrow < 0 || nrow >= grid->layout.num_rows) continue;
+    for (int ncol = col - 1; ncol <= col + 1; ++ncol) {
+      if (ncol < 0 || ncol >= grid->layout.num_cols) continue;
+      if (field->dist[nrow][ncol] >= best_dist) continue;
+      if (nrow != row && ncol != col &&
+          (grid->blocked[row][ncol] || grid->blocked[nrow][col])) continue;
+      best_dist = field->dist[nrow][ncol];
+      best_col = ncol;
+      best_row = nrow;
+    }
+  }
+  if (best_col < 0) return false;
+  *direction_out =
+    az_vunit(az_vsub(cell_center(grid, best_col, best_row), position));
+  return true;
+}
+
+/*===========================================================================*/
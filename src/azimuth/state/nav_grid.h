@@ -0,0 +1,104 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#pragma once
+#ifndef AZIMUTH_STATE_NAV_GRID_H_
+#define AZIMUTH_STATE_NAV_GRID_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "azimuth/state/room.h"
+#include "azimuth/state/wall.h"
+#include "azimuth/state/wall_grid.h"
+#include "azimuth/util/vector.h"
+
+/*===========================================================================*/
+
+// The maximum number of rows/columns in a navigation grid.
+#define AZ_NAV_GRID_MAX_CELLS 64
+
+// A navigation grid divides a room into a uniform grid of cells, and records
+// which cells are blocked (that is, which have a wall within half a cell of
+// their center).  Baddies can use it, along with flow fields (see below), to
+// find their way around walls rather than getting stuck against them.
+typedef struct {
+  az_grid_layout_t layout; // if empty, the grid contains no walls
+  // The range of cells that each wall could have blocked when it was last
+  // added to the grid:
+  az_grid_cell_range_t wall_cells[AZ_MAX_NUM_WALLS];
+  bool blocked[AZ_NAV_GRID_MAX_CELLS][AZ_NAV_GRID_MAX_CELLS];
+} az_nav_grid_t;
+
+// Rebuild the grid from scratch to cover all walls in the given array (which
+// must have AZ_MAX_NUM_WALLS elements).  The wall grid must already be up to
+// date for the walls, since it is used to find the walls near each cell.
+void az_build_nav_grid(az_nav_grid_t *grid, const az_wall_t *walls,
+                       const az_wall_grid_t *wall_grid);
+
+// Update the grid to reflect that the wall at the given index has moved,
+// appeared, or been removed; the wall grid must already have been updated.
+// Only the cells that the wall covered before or covers now are recomputed,
+// unless the wall has moved outside the grid, in which case the whole grid is
+// rebuilt.
+void az_update_nav_grid(az_nav_grid_t *grid, const az_wall_t *walls,
+                        const az_wall_grid_t *wall_grid, int index);
+
+// Find the cell containing the given position.  Returns false if the
+// position is outside the grid.
+bool az_nav_grid_cell(const az_nav_grid_t *grid, az_vector_t position,
+                      int *col_out, int *row_out);
+
+// Return false if the line segment from start to end passes through any
+// blocked cell other than the ones containing its endpoints, or true
+// otherwise (including if the segment lies outside the grid).
+bool az_nav_grid_line_is_clear(const az_nav_grid_t *grid, az_vector_t start,
+                               az_vector_t end);
+
+/*===========================================================================*/
+
+// The distance that a flow field reports for cells from which its goal can't
+// be reached:
+#define AZ_FLOW_UNREACHABLE UINT16_MAX
+
+// A flow field records, for each cell of a navigation grid, how many steps
+// (between orthogonally adjacent unblocked cells) it takes to get from that
+// cell to a goal cell.
+typedef struct {
+  int goal_col, goal_row;
+  uint16_t dist[AZ_NAV_GRID_MAX_CELLS][AZ_NAV_GRID_MAX_CELLS];
+} az_flow_field_t;
+
+// Compute a flow field towards the given goal position (which is clamped to
+// the grid if it lies outside of it).  The grid must not be empty.
+void az_build_flow_field(const az_nav_grid_t *grid, az_vector_t goal,
+                         az_flow_field_t *field_out);
+
+// Determine which way to head from the given position in order to follow the
+// flow field towards its goal, and store it (as a unit vector) in
+// *direction_out.  Returns false, leaving *direction_out unchanged, if the
+// position is outside the grid or already in the goal cell, or if the goal
+// can't be reached from there.
+bool az_flow_field_direction(const az_nav_grid_t *grid,
+                             const az_flow_field_t *field,
+                             az_vector_t position, az_vector_t *direction_out);
+
+/*===========================================================================*/
+
+#endif // AZIMUTH_STATE_NAV_GRID_H_
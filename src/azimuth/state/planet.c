@@ -26,6 +26,7 @@
 #include <stdlib.h>
 
 #include "azimuth/constants.h"
+#include "azimuth/state/compiled_planet.h"
 #include "azimuth/state/dialog.h"
 #include "azimuth/state/room.h"
 #include "azimuth/util/misc.h"
@@ -33,10 +34,6 @@
 
 /*===========================================================================*/
 
-// Arbitrary limits to enforce sanity:
-#define AZ_MAX_NUM_HINTS 500
-#define AZ_MAX_NUM_PARAGRAPHS 50000
-
 typedef struct {
   az_reader_t *reader;
   jmp_buf jump;
@@ -217,22 +214,48 @@ static bool parse_planet_basis(az_load_planet_t *loader) {
 
 static bool read_planet_basis(az_reader_t *reader, az_planet_t *planet_out) {
   assert(planet_out != NULL);
+  AZ_ZERO_OBJECT(planet_out); // in particular, there's no room cache
   az_load_planet_t loader = {.reader = reader, .planet = planet_out};
   return parse_planet_basis(&loader);
 }
 
+// Load the planet from rooms/planet.bin, if the resource reader provides it.
+// Returns false if there is no compiled planet or if it fails to load.
+static bool read_compiled_planet(az_resource_reader_fn_t resource_reader,
+                                 az_planet_t *planet_out) {
+  az_reader_t reader;
+  if (!resource_reader("rooms/planet.bin", &reader)) return false;
+  az_rmapping_t mapping;
+  bool success = az_rmap(&reader, &mapping);
+  az_rclose(&reader);
+  if (success) {
+    success = az_open_compiled_planet(&mapping, planet_out);
+    az_runmap(&mapping); // does nothing if the planet took the mapping
+  }
+  if (!success) {
+    fprintf(stderr, "Failed to load rooms/planet.bin; "
+            "falling back to text files.\n");
+  }
+  return success;
+}
+
+char *az_room_resource_name(az_room_key_t key) {
+  return az_strprintf("rooms/room%03d.txt", (int)key);
+}
+
 bool az_read_planet(az_resource_reader_fn_t resource_reader,
                     az_planet_t *planet_out) {
   assert(planet_out != NULL);
+  if (read_compiled_planet(resource_reader, planet_out)) return true;
 
   az_reader_t reader;
-  if (!resource_reader("rooms/planet.txt", &reader)) return false;
+  if (!resource_reader(AZ_PLANET_BASIS_RESOURCE_NAME, &reader)) return false;
   bool success = read_planet_basis(&reader, planet_out);
   az_rclose(&reader);
   if (!success) return false;
 
   for (int i = 0; i < planet_out->num_rooms; ++i) {
-    char *room_name = az_strprintf("rooms/room%03d.txt", i);
+    char *room_name = az_room_resource_name(i);
     resource_reader(room_name, &reader);
     success = az_read_room(&reader, &planet_out->rooms[i]) &&
       planet_out->rooms[i].zone_key < planet_out->num_zones;
@@ -253,8 +276,7 @@ bool az_read_planet(az_resource_reader_fn_t resource_reader,
     if (!az_wprintf(writer, __VA_ARGS__)) return false; \
   } while (false)
 
-static bool write_planet_basis(const az_planet_t *planet,
-                               az_writer_t *writer) {
+bool az_write_planet_basis(const az_planet_t *planet, az_writer_t *writer) {
   WRITE("@P z%d h%d r%d t%d s%d\n",
         planet->num_zones, planet->num_hints, planet->num_rooms,
         planet->num_paragraphs, planet->start_room);
@@ -315,7 +337,7 @@ bool az_write_planet(const az_planet_t *planet,
 
   for (int i = 0; i < num_rooms_to_write; ++i) {
     const int key = rooms_to_write[i];
-    char *room_name = az_strprintf("rooms/room%03d.txt", key);
+    char *room_name = az_room_resource_name(key);
     bool success = false;
     az_writer_t writer;
     if (resource_writer(room_name, &writer)) {
@@ -328,8 +350,8 @@ bool az_write_planet(const az_planet_t *planet,
 
   bool success = false;
   az_writer_t writer;
-  if (resource_writer("rooms/planet.txt", &writer)) {
-    success = write_planet_basis(planet, &writer);
+  if (resource_writer(AZ_PLANET_BASIS_RESOURCE_NAME, &writer)) {
+    success = az_write_planet_basis(planet, &writer);
     az_wclose(&writer);
   }
   return success;
@@ -349,13 +371,38 @@ void az_destroy_planet(az_planet_t *planet) {
     free(planet->zones[i].entering_message);
   }
   free(planet->zones);
+  free(planet->hints);
   for (int i = 0; i < planet->num_rooms; ++i) {
     az_destroy_room(&planet->rooms[i]);
   }
   free(planet->rooms);
+  az_destroy_room_cache(planet->room_cache);
   AZ_ZERO_OBJECT(planet);
 }
 
+const az_room_t *az_get_room(const az_planet_t *planet, az_room_key_t key) {
+  assert(key >= 0 && key < planet->num_rooms);
+  if (planet->room_cache == NULL) return &planet->rooms[key];
+  return az_get_cached_room(planet, key);
+}
+
+const az_room_t *az_peek_room(const az_planet_t *planet, az_room_key_t key) {
+  assert(key >= 0 && key < planet->num_rooms);
+  if (planet->room_cache == NULL) return &planet->rooms[key];
+  return az_peek_cached_room(planet, key);
+}
+
+void az_prefetch_neighbor_rooms(const az_planet_t *planet, az_room_key_t key) {
+  assert(key >= 0 && key < planet->num_rooms);
+  if (planet->room_cache != NULL) az_prefetch_cached_rooms(planet, key);
+}
+
+uint64_t az_room_generation(const az_planet_t *planet, az_room_key_t key) {
+  assert(key >= 0 && key < planet->num_rooms);
+  if (planet->room_cache == NULL) return 1;
+  return az_cached_room_generation(planet, key);
+}
+
 void az_clone_zone(const az_zone_t *original, az_zone_t *clone_out) {
   clone_out->name = az_strdup(original->name);
   clone_out->entering_message = az_strdup(original->entering_message);
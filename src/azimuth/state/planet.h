@@ -22,6 +22,7 @@
 #define AZIMUTH_STATE_PLANET_H_
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "azimuth/state/dialog.h"
 #include "azimuth/state/player.h"
@@ -32,6 +33,10 @@
 
 /*===========================================================================*/
 
+// Arbitrary limits to enforce sanity:
+#define AZ_MAX_NUM_HINTS 500
+#define AZ_MAX_NUM_PARAGRAPHS 50000
+
 typedef struct {
   char *name; // NUL-terminated; owned by zone object
   char *entering_message; // NUL-terminated; owned by zone object
@@ -55,6 +60,9 @@ typedef struct {
   az_room_key_t target_room;
 } az_hint_t;
 
+// Holds lazily loaded rooms; see compiled_planet.h.
+typedef struct az_room_cache az_room_cache_t;
+
 typedef struct {
   az_room_key_t start_room;
   az_script_t *on_start;
@@ -65,9 +73,25 @@ typedef struct {
   int num_hints;
   az_hint_t *hints;
   int num_rooms;
+  // If room_cache is NULL, all rooms are fully loaded.  Otherwise, the rooms
+  // array holds only room headers (zone_key, properties, marker_flag,
+  // camera_bounds, and background_pattern), and full rooms must be obtained
+  // with az_get_room.
   az_room_t *rooms;
+  az_room_cache_t *room_cache;
 } az_planet_t;
 
+// The name of the resource holding the planet-wide part of a text planet:
+#define AZ_PLANET_BASIS_RESOURCE_NAME "rooms/planet.txt"
+
+// Return the name of the resource holding the given room's text file (e.g.
+// "rooms/room007.txt").  The caller must free the returned string.
+char *az_room_resource_name(az_room_key_t key);
+
+// Load the planet from the compiled rooms/planet.bin (see compiled_planet.h)
+// if the resource reader provides it, in which case rooms will be loaded
+// lazily; or else fully load it from rooms/planet.txt and the text room
+// files.  Returns true on success, false on failure.
 bool az_read_planet(az_resource_reader_fn_t resource_reader,
                     az_planet_t *planet_out);
 
@@ -76,9 +100,36 @@ bool az_write_planet(const az_planet_t *planet,
                      const az_room_key_t *rooms_to_write,
                      int num_rooms_to_write);
 
+// Write just the planet-wide part of the planet (what az_write_planet puts in
+// rooms/planet.txt) to the given writer.  This only reads num_rooms from the
+// planet's rooms.  Returns true on success, false on failure.
+bool az_write_planet_basis(const az_planet_t *planet, az_writer_t *writer);
+
 // Delete the data arrays owned by a planet (but not the planet object itself).
 void az_destroy_planet(az_planet_t *planet);
 
+// Return the given room, with all of its object specs and scripts loaded.  If
+// the planet loads rooms lazily, the room is loaded into the planet's room
+// cache if it isn't there already.  The rooms returned by the two most recent
+// calls are never evicted from the cache, but any other pointer returned by
+// this function may become invalid on the next call.
+const az_room_t *az_get_room(const az_planet_t *planet, az_room_key_t key);
+
+// Like az_get_room, but doesn't count as one of the most recent calls.  If the
+// room was already prefetched (see below), this won't load or evict anything.
+const az_room_t *az_peek_room(const az_planet_t *planet, az_room_key_t key);
+
+// If the planet loads rooms lazily, load the rooms reachable through the
+// doors of the given room into the room cache ahead of time.
+void az_prefetch_neighbor_rooms(const az_planet_t *planet, az_room_key_t key);
+
+// Return a number identifying the copy of the given room currently loaded in
+// the room cache, which changes whenever the room is evicted or reloaded (even
+// if it is reloaded at the same address), or zero if the room isn't loaded.
+// For planets without a room cache, the result is always 1.  This doesn't
+// load or evict anything.
+uint64_t az_room_generation(const az_planet_t *planet, az_room_key_t key);
+
 void az_clone_zone(const az_zone_t *original, az_zone_t *clone_out);
 
 /*===========================================================================*/
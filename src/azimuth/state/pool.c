@@ -0,0 +1,63 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#include "azimuth/state/pool.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/*===========================================================================*/
+
+int az_pool_insert(az_pool_t *pool, int capacity,
+                   az_pool_vacancy_fn_t is_vacant, const void *objects) {
+  assert(capacity > 0 && capacity <= AZ_MAX_POOL_SIZE);
+  assert(pool->num_live + pool->num_vacant == pool->num_touched);
+  int slot;
+  if (pool->num_vacant > 0) {
+    slot = pool->vacant[--pool->num_vacant];
+  } else if (pool->num_touched < capacity) {
+    slot = pool->num_touched++;
+  } else {
+    // Every slot is in the live list, but some of them may have been emptied
+    // since the last collection; reuse the first of those that we find.
+    for (int i = 0; i < pool->num_live; ++i) {
+      if (is_vacant(objects, pool->live[i])) return pool->live[i];
+    }
+    return -1;
+  }
+  assert(is_vacant(objects, slot));
+  pool->live[pool->num_live++] = slot;
+  return slot;
+}
+
+void az_pool_collect(az_pool_t *pool, az_pool_vacancy_fn_t is_vacant,
+                     const void *objects) {
+  int num_kept = 0;
+  for (int i = 0; i < pool->num_live; ++i) {
+    const int slot = pool->live[i];
+    if (is_vacant(objects, slot)) {
+      assert(pool->num_vacant < AZ_MAX_POOL_SIZE);
+      pool->vacant[pool->num_vacant++] = slot;
+    } else pool->live[num_kept++] = slot;
+  }
+  pool->num_live = num_kept;
+}
+
+/*===========================================================================*/
@@ -0,0 +1,81 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#pragma once
+#ifndef AZIMUTH_STATE_POOL_H_
+#define AZIMUTH_STATE_POOL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*===========================================================================*/
+
+// The largest object array that a pool can keep track of.
+#define AZ_MAX_POOL_SIZE 1000
+
+// A pool keeps track of which slots of a fixed-size object array are in use,
+// so that inserting an object doesn't need to scan the array for an empty
+// slot, and so that loops over the objects only need to visit slots that are
+// in use.  A zeroed pool is a valid pool with every slot vacant.
+//
+// Objects are removed from the array simply by setting their kind to NOTHING,
+// as usual; the pool doesn't find out about this until the next call to
+// az_pool_collect, so until then the live list may still contain some vacant
+// slots (which loops must skip over, just as they would for a plain array).
+typedef struct {
+  int num_live; // number of entries in the live array
+  int num_vacant; // number of entries in the vacant array
+  int num_touched; // slots at or above this index have never been used
+  int16_t live[AZ_MAX_POOL_SIZE]; // slots in use, in order of insertion
+  int16_t vacant[AZ_MAX_POOL_SIZE]; // stack of slots known to be empty
+} az_pool_t;
+
+// A function that returns true if the object in the given slot of the given
+// array is empty (that is, its kind is NOTHING).
+typedef bool (*az_pool_vacancy_fn_t)(const void *objects, int slot);
+
+// Reserve a vacant slot of an array with the given capacity, add it to the
+// end of the live list, and return its index; return -1 if the array is full.
+// The caller is responsible for filling in the object in that slot.  This
+// takes constant time, unless no slots are known to be vacant, in which case
+// the live list is searched for a slot that has been emptied since the last
+// call to az_pool_collect (and that slot keeps its place in the live list).
+// This never reorders the live list, so it's safe to call within a loop over
+// the pool.
+int az_pool_insert(az_pool_t *pool, int capacity,
+                   az_pool_vacancy_fn_t is_vacant, const void *objects);
+
+// Remove all vacant slots from the live list, preserving the order of the
+// remaining slots.  This must not be called within a loop over the pool.
+void az_pool_collect(az_pool_t *pool, az_pool_vacancy_fn_t is_vacant,
+                     const void *objects);
+
+// Loop over the objects in the live slots of an array, in order of insertion.
+// Objects inserted during the loop will also be visited.  As with
+// AZ_ARRAY_LOOP, the loop body should skip over empty objects.
+#define AZ_POOL_LOOP(var_name, array, pool) \
+  for (int az_pool_pos_ = 0, az_pool_brk_ = 0; \
+       !az_pool_brk_ && az_pool_pos_ < (pool)->num_live; ++az_pool_pos_) \
+    for (__typeof__(&*(array)) var_name = \
+           (az_pool_brk_ = 1, &(array)[(pool)->live[az_pool_pos_]]); \
+         az_pool_brk_; az_pool_brk_ = 0)
+
+/*===========================================================================*/
+
+#endif // AZIMUTH_STATE_POOL_H_
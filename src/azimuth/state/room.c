@@ -474,8 +474,21 @@ bool az_save_room_to_path(const az_room_t *room, const char *filepath) {
 void az_destroy_room(az_room_t *room) {
   assert(room != NULL);
   az_free_script(room->on_start);
+  for (int i = 0; i < room->num_baddies; ++i) {
+    az_free_script(room->baddies[i].on_kill);
+  }
   free(room->baddies);
+  for (int i = 0; i < room->num_doors; ++i) {
+    az_free_script(room->doors[i].on_open);
+  }
   free(room->doors);
+  for (int i = 0; i < room->num_gravfields; ++i) {
+    az_free_script(room->gravfields[i].on_enter);
+  }
+  free(room->gravfields);
+  for (int i = 0; i < room->num_nodes; ++i) {
+    az_free_script(room->nodes[i].on_use);
+  }
   free(room->nodes);
   free(room->walls);
   AZ_ZERO_OBJECT(room);
@@ -0,0 +1,166 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#include "azimuth/state/room_builder.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "azimuth/state/planet.h"
+#include "azimuth/state/player.h"
+#include "azimuth/state/room.h"
+#include "azimuth/state/space.h"
+#include "azimuth/util/misc.h"
+#include "azimuth/util/thread.h"
+
+/*===========================================================================*/
+
+struct az_room_builder {
+  az_thread_t *thread;
+  az_mutex_t *mutex;
+  az_condvar_t *condvar; // signalled whenever status or quit changes
+  // The fields below are protected by the mutex, except that while status is
+  // BUILDING, the worker thread may read the request fields and write to the
+  // objects without holding it (and the main thread won't touch them).
+  bool quit;
+  enum {
+    IDLE, // no build requested
+    PENDING, // build requested, but the worker hasn't started on it yet
+    BUILDING, // worker is building the objects
+    READY // objects are built, and belong to the main thread again
+  } status;
+  // The request (meaningful whenever status isn't IDLE):
+  const az_planet_t *planet;
+  az_room_key_t key;
+  const az_room_t *room;
+  uint64_t room_generation; // see az_room_generation
+  az_player_t player;
+  // The result (meaningful only when status is READY):
+  az_room_objects_t objects;
+};
+
+static void worker_main(void *arg) {
+  az_room_builder_t *builder = arg;
+  az_lock_mutex(builder->mutex);
+  while (true) {
+    while (!builder->quit && builder->status != PENDING) {
+      az_wait_condvar(builder->condvar, builder->mutex);
+    }
+    if (builder->quit) break;
+    builder->status = BUILDING;
+    az_unlock_mutex(builder->mutex);
+    az_build_room_objects(builder->planet, &builder->player, builder->room,
+                          &builder->objects);
+    az_lock_mutex(builder->mutex);
+    builder->status = READY;
+    az_broadcast_condvar(builder->condvar);
+  }
+  az_unlock_mutex(builder->mutex);
+}
+
+// Wait until the worker isn't building anything.  The mutex must be locked.
+static void wait_while_building(az_room_builder_t *builder) {
+  while (builder->status == BUILDING) {
+    az_wait_condvar(builder->condvar, builder->mutex);
+  }
+}
+
+/*===========================================================================*/
+
+az_room_builder_t *az_create_room_builder(void) {
+  az_room_builder_t *builder = AZ_ALLOC(1, az_room_builder_t);
+  builder->mutex = az_create_mutex();
+  builder->condvar = az_create_condvar();
+  builder->status = IDLE;
+  builder->thread = az_start_thread(worker_main, builder);
+  return builder;
+}
+
+void az_destroy_room_builder(az_room_builder_t *builder) {
+  if (builder == NULL) return;
+  az_lock_mutex(builder->mutex);
+  builder->quit = true;
+  az_broadcast_condvar(builder->condvar);
+  az_unlock_mutex(builder->mutex);
+  az_join_thread(builder->thread);
+  az_destroy_condvar(builder->condvar);
+  az_destroy_mutex(builder->mutex);
+  free(builder);
+}
+
+void az_request_room_build(az_room_builder_t *builder,
+                           const az_planet_t *planet,
+                           const az_player_t *player, az_room_key_t key) {
+  assert(key >= 0 && key < planet->num_rooms);
+  az_lock_mutex(builder->mutex);
+  if (builder->status == IDLE || builder->planet != planet ||
+      builder->key != key) {
+    wait_while_building(builder);
+    // Now that the worker isn't reading any room, it's safe to touch the
+    // room cache.
+    builder->planet = planet;
+    builder->key = key;
+    builder->room = az_peek_room(planet, key);
+    builder->room_generation = az_room_generation(planet, key);
+    builder->player = *player;
+    builder->status = PENDING;
+    az_broadcast_condvar(builder->condvar);
+  }
+  az_unlock_mutex(builder->mutex);
+}
+
+bool az_take_room_build(az_room_builder_t *builder, az_space_state_t *state,
+                        az_room_key_t key) {
+  az_lock_mutex(builder->mutex);
+  bool taken = false;
+  if (builder->status != IDLE && builder->planet == state->planet &&
+      builder->key == key) {
+    while (builder->status != READY) {
+      az_wait_condvar(builder->condvar, builder->mutex);
+    }
+    // Now that the worker is done, it's safe to touch the room cache.  If the
+    // room was reloaded since the build was requested, the objects may refer
+    // to the old copy's scripts, so compare generations rather than room
+    // pointers (a reloaded room can land at the same address).  Getting an
+    // upgrade removes its node from the room, so if the player has gotten
+    // any upgrades since the build was requested, we have to rebuild.
+    if (builder->room_generation ==
+        az_room_generation(state->planet, key) &&
+        memcmp(&builder->player.upgrades, &state->ship.player.upgrades,
+               sizeof(builder->player.upgrades)) == 0) {
+      az_install_room_objects(state, &builder->objects);
+      taken = true;
+    }
+  } else wait_while_building(builder);
+  builder->status = IDLE;
+  az_unlock_mutex(builder->mutex);
+  return taken;
+}
+
+void az_cancel_room_build(az_room_builder_t *builder) {
+  az_lock_mutex(builder->mutex);
+  wait_while_building(builder);
+  builder->status = IDLE;
+  az_unlock_mutex(builder->mutex);
+}
+
+/*===========================================================================*/
@@ -0,0 +1,82 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#pragma once
+#ifndef AZIMUTH_STATE_ROOM_BUILDER_H_
+#define AZIMUTH_STATE_ROOM_BUILDER_H_
+
+#include <stdbool.h>
+
+#include "azimuth/state/planet.h"
+#include "azimuth/state/player.h"
+#include "azimuth/state/room.h"
+#include "azimuth/state/space.h"
+
+/*===========================================================================*/
+
+// A room builder owns a worker thread that builds the objects for a room
+// (see az_build_room_objects) in the background, so that going through a door
+// only has to install the prebuilt objects into the space state.
+//
+// Ownership works like this: the worker thread never touches the space
+// state.  It only writes to the builder's own az_room_objects_t, and only
+// reads from the room being built, the planet's room headers, and the
+// builder's own copy of the player.  The main thread owns everything else,
+// and only looks at the builder's objects once the worker has finished with
+// them.  Since the worker reads the room directly, the main thread must not
+// do anything that could evict that room from the planet's room cache (that
+// is, call az_get_room or az_prefetch_neighbor_rooms) until it has taken or
+// cancelled the build.  All of these functions must be called from the main
+// thread only.
+//
+// (az_space_state_t's room_builder field isn't owned by the space state; the
+// room builder lives as long as whoever created it wants.)
+
+// Create a new room builder, with its own worker thread.
+az_room_builder_t *az_create_room_builder(void);
+
+// Wait for the worker thread to finish, and then free the builder.  Does
+// nothing if the builder is NULL.
+void az_destroy_room_builder(az_room_builder_t *builder);
+
+// Start building the objects for the given room in the background, as they
+// would be for the given player.  This discards any other build (waiting for
+// it to finish, if it is in progress), but does nothing if the same room has
+// already been requested.  The room is gotten with az_peek_room, so the room
+// should already have been prefetched.
+void az_request_room_build(az_room_builder_t *builder,
+                           const az_planet_t *planet,
+                           const az_player_t *player, az_room_key_t key);
+
+// If a build of the given room was requested, wait for it to finish, and
+// then, if it is still valid for the given state (the room hasn't been
+// reloaded into the room cache, and the player hasn't gotten any upgrades
+// since the build was requested), install its objects into the state (which
+// should have just been cleared with az_clear_space) and return true.
+// Otherwise, discard any build and return false, in which case the caller
+// should call az_enter_room instead.
+bool az_take_room_build(az_room_builder_t *builder, az_space_state_t *state,
+                        az_room_key_t key);
+
+// Discard any build, waiting for it to finish if it is in progress.
+void az_cancel_room_build(az_room_builder_t *builder);
+
+/*===========================================================================*/
+
+#endif // AZIMUTH_STATE_ROOM_BUILDER_H_
@@ -20,6 +20,7 @@
 #include "azimuth/state/script.h"
 
 #include <assert.h>
+#include <math.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -28,6 +29,7 @@
 
 #include "azimuth/util/misc.h"
 #include "azimuth/util/rw.h"
+#include "azimuth/util/vector.h"
 
 /*===========================================================================*/
 
@@ -365,6 +367,288 @@ bool az_sprint_script(const az_script_t *script, char *buffer, int length) {
 
 /*===========================================================================*/
 
+// Get how many values the instruction needs on the stack, and how many it
+// leaves in their place, assuming it doesn't fail.
+static void get_stack_effect(az_instruction_t ins, int *pops_out,
+                             int *pushes_out) {
+  int pops = 0, pushes = 0;
+  switch (ins.opcode) {
+    case AZ_OP_PUSH:
+    case AZ_OP_RAND:
+    case AZ_OP_TEST:
+    case AZ_OP_HAS:
+    case AZ_OP_GHEAL:
+    case AZ_OP_GANG:
+    case AZ_OP_GSTAT:
+    case AZ_OP_GSTR:
+      pushes = 1;
+      break;
+    case AZ_OP_GPOS:
+    case AZ_OP_GVEL:
+    case AZ_OP_GCAM:
+      pushes = 2;
+      break;
+    case AZ_OP_POP:
+      pops = az_imax(1, (int)ins.immediate);
+      break;
+    case AZ_OP_DUP:
+      pops = az_imax(1, (int)ins.immediate);
+      pushes = 2 * pops;
+      break;
+    case AZ_OP_SWAP: {
+      const int cycle = (int)ins.immediate;
+      pops = pushes = (cycle == 0 ? 2 : abs(cycle));
+    } break;
+    case AZ_OP_ADDI:
+    case AZ_OP_SUBI:
+    case AZ_OP_ISUB:
+    case AZ_OP_MULI:
+    case AZ_OP_DIVI:
+    case AZ_OP_IDIV:
+    case AZ_OP_MODI:
+    case AZ_OP_MINI:
+    case AZ_OP_MAXI:
+    case AZ_OP_ABS:
+    case AZ_OP_MTAU:
+    case AZ_OP_SQRT:
+    case AZ_OP_EQI:
+    case AZ_OP_NEI:
+    case AZ_OP_LTI:
+    case AZ_OP_GTI:
+    case AZ_OP_LEI:
+    case AZ_OP_GEI:
+      pops = pushes = 1;
+      break;
+    case AZ_OP_ADD:
+    case AZ_OP_SUB:
+    case AZ_OP_MUL:
+    case AZ_OP_DIV:
+    case AZ_OP_MOD:
+    case AZ_OP_MIN:
+    case AZ_OP_MAX:
+    case AZ_OP_VNORM:
+    case AZ_OP_VTHETA:
+    case AZ_OP_EQ:
+    case AZ_OP_NE:
+    case AZ_OP_LT:
+    case AZ_OP_GT:
+    case AZ_OP_LE:
+    case AZ_OP_GE:
+      pops = 2;
+      pushes = 1;
+      break;
+    case AZ_OP_VMULI:
+    case AZ_OP_VPOLAR:
+      pops = pushes = 2;
+      break;
+    case AZ_OP_VMUL:
+      pops = 3;
+      pushes = 2;
+      break;
+    case AZ_OP_VADD:
+    case AZ_OP_VSUB:
+      pops = 4;
+      pushes = 2;
+      break;
+    case AZ_OP_SHEAL:
+    case AZ_OP_SANG:
+    case AZ_OP_SSTAT:
+    case AZ_OP_TURN:
+    case AZ_OP_SBADK:
+    case AZ_OP_SSTR:
+    case AZ_OP_RCAM:
+    case AZ_OP_DARKS:
+    case AZ_OP_WAITS:
+    case AZ_OP_BEQZ:
+    case AZ_OP_BNEZ:
+    case AZ_OP_HEQZ:
+    case AZ_OP_HNEZ:
+      pops = 1;
+      break;
+    case AZ_OP_SPOS:
+    case AZ_OP_SVEL:
+    case AZ_OP_BOOM:
+    case AZ_OP_NPS:
+      pops = 2;
+      break;
+    case AZ_OP_BAD:
+    case AZ_OP_BOLT:
+      pops = 4;
+      break;
+    case AZ_OP_NOP:
+    case AZ_OP_SET:
+    case AZ_OP_CLR:
+    case AZ_OP_MAP:
+    case AZ_OP_NIX:
+    case AZ_OP_KILL:
+    case AZ_OP_ACTIV:
+    case AZ_OP_DEACT:
+    case AZ_OP_AUTOP:
+    case AZ_OP_THRUST:
+    case AZ_OP_CPLUS:
+    case AZ_OP_BOSS:
+    case AZ_OP_OPEN:
+    case AZ_OP_CLOSE:
+    case AZ_OP_LOCK:
+    case AZ_OP_UNLOCK:
+    case AZ_OP_DARK:
+    case AZ_OP_BLINK:
+    case AZ_OP_SHAKE:
+    case AZ_OP_QUAKE:
+    case AZ_OP_NUKE:
+    case AZ_OP_FADO:
+    case AZ_OP_FADI:
+    case AZ_OP_FLASH:
+    case AZ_OP_SCENE:
+    case AZ_OP_SCTXT:
+    case AZ_OP_SKIP:
+    case AZ_OP_MSG:
+    case AZ_OP_DLOG:
+    case AZ_OP_PT:
+    case AZ_OP_PB:
+    case AZ_OP_TT:
+    case AZ_OP_TB:
+    case AZ_OP_DEND:
+    case AZ_OP_MLOG:
+    case AZ_OP_TM:
+    case AZ_OP_MEND:
+    case AZ_OP_MUS:
+    case AZ_OP_MUSF:
+    case AZ_OP_SND:
+    case AZ_OP_WAIT:
+    case AZ_OP_DOOM:
+    case AZ_OP_SAFE:
+    case AZ_OP_JUMP:
+    case AZ_OP_HALT:
+    case AZ_OP_VICT:
+    case AZ_OP_ERROR:
+      break;
+  }
+  *pops_out = pops;
+  *pushes_out = pushes;
+}
+
+// Determine whether every instruction the script can reach (starting from
+// the beginning with an empty stack) is always reached with the same stack
+// depth, and never overflows or underflows the stack.  Scripts always
+// resume right where they were suspended, with the stack they had then, so
+// this holds no matter how many times the script is suspended.
+static bool is_stack_safe(const az_script_t *script) {
+  const int num_instructions = script->num_instructions;
+  const az_compiled_instruction_t *compiled = script->compiled;
+  int depths[num_instructions]; // -1 for not (yet) reached
+  int worklist[num_instructions];
+  for (int i = 0; i < num_instructions; ++i) depths[i] = -1;
+  depths[0] = 0;
+  worklist[0] = 0;
+  int worklist_size = 1;
+  while (worklist_size > 0) {
+    const int pc = worklist[--worklist_size];
+    int pops, pushes;
+    get_stack_effect(script->instructions[pc], &pops, &pushes);
+    if (depths[pc] < pops ||
+        depths[pc] - pops + pushes > AZ_SCRIPT_STACK_SIZE) return false;
+    const int new_depth = depths[pc] - pops + pushes;
+    int successors[2];
+    int num_successors = 0;
+    switch (compiled[pc].opcode) {
+      case AZ_OP_HALT:
+      case AZ_OP_VICT:
+      case AZ_OP_ERROR:
+        break;
+      case AZ_OP_JUMP:
+        successors[num_successors++] = compiled[pc].target;
+        break;
+      case AZ_OP_BEQZ:
+      case AZ_OP_BNEZ:
+        successors[num_successors++] = compiled[pc].target;
+        successors[num_successors++] = pc + 1;
+        break;
+      default:
+        successors[num_successors++] = pc + 1;
+        break;
+    }
+    for (int i = 0; i < num_successors; ++i) {
+      const int next = successors[i];
+      // Jumping out of range is an error, and running off the end of the
+      // script just halts it, so neither has a stack depth to check.
+      if (next < 0 || next >= num_instructions) continue;
+      if (depths[next] < 0) {
+        depths[next] = new_depth;
+        assert(worklist_size < num_instructions);
+        worklist[worklist_size++] = next;
+      } else if (depths[next] != new_depth) return false;
+    }
+  }
+  return true;
+}
+
+void az_compile_script(az_script_t *script) {
+  const int num_instructions = script->num_instructions;
+  assert(num_instructions > 0);
+  free(script->compiled);
+  az_compiled_instruction_t *compiled =
+    AZ_ALLOC(num_instructions + 1, az_compiled_instruction_t);
+  script->compiled = compiled;
+  // First, decode each instruction on its own.
+  for (int pc = 0; pc < num_instructions; ++pc) {
+    const az_instruction_t ins = script->instructions[pc];
+    az_compiled_instruction_t *out = &compiled[pc];
+    out->handler = ins.opcode;
+    out->opcode = ins.opcode;
+    out->length = 1;
+    out->index = (int)ins.immediate;
+    out->target = -1;
+    out->immediate = ins.immediate;
+    if (is_jump(ins.opcode)) {
+      const int dest = pc + out->index;
+      if (dest >= 0 && dest <= num_instructions) out->target = dest;
+    }
+  }
+  compiled[num_instructions] = (az_compiled_instruction_t){
+    .handler = AZ_SOP_END, .opcode = AZ_OP_HALT, .length = 0, .target = -1
+  };
+  script->stack_safe = is_stack_safe(script);
+  // Then fuse common sequences into superinstructions.  We only ever change
+  // the first instruction of a sequence, so the rest of the sequence is still
+  // there to run on its own, if something jumps into the middle of it.
+  for (int pc = 0; pc + 1 < num_instructions; ++pc) {
+    az_compiled_instruction_t *first = &compiled[pc];
+    const az_compiled_instruction_t *second = &compiled[pc + 1];
+    if (first->opcode == AZ_OP_TEST) {
+      switch (second->opcode) {
+        case AZ_OP_BEQZ: first->handler = AZ_SOP_TEST_BEQZ; break;
+        case AZ_OP_BNEZ: first->handler = AZ_SOP_TEST_BNEZ; break;
+        case AZ_OP_HEQZ: first->handler = AZ_SOP_TEST_HEQZ; break;
+        case AZ_OP_HNEZ: first->handler = AZ_SOP_TEST_HNEZ; break;
+        default: continue;
+      }
+      first->length = 2;
+      first->target = second->target;
+    } else if (first->opcode == AZ_OP_PUSH && isfinite(first->immediate) &&
+               (second->opcode == AZ_OP_BEQZ ||
+                second->opcode == AZ_OP_BNEZ)) {
+      const bool taken = ((first->immediate == 0.0) ==
+                          (second->opcode == AZ_OP_BEQZ));
+      // Leave out-of-range jumps to the ordinary instructions, which will
+      // report the error.
+      if (taken && second->target < 0) continue;
+      first->handler = AZ_SOP_GOTO;
+      first->length = 2;
+      first->target = (taken ? second->target : pc + 2);
+    } else if (first->opcode == AZ_OP_NIX &&
+               second->opcode == AZ_OP_NIX) {
+      int length = 2;
+      while (pc + length < num_instructions &&
+             compiled[pc + length].opcode == AZ_OP_NIX) ++length;
+      first->handler = AZ_SOP_NIX_RUN;
+      first->length = length;
+    }
+  }
+}
+
+/*===========================================================================*/
+
 static bool read_instructions(az_reader_t *reader, int num_instructions,
                               az_instruction_t *instructions) {
   int label_table[26] = {0};
@@ -432,6 +716,7 @@ az_script_t *az_read_script(az_reader_t *reader) {
   az_script_t *script = AZ_ALLOC(1, az_script_t);
   script->num_instructions = num_instructions;
   script->instructions = instructions;
+  az_compile_script(script);
   return script;
 }
 
@@ -452,11 +737,13 @@ az_script_t *az_clone_script(const az_script_t *script) {
   clone->instructions = AZ_ALLOC(clone->num_instructions, az_instruction_t);
   memcpy(clone->instructions, script->instructions,
          clone->num_instructions * sizeof(az_instruction_t));
+  az_compile_script(clone);
   return clone;
 }
 
 void az_free_script(az_script_t *script) {
   if (script == NULL) return;
+  free(script->compiled);
   free(script->instructions);
   free(script);
 }
@@ -176,16 +176,55 @@ typedef struct {
   double immediate;
 } az_instruction_t;
 
+// Superinstructions, which a compiled script uses in place of common
+// sequences of instructions (see az_compile_script).  These are numbered
+// after the opcodes, so that the two can share a dispatch table.
+typedef enum {
+  AZ_SOP_END = AZ_OP_ERROR + 1, // sentinel after the last instruction
+  AZ_SOP_TEST_BEQZ, // test i, then beqz
+  AZ_SOP_TEST_BNEZ, // test i, then bnez
+  AZ_SOP_TEST_HEQZ, // test i, then heqz
+  AZ_SOP_TEST_HNEZ, // test i, then hnez
+  AZ_SOP_GOTO, // push i, then beqz or bnez (so the branch is decided ahead)
+  AZ_SOP_NIX_RUN // two or more nix instructions in a row
+} az_superop_t;
+
+#define AZ_NUM_SCRIPT_HANDLERS (AZ_SOP_NIX_RUN + 1)
+
+// One instruction of a compiled script, pre-decoded for the interpreter.
+// Compiled instructions correspond one-to-one with the original ones, so
+// that pc values mean the same thing in both; a superinstruction just stands
+// in for the instructions after it as well as its own.
+typedef struct {
+  int handler; // an az_opcode_t, or an az_superop_t
+  az_opcode_t opcode; // the original instruction's opcode
+  int length; // how many instructions this stands for (zero for AZ_SOP_END)
+  int index; // the original instruction's immediate, truncated to an int
+  // For jumps, and superinstructions ending in a jump, the pc to jump to, or
+  // -1 if the jump is out of range:
+  int target;
+  double immediate; // the original instruction's immediate
+} az_compiled_instruction_t;
+
 typedef struct {
   int num_instructions;
   az_instruction_t *instructions;
+  // The compiled form of the instructions (with an AZ_SOP_END sentinel at
+  // the end), or NULL if the script hasn't been compiled (see
+  // az_compile_script).  Only compiled scripts can be run.
+  az_compiled_instruction_t *compiled;
+  // True if the compiler proved that running the script can never overflow
+  // or underflow the stack, so that the interpreter needn't check:
+  bool stack_safe;
 } az_script_t;
 
+#define AZ_SCRIPT_STACK_SIZE 20
+
 typedef struct {
   const az_script_t *script;
   int pc;
   int stack_size;
-  double stack[20];
+  double stack[AZ_SCRIPT_STACK_SIZE];
 } az_script_vm_t;
 
 typedef struct {
@@ -204,6 +243,11 @@ az_script_t *az_sscan_script(const char *string, int length);
 // Allocate and return a copy of the given script.  Returns NULL if given NULL.
 az_script_t *az_clone_script(const az_script_t *script);
 
+// (Re)build the compiled form of the script from its instructions.  The
+// functions above that return new scripts all do this already, so this only
+// needs to be called for scripts constructed by hand.
+void az_compile_script(az_script_t *script);
+
 // Free the script object and its data array.  Does nothing if given NULL.
 void az_free_script(az_script_t *script);
 
@@ -1042,11 +1042,11 @@ static const az_sound_data_t *sound_data_for_key(az_sound_key_t sound_key) {
   return sound_data;
 }
 
-void az_init_sound_datas(void) {
+void az_init_sound_datas(const char *cache_path) {
   assert(!sound_data_initialized);
-  for (int i = 1; i < AZ_ARRAY_SIZE(sound_specs); ++i) {
-    az_create_sound_data(&sound_specs[i], &sound_datas[i]);
-  }
+  // Skip AZ_SND_NOTHING, which has no sound data.
+  az_create_sound_datas(AZ_ARRAY_SIZE(sound_specs) - 1, sound_specs + 1,
+                        sound_datas + 1, cache_path);
   sound_data_initialized = true;
   atexit(destroy_sound_datas);
   assert(sound_data_for_key(AZ_SND_NOTHING) == NULL);
@@ -1063,6 +1063,11 @@ void az_play_sound_with_volume(
   az_play_sound_data(soundboard, sound_data_for_key(sound_key), volume);
 }
 
+void az_play_sound_with_pan(
+    az_soundboard_t *soundboard, az_sound_key_t sound_key, float pan) {
+  az_play_panned_sound_data(soundboard, sound_data_for_key(sound_key), 1, pan);
+}
+
 void az_loop_sound(az_soundboard_t *soundboard, az_sound_key_t sound_key) {
   az_loop_sound_data(soundboard, sound_data_for_key(sound_key), 1);
 }
@@ -170,7 +170,10 @@ typedef enum {
 
 /*===========================================================================*/
 
-void az_init_sound_datas(void);
+// Render all sound effects.  If cache_path is non-NULL, reuse any sounds
+// saved in the sound cache file at that path by a previous run, and update it
+// afterwards (see az_create_sound_datas).
+void az_init_sound_datas(const char *cache_path);
 
 // Indicate that we should play the given sound (once).  The sound will not
 // loop, and cannot be cancelled or paused once started.
@@ -179,6 +182,10 @@ void az_play_sound(az_soundboard_t *soundboard, az_sound_key_t sound);
 void az_play_sound_with_volume(
     az_soundboard_t *soundboard, az_sound_key_t sound, float volume);
 
+// Like az_play_sound, but pan the sound between -1 (left) and 1 (right).
+void az_play_sound_with_pan(
+    az_soundboard_t *soundboard, az_sound_key_t sound, float pan);
+
 // Indicate that we should start playing, or continue to play, the given sound.
 // To keep the sound going, we must call this function every frame with the
 // same sound, otherwise the sound will stop.  As long as we keep calling this
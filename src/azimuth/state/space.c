@@ -22,8 +22,10 @@
 #include <assert.h>
 #include <math.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include "azimuth/state/room.h"
+#include "azimuth/state/sound.h"
 #include "azimuth/state/uid.h"
 #include "azimuth/state/upgrade.h"
 #include "azimuth/util/misc.h"
@@ -40,26 +42,50 @@ void az_clear_space(az_space_state_t *state) {
   AZ_ZERO_ARRAY(state->gravfields);
   AZ_ZERO_ARRAY(state->nodes);
   AZ_ZERO_ARRAY(state->particles);
+  AZ_ZERO_OBJECT(&state->particle_pool);
   AZ_ZERO_ARRAY(state->pickups);
   AZ_ZERO_ARRAY(state->projectiles);
-  AZ_ZERO_ARRAY(state->specks);
+  AZ_ZERO_OBJECT(&state->projectile_pool);
+  state->specks.count = 0;
+  state->num_homing_targets = 0;
+  state->homing_targets_stale = false;
   AZ_ZERO_ARRAY(state->timers);
   AZ_ZERO_ARRAY(state->walls);
+  AZ_ZERO_OBJECT(&state->wall_grid);
+  AZ_ZERO_OBJECT(&state->nav_grid);
   AZ_ZERO_ARRAY(state->uuids);
+  ++state->wall_generation;
+  AZ_ZERO_ARRAY(state->sight_cache);
+  AZ_ZERO_ARRAY(state->flow_cache);
+  state->next_flow_cache_entry = 0;
 }
 
-static void put_uuid(az_space_state_t *state, int slot,
+// Pointers to the object arrays that get filled in when entering a room, so
+// that we can fill in either an az_space_state_t or an az_room_objects_t.
+typedef struct {
+  az_baddie_t *baddies;
+  az_door_t *doors;
+  az_gravfield_t *gravfields;
+  az_node_t *nodes;
+  az_wall_t *walls;
+  az_wall_grid_t *wall_grid;
+  az_nav_grid_t *nav_grid;
+  az_uuid_t *uuids;
+} room_arrays_t;
+
+static void put_uuid(room_arrays_t arrays, int slot,
                      az_uuid_type_t type, az_uid_t uid) {
   if (slot != 0) {
     assert(slot >= 1);
-    assert(slot <= AZ_ARRAY_SIZE(state->uuids));
-    state->uuids[slot - 1].type = type;
-    state->uuids[slot - 1].uid = uid;
+    assert(slot <= AZ_NUM_UUID_SLOTS);
+    arrays.uuids[slot - 1].type = type;
+    arrays.uuids[slot - 1].uid = uid;
   }
 }
 
-void az_enter_room(az_space_state_t *state, const az_room_t *room) {
-  state->darkness = state->dark_goal = 0.0;
+static void add_room_objects(const az_planet_t *planet,
+                             const az_player_t *player, const az_room_t *room,
+                             room_arrays_t arrays) {
   // Make a map from UUID table indices to the baddie (if any) carrying that
   // object as cargo.
   az_baddie_t *cargo_carriers[AZ_NUM_UUID_SLOTS];
@@ -67,11 +93,18 @@ void az_enter_room(az_space_state_t *state, const az_room_t *room) {
   // Insert objects into space:
   for (int i = 0; i < room->num_baddies; ++i) {
     const az_baddie_spec_t *spec = &room->baddies[i];
-    az_baddie_t *baddie =
-      az_add_baddie(state, spec->kind, spec->position, spec->angle);
+    az_baddie_t *baddie = NULL;
+    for (int j = 0; j < AZ_MAX_NUM_BADDIES; ++j) {
+      if (arrays.baddies[j].kind == AZ_BAD_NOTHING) {
+        baddie = &arrays.baddies[j];
+        az_assign_uid(j, &baddie->uid);
+        az_init_baddie(baddie, spec->kind, spec->position, spec->angle);
+        break;
+      }
+    }
     if (baddie != NULL) {
       baddie->on_kill = spec->on_kill;
-      put_uuid(state, spec->uuid_slot, AZ_UUID_BADDIE, baddie->uid);
+      put_uuid(arrays, spec->uuid_slot, AZ_UUID_BADDIE, baddie->uid);
       AZ_ARRAY_LOOP(slot, spec->cargo_slots) {
         if (*slot == 0) continue;
         const int slot_index = *slot - 1;
@@ -79,15 +112,19 @@ void az_enter_room(az_space_state_t *state, const az_room_t *room) {
         assert(slot_index < AZ_ARRAY_SIZE(cargo_carriers));
         cargo_carriers[slot_index] = baddie;
       }
+    } else {
+      AZ_WARNING_ONCE("Failed to add baddie (kind=%d); array is full.\n",
+                      (int)spec->kind);
     }
   }
   for (int i = 0; i < room->num_doors; ++i) {
     const az_door_spec_t *spec = &room->doors[i];
-    AZ_ARRAY_LOOP(door, state->doors) {
+    for (int j = 0; j < AZ_MAX_NUM_DOORS; ++j) {
+      az_door_t *door = &arrays.doors[j];
       if (door->kind == AZ_DOOR_NOTHING) {
         door->kind = spec->kind;
-        az_assign_uid(door - state->doors, &door->uid);
-        put_uuid(state, spec->uuid_slot, AZ_UUID_DOOR, door->uid);
+        az_assign_uid(j, &door->uid);
+        put_uuid(arrays, spec->uuid_slot, AZ_UUID_DOOR, door->uid);
         door->on_open = spec->on_open;
         door->position = spec->position;
         door->angle = spec->angle;
@@ -97,7 +134,7 @@ void az_enter_room(az_space_state_t *state, const az_room_t *room) {
         door->openness = (door->is_open ? 1.0 : 0.0);
         door->lockedness = (spec->kind == AZ_DOOR_LOCKED ? 1.0 : 0.0);
         const az_room_flags_t dest_flags =
-          state->planet->rooms[spec->destination].properties;
+          planet->rooms[spec->destination].properties;
         if (dest_flags & AZ_ROOMF_WITH_SAVE) {
           door->marker = AZ_DOORMARK_SAVE;
         } else if (dest_flags & AZ_ROOMF_WITH_REFILL) {
@@ -112,11 +149,12 @@ void az_enter_room(az_space_state_t *state, const az_room_t *room) {
   for (int i = 0; i < room->num_gravfields; ++i) {
     const az_gravfield_spec_t *spec = &room->gravfields[i];
     assert(spec->strength == 1.0 || !az_is_liquid(spec->kind));
-    AZ_ARRAY_LOOP(gravfield, state->gravfields) {
+    for (int j = 0; j < AZ_MAX_NUM_GRAVFIELDS; ++j) {
+      az_gravfield_t *gravfield = &arrays.gravfields[j];
       if (gravfield->kind == AZ_GRAV_NOTHING) {
         gravfield->kind = spec->kind;
-        az_assign_uid(gravfield - state->gravfields, &gravfield->uid);
-        put_uuid(state, spec->uuid_slot, AZ_UUID_GRAVFIELD, gravfield->uid);
+        az_assign_uid(j, &gravfield->uid);
+        put_uuid(arrays, spec->uuid_slot, AZ_UUID_GRAVFIELD, gravfield->uid);
         gravfield->on_enter = spec->on_enter;
         gravfield->position = spec->position;
         gravfield->angle = spec->angle;
@@ -131,13 +169,14 @@ void az_enter_room(az_space_state_t *state, const az_room_t *room) {
   for (int i = 0; i < room->num_nodes; ++i) {
     const az_node_spec_t *spec = &room->nodes[i];
     if (spec->kind == AZ_NODE_UPGRADE &&
-        az_has_upgrade(&state->ship.player, spec->subkind.upgrade)) continue;
-    AZ_ARRAY_LOOP(node, state->nodes) {
+        az_has_upgrade(player, spec->subkind.upgrade)) continue;
+    for (int j = 0; j < AZ_MAX_NUM_NODES; ++j) {
+      az_node_t *node = &arrays.nodes[j];
       if (node->kind == AZ_NODE_NOTHING) {
         node->kind = spec->kind;
         node->subkind = spec->subkind;
-        az_assign_uid(node - state->nodes, &node->uid);
-        put_uuid(state, spec->uuid_slot, AZ_UUID_NODE, node->uid);
+        az_assign_uid(j, &node->uid);
+        put_uuid(arrays, spec->uuid_slot, AZ_UUID_NODE, node->uid);
         node->on_use = spec->on_use;
         node->position = spec->position;
         node->angle = spec->angle;
@@ -148,12 +187,13 @@ void az_enter_room(az_space_state_t *state, const az_room_t *room) {
   }
   for (int i = 0; i < room->num_walls; ++i) {
     const az_wall_spec_t *spec = &room->walls[i];
-    AZ_ARRAY_LOOP(wall, state->walls) {
+    for (int j = 0; j < AZ_MAX_NUM_WALLS; ++j) {
+      az_wall_t *wall = &arrays.walls[j];
       if (wall->kind == AZ_WALL_NOTHING) {
         wall->kind = spec->kind;
         wall->data = spec->data;
-        az_assign_uid(wall - state->walls, &wall->uid);
-        put_uuid(state, spec->uuid_slot, AZ_UUID_WALL, wall->uid);
+        az_assign_uid(j, &wall->uid);
+        put_uuid(arrays, spec->uuid_slot, AZ_UUID_WALL, wall->uid);
         wall->position = spec->position;
         wall->angle = spec->angle;
         wall->flare = 0.0;
@@ -161,6 +201,8 @@ void az_enter_room(az_space_state_t *state, const az_room_t *room) {
       }
     }
   }
+  az_build_wall_grid(arrays.wall_grid, arrays.walls);
+  az_build_nav_grid(arrays.nav_grid, arrays.walls, arrays.wall_grid);
   // Now that all objects are inserted and the UUID table is populated, fill in
   // each baddie's cargo table:
   for (int i = 0; i < AZ_ARRAY_SIZE(cargo_carriers); ++i) {
@@ -169,13 +211,57 @@ void az_enter_room(az_space_state_t *state, const az_room_t *room) {
     assert(baddie->kind != AZ_BAD_NOTHING);
     AZ_ARRAY_LOOP(cargo, baddie->cargo_uuids) {
       if (cargo->type == AZ_UUID_NOTHING) {
-        *cargo = state->uuids[i];
+        *cargo = arrays.uuids[i];
         break;
       }
     }
   }
 }
 
+void az_enter_room(az_space_state_t *state, const az_room_t *room) {
+  state->darkness = state->dark_goal = 0.0;
+  add_room_objects(state->planet, &state->ship.player, room, (room_arrays_t){
+      .baddies = state->baddies, .doors = state->doors,
+      .gravfields = state->gravfields, .nodes = state->nodes,
+      .walls = state->walls, .wall_grid = &state->wall_grid,
+      .nav_grid = &state->nav_grid, .uuids = state->uuids });
+  ++state->wall_generation;
+}
+
+void az_build_room_objects(const az_planet_t *planet,
+                           const az_player_t *player, const az_room_t *room,
+                           az_room_objects_t *objects_out) {
+  AZ_ZERO_OBJECT(objects_out);
+  add_room_objects(planet, player, room, (room_arrays_t){
+      .baddies = objects_out->baddies, .doors = objects_out->doors,
+      .gravfields = objects_out->gravfields, .nodes = objects_out->nodes,
+      .walls = objects_out->walls, .wall_grid = &objects_out->wall_grid,
+      .nav_grid = &objects_out->nav_grid, .uuids = objects_out->uuids });
+}
+
+void az_install_room_objects(az_space_state_t *state,
+                             const az_room_objects_t *objects) {
+  state->darkness = state->dark_goal = 0.0;
+  memcpy(state->baddies, objects->baddies, sizeof(state->baddies));
+  memcpy(state->doors, objects->doors, sizeof(state->doors));
+  memcpy(state->gravfields, objects->gravfields, sizeof(state->gravfields));
+  memcpy(state->nodes, objects->nodes, sizeof(state->nodes));
+  memcpy(state->walls, objects->walls, sizeof(state->walls));
+  state->wall_grid = objects->wall_grid;
+  state->nav_grid = objects->nav_grid;
+  memcpy(state->uuids, objects->uuids, sizeof(state->uuids));
+  ++state->wall_generation;
+}
+
+void az_reindex_wall(az_space_state_t *state, const az_wall_t *wall) {
+  assert(wall >= state->walls);
+  assert(wall < state->walls + AZ_ARRAY_SIZE(state->walls));
+  az_update_wall_grid(&state->wall_grid, state->walls, wall - state->walls);
+  az_update_nav_grid(&state->nav_grid, state->walls, &state->wall_grid,
+                     wall - state->walls);
+  ++state->wall_generation;
+}
+
 /*===========================================================================*/
 
 void az_set_message(az_space_state_t *state, const char *paragraph) {
@@ -187,12 +273,19 @@ void az_set_message(az_space_state_t *state, const char *paragraph) {
   };
 }
 
+void az_play_sound_at(az_space_state_t *state, az_sound_key_t sound,
+                      az_vector_t position) {
+  az_play_sound_with_pan(&state->soundboard, sound,
+                         az_camera_pan(&state->camera, position));
+}
+
 az_baddie_t *az_add_baddie(az_space_state_t *state, az_baddie_kind_t kind,
                            az_vector_t position, double angle) {
   AZ_ARRAY_LOOP(baddie, state->baddies) {
     if (baddie->kind == AZ_BAD_NOTHING) {
       az_assign_uid(baddie - state->baddies, &baddie->uid);
       az_init_baddie(baddie, kind, position, angle);
+      state->homing_targets_stale = true;
       return baddie;
     }
   }
@@ -201,17 +294,155 @@ az_baddie_t *az_add_baddie(az_space_state_t *state, az_baddie_kind_t kind,
   return NULL;
 }
 
-bool az_insert_particle(az_space_state_t *state,
-                        az_particle_t **particle_out) {
-  AZ_ARRAY_LOOP(particle, state->particles) {
-    if (particle->kind == AZ_PAR_NOTHING) {
-      particle->age = 0.0;
-      *particle_out = particle;
-      return true;
+AZ_STATIC_ASSERT(AZ_MAX_NUM_PARTICLES <= AZ_MAX_POOL_SIZE);
+AZ_STATIC_ASSERT(AZ_MAX_NUM_PROJECTILES <= AZ_MAX_POOL_SIZE);
+
+static bool particle_is_vacant(const void *particles, int slot) {
+  return ((const az_particle_t *)particles)[slot].kind == AZ_PAR_NOTHING;
+}
+
+static bool projectile_is_vacant(const void *projectiles, int slot) {
+  return ((const az_projectile_t *)projectiles)[slot].kind == AZ_PROJ_NOTHING;
+}
+
+void az_collect_space_pools(az_space_state_t *state) {
+  az_pool_collect(&state->particle_pool, particle_is_vacant,
+                  state->particles);
+  az_pool_collect(&state->projectile_pool, projectile_is_vacant,
+                  state->projectiles);
+}
+
+void az_build_homing_targets(az_space_state_t *state) {
+  int num_targets = 0;
+  AZ_ARRAY_LOOP(baddie, state->baddies) {
+    if (baddie->kind == AZ_BAD_NOTHING) continue;
+    const az_baddie_flags_t flags = AZ_BADF_NO_HOMING &
+      (baddie->data->static_properties | baddie->temp_properties);
+    if (flags == AZ_BADF_NO_HOMING) continue;
+    az_homing_target_t *target = &state->homing_targets[num_targets++];
+    target->uid = baddie->uid;
+    target->position = baddie->position;
+  }
+  state->num_homing_targets = num_targets;
+  state->homing_targets_stale = false;
+}
+
+bool az_homing_target_is_alive(const az_space_state_t *state,
+                               const az_homing_target_t *target,
+                               az_baddie_flags_t ignore_flag) {
+  const int index = az_uid_index(target->uid);
+  assert(0 <= index && index < AZ_ARRAY_SIZE(state->baddies));
+  const az_baddie_t *baddie = &state->baddies[index];
+  return (baddie->kind != AZ_BAD_NOTHING && baddie->uid == target->uid &&
+          !az_baddie_has_flag(baddie, ignore_flag));
+}
+
+// Homing scores whose lower bounds exceed the best known score by less than
+// this are computed exactly anyway, to guard against rounding error:
+#define HOMING_SCORE_MARGIN 1e-6
+
+// Return how much a homing projectile at the given position and angle wants
+// to target the given position (lower is better).
+static double homing_score(az_vector_t position, double angle,
+                           az_vector_t target_position) {
+  return az_vdist(target_position, position) +
+    fabs(az_mod2pi(az_vtheta(az_vsub(target_position, position)) - angle)) *
+    100.0;
+}
+
+bool az_find_homing_target(az_space_state_t *state, az_vector_t position,
+                           double angle, az_uid_t ignore_uid,
+                           az_baddie_flags_t ignore_flag,
+                           az_vector_t *target_position_out) {
+  // Since an angle (in radians) is never less than one minus its cosine, we
+  // can get a lower bound on each target's score from a dot product.  The
+  // exact score of the target with the lowest bound is an upper bound on the
+  // best score, and we then only need exact scores (which each need an
+  // atan2) for targets whose lower bounds don't exceed that.
+  if (state->homing_targets_stale) az_build_homing_targets(state);
+  double bounds[AZ_MAX_NUM_BADDIES];
+  const az_vector_t heading = az_vpolar(1, angle);
+  int seed = -1;
+  for (int i = 0; i < state->num_homing_targets; ++i) {
+    const az_homing_target_t *target = &state->homing_targets[i];
+    bounds[i] = INFINITY;
+    if (target->uid == ignore_uid) continue;
+    if (!az_homing_target_is_alive(state, target, ignore_flag)) continue;
+    const az_vector_t delta = az_vsub(target->position, position);
+    const double dist = az_vnorm(delta);
+    bounds[i] = dist;
+    if (dist > 0.0) {
+      bounds[i] += (1.0 - az_vdot(delta, heading) / dist) * 100.0;
+    }
+    if (seed < 0 || bounds[i] < bounds[seed]) seed = i;
+  }
+  if (seed < 0) return false;
+  const double cutoff = homing_score(
+      position, angle, state->homing_targets[seed].position) +
+    HOMING_SCORE_MARGIN;
+  double best_score = INFINITY;
+  bool found_target = false;
+  for (int i = 0; i < state->num_homing_targets; ++i) {
+    if (!(bounds[i] <= cutoff)) continue;
+    const az_vector_t target_position = state->homing_targets[i].position;
+    const double score = homing_score(position, angle, target_position);
+    if (score < best_score) {
+      best_score = score;
+      found_target = true;
+      *target_position_out = target_position;
     }
   }
-  AZ_WARNING_ONCE("Failed to insert particle; array is full.\n");
-  return false;
+  return found_target;
+}
+
+// When the cosine of a target's angle off forward is within this of the
+// cosine of the auto-aim limit, compare the angles exactly instead:
+#define AUTO_AIM_COSINE_MARGIN 1e-9
+
+bool az_find_auto_aim_target(az_space_state_t *state, az_vector_t start,
+                             double forward, double limit,
+                             az_baddie_flags_t ignore_flag,
+                             az_vector_t *delta_out) {
+  if (state->homing_targets_stale) az_build_homing_targets(state);
+  const az_vector_t heading = az_vpolar(1, forward);
+  const double cos_limit = cos(limit);
+  double best_dist = INFINITY;
+  bool found_target = false;
+  for (int i = 0; i < state->num_homing_targets; ++i) {
+    const az_homing_target_t *target = &state->homing_targets[i];
+    if (!az_homing_target_is_alive(state, target, ignore_flag)) continue;
+    const az_vector_t delta = az_vsub(target->position, start);
+    const double dist = az_vnorm(delta);
+    if (dist >= best_dist) continue;
+    // Compare the cosine of the angle off forward against that of the limit,
+    // unless they are too close to call, in which case use the angle itself.
+    const double cosine = (dist > 0.0 ? az_vdot(delta, heading) / dist : 0.0);
+    const bool within_limit =
+      (dist > 0.0 && fabs(cosine - cos_limit) > AUTO_AIM_COSINE_MARGIN ?
+       cosine > cos_limit :
+       fabs(az_mod2pi(az_vtheta(delta) - forward)) <= limit);
+    if (within_limit) {
+      best_dist = dist;
+      found_target = true;
+      *delta_out = delta;
+    }
+  }
+  return found_target;
+}
+
+bool az_insert_particle(az_space_state_t *state,
+                        az_particle_t **particle_out) {
+  const int slot = az_pool_insert(&state->particle_pool,
+                                  AZ_ARRAY_SIZE(state->particles),
+                                  particle_is_vacant, state->particles);
+  if (slot < 0) {
+    AZ_WARNING_ONCE("Failed to insert particle; array is full.\n");
+    return false;
+  }
+  az_particle_t *particle = &state->particles[slot];
+  particle->age = 0.0;
+  *particle_out = particle;
+  return true;
 }
 
 void az_add_beam(az_space_state_t *state, az_color_t color, az_vector_t start,
@@ -232,18 +463,17 @@ void az_add_beam(az_space_state_t *state, az_color_t color, az_vector_t start,
 
 void az_add_speck(az_space_state_t *state, az_color_t color, double lifetime,
                   az_vector_t position, az_vector_t velocity) {
-  AZ_ARRAY_LOOP(speck, state->specks) {
-    if (speck->kind == AZ_SPECK_NOTHING) {
-      speck->kind = AZ_SPECK_NORMAL;
-      speck->color = color;
-      speck->position = position;
-      speck->velocity = velocity;
-      speck->age = 0.0;
-      speck->lifetime = lifetime;
-      return;
-    }
+  az_speck_array_t *specks = &state->specks;
+  if (specks->count >= AZ_MAX_NUM_SPECKS) {
+    AZ_WARNING_ONCE("Failed to add speck; array is full.\n");
+    return;
   }
-  AZ_WARNING_ONCE("Failed to add speck; array is full.\n");
+  const int index = specks->count++;
+  specks->color[index] = color;
+  specks->position[index] = position;
+  specks->velocity[index] = velocity;
+  specks->age[index] = 0.0;
+  specks->lifetime[index] = lifetime;
 }
 
 void az_add_sploosh(az_space_state_t *state, const az_gravfield_t *gravfield,
@@ -276,15 +506,17 @@ void az_add_sploosh(az_space_state_t *state, const az_gravfield_t *gravfield,
 az_projectile_t *az_add_projectile(
     az_space_state_t *state, az_proj_kind_t kind, az_vector_t position,
     double angle, double power, az_uid_t fired_by) {
-  AZ_ARRAY_LOOP(proj, state->projectiles) {
-    if (proj->kind == AZ_PROJ_NOTHING) {
-      az_init_projectile(proj, kind, position, angle, power, fired_by);
-      return proj;
-    }
-  }
-  AZ_WARNING_ONCE("Failed to add projectile (kind=%d); array is full.\n",
-                  (int)kind);
-  return NULL;
+  const int slot = az_pool_insert(&state->projectile_pool,
+                                  AZ_ARRAY_SIZE(state->projectiles),
+                                  projectile_is_vacant, state->projectiles);
+  if (slot < 0) {
+    AZ_WARNING_ONCE("Failed to add projectile (kind=%d); array is full.\n",
+                    (int)kind);
+    return NULL;
+  }
+  az_projectile_t *proj = &state->projectiles[slot];
+  az_init_projectile(proj, kind, position, angle, power, fired_by);
+  return proj;
 }
 
 az_pickup_t *az_add_random_pickup(az_space_state_t *state,
@@ -400,7 +632,11 @@ void az_ray_impact(az_space_state_t *state, az_vector_t start,
 
   // Walls:
   if (!(skip_types & AZ_IMPF_WALL)) {
-    AZ_ARRAY_LOOP(wall, state->walls) {
+    az_wall_set_t candidates;
+    az_wall_grid_sweep(&state->wall_grid, 0.0, start, delta, &candidates);
+    for (int i = az_wall_set_next(&candidates, 0); i >= 0;
+         i = az_wall_set_next(&candidates, i + 1)) {
+      az_wall_t *wall = &state->walls[i];
       if (wall->kind == AZ_WALL_NOTHING) continue;
       if (az_ray_hits_wall(wall, start, delta, position, normal)) {
         impact_out->type = AZ_IMP_WALL;
@@ -486,7 +722,11 @@ void az_circle_impact(az_space_state_t *state, double radius,
 
   // Walls:
   if (!(skip_types & AZ_IMPF_WALL)) {
-    AZ_ARRAY_LOOP(wall, state->walls) {
+    az_wall_set_t candidates;
+    az_wall_grid_sweep(&state->wall_grid, radius, start, delta, &candidates);
+    for (int i = az_wall_set_next(&candidates, 0); i >= 0;
+         i = az_wall_set_next(&candidates, i + 1)) {
+      az_wall_t *wall = &state->walls[i];
       if (wall->kind == AZ_WALL_NOTHING) continue;
       if (az_circle_hits_wall(wall, radius, start, delta,
                               position_out, normal_out)) {
@@ -577,7 +817,12 @@ void az_arc_circle_impact(
 
   // Walls:
   if (!(skip_types & AZ_IMPF_WALL)) {
-    AZ_ARRAY_LOOP(wall, state->walls) {
+    az_wall_set_t candidates;
+    az_wall_grid_arc_sweep(&state->wall_grid, circle_radius, start,
+                           spin_center, spin_angle, &candidates);
+    for (int i = az_wall_set_next(&candidates, 0); i >= 0;
+         i = az_wall_set_next(&candidates, i + 1)) {
+      az_wall_t *wall = &state->walls[i];
       if (wall->kind == AZ_WALL_NOTHING) continue;
       if (az_arc_circle_hits_wall(
               wall, circle_radius, start, spin_center, spin_angle,
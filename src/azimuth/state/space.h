@@ -30,19 +30,23 @@
 #include "azimuth/state/dialog.h"
 #include "azimuth/state/door.h"
 #include "azimuth/state/gravfield.h"
+#include "azimuth/state/nav_grid.h"
 #include "azimuth/state/node.h"
 #include "azimuth/state/particle.h"
 #include "azimuth/state/pickup.h"
 #include "azimuth/state/planet.h"
 #include "azimuth/state/player.h"
+#include "azimuth/state/pool.h"
 #include "azimuth/state/projectile.h"
 #include "azimuth/state/room.h"
 #include "azimuth/state/script.h"
 #include "azimuth/state/ship.h"
+#include "azimuth/state/sound.h"
 #include "azimuth/state/speck.h"
 #include "azimuth/state/uid.h"
 #include "azimuth/state/upgrade.h"
 #include "azimuth/state/wall.h"
+#include "azimuth/state/wall_grid.h"
 #include "azimuth/util/audio.h"
 #include "azimuth/util/clock.h"
 #include "azimuth/util/prefs.h"
@@ -50,6 +54,9 @@
 
 /*===========================================================================*/
 
+#define AZ_MAX_NUM_PARTICLES 1000
+#define AZ_MAX_NUM_PROJECTILES 250
+
 typedef struct {
   double time_remaining; // seconds
   const char *paragraph;
@@ -124,9 +131,65 @@ typedef struct {
 
 /*===========================================================================*/
 
+// A memoized line-of-sight query from a baddie to the ship (see
+// az_can_see_ship in azimuth/tick/baddie_util.h).  Only the walls are cached,
+// since they are by far the most expensive part of the query.
+typedef struct {
+  az_uid_t baddie_uid; // AZ_NULL_UID if the entry is unused
+  unsigned int wall_generation; // state->wall_generation when computed
+  az_vector_t baddie_position, ship_position; // positions when computed
+  // How far from the baddie the ray towards the ship hits a wall, or INFINITY
+  // if it reaches the ship's position without hitting one:
+  double wall_dist;
+} az_sight_cache_entry_t;
+
+// A baddie that homing weapons might target, as recorded by
+// az_build_homing_targets.  Homing weapons search this list rather than the
+// whole baddies array, and use the cached position for cheap distance and
+// direction checks before doing any trigonometry.
+typedef struct {
+  az_uid_t uid;
+  az_vector_t position;
+} az_homing_target_t;
+
+// How many flow fields the space state caches at once:
+#define AZ_FLOW_CACHE_SIZE 4
+
+// A cached flow field towards some goal (see az_navigate_towards in
+// azimuth/tick/baddie_util.h).
+typedef struct {
+  bool valid;
+  unsigned int wall_generation; // state->wall_generation when built
+  az_flow_field_t field;
+} az_flow_cache_entry_t;
+
+/*===========================================================================*/
+
+// The objects that entering a room adds to an empty space state.  These can
+// be built separately from the space state (by az_build_room_objects, perhaps
+// on another thread), and then installed into it all at once.
+typedef struct {
+  az_baddie_t baddies[AZ_MAX_NUM_BADDIES];
+  az_door_t doors[AZ_MAX_NUM_DOORS];
+  az_gravfield_t gravfields[AZ_MAX_NUM_GRAVFIELDS];
+  az_node_t nodes[AZ_MAX_NUM_NODES];
+  az_wall_t walls[AZ_MAX_NUM_WALLS];
+  az_wall_grid_t wall_grid;
+  az_nav_grid_t nav_grid;
+  az_uuid_t uuids[AZ_NUM_UUID_SLOTS];
+} az_room_objects_t;
+
+// See azimuth/state/room_builder.h.
+typedef struct az_room_builder az_room_builder_t;
+
+/*===========================================================================*/
+
 typedef struct {
   const az_planet_t *planet;
   const az_preferences_t *prefs;
+  // If non-NULL, this is used to build the next room's objects in the
+  // background before we go through a door.  The space state doesn't own it.
+  az_room_builder_t *room_builder;
   int save_file_index;
   az_clock_t clock;
   az_camera_t camera;
@@ -170,13 +233,31 @@ typedef struct {
   az_door_t doors[AZ_MAX_NUM_DOORS];
   az_gravfield_t gravfields[AZ_MAX_NUM_GRAVFIELDS];
   az_node_t nodes[AZ_MAX_NUM_NODES];
-  az_particle_t particles[500];
+  az_particle_t particles[AZ_MAX_NUM_PARTICLES];
+  az_pool_t particle_pool; // tracks which particles slots are in use
   az_pickup_t pickups[100];
-  az_projectile_t projectiles[250];
-  az_speck_t specks[750];
+  az_projectile_t projectiles[AZ_MAX_NUM_PROJECTILES];
+  az_pool_t projectile_pool; // tracks which projectiles slots are in use
+  az_speck_array_t specks;
   az_timer_t timers[20];
   az_wall_t walls[AZ_MAX_NUM_WALLS];
+  az_wall_grid_t wall_grid; // broad-phase index over the walls array
+  az_nav_grid_t nav_grid; // which parts of the room are blocked by walls
   az_uuid_t uuids[AZ_NUM_UUID_SLOTS];
+  // This is incremented whenever walls are added, moved, or removed, so that
+  // cached queries against the walls can tell when they are out of date:
+  unsigned int wall_generation;
+  // Line-of-sight cache, indexed the same way as the baddies array:
+  az_sight_cache_entry_t sight_cache[AZ_MAX_NUM_BADDIES];
+  // Flow fields for baddie navigation, replaced round-robin:
+  az_flow_cache_entry_t flow_cache[AZ_FLOW_CACHE_SIZE];
+  int next_flow_cache_entry;
+  // Baddies that homing weapons might target (see az_build_homing_targets):
+  az_homing_target_t homing_targets[AZ_MAX_NUM_BADDIES];
+  int num_homing_targets;
+  // Set when a baddie is added or changes kind, so that homing weapons know
+  // to rebuild the list before using it:
+  bool homing_targets_stale;
 } az_space_state_t;
 
 /*===========================================================================*/
@@ -190,11 +271,81 @@ void az_clear_space(az_space_state_t *state);
 // any changes to the ship or any other fields.
 void az_enter_room(az_space_state_t *state, const az_room_t *room);
 
+// Build the objects that az_enter_room would add to an empty space state for
+// the given room and player.  This only reads from its arguments (and from
+// the planet's room headers), so it is safe to call from a thread other than
+// the one that owns the space state.
+void az_build_room_objects(const az_planet_t *planet,
+                           const az_player_t *player, const az_room_t *room,
+                           az_room_objects_t *objects_out);
+
+// Copy the given room objects into the space state.  Calling this just after
+// az_clear_space is equivalent to calling az_enter_room with the room and
+// player that the objects were built for.
+void az_install_room_objects(az_space_state_t *state,
+                             const az_room_objects_t *objects);
+
+// Update the wall and navigation grids for a wall that has just been moved or
+// removed.  This must be called whenever a wall's position, angle, or kind
+// changes (other than within az_clear_space or az_enter_room, which take care
+// of this themselves), so that impact queries continue to find the wall and
+// cached queries know to recompute.
+void az_reindex_wall(az_space_state_t *state, const az_wall_t *wall);
+
+// Remove emptied slots from the live lists of the particle and projectile
+// pools.  This should be called once per frame, outside of any loop over
+// those objects.
+void az_collect_space_pools(az_space_state_t *state);
+
+// Rebuild the homing target list from the baddies array, recording every
+// baddie that isn't ignored by all homing weapons.  This should be called
+// before each batch of homing queries during which the baddies don't move
+// (e.g. at the start of ticking projectiles), and again whenever
+// homing_targets_stale gets set.  Baddies killed, or given a NO_HOMING flag,
+// in the meantime are detected by az_homing_target_is_alive.  A baddie that
+// had every NO_HOMING flag when the list was built stays untargetable until
+// the next rebuild, even if it loses one of them.
+void az_build_homing_targets(az_space_state_t *state);
+
+// Return true if the baddie recorded by the given homing target still exists
+// and doesn't currently have the given flag.  The flag is checked against the
+// baddie itself rather than the list, since its flags can change in between.
+bool az_homing_target_is_alive(const az_space_state_t *state,
+                               const az_homing_target_t *target,
+                               az_baddie_flags_t ignore_flag);
+
+// Find the baddie that a homing projectile at the given position and angle
+// should home in on, skipping the baddie with the given uid and any baddies
+// with the given flag.  The best target is the one minimizing its distance
+// plus 100 times its angle (in radians) off the projectile's heading.  If
+// there is one, store its position in *target_position_out and return true;
+// otherwise return false.  This uses the homing target list, rebuilding it
+// first if it is stale.
+bool az_find_homing_target(az_space_state_t *state, az_vector_t position,
+                           double angle, az_uid_t ignore_uid,
+                           az_baddie_flags_t ignore_flag,
+                           az_vector_t *target_position_out);
+
+// Find the nearest baddie without the given flag that is within limit
+// radians of the forward angle, as seen from start.  If there is one, store
+// the vector from start to it in *delta_out and return true; otherwise return
+// false.  This uses the homing target list, rebuilding it first if it is
+// stale.
+bool az_find_auto_aim_target(az_space_state_t *state, az_vector_t start,
+                             double forward, double limit,
+                             az_baddie_flags_t ignore_flag,
+                             az_vector_t *delta_out);
+
 // Set the current message (displayed at the bottom of the screen) to the given
 // paragraph.  This will automatically intialize the various fields of
 // state->message appropriately.
 void az_set_message(az_space_state_t *state, const char *paragraph);
 
+// Play the given sound (once), panned according to where the given position
+// (e.g. of the object making the sound) is relative to the camera.
+void az_play_sound_at(az_space_state_t *state, az_sound_key_t sound,
+                      az_vector_t position);
+
 // Add and init a new baddie and return a pointer to it, or return NULL if the
 // baddie array is already full.
 az_baddie_t *az_add_baddie(az_space_state_t *state, az_baddie_kind_t kind,
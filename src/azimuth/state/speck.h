@@ -41,4 +41,21 @@ typedef struct {
 
 /*===========================================================================*/
 
+#define AZ_MAX_NUM_SPECKS 3000
+
+// The specks in space are stored in structure-of-arrays form rather than as
+// an array of az_speck_t, so that they can be moved and aged in bulk.  The
+// arrays are kept dense: specks 0 through count-1 are all present, and
+// expired specks are compacted out when the array is ticked.
+typedef struct {
+  int count; // number of specks present
+  az_color_t color[AZ_MAX_NUM_SPECKS];
+  az_vector_t position[AZ_MAX_NUM_SPECKS];
+  az_vector_t velocity[AZ_MAX_NUM_SPECKS];
+  double age[AZ_MAX_NUM_SPECKS]; // seconds
+  double lifetime[AZ_MAX_NUM_SPECKS]; // seconds
+} az_speck_array_t;
+
+/*===========================================================================*/
+
 #endif // AZIMUTH_STATE_SPECK_H_
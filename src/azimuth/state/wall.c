@@ -1581,6 +1581,7 @@ void az_init_wall_datas(void) {
       radius = fmax(radius, az_vnorm(polygon.vertices[i]));
     }
     data->bounding_radius = radius + 0.01; // small safety margin
+    az_compile_polygon(&data->polygon);
   }
   wall_data_initialized = true;
 }
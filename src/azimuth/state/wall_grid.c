@@ -0,0 +1,282 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#include "azimuth/state/wall_grid.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "azimuth/state/room.h"
+#include "azimuth/state/wall.h"
+#include "azimuth/util/misc.h"
+#include "azimuth/util/vector.h"
+
+/*===========================================================================*/
+
+int az_wall_set_next(const az_wall_set_t *set, int start) {
+  assert(start >= 0);
+  int word = start / 64;
+  if (word >= AZ_ARRAY_SIZE(set->bits)) return -1;
+  uint64_t bits = set->bits[word] & (~UINT64_C(0) << (start % 64));
+  while (bits == 0) {
+    if (++word >= AZ_ARRAY_SIZE(set->bits)) return -1;
+    bits = set->bits[word];
+  }
+  return word * 64 + __builtin_ctzll(bits);
+}
+
+/*===========================================================================*/
+
+// Return the index of the row/column containing the given offset from the
+// grid's min corner, clamped to the grid.
+static int cell_index(double offset, double cell_size, int num_cells) {
+  const double cell = floor(offset / cell_size);
+  return (cell < 0.0 ? 0 : cell >= num_cells ? num_cells - 1 : (int)cell);
+}
+
+void az_layout_grid_for_walls(const az_wall_t *walls, int max_cells,
+                              double min_cell_size,
+                              az_grid_layout_t *layout_out) {
+  AZ_ZERO_OBJECT(layout_out);
+  // Find the bounding box of all walls present.
+  bool any_walls = false;
+  double xlo = 0, xhi = 0, ylo = 0, yhi = 0;
+  for (int i = 0; i < AZ_MAX_NUM_WALLS; ++i) {
+    const az_wall_t *wall = &walls[i];
+    if (wall->kind == AZ_WALL_NOTHING) continue;
+    const double radius = wall->data->bounding_radius;
+    if (!any_walls) {
+      any_walls = true;
+      xlo = xhi = wall->position.x;
+      ylo = yhi = wall->position.y;
+    }
+    xlo = fmin(xlo, wall->position.x - radius);
+    xhi = fmax(xhi, wall->position.x + radius);
+    ylo = fmin(ylo, wall->position.y - radius);
+    yhi = fmax(yhi, wall->position.y + radius);
+  }
+  if (!any_walls) return;
+  // Choose a cell size that fits the bounding box into the grid.
+  const double width = xhi - xlo, height = yhi - ylo;
+  layout_out->min_corner = (az_vector_t){xlo, ylo};
+  layout_out->cell_size =
+    fmax(min_cell_size, fmax(width, height) / max_cells);
+  layout_out->num_cols =
+    az_imax(1, az_imin(max_cells, (int)ceil(width / layout_out->cell_size)));
+  layout_out->num_rows =
+    az_imax(1, az_imin(max_cells, (int)ceil(height / layout_out->cell_size)));
+}
+
+int az_grid_col(const az_grid_layout_t *layout, double x) {
+  assert(layout->num_cols > 0);
+  return cell_index(x - layout->min_corner.x, layout->cell_size,
+                    layout->num_cols);
+}
+
+int az_grid_row(const az_grid_layout_t *layout, double y) {
+  assert(layout->num_rows > 0);
+  return cell_index(y - layout->min_corner.y, layout->cell_size,
+                    layout->num_rows);
+}
+
+bool az_grid_covers_wall(const az_grid_layout_t *layout,
+                         const az_wall_t *wall) {
+  const double radius = wall->data->bounding_radius;
+  return (layout->num_cols > 0 &&
+          wall->position.x - radius >= layout->min_corner.x &&
+          wall->position.x + radius <=
+          layout->min_corner.x + layout->num_cols * layout->cell_size &&
+          wall->position.y - radius >= layout->min_corner.y &&
+          wall->position.y + radius <=
+          layout->min_corner.y + layout->num_rows * layout->cell_size);
+}
+
+void az_grid_wall_cells(const az_grid_layout_t *layout, const az_wall_t *wall,
+                        az_grid_cell_range_t *range_out) {
+  assert(wall->kind != AZ_WALL_NOTHING);
+  const double radius = wall->data->bounding_radius;
+  range_out->present = true;
+  range_out->min_col = az_grid_col(layout, wall->position.x - radius);
+  range_out->max_col = az_grid_col(layout, wall->position.x + radius);
+  range_out->min_row = az_grid_row(layout, wall->position.y - radius);
+  range_out->max_row = az_grid_row(layout, wall->position.y + radius);
+}
+
+/*===========================================================================*/
+
+// Cells are never smaller than this, so that small rooms don't get chopped up
+// into cells much smaller than a typical wall.
+#define MIN_CELL_SIZE 32.0
+
+// Query shapes are padded by this much, to guard against rounding error.
+#define QUERY_MARGIN 0.01
+
+static void insert_wall(az_wall_grid_t *grid, const az_wall_t *wall,
+                        int index) {
+  assert(!grid->wall_cells[index].present);
+  az_grid_cell_range_t *range = &grid->wall_cells[index];
+  az_grid_wall_cells(&grid->layout, wall, range);
+  const uint64_t bit = UINT64_C(1) << (index % 64);
+  for (int row = range->min_row; row <= range->max_row; ++row) {
+    for (int col = range->min_col; col <= range->max_col; ++col) {
+      grid->cells[row][col].bits[index / 64] |= bit;
+    }
+  }
+}
+
+static void remove_wall(az_wall_grid_t *grid, int index) {
+  if (!grid->wall_cells[index].present) return;
+  const uint64_t bit = UINT64_C(1) << (index % 64);
+  for (int row = grid->wall_cells[index].min_row;
+       row <= grid->wall_cells[index].max_row; ++row) {
+    for (int col = grid->wall_cells[index].min_col;
+         col <= grid->wall_cells[index].max_col; ++col) {
+      grid->cells[row][col].bits[index / 64] &= ~bit;
+    }
+  }
+  grid->wall_cells[index].present = false;
+}
+
+void az_build_wall_grid(az_wall_grid_t *grid, const az_wall_t *walls) {
+  AZ_ZERO_OBJECT(grid);
+  az_layout_grid_for_walls(walls, AZ_WALL_GRID_MAX_CELLS, MIN_CELL_SIZE,
+                           &grid->layout);
+  for (int i = 0; i < AZ_MAX_NUM_WALLS; ++i) {
+    if (walls[i].kind == AZ_WALL_NOTHING) continue;
+    insert_wall(grid, &walls[i], i);
+  }
+}
+
+void az_update_wall_grid(az_wall_grid_t *grid, const az_wall_t *walls,
+                         int index) {
+  assert(index >= 0);
+  assert(index < AZ_MAX_NUM_WALLS);
+  remove_wall(grid, index);
+  const az_wall_t *wall = &walls[index];
+  if (wall->kind == AZ_WALL_NOTHING) return;
+  if (az_grid_covers_wall(&grid->layout, wall)) {
+    insert_wall(grid, wall, index);
+  } else az_build_wall_grid(grid, walls);
+}
+
+/*===========================================================================*/
+
+static void union_cells_in_row(const az_wall_grid_t *grid, int row,
+                               double xlo, double xhi,
+                               az_wall_set_t *set_out) {
+  const az_grid_layout_t *layout = &grid->layout;
+  if (xhi < layout->min_corner.x ||
+      xlo > layout->min_corner.x + layout->num_cols * layout->cell_size) {
+    return;
+  }
+  const int min_col = az_grid_col(layout, xlo);
+  const int max_col = az_grid_col(layout, xhi);
+  for (int col = min_col; col <= max_col; ++col) {
+    const az_wall_set_t *cell = &grid->cells[row][col];
+    for (int i = 0; i < AZ_ARRAY_SIZE(set_out->bits); ++i) {
+      set_out->bits[i] |= cell->bits[i];
+    }
+  }
+}
+
+// Determine the range of grid rows overlapping [ylo, yhi].  Returns false if
+// the range lies entirely outside the grid.
+static bool row_range(const az_wall_grid_t *grid, double ylo, double yhi,
+                      int *min_row_out, int *max_row_out) {
+  const az_grid_layout_t *layout = &grid->layout;
+  if (layout->num_rows == 0 || yhi < layout->min_corner.y ||
+      ylo > layout->min_corner.y + layout->num_rows * layout->cell_size) {
+    return false;
+  }
+  *min_row_out = az_grid_row(layout, ylo);
+  *max_row_out = az_grid_row(layout, yhi);
+  return true;
+}
+
+void az_wall_grid_sweep(const az_wall_grid_t *grid, double radius,
+                        az_vector_t start, az_vector_t delta,
+                        az_wall_set_t *set_out) {
+  assert(radius >= 0.0);
+  AZ_ZERO_OBJECT(set_out);
+  const double margin = radius + QUERY_MARGIN;
+  const az_vector_t end = az_vadd(start, delta);
+  int min_row, max_row;
+  if (!row_range(grid, fmin(start.y, end.y) - margin,
+                 fmax(start.y, end.y) + margin, &min_row, &max_row)) return;
+  for (int row = min_row; row <= max_row; ++row) {
+    // Find the portion of the path along which the circle overlaps this row,
+    // and from that, which columns of the row the circle passes through.
+    double t0 = 0.0, t1 = 1.0;
+    if (delta.y != 0.0) {
+      const double row_lo =
+        grid->layout.min_corner.y + row * grid->layout.cell_size - margin;
+      const double row_hi = row_lo + grid->layout.cell_size + 2.0 * margin;
+      const double ta = (row_lo - start.y) / delta.y;
+      const double tb = (row_hi - start.y) / delta.y;
+      t0 = fmax(0.0, fmin(ta, tb));
+      t1 = fmin(1.0, fmax(ta, tb));
+      if (t0 > t1) continue;
+    }
+    const double x0 = start.x + t0 * delta.x;
+    const double x1 = start.x + t1 * delta.x;
+    union_cells_in_row(grid, row, fmin(x0, x1) - margin,
+                       fmax(x0, x1) + margin, set_out);
+  }
+}
+
+void az_wall_grid_arc_sweep(const az_wall_grid_t *grid, double radius,
+                            az_vector_t start, az_vector_t spin_center,
+                            double spin_angle, az_wall_set_t *set_out) {
+  assert(radius >= 0.0);
+  AZ_ZERO_OBJECT(set_out);
+  // Find the bounding box of the arc, which is determined by its endpoints
+  // plus any of the four axis-aligned extreme points that the arc sweeps past.
+  const az_vector_t rel = az_vsub(start, spin_center);
+  const az_vector_t end = az_vadd(spin_center, az_vrotate(rel, spin_angle));
+  double xlo = fmin(start.x, end.x), xhi = fmax(start.x, end.x);
+  double ylo = fmin(start.y, end.y), yhi = fmax(start.y, end.y);
+  const double arc_radius = az_vnorm(rel);
+  const double span = fabs(spin_angle);
+  const double theta0 =
+    az_vtheta(rel) + (spin_angle < 0.0 ? spin_angle : 0.0);
+  for (int i = 0; i < 4; ++i) {
+    const double axis_theta = i * AZ_HALF_PI;
+    if (span < AZ_TWO_PI && az_mod2pi_nonneg(axis_theta - theta0) > span) {
+      continue;
+    }
+    const az_vector_t extreme =
+      az_vadd(spin_center, az_vpolar(arc_radius, axis_theta));
+    xlo = fmin(xlo, extreme.x);
+    xhi = fmax(xhi, extreme.x);
+    ylo = fmin(ylo, extreme.y);
+    yhi = fmax(yhi, extreme.y);
+  }
+  const double margin = radius + QUERY_MARGIN;
+  int min_row, max_row;
+  if (!row_range(grid, ylo - margin, yhi + margin, &min_row, &max_row)) {
+    return;
+  }
+  for (int row = min_row; row <= max_row; ++row) {
+    union_cells_in_row(grid, row, xlo - margin, xhi + margin, set_out);
+  }
+}
+
+/*===========================================================================*/
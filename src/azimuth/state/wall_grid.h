@@ -0,0 +1,131 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#pragma once
+#ifndef AZIMUTH_STATE_WALL_GRID_H_
+#define AZIMUTH_STATE_WALL_GRID_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "azimuth/state/room.h"
+#include "azimuth/state/wall.h"
+#include "azimuth/util/vector.h"
+
+/*===========================================================================*/
+
+// A set of wall indices (that is, indices into the walls array of
+// az_space_state_t), stored as a bitset.
+typedef struct {
+  uint64_t bits[(AZ_MAX_NUM_WALLS + 63) / 64];
+} az_wall_set_t;
+
+// Return the smallest wall index in the set that is greater than or equal to
+// start, or -1 if there is no such index.  Thus, to loop over a set in
+// ascending order:
+//   for (int i = az_wall_set_next(&set, 0); i >= 0;
+//        i = az_wall_set_next(&set, i + 1)) { ... }
+int az_wall_set_next(const az_wall_set_t *set, int start);
+
+/*===========================================================================*/
+
+// The layout of a uniform grid of square cells covering a rectangular part of
+// a room.  Wall grids (below) and navigation grids (see nav_grid.h) both use
+// this.
+typedef struct {
+  az_vector_t min_corner;
+  double cell_size;
+  int num_cols, num_rows; // if zero, the grid is empty
+} az_grid_layout_t;
+
+// A range of cells within a grid layout, used to record which cells a wall
+// covers.
+typedef struct {
+  bool present;
+  int8_t min_col, min_row, max_col, max_row;
+} az_grid_cell_range_t;
+
+// Lay out a grid covering the bounding circles of all walls present in the
+// given array (which must have AZ_MAX_NUM_WALLS elements), with at most
+// max_cells rows and columns, and with cells no smaller than min_cell_size.
+// If there are no walls, the layout is empty.
+void az_layout_grid_for_walls(const az_wall_t *walls, int max_cells,
+                              double min_cell_size,
+                              az_grid_layout_t *layout_out);
+
+// Return the index of the column/row containing the given x/y coordinate,
+// clamped to the grid (which must not be empty).
+int az_grid_col(const az_grid_layout_t *layout, double x);
+int az_grid_row(const az_grid_layout_t *layout, double y);
+
+// Return true if the grid isn't empty and the wall's bounding circle lies
+// entirely within it.
+bool az_grid_covers_wall(const az_grid_layout_t *layout,
+                         const az_wall_t *wall);
+
+// Store in *range_out the range of cells that the wall's bounding circle
+// overlaps, clamped to the grid (which must not be empty), and mark the range
+// as present.
+void az_grid_wall_cells(const az_grid_layout_t *layout, const az_wall_t *wall,
+                        az_grid_cell_range_t *range_out);
+
+/*===========================================================================*/
+
+// The maximum number of rows/columns in a wall grid.
+#define AZ_WALL_GRID_MAX_CELLS 32
+
+// A wall grid is a broad-phase index over the walls in a room.  The room is
+// divided into a uniform grid of cells, and each cell records the set of
+// walls whose bounding circles overlap that cell.  Collision queries can then
+// look at only those walls that share a cell with the swept shape, rather
+// than testing every wall in the room.  The grid is conservative: it may
+// report walls that can't actually be hit (or that are no longer present),
+// but it will never omit a wall that can be.
+typedef struct {
+  az_grid_layout_t layout; // if empty, the grid contains no walls
+  az_grid_cell_range_t wall_cells[AZ_MAX_NUM_WALLS];
+  az_wall_set_t cells[AZ_WALL_GRID_MAX_CELLS][AZ_WALL_GRID_MAX_CELLS];
+} az_wall_grid_t;
+
+// Rebuild the grid from scratch to cover all walls in the given array (which
+// must have AZ_MAX_NUM_WALLS elements).
+void az_build_wall_grid(az_wall_grid_t *grid, const az_wall_t *walls);
+
+// Update the grid to reflect that the wall at the given index has moved,
+// appeared, or been removed.  If the wall has moved outside the area covered
+// by the grid, this will rebuild the whole grid.
+void az_update_wall_grid(az_wall_grid_t *grid, const az_wall_t *walls,
+                         int index);
+
+// Store in *set_out the set of walls that might be hit by a circle with the
+// given radius (which may be zero, for a ray), travelling delta from start.
+void az_wall_grid_sweep(const az_wall_grid_t *grid, double radius,
+                        az_vector_t start, az_vector_t delta,
+                        az_wall_set_t *set_out);
+
+// Store in *set_out the set of walls that might be hit by a circle with the
+// given radius, travelling in a circular path from start around spin_center
+// by spin_angle radians.
+void az_wall_grid_arc_sweep(const az_wall_grid_t *grid, double radius,
+                            az_vector_t start, az_vector_t spin_center,
+                            double spin_angle, az_wall_set_t *set_out);
+
+/*===========================================================================*/
+
+#endif // AZIMUTH_STATE_WALL_GRID_H_
@@ -62,13 +62,26 @@ static int compare_resource_entries(const void *key_ptr,
   return strcmp(name, entry->name);
 }
 
+// Binary resources (such as the compiled planet) are read in place from the
+// blob.  Text resources are copied into a temporary file instead, so that they
+// can be parsed with az_rscanf.
+static bool is_binary_resource(const char *name) {
+  const size_t length = strlen(name);
+  return length >= 4 && strcmp(name + length - 4, ".bin") == 0;
+}
+
 bool az_system_resource_reader(const char *name, az_reader_t *reader) {
   struct resource_entry *entry =
     bsearch(name, resource_index, resource_index_size,
             sizeof(struct resource_entry), &compare_resource_entries);
   if (entry == NULL) return false;
-  az_charbuf_reader(_binary_resources_start + entry->offset, entry->length,
-                    reader);
+  if (is_binary_resource(name)) {
+    az_membuf_reader(_binary_resources_start + entry->offset, entry->length,
+                     reader);
+  } else {
+    az_charbuf_reader(_binary_resources_start + entry->offset, entry->length,
+                      reader);
+  }
   return true;
 }
 #endif
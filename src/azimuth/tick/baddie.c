@@ -464,7 +464,7 @@ static void tick_baddie(az_space_state_t *state, az_baddie_t *baddie,
     case AZ_BAD_INCORPOREAL_PISTON:
     case AZ_BAD_INCORPOREAL_PISTON_EXT: {
       if (baddie->state != (int)baddie->param) {
-        az_play_sound(&state->soundboard, AZ_SND_PISTON_MOVEMENT);
+        az_play_sound_at(state, AZ_SND_PISTON_MOVEMENT, baddie->position);
         baddie->param = baddie->state;
       }
       const az_vector_t base_pos =
@@ -552,7 +552,7 @@ static void tick_baddie(az_space_state_t *state, az_baddie_t *baddie,
               theta = -theta;
               if (i % 2 == 0) theta += AZ_DEG2RAD(1);
             }
-            az_play_sound(&state->soundboard, AZ_SND_SONIC_SCREECH);
+            az_play_sound_at(state, AZ_SND_SONIC_SCREECH, baddie->position);
             baddie->cooldown = 2.0;
           }
           az_fly_towards_ship(state, baddie, time,
@@ -682,7 +682,7 @@ static void tick_baddie(az_space_state_t *state, az_baddie_t *baddie,
           if (az_ray_intersects_camera_rectangle(
                   &state->camera, baddie->position,
                   az_vmul(proj->velocity, proj->data->lifetime))) {
-            az_play_sound(&state->soundboard, AZ_SND_ERUPTION);
+            az_play_sound_at(state, AZ_SND_ERUPTION, baddie->position);
           } else {
             az_play_sound_with_volume(&state->soundboard, AZ_SND_ERUPTION,
                                       0.27);
@@ -724,7 +724,7 @@ static void tick_baddie(az_space_state_t *state, az_baddie_t *baddie,
               az_fire_baddie_projectile(state, baddie, AZ_PROJ_FIREBALL_FAST,
                                         8, 0, i * AZ_DEG2RAD(10));
             }
-            az_play_sound(&state->soundboard, AZ_SND_FIRE_FIREBALL);
+            az_play_sound_at(state, AZ_SND_FIRE_FIREBALL, baddie->position);
             baddie->cooldown = 2.0;
           }
           az_fly_towards_ship(state, baddie, time, AZ_DEG2RAD(150),
@@ -822,12 +822,13 @@ static void tick_baddie(az_space_state_t *state, az_baddie_t *baddie,
       az_add_sploosh(state, gravfield, position, normal,
                      az_vdiv(position_delta, time),
                      baddie->data->main_body.bounding_radius);
-      az_play_sound(&state->soundboard, AZ_SND_SPLASH);
+      az_play_sound_at(state, AZ_SND_SPLASH, baddie->position);
     }
   }
 }
 
 void az_tick_baddies(az_space_state_t *state, double time) {
+  az_update_sight_cache(state);
   AZ_ARRAY_LOOP(baddie, state->baddies) {
     if (baddie->kind == AZ_BAD_NOTHING) continue;
     assert(baddie->health > 0.0);
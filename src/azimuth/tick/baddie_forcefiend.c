@@ -86,7 +86,7 @@ static int get_num_eggs(const az_space_state_t *state) {
 }
 
 static bool there_are_no_gravity_torps(const az_space_state_t *state) {
-  AZ_ARRAY_LOOP(proj, state->projectiles) {
+  AZ_POOL_LOOP(proj, state->projectiles, &state->projectile_pool) {
     if (proj->kind == AZ_PROJ_GRAVITY_TORPEDO ||
         proj->kind == AZ_PROJ_GRAVITY_TORPEDO_WELL) {
       return false;
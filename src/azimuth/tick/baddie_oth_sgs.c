@@ -399,7 +399,7 @@ void az_tick_bad_oth_supergunship(
       bool ready_to_fire = false;
       if (get_secondary_state(baddie) == 0) {
         fly_towards_ship(state, baddie, time);
-        AZ_ARRAY_LOOP(proj, state->projectiles) {
+        AZ_POOL_LOOP(proj, state->projectiles, &state->projectile_pool) {
           if (proj->kind == AZ_PROJ_NOTHING) continue;
           if (proj->fired_by != AZ_SHIP_UID) continue;
           if (proj->data->properties & AZ_PROJF_NO_HIT) continue;
@@ -24,8 +24,12 @@
 #include <stdbool.h>
 
 #include "azimuth/state/baddie.h"
+#include "azimuth/state/nav_grid.h"
 #include "azimuth/state/projectile.h"
 #include "azimuth/state/space.h"
+#include "azimuth/state/wall.h"
+#include "azimuth/state/wall_grid.h"
+#include "azimuth/util/misc.h"
 #include "azimuth/util/random.h"
 #include "azimuth/util/vector.h"
 
@@ -56,16 +60,89 @@ bool az_ship_within_angle(
                                            baddie->position)))) <= angle);
 }
 
-bool az_can_see_ship(az_space_state_t *state, const az_baddie_t *baddie) {
-  if (!az_ship_is_decloaked(&state->ship)) return false;
+// A cached line-of-sight result stays valid until the baddie or the ship
+// moves more than this far from where it was when the result was computed:
+#define SIGHT_CACHE_TOLERANCE 2.0
+
+// Return the baddie's line-of-sight cache entry, or NULL if the baddie isn't
+// in the state's baddies array (e.g. a dying boss).
+static az_sight_cache_entry_t *get_sight_cache_entry(
+    az_space_state_t *state, const az_baddie_t *baddie) {
+  if (baddie < state->baddies ||
+      baddie >= state->baddies + AZ_ARRAY_SIZE(state->baddies)) return NULL;
+  return &state->sight_cache[baddie - state->baddies];
+}
+
+static bool sight_cache_entry_is_fresh(
+    const az_space_state_t *state, const az_baddie_t *baddie,
+    const az_sight_cache_entry_t *entry) {
+  return (entry->baddie_uid == baddie->uid &&
+          entry->wall_generation == state->wall_generation &&
+          az_vwithin(entry->baddie_position, baddie->position,
+                     SIGHT_CACHE_TOLERANCE) &&
+          az_vwithin(entry->ship_position, state->ship.position,
+                     SIGHT_CACHE_TOLERANCE));
+}
+
+static void reset_sight_cache_entry(
+    const az_space_state_t *state, const az_baddie_t *baddie,
+    az_sight_cache_entry_t *entry) {
+  entry->baddie_uid = baddie->uid;
+  entry->wall_generation = state->wall_generation;
+  entry->baddie_position = baddie->position;
+  entry->ship_position = state->ship.position;
+  entry->wall_dist = INFINITY;
+}
+
+// Return how far the baddie can see towards the ship before hitting a wall.
+static double wall_dist_towards_ship(az_space_state_t *state,
+                                     const az_baddie_t *baddie) {
   az_impact_t impact;
   az_ray_impact(state, baddie->position,
                 az_vsub(state->ship.position, baddie->position),
-                (non_wall_types(baddie) & ~AZ_IMPF_SHIP),
+                (AZ_IMPF_BADDIE | AZ_IMPF_DOOR_INSIDE | AZ_IMPF_DOOR_OUTSIDE |
+                 AZ_IMPF_SHIP), baddie->uid, &impact);
+  return (impact.type == AZ_IMP_WALL ?
+          az_vdist(baddie->position, impact.position) : INFINITY);
+}
+
+bool az_can_see_ship(az_space_state_t *state, const az_baddie_t *baddie) {
+  if (!az_ship_is_decloaked(&state->ship)) return false;
+  double wall_dist;
+  az_sight_cache_entry_t *entry = get_sight_cache_entry(state, baddie);
+  if (entry == NULL) {
+    wall_dist = wall_dist_towards_ship(state, baddie);
+  } else {
+    if (!sight_cache_entry_is_fresh(state, baddie, entry)) {
+      reset_sight_cache_entry(state, baddie, entry);
+      entry->wall_dist = wall_dist_towards_ship(state, baddie);
+    }
+    wall_dist = entry->wall_dist;
+  }
+  // The walls are taken care of, so check the doors (and the ship itself)
+  // along the part of the ray that the walls don't block.
+  az_vector_t delta = az_vsub(state->ship.position, baddie->position);
+  if (wall_dist < az_vnorm(delta)) delta = az_vwithlen(delta, wall_dist);
+  az_impact_t impact;
+  az_ray_impact(state, baddie->position, delta,
+                ((non_wall_types(baddie) & ~AZ_IMPF_SHIP) | AZ_IMPF_WALL),
                 baddie->uid, &impact);
   return (impact.type == AZ_IMP_SHIP);
 }
 
+void az_update_sight_cache(az_space_state_t *state) {
+  if (!az_ship_is_decloaked(&state->ship)) return;
+  for (int i = 0; i < AZ_ARRAY_SIZE(state->baddies); ++i) {
+    const az_baddie_t *baddie = &state->baddies[i];
+    az_sight_cache_entry_t *entry = &state->sight_cache[i];
+    if (baddie->kind == AZ_BAD_NOTHING ||
+        entry->baddie_uid != baddie->uid) continue;
+    if (sight_cache_entry_is_fresh(state, baddie, entry)) continue;
+    reset_sight_cache_entry(state, baddie, entry);
+    entry->wall_dist = wall_dist_towards_ship(state, baddie);
+  }
+}
+
 /*===========================================================================*/
 
 double az_baddie_dist_to_wall(
@@ -214,6 +291,47 @@ void az_snake_towards(
   baddie->param = AZ_TWO_PI + az_mod2pi(baddie->param + AZ_TWO_PI * time);
 }
 
+// Walls whose bounding circles are more than this far from a baddie's push it
+// away with a force of less than exp(-WALL_FORCE_RANGE) times wall_far_coeff,
+// which is small enough to ignore.
+#define WALL_FORCE_RANGE 32.0
+
+static az_flow_field_t *get_flow_field(az_space_state_t *state,
+                                       az_vector_t goal) {
+  int goal_col, goal_row;
+  if (!az_nav_grid_cell(&state->nav_grid, goal, &goal_col, &goal_row)) {
+    return NULL;
+  }
+  AZ_ARRAY_LOOP(entry, state->flow_cache) {
+    if (entry->valid && entry->wall_generation == state->wall_generation &&
+        entry->field.goal_col == goal_col &&
+        entry->field.goal_row == goal_row) return &entry->field;
+  }
+  az_flow_cache_entry_t *entry =
+    &state->flow_cache[state->next_flow_cache_entry];
+  state->next_flow_cache_entry =
+    (state->next_flow_cache_entry + 1) % AZ_ARRAY_SIZE(state->flow_cache);
+  entry->valid = true;
+  entry->wall_generation = state->wall_generation;
+  az_build_flow_field(&state->nav_grid, goal, &entry->field);
+  return &entry->field;
+}
+
+az_vector_t az_navigate_towards(az_space_state_t *state,
+                                az_vector_t position, az_vector_t goal) {
+  const az_vector_t direct = az_vsub(goal, position);
+  if (az_nav_grid_line_is_clear(&state->nav_grid, position, goal)) {
+    return direct;
+  }
+  const az_flow_field_t *field = get_flow_field(state, goal);
+  az_vector_t direction;
+  if (field != NULL && az_flow_field_direction(&state->nav_grid, field,
+                                               position, &direction)) {
+    return az_vmul(direction, az_vnorm(direct));
+  }
+  return direct;
+}
+
 static void apply_walls_to_force_field(
     az_space_state_t *state, az_baddie_t *baddie,
     double wall_far_coeff, double wall_near_coeff, az_vector_t *drift) {
@@ -230,7 +348,12 @@ static void apply_walls_to_force_field(
       az_vpluseq(drift, az_vwithlen(delta, wall_far_coeff * exp(-dist)));
     }
   }
-  AZ_ARRAY_LOOP(wall, state->walls) {
+  az_wall_set_t nearby;
+  az_wall_grid_sweep(&state->wall_grid, baddie->data->overall_bounding_radius +
+                     WALL_FORCE_RANGE, pos, AZ_VZERO, &nearby);
+  for (int i = az_wall_set_next(&nearby, 0); i >= 0;
+       i = az_wall_set_next(&nearby, i + 1)) {
+    const az_wall_t *wall = &state->walls[i];
     if (wall->kind == AZ_WALL_NOTHING) continue;
     const az_vector_t delta = az_vsub(pos, wall->position);
     const double dist = az_vnorm(delta) - wall->data->bounding_radius -
@@ -249,9 +372,18 @@ static az_vector_t force_field_to_ship(
     double wall_far_coeff, double wall_near_coeff) {
   az_vector_t drift = AZ_VZERO;
   if (az_ship_in_range(state, baddie, ship_max_range)) {
-    drift = az_vwithlen(az_vsub(state->ship.position, baddie->position),
-                        (az_ship_in_range(state, baddie, ship_min_range) ?
-                         -ship_coeff : ship_coeff));
+    const az_vector_t ship_position = state->ship.position;
+    if (az_ship_in_range(state, baddie, ship_min_range)) {
+      drift = az_vwithlen(az_vsub(ship_position, baddie->position),
+                          -ship_coeff);
+    } else if (ship_coeff > 0.0 &&
+               az_baddie_has_flag(baddie, AZ_BADF_NAVIGATES)) {
+      drift = az_vwithlen(az_navigate_towards(state, baddie->position,
+                                              ship_position), ship_coeff);
+    } else {
+      drift = az_vwithlen(az_vsub(ship_position, baddie->position),
+                          ship_coeff);
+    }
   }
   apply_walls_to_force_field(state, baddie, wall_far_coeff,
                              wall_near_coeff, &drift);
@@ -261,7 +393,11 @@ static az_vector_t force_field_to_ship(
 static az_vector_t force_field_to_position(
     az_space_state_t *state, az_baddie_t *baddie, az_vector_t goal,
     double goal_coeff, double wall_far_coeff, double wall_near_coeff) {
-  az_vector_t drift = az_vwithlen(az_vsub(goal, baddie->position), goal_coeff);
+  const bool navigate = (goal_coeff > 0.0 &&
+                         az_baddie_has_flag(baddie, AZ_BADF_NAVIGATES));
+  az_vector_t drift = az_vwithlen(
+      (navigate ? az_navigate_towards(state, baddie->position, goal) :
+       az_vsub(goal, baddie->position)), goal_coeff);
   apply_walls_to_force_field(state, baddie, wall_far_coeff,
                              wall_near_coeff, &drift);
   return drift;
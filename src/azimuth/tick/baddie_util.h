@@ -45,9 +45,16 @@ bool az_ship_within_angle(
 
 // Return true if the ship is decloaked and if the baddie has a clear
 // line-of-sight to the ship (blocked by walls/doors, but not by other
-// baddies); false otherwise.
+// baddies); false otherwise.  The part of the answer that depends on walls is
+// cached (in state->sight_cache), and only recomputed once the baddie or ship
+// has moved more than a small distance, or the walls have changed.
 bool az_can_see_ship(az_space_state_t *state, const az_baddie_t *baddie);
 
+// Bring the line-of-sight cache up to date for every baddie that has used it
+// before.  This should be called once per frame before ticking baddies, so
+// that most az_can_see_ship calls can be answered from the cache.
+void az_update_sight_cache(az_space_state_t *state);
+
 /*===========================================================================*/
 // Detecting walls:
 
@@ -66,6 +73,16 @@ bool az_baddie_has_clear_path_to_position(
 /*===========================================================================*/
 // Navigation:
 
+// Return the direction (with the same length as goal - position) in which
+// something at the given position should head in order to reach the goal.
+// This points straight at the goal unless the room's navigation grid says
+// that walls are in the way, in which case it follows a (cached) flow field
+// around them.  The az_drift_towards_* and az_fly_towards_* functions below
+// use this to steer towards their goals for baddies with the
+// AZ_BADF_NAVIGATES flag; other baddies head straight for their goals.
+az_vector_t az_navigate_towards(az_space_state_t *state,
+                                az_vector_t position, az_vector_t goal);
+
 // Crawl along the wall.  The `rightwards` argument controls the direction of
 // crawling, while the other arguments control the speed.
 void az_crawl_around(
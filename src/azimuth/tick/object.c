@@ -148,6 +148,7 @@ static void move_object_internal(
         az_vadd(object->obj.wall->position, delta_position);
       object->obj.wall->angle =
         az_mod2pi(object->obj.wall->angle + delta_angle);
+      az_reindex_wall(state, object->obj.wall);
       break;
   }
 }
@@ -186,7 +187,7 @@ void az_move_baddie_cargo(az_space_state_t *state, az_baddie_t *baddie,
 static void kill_baddie_internal(
     az_space_state_t *state, az_baddie_t *baddie, bool pickups_and_scripts) {
   assert(baddie->kind != AZ_BAD_NOTHING);
-  az_play_sound(&state->soundboard, baddie->data->death_sound);
+  az_play_sound_at(state, baddie->data->death_sound, baddie->position);
   // Add particles for baddie debris:
   const double overall_radius = baddie->data->overall_bounding_radius;
   const double step = 6.0;
@@ -346,7 +347,7 @@ bool az_try_damage_baddie(
         !(component->immunities & AZ_DMGF_FREEZE) &&
         baddie->health <= fmax(damage_amount, 1.0) * freeze_threshold) {
       if (baddie->frozen <= 0.0) {
-        az_play_sound(&state->soundboard, AZ_SND_FREEZE_BADDIE);
+        az_play_sound_at(state, AZ_SND_FREEZE_BADDIE, baddie->position);
       }
       baddie->frozen = 1.0;
       was_frozen = true;
@@ -397,7 +398,7 @@ bool az_try_damage_baddie(
         if (other->data->static_properties & AZ_BADF_INCORPOREAL) continue;
         az_kill_baddie(state, other);
       }
-      AZ_ARRAY_LOOP(proj, state->projectiles) {
+      AZ_POOL_LOOP(proj, state->projectiles, &state->projectile_pool) {
         if (proj->kind == AZ_PROJ_NOTHING) continue;
         if (proj->data->properties & AZ_PROJF_BOSS_EXPIRE) {
           az_expire_projectile(state, proj);
@@ -511,7 +512,7 @@ void az_kill_ship(az_space_state_t *state) {
 static void break_wall_internal(
     az_space_state_t *state, az_wall_t *wall, az_vector_t impact_point) {
   assert(wall->kind != AZ_WALL_NOTHING);
-  az_play_sound(&state->soundboard, AZ_SND_KILL_TURRET);
+  az_play_sound_at(state, AZ_SND_KILL_TURRET, wall->position);
   // Place particles for wall debris.
   const double radius = wall->data->bounding_radius;
   const double step = 3.0 + radius / 10.0;
@@ -540,6 +541,7 @@ static void break_wall_internal(
   }
   // Remove the wall.
   wall->kind = AZ_WALL_NOTHING;
+  az_reindex_wall(state, wall);
 }
 
 bool az_try_break_wall(az_space_state_t *state, az_wall_t *wall,
@@ -582,7 +584,7 @@ bool az_try_break_wall(az_space_state_t *state, az_wall_t *wall,
   // damage would be able to destroy this wall).
   else {
     wall->flare = 1.0;
-    az_play_sound(&state->soundboard, AZ_SND_METAL_CLINK);
+    az_play_sound_at(state, AZ_SND_METAL_CLINK, impact_point);
     return false;
   }
 }
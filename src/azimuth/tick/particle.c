@@ -36,7 +36,7 @@ void az_tick_particle(az_particle_t *particle, double time) {
 }
 
 void az_tick_particles(az_space_state_t *state, double time) {
-  AZ_ARRAY_LOOP(particle, state->particles) {
+  AZ_POOL_LOOP(particle, state->particles, &state->particle_pool) {
     az_tick_particle(particle, time);
   }
 }
@@ -197,7 +197,7 @@ static void on_projectile_impact(az_space_state_t *state,
   }
 
   // Play sound.
-  az_play_sound(&state->soundboard, proj->data->impact_sound);
+  az_play_sound_at(state, proj->data->impact_sound, proj->position);
 
   // Gravity torpedos are special: on impact, they create a temporary gravity
   // well that pulls the ship in.
@@ -252,7 +252,7 @@ static void on_projectile_hit_wall(az_space_state_t *state,
     az_vpluseq(&proj->position, az_vwithlen(normal, 0.5));
     az_vpluseq(&proj->velocity, az_vmul(az_vproj(proj->velocity, normal), -2));
     proj->angle = az_vtheta(proj->velocity);
-    az_play_sound(&state->soundboard, AZ_SND_BOUNCE_FIREBALL);
+    az_play_sound_at(state, AZ_SND_BOUNCE_FIREBALL, proj->position);
     return;
   }
   // Explode the projectile.
@@ -318,9 +318,9 @@ static void on_projectile_hit_baddie(
   const double prev_flare = baddie->armor_flare;
   if (!az_try_damage_baddie(state, baddie, component, proj->data->damage_kind,
                             proj->data->impact_damage * proj->power)) {
-    az_play_sound(&state->soundboard, baddie->data->armor_sound);
+    az_play_sound_at(state, baddie->data->armor_sound, proj->position);
   } else if (baddie->kind != AZ_BAD_NOTHING && prev_flare < 0.75) {
-    az_play_sound(&state->soundboard, baddie->data->hurt_sound);
+    az_play_sound_at(state, baddie->data->hurt_sound, proj->position);
   }
   // Note that at this point, the baddie may now be dead and removed.  So we
   // can no longer use the `baddie` or `component` pointers.
@@ -359,20 +359,9 @@ static void projectile_home_in(az_space_state_t *state,
       goal = state->ship.position;
     }
   } else {
-    double best_dist = INFINITY;
-    AZ_ARRAY_LOOP(baddie, state->baddies) {
-      if (baddie->kind == AZ_BAD_NOTHING) continue;
-      if (baddie->uid == proj->last_hit_uid) continue;
-      if (az_baddie_has_flag(baddie, AZ_BADF_NO_HOMING_PROJ)) continue;
-      const double dist = az_vdist(baddie->position, proj->position) +
-        fabs(az_mod2pi(az_vtheta(az_vsub(baddie->position, proj->position)) -
-                       proj->angle)) * 100.0;
-      if (dist < best_dist) {
-        best_dist = dist;
-        found_target = true;
-        goal = baddie->position;
-      }
-    }
+    found_target = az_find_homing_target(
+        state, proj->position, proj->angle, proj->last_hit_uid,
+        AZ_BADF_NO_HOMING_PROJ, &goal);
   }
   if (!found_target) return;
   // Now, home in on the goal position.
@@ -497,7 +486,7 @@ static void projectile_special_logic(az_space_state_t *state,
         const double radius =
           proj->data->splash_radius * (proj->age / proj->data->lifetime);
         // Destroy enemy projectiles within the blast:
-        AZ_ARRAY_LOOP(other_proj, state->projectiles) {
+        AZ_POOL_LOOP(other_proj, state->projectiles, &state->projectile_pool) {
           if (other_proj->kind == AZ_PROJ_NOTHING) continue;
           if (other_proj->fired_by != AZ_SHIP_UID &&
               !(other_proj->data->properties & AZ_PROJF_NO_HIT) &&
@@ -826,7 +815,7 @@ static void projectile_special_logic(az_space_state_t *state,
       const double radius =
         proj->data->splash_radius * (proj->age / proj->data->lifetime);
       // Destroy player projectiles within the blast:
-      AZ_ARRAY_LOOP(other_proj, state->projectiles) {
+      AZ_POOL_LOOP(other_proj, state->projectiles, &state->projectile_pool) {
         if (other_proj->kind == AZ_PROJ_NOTHING) continue;
         if (other_proj->fired_by == AZ_SHIP_UID &&
             !(other_proj->data->properties & AZ_PROJF_NO_HIT) &&
@@ -1115,7 +1104,8 @@ static void tick_projectile(az_space_state_t *state, az_projectile_t *proj,
 }
 
 void az_tick_projectiles(az_space_state_t *state, double time) {
-  AZ_ARRAY_LOOP(proj, state->projectiles) {
+  az_build_homing_targets(state);
+  AZ_POOL_LOOP(proj, state->projectiles, &state->projectile_pool) {
     if (proj->kind == AZ_PROJ_NOTHING) continue;
     tick_projectile(state, proj, time);
   }
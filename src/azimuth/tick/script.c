@@ -23,16 +23,22 @@
 #include <math.h>
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
+#include "azimuth/constants.h"
 #include "azimuth/state/dialog.h"
 #include "azimuth/state/object.h"
+#include "azimuth/state/planet.h"
+#include "azimuth/state/room.h"
 #include "azimuth/state/script.h"
 #include "azimuth/state/space.h"
 #include "azimuth/tick/object.h"
 #include "azimuth/util/audio.h"
 #include "azimuth/util/misc.h"
+#include "azimuth/util/profile.h"
 #include "azimuth/util/random.h"
 #include "azimuth/util/rw.h"
 #include "azimuth/util/vector.h"
@@ -72,9 +78,10 @@ static void print_error(const char *msg, const az_script_vm_t *vm) {
 
 // STACK_PUSH(...) takes 1 or more double args, and pushes those values onto
 // the stack (or errors on overflow), in order (so that the last argument will
-// be the new top of the stack).
+// be the new top of the stack).  The overflow check is skipped for scripts
+// that the compiler proved stack-safe (see az_compile_script).
 #define STACK_PUSH(...) do { \
-    if (vm->stack_size + AZ_COUNT_ARGS(__VA_ARGS__) <= \
+    if (!check_stack || vm->stack_size + AZ_COUNT_ARGS(__VA_ARGS__) <= \
         AZ_ARRAY_SIZE(vm->stack)) { \
       if (!do_stack_push(vm, AZ_COUNT_ARGS(__VA_ARGS__), __VA_ARGS__)) { \
         SCRIPT_ERROR("non-finite result"); \
@@ -104,8 +111,9 @@ static bool do_stack_push(az_script_vm_t *vm, int num_args, ...) {
 // STACK_POP(...) takes 1 or more double* args; it pops that many values off
 // the stack (or errors on underflow), and assigns them to the pointers.  The
 // top of the stack will be stored to the rightmost pointer passed, and so on.
+// As with STACK_PUSH, stack-safe scripts skip the underflow check.
 #define STACK_POP(...) do { \
-    if (vm->stack_size >= AZ_COUNT_ARGS(__VA_ARGS__)) { \
+    if (!check_stack || vm->stack_size >= AZ_COUNT_ARGS(__VA_ARGS__)) { \
       do_stack_pop(vm, AZ_COUNT_ARGS(__VA_ARGS__), __VA_ARGS__); \
     } else SCRIPT_ERROR("stack underflow"); \
   } while (0)
@@ -124,12 +132,11 @@ static void do_stack_pop(az_script_vm_t *vm, int num_args, ...) {
 
 /*===========================================================================*/
 
+// Jump targets are resolved by the compiler, which marks out-of-range jumps
+// with a negative target.
 #define DO_JUMP() do { \
-    const int new_pc = vm->pc + (int)ins.immediate; \
-    if (new_pc < 0 || new_pc > vm->script->num_instructions) { \
-      SCRIPT_ERROR("jump out of range"); \
-    } \
-    vm->pc = new_pc - 1; \
+    if (ins.target < 0) SCRIPT_ERROR("jump out of range"); \
+    next_pc = ins.target; \
   } while (0)
 
 static void do_suspend(az_script_vm_t *vm, az_script_vm_t *target_vm) {
@@ -172,7 +179,7 @@ static double modulo(double a, double b) {
 /*===========================================================================*/
 
 #define GET_UUID(uuid_out) do { \
-    const int slot = (int)ins.immediate; \
+    const int slot = ins.index; \
     if (slot < 0 || slot > AZ_NUM_UUID_SLOTS) { \
       SCRIPT_ERROR("invalid uuid index"); \
     } \
@@ -238,6 +245,36 @@ static void set_object_state(az_object_t *object, double value) {
   }
 }
 
+// Remove the object in the given uuid slot.  Returns NULL on success, or an
+// error message on failure.
+static const char *nix_object(az_space_state_t *state, int slot) {
+  if (slot < 0 || slot > AZ_NUM_UUID_SLOTS) return "invalid uuid index";
+  az_object_t object;
+  az_lookup_object(state, (slot == 0 ? AZ_SHIP_UUID : state->uuids[slot - 1]),
+                   &object);
+  switch (object.type) {
+    case AZ_OBJ_NOTHING: break;
+    case AZ_OBJ_BADDIE:
+      object.obj.baddie->kind = AZ_BAD_NOTHING;
+      break;
+    case AZ_OBJ_DOOR:
+      object.obj.door->kind = AZ_DOOR_NOTHING;
+      break;
+    case AZ_OBJ_GRAVFIELD:
+      object.obj.gravfield->kind = AZ_GRAV_NOTHING;
+      break;
+    case AZ_OBJ_NODE:
+      object.obj.node->kind = AZ_NODE_NOTHING;
+      break;
+    case AZ_OBJ_SHIP: return "invalid object type";
+    case AZ_OBJ_WALL:
+      object.obj.wall->kind = AZ_WALL_NOTHING;
+      az_reindex_wall(state, object.obj.wall);
+      break;
+  }
+  return NULL;
+}
+
 static void disable_skips(az_space_state_t *state) {
   state->skip.cooldown = 0.0;
   state->skip.allowed = false;
@@ -246,32 +283,146 @@ static void disable_skips(az_space_state_t *state) {
 
 /*===========================================================================*/
 
+#if AZ_PROFILING
+static az_script_profile_t script_profiles[AZ_MAX_NUM_ROOMS]
+                                          [AZ_NUM_SCRIPT_KINDS];
+static uint64_t opcode_counts[AZ_OP_ERROR + 1];
+static uint64_t total_instructions_executed = 0;
+#endif
+
+/*===========================================================================*/
+
+// Run the test half of a test-and-branch superinstruction, storing the flag
+// value to flag_out, and then advance the pc to the branch half.  The value
+// goes straight to the branch rather than through the stack, but this fails
+// in all the same ways that a test instruction would.
+#define FUSED_TEST(flag_out) do { \
+    if (ins.index < 0 || ins.index >= AZ_MAX_NUM_FLAGS) { \
+      SCRIPT_ERROR("invalid flag index"); \
+    } \
+    if (check_stack && vm->stack_size >= AZ_ARRAY_SIZE(vm->stack)) { \
+      SCRIPT_ERROR("stack overflow"); \
+    } \
+    *(flag_out) = az_test_flag(&state->ship.player, (az_flag_t)ins.index); \
+    ++vm->pc; \
+  } while (0)
+
+// Where the compiler supports it (GCC and Clang both do), dispatch each
+// instruction with a computed goto straight to its handler, which skips the
+// range check that a switch statement needs.  Each case of the switch in
+// run_vm is also labelled, so that the switch can serve as a fallback.
+// Computed gotos are an extension, so we have to tell -pedantic that we know.
+#if defined(__GNUC__)
+#define USE_COMPUTED_GOTO 1
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#define CASE(handler) case handler: handle_##handler
+#define HANDLER(handler) [handler] = &&handle_##handler
+#else
+#define USE_COMPUTED_GOTO 0
+#define CASE(handler) case handler
+#endif
+
 static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
   assert(vm != NULL);
   assert(vm->script != NULL);
   assert(vm->script->instructions != NULL);
   assert(state != NULL);
   assert(state->sync_vm.script == NULL);
+  assert(vm->script->compiled != NULL);
+  const az_compiled_instruction_t *code = vm->script->compiled;
+  const bool check_stack = !vm->script->stack_safe;
+#if USE_COMPUTED_GOTO
+  static void *const dispatch_table[AZ_NUM_SCRIPT_HANDLERS] = {
+    HANDLER(AZ_OP_NOP), HANDLER(AZ_OP_PUSH), HANDLER(AZ_OP_POP),
+    HANDLER(AZ_OP_DUP), HANDLER(AZ_OP_SWAP), HANDLER(AZ_OP_ADD),
+    HANDLER(AZ_OP_ADDI), HANDLER(AZ_OP_SUB), HANDLER(AZ_OP_SUBI),
+    HANDLER(AZ_OP_ISUB), HANDLER(AZ_OP_MUL), HANDLER(AZ_OP_MULI),
+    HANDLER(AZ_OP_DIV), HANDLER(AZ_OP_DIVI), HANDLER(AZ_OP_IDIV),
+    HANDLER(AZ_OP_MOD), HANDLER(AZ_OP_MODI), HANDLER(AZ_OP_MIN),
+    HANDLER(AZ_OP_MINI), HANDLER(AZ_OP_MAX), HANDLER(AZ_OP_MAXI),
+    HANDLER(AZ_OP_ABS), HANDLER(AZ_OP_MTAU), HANDLER(AZ_OP_RAND),
+    HANDLER(AZ_OP_SQRT), HANDLER(AZ_OP_VADD), HANDLER(AZ_OP_VSUB),
+    HANDLER(AZ_OP_VMUL), HANDLER(AZ_OP_VMULI), HANDLER(AZ_OP_VNORM),
+    HANDLER(AZ_OP_VTHETA), HANDLER(AZ_OP_VPOLAR), HANDLER(AZ_OP_EQ),
+    HANDLER(AZ_OP_EQI), HANDLER(AZ_OP_NE), HANDLER(AZ_OP_NEI),
+    HANDLER(AZ_OP_LT), HANDLER(AZ_OP_LTI), HANDLER(AZ_OP_GT),
+    HANDLER(AZ_OP_GTI), HANDLER(AZ_OP_LE), HANDLER(AZ_OP_LEI),
+    HANDLER(AZ_OP_GE), HANDLER(AZ_OP_GEI), HANDLER(AZ_OP_TEST),
+    HANDLER(AZ_OP_SET), HANDLER(AZ_OP_CLR), HANDLER(AZ_OP_HAS),
+    HANDLER(AZ_OP_MAP), HANDLER(AZ_OP_NIX), HANDLER(AZ_OP_KILL),
+    HANDLER(AZ_OP_GHEAL), HANDLER(AZ_OP_SHEAL), HANDLER(AZ_OP_GPOS),
+    HANDLER(AZ_OP_SPOS), HANDLER(AZ_OP_GANG), HANDLER(AZ_OP_SANG),
+    HANDLER(AZ_OP_GSTAT), HANDLER(AZ_OP_SSTAT), HANDLER(AZ_OP_ACTIV),
+    HANDLER(AZ_OP_DEACT), HANDLER(AZ_OP_GVEL), HANDLER(AZ_OP_SVEL),
+    HANDLER(AZ_OP_AUTOP), HANDLER(AZ_OP_TURN), HANDLER(AZ_OP_THRUST),
+    HANDLER(AZ_OP_CPLUS), HANDLER(AZ_OP_BAD), HANDLER(AZ_OP_SBADK),
+    HANDLER(AZ_OP_BOSS), HANDLER(AZ_OP_OPEN), HANDLER(AZ_OP_CLOSE),
+    HANDLER(AZ_OP_LOCK), HANDLER(AZ_OP_UNLOCK), HANDLER(AZ_OP_GSTR),
+    HANDLER(AZ_OP_SSTR), HANDLER(AZ_OP_GCAM), HANDLER(AZ_OP_RCAM),
+    HANDLER(AZ_OP_DARK), HANDLER(AZ_OP_DARKS), HANDLER(AZ_OP_BLINK),
+    HANDLER(AZ_OP_SHAKE), HANDLER(AZ_OP_QUAKE), HANDLER(AZ_OP_BOOM),
+    HANDLER(AZ_OP_NUKE), HANDLER(AZ_OP_BOLT), HANDLER(AZ_OP_NPS),
+    HANDLER(AZ_OP_FADO), HANDLER(AZ_OP_FADI), HANDLER(AZ_OP_FLASH),
+    HANDLER(AZ_OP_SCENE), HANDLER(AZ_OP_SCTXT), HANDLER(AZ_OP_SKIP),
+    HANDLER(AZ_OP_MSG), HANDLER(AZ_OP_DLOG), HANDLER(AZ_OP_PT),
+    HANDLER(AZ_OP_PB), HANDLER(AZ_OP_TT), HANDLER(AZ_OP_TB),
+    HANDLER(AZ_OP_DEND), HANDLER(AZ_OP_MLOG), HANDLER(AZ_OP_TM),
+    HANDLER(AZ_OP_MEND), HANDLER(AZ_OP_MUS), HANDLER(AZ_OP_MUSF),
+    HANDLER(AZ_OP_SND), HANDLER(AZ_OP_WAIT), HANDLER(AZ_OP_WAITS),
+    HANDLER(AZ_OP_DOOM), HANDLER(AZ_OP_SAFE), HANDLER(AZ_OP_JUMP),
+    HANDLER(AZ_OP_BEQZ), HANDLER(AZ_OP_BNEZ), HANDLER(AZ_OP_HALT),
+    HANDLER(AZ_OP_HEQZ), HANDLER(AZ_OP_HNEZ), HANDLER(AZ_OP_VICT),
+    HANDLER(AZ_OP_ERROR), HANDLER(AZ_SOP_END), HANDLER(AZ_SOP_TEST_BEQZ),
+    HANDLER(AZ_SOP_TEST_BNEZ), HANDLER(AZ_SOP_TEST_HEQZ),
+    HANDLER(AZ_SOP_TEST_HNEZ), HANDLER(AZ_SOP_GOTO), HANDLER(AZ_SOP_NIX_RUN)
+  };
+#endif
   int total_steps = 0;
-  while (vm->pc < vm->script->num_instructions) {
-    if (++total_steps > AZ_MAX_SCRIPT_STEPS) SCRIPT_ERROR("ran for too long");
-    const az_instruction_t ins = vm->script->instructions[vm->pc];
-    switch (ins.opcode) {
-      case AZ_OP_NOP: break;
+  while (true) {
+    assert(vm->pc >= 0);
+    assert(vm->pc <= vm->script->num_instructions);
+    az_compiled_instruction_t ins = code[vm->pc];
+    if (total_steps + ins.length > AZ_MAX_SCRIPT_STEPS) {
+      // If a superinstruction would take us past the limit, run just the
+      // first instruction it stands for, so that we stop in the same place
+      // that we would have without it.
+      if (ins.length <= 1) SCRIPT_ERROR("ran for too long");
+      ins.handler = ins.opcode;
+      ins.length = 1;
+    }
+    total_steps += ins.length;
+#if AZ_PROFILING
+    for (int i = 0; i < ins.length; ++i) {
+      ++opcode_counts[code[vm->pc + i].opcode];
+    }
+    total_instructions_executed += ins.length;
+#endif
+    int next_pc = vm->pc + ins.length;
+#if USE_COMPUTED_GOTO
+    assert(dispatch_table[ins.handler] != NULL);
+    goto *dispatch_table[ins.handler];
+#endif
+    switch (ins.handler) {
+      CASE(AZ_OP_NOP): break;
       // Stack manipulation:
-      case AZ_OP_PUSH:
+      CASE(AZ_OP_PUSH):
         STACK_PUSH(ins.immediate);
         break;
-      case AZ_OP_POP: {
-        const int num = az_imax(1, (int)ins.immediate);
-        if (vm->stack_size < num) SCRIPT_ERROR("stack underflow");
+      CASE(AZ_OP_POP): {
+        const int num = az_imax(1, ins.index);
+        if (check_stack && vm->stack_size < num) {
+          SCRIPT_ERROR("stack underflow");
+        }
         vm->stack_size -= num;
       } break;
-      case AZ_OP_DUP: {
-        const int num = az_imax(1, (int)ins.immediate);
-        if (vm->stack_size < num) SCRIPT_ERROR("stack underflow");
-        if (vm->stack_size + num > AZ_ARRAY_SIZE(vm->stack)) {
-          SCRIPT_ERROR("stack overflow");
+      CASE(AZ_OP_DUP): {
+        const int num = az_imax(1, ins.index);
+        if (check_stack) {
+          if (vm->stack_size < num) SCRIPT_ERROR("stack underflow");
+          if (vm->stack_size + num > AZ_ARRAY_SIZE(vm->stack)) {
+            SCRIPT_ERROR("stack overflow");
+          }
         }
         for (int i = 0; i < num; ++i) {
           vm->stack[vm->stack_size + i] =
@@ -279,19 +430,19 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
         }
         vm->stack_size += num;
       } break;
-      case AZ_OP_SWAP: {
+      CASE(AZ_OP_SWAP): {
         const int size = vm->stack_size;
-        int cycle = (int)ins.immediate;
+        int cycle = ins.index;
         if (cycle == 0) cycle = 2;
         if (cycle < 0) {
-          if (cycle < -size) SCRIPT_ERROR("stack underflow");
+          if (check_stack && cycle < -size) SCRIPT_ERROR("stack underflow");
           const double temp = vm->stack[size - 1];
           for (int i = 1; i < -cycle; ++i) {
             vm->stack[size - i] = vm->stack[size - (i + 1)];
           }
           vm->stack[size + cycle] = temp;
         } else {
-          if (cycle > size) SCRIPT_ERROR("stack underflow");
+          if (check_stack && cycle > size) SCRIPT_ERROR("stack underflow");
           const double temp = vm->stack[size - cycle];
           for (int i = cycle - 1; i >= 1; --i) {
             vm->stack[size - (i + 1)] = vm->stack[size - i];
@@ -300,137 +451,118 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
         }
       } break;
       // Arithmetic:
-      case AZ_OP_ADD: BINARY_OP(a + b); break;
-      case AZ_OP_ADDI: UNARY_OP(a + ins.immediate); break;
-      case AZ_OP_SUB: BINARY_OP(a - b); break;
-      case AZ_OP_SUBI: UNARY_OP(a - ins.immediate); break;
-      case AZ_OP_ISUB: UNARY_OP(ins.immediate - a); break;
-      case AZ_OP_MUL: BINARY_OP(a * b); break;
-      case AZ_OP_MULI: UNARY_OP(a * ins.immediate); break;
-      case AZ_OP_DIV: BINARY_OP(a / b); break;
-      case AZ_OP_DIVI: UNARY_OP(a / ins.immediate); break;
-      case AZ_OP_IDIV: UNARY_OP(ins.immediate / a); break;
-      case AZ_OP_MOD: BINARY_OP(modulo(a, b)); break;
-      case AZ_OP_MODI: UNARY_OP(modulo(a, ins.immediate)); break;
-      case AZ_OP_MIN: BINARY_OP(fmin(a, b)); break;
-      case AZ_OP_MINI: UNARY_OP(fmin(a, ins.immediate)); break;
-      case AZ_OP_MAX: BINARY_OP(fmax(a, b)); break;
-      case AZ_OP_MAXI: UNARY_OP(fmax(a, ins.immediate)); break;
+      CASE(AZ_OP_ADD): BINARY_OP(a + b); break;
+      CASE(AZ_OP_ADDI): UNARY_OP(a + ins.immediate); break;
+      CASE(AZ_OP_SUB): BINARY_OP(a - b); break;
+      CASE(AZ_OP_SUBI): UNARY_OP(a - ins.immediate); break;
+      CASE(AZ_OP_ISUB): UNARY_OP(ins.immediate - a); break;
+      CASE(AZ_OP_MUL): BINARY_OP(a * b); break;
+      CASE(AZ_OP_MULI): UNARY_OP(a * ins.immediate); break;
+      CASE(AZ_OP_DIV): BINARY_OP(a / b); break;
+      CASE(AZ_OP_DIVI): UNARY_OP(a / ins.immediate); break;
+      CASE(AZ_OP_IDIV): UNARY_OP(ins.immediate / a); break;
+      CASE(AZ_OP_MOD): BINARY_OP(modulo(a, b)); break;
+      CASE(AZ_OP_MODI): UNARY_OP(modulo(a, ins.immediate)); break;
+      CASE(AZ_OP_MIN): BINARY_OP(fmin(a, b)); break;
+      CASE(AZ_OP_MINI): UNARY_OP(fmin(a, ins.immediate)); break;
+      CASE(AZ_OP_MAX): BINARY_OP(fmax(a, b)); break;
+      CASE(AZ_OP_MAXI): UNARY_OP(fmax(a, ins.immediate)); break;
       // Math:
-      case AZ_OP_ABS: UNARY_OP(fabs(a)); break;
-      case AZ_OP_MTAU: UNARY_OP(az_mod2pi(a)); break;
-      case AZ_OP_RAND: STACK_PUSH(az_random(0.0, 1.0)); break;
-      case AZ_OP_SQRT: UNARY_OP(a < 0.0 ? NAN : sqrt(a)); break;
+      CASE(AZ_OP_ABS): UNARY_OP(fabs(a)); break;
+      CASE(AZ_OP_MTAU): UNARY_OP(az_mod2pi(a)); break;
+      CASE(AZ_OP_RAND): STACK_PUSH(az_random(0.0, 1.0)); break;
+      CASE(AZ_OP_SQRT): UNARY_OP(a < 0.0 ? NAN : sqrt(a)); break;
       // Vectors:
-      case AZ_OP_VADD: {
+      CASE(AZ_OP_VADD): {
         double xa, ya, xb, yb;
         STACK_POP(&xa, &ya, &xb, &yb);
         STACK_PUSH(xa + xb, ya + yb);
       } break;
-      case AZ_OP_VSUB: {
+      CASE(AZ_OP_VSUB): {
         double xa, ya, xb, yb;
         STACK_POP(&xa, &ya, &xb, &yb);
         STACK_PUSH(xa - xb, ya - yb);
       } break;
-      case AZ_OP_VMUL: {
+      CASE(AZ_OP_VMUL): {
         double x, y, f;
         STACK_POP(&x, &y, &f);
         STACK_PUSH(x * f, y * f);
       } break;
-      case AZ_OP_VMULI: {
+      CASE(AZ_OP_VMULI): {
         double x, y;
         STACK_POP(&x, &y);
         STACK_PUSH(x * ins.immediate, y * ins.immediate);
       } break;
-      case AZ_OP_VNORM: BINARY_OP(hypot(a, b)); break;
-      case AZ_OP_VTHETA: BINARY_OP(atan2(b, a)); break;
-      case AZ_OP_VPOLAR: {
+      CASE(AZ_OP_VNORM): BINARY_OP(hypot(a, b)); break;
+      CASE(AZ_OP_VTHETA): BINARY_OP(atan2(b, a)); break;
+      CASE(AZ_OP_VPOLAR): {
         double magnitude, theta;
         STACK_POP(&magnitude, &theta);
         const az_vector_t vec = az_vpolar(magnitude, theta);
         STACK_PUSH(vec.x, vec.y);
       } break;
       // Comparisons:
-      case AZ_OP_EQ: BINARY_OP(a == b ? 1.0 : 0.0); break;
-      case AZ_OP_EQI: UNARY_OP(a == ins.immediate ? 1.0 : 0.0); break;
-      case AZ_OP_NE: BINARY_OP(a != b ? 1.0 : 0.0); break;
-      case AZ_OP_NEI: UNARY_OP(a != ins.immediate ? 1.0 : 0.0); break;
-      case AZ_OP_LT: BINARY_OP(a < b ? 1.0 : 0.0); break;
-      case AZ_OP_LTI: UNARY_OP(a < ins.immediate ? 1.0 : 0.0); break;
-      case AZ_OP_GT: BINARY_OP(a > b ? 1.0 : 0.0); break;
-      case AZ_OP_GTI: UNARY_OP(a > ins.immediate ? 1.0 : 0.0); break;
-      case AZ_OP_LE: BINARY_OP(a <= b ? 1.0 : 0.0); break;
-      case AZ_OP_LEI: UNARY_OP(a <= ins.immediate ? 1.0 : 0.0); break;
-      case AZ_OP_GE: BINARY_OP(a >= b ? 1.0 : 0.0); break;
-      case AZ_OP_GEI: UNARY_OP(a >= ins.immediate ? 1.0 : 0.0); break;
+      CASE(AZ_OP_EQ): BINARY_OP(a == b ? 1.0 : 0.0); break;
+      CASE(AZ_OP_EQI): UNARY_OP(a == ins.immediate ? 1.0 : 0.0); break;
+      CASE(AZ_OP_NE): BINARY_OP(a != b ? 1.0 : 0.0); break;
+      CASE(AZ_OP_NEI): UNARY_OP(a != ins.immediate ? 1.0 : 0.0); break;
+      CASE(AZ_OP_LT): BINARY_OP(a < b ? 1.0 : 0.0); break;
+      CASE(AZ_OP_LTI): UNARY_OP(a < ins.immediate ? 1.0 : 0.0); break;
+      CASE(AZ_OP_GT): BINARY_OP(a > b ? 1.0 : 0.0); break;
+      CASE(AZ_OP_GTI): UNARY_OP(a > ins.immediate ? 1.0 : 0.0); break;
+      CASE(AZ_OP_LE): BINARY_OP(a <= b ? 1.0 : 0.0); break;
+      CASE(AZ_OP_LEI): UNARY_OP(a <= ins.immediate ? 1.0 : 0.0); break;
+      CASE(AZ_OP_GE): BINARY_OP(a >= b ? 1.0 : 0.0); break;
+      CASE(AZ_OP_GEI): UNARY_OP(a >= ins.immediate ? 1.0 : 0.0); break;
       // Flags:
-      case AZ_OP_TEST: {
-        const int flag_index = (int)ins.immediate;
+      CASE(AZ_OP_TEST): {
+        const int flag_index = ins.index;
         if (flag_index < 0 || flag_index >= AZ_MAX_NUM_FLAGS) {
           SCRIPT_ERROR("invalid flag index");
         }
         STACK_PUSH(az_test_flag(&state->ship.player, (az_flag_t)flag_index) ?
                    1.0 : 0.0);
       } break;
-      case AZ_OP_SET: {
-        const int flag_index = (int)ins.immediate;
+      CASE(AZ_OP_SET): {
+        const int flag_index = ins.index;
         if (flag_index < 0 || flag_index >= AZ_MAX_NUM_FLAGS) {
           SCRIPT_ERROR("invalid flag index");
         }
         az_set_flag(&state->ship.player, (az_flag_t)flag_index);
       } break;
-      case AZ_OP_CLR: {
-        const int flag_index = (int)ins.immediate;
+      CASE(AZ_OP_CLR): {
+        const int flag_index = ins.index;
         if (flag_index < 0 || flag_index >= AZ_MAX_NUM_FLAGS) {
           SCRIPT_ERROR("invalid flag index");
         }
         az_clear_flag(&state->ship.player, (az_flag_t)flag_index);
       } break;
-      case AZ_OP_HAS: {
-        const int upgrade_index = (int)ins.immediate;
+      CASE(AZ_OP_HAS): {
+        const int upgrade_index = ins.index;
         if (upgrade_index < 0 || upgrade_index >= AZ_NUM_UPGRADES) {
           SCRIPT_ERROR("invalid upgrade index");
         }
         STACK_PUSH(az_has_upgrade(&state->ship.player,
                                   (az_upgrade_t)upgrade_index) ? 1.0 : 0.0);
       } break;
-      case AZ_OP_MAP: {
-        const int zone_index = (int)ins.immediate;
+      CASE(AZ_OP_MAP): {
+        const int zone_index = ins.index;
         if (zone_index < 0 || zone_index >= state->planet->num_zones) {
           SCRIPT_ERROR("invalid zone index");
         }
         az_set_zone_mapped(&state->ship.player, (az_zone_key_t)zone_index);
       } break;
       // Objects:
-      case AZ_OP_NIX: {
-        az_object_t object;
-        GET_OBJECT(&object);
-        switch (object.type) {
-          case AZ_OBJ_NOTHING: break;
-          case AZ_OBJ_BADDIE:
-            object.obj.baddie->kind = AZ_BAD_NOTHING;
-            break;
-          case AZ_OBJ_DOOR:
-            object.obj.door->kind = AZ_DOOR_NOTHING;
-            break;
-          case AZ_OBJ_GRAVFIELD:
-            object.obj.gravfield->kind = AZ_GRAV_NOTHING;
-            break;
-          case AZ_OBJ_NODE:
-            object.obj.node->kind = AZ_NODE_NOTHING;
-            break;
-          case AZ_OBJ_SHIP: SCRIPT_ERROR("invalid object type");
-          case AZ_OBJ_WALL:
-            object.obj.wall->kind = AZ_WALL_NOTHING;
-            break;
-        }
+      CASE(AZ_OP_NIX): {
+        const char *error = nix_object(state, ins.index);
+        if (error != NULL) SCRIPT_ERROR(error);
       } break;
-      case AZ_OP_KILL: {
+      CASE(AZ_OP_KILL): {
         az_object_t object;
         GET_OBJECT(&object);
         az_kill_object(state, &object);
       } break;
-      case AZ_OP_GHEAL: {
+      CASE(AZ_OP_GHEAL): {
         az_object_t object;
         GET_OBJECT(&object);
         switch (object.type) {
@@ -440,7 +572,7 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
           default: SCRIPT_ERROR("invalid object type");
         }
       } break;
-      case AZ_OP_SHEAL: {
+      CASE(AZ_OP_SHEAL): {
         az_object_t object;
         GET_OBJECT(&object);
         double new_health;
@@ -460,7 +592,7 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
           default: SCRIPT_ERROR("invalid object type");
         }
       } break;
-      case AZ_OP_GPOS: {
+      CASE(AZ_OP_GPOS): {
         az_object_t object;
         GET_OBJECT(&object);
         const az_vector_t position =
@@ -468,7 +600,7 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
            az_get_object_position(&object));
         STACK_PUSH(position.x, position.y);
       } break;
-      case AZ_OP_SPOS: {
+      CASE(AZ_OP_SPOS): {
         az_object_t object;
         GET_OBJECT(&object);
         az_vector_t new_position;
@@ -479,13 +611,13 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
                          0.0);
         }
       } break;
-      case AZ_OP_GANG: {
+      CASE(AZ_OP_GANG): {
         az_object_t object;
         GET_OBJECT(&object);
         STACK_PUSH(object.type == AZ_OBJ_NOTHING ? 0.0 :
                    az_get_object_angle(&object));
       } break;
-      case AZ_OP_SANG: {
+      CASE(AZ_OP_SANG): {
         az_object_t object;
         GET_OBJECT(&object);
         double new_angle;
@@ -496,7 +628,7 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
                          az_mod2pi(new_angle - old_angle));
         }
       } break;
-      case AZ_OP_GSTAT: {
+      CASE(AZ_OP_GSTAT): {
         az_object_t object;
         GET_OBJECT(&object);
         double value = 0.0;
@@ -532,33 +664,33 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
         }
         STACK_PUSH(value);
       } break;
-      case AZ_OP_SSTAT: {
+      CASE(AZ_OP_SSTAT): {
         az_object_t object;
         GET_OBJECT(&object);
         double value;
         STACK_POP(&value);
         set_object_state(&object, value);
       } break;
-      case AZ_OP_ACTIV: {
+      CASE(AZ_OP_ACTIV): {
         az_object_t object;
         GET_OBJECT(&object);
         set_object_state(&object, 1);
       } break;
-      case AZ_OP_DEACT: {
+      CASE(AZ_OP_DEACT): {
         az_object_t object;
         GET_OBJECT(&object);
         set_object_state(&object, 0);
       } break;
       // Ship:
-      case AZ_OP_GVEL:
+      CASE(AZ_OP_GVEL):
         STACK_PUSH(state->ship.velocity.x, state->ship.velocity.y);
         break;
-      case AZ_OP_SVEL: {
+      CASE(AZ_OP_SVEL): {
         az_vector_t new_velocity;
         STACK_POP(&new_velocity.x, &new_velocity.y);
         state->ship.velocity = new_velocity;
       } break;
-      case AZ_OP_AUTOP: {
+      CASE(AZ_OP_AUTOP): {
         if (ins.immediate) {
           state->ship.autopilot.enabled = true;
           state->ship.autopilot.thrust = 0;
@@ -568,28 +700,28 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
           state->ship.autopilot.enabled = false;
         }
       } break;
-      case AZ_OP_TURN: {
+      CASE(AZ_OP_TURN): {
         double goal_angle;
         STACK_POP(&goal_angle);
         if (state->ship.autopilot.enabled) {
           state->ship.autopilot.goal_angle = az_mod2pi(goal_angle);
         }
       } break;
-      case AZ_OP_THRUST: {
+      CASE(AZ_OP_THRUST): {
         if (state->ship.autopilot.enabled) {
           if (ins.immediate > 0) state->ship.autopilot.thrust = 1;
           else if (ins.immediate < 0) state->ship.autopilot.thrust = -1;
           else state->ship.autopilot.thrust = 0;
         }
       } break;
-      case AZ_OP_CPLUS: {
+      CASE(AZ_OP_CPLUS): {
         if (state->ship.autopilot.enabled) {
           state->ship.autopilot.cplus = (bool)ins.immediate;
         }
       } break;
       // Baddies:
-      case AZ_OP_BAD: {
-        const int slot = (int)ins.immediate;
+      CASE(AZ_OP_BAD): {
+        const int slot = ins.index;
         if (slot < 0 || slot > AZ_NUM_UUID_SLOTS) {
           SCRIPT_ERROR("invalid uuid index");
         }
@@ -609,7 +741,7 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
           } else state->uuids[slot - 1] = AZ_NULL_UUID;
         }
       } break;
-      case AZ_OP_SBADK: {
+      CASE(AZ_OP_SBADK): {
         az_uid_t uid;
         GET_UID(AZ_UUID_BADDIE, &uid);
         double argument;
@@ -624,15 +756,16 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
           az_init_baddie(baddie, (az_baddie_kind_t)kind, baddie->position,
                          baddie->angle);
           baddie->on_kill = baddie_script;
+          state->homing_targets_stale = true;
         }
       } break;
-      case AZ_OP_BOSS: {
+      CASE(AZ_OP_BOSS): {
         az_uid_t uid;
         GET_UID(AZ_UUID_BADDIE, &uid);
         state->boss_uid = uid;
       } break;
       // Doors:
-      case AZ_OP_OPEN: {
+      CASE(AZ_OP_OPEN): {
         az_uid_t uid;
         GET_UID(AZ_UUID_DOOR, &uid);
         az_door_t *door;
@@ -647,7 +780,7 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
           }
         }
       } break;
-      case AZ_OP_CLOSE: {
+      CASE(AZ_OP_CLOSE): {
         az_uid_t uid;
         GET_UID(AZ_UUID_DOOR, &uid);
         az_door_t *door;
@@ -662,7 +795,7 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
           }
         }
       } break;
-      case AZ_OP_LOCK: {
+      CASE(AZ_OP_LOCK): {
         az_uid_t uid;
         GET_UID(AZ_UUID_DOOR, &uid);
         az_door_t *door;
@@ -679,7 +812,7 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
           }
         }
       } break;
-      case AZ_OP_UNLOCK: {
+      CASE(AZ_OP_UNLOCK): {
         az_uid_t uid;
         GET_UID(AZ_UUID_DOOR, &uid);
         az_door_t *door;
@@ -695,14 +828,14 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
         }
       } break;
       // Gravfields:
-      case AZ_OP_GSTR: {
+      CASE(AZ_OP_GSTR): {
         az_uid_t uid;
         GET_UID(AZ_UUID_GRAVFIELD, &uid);
         az_gravfield_t *gravfield;
         STACK_PUSH(az_lookup_gravfield(state, uid, &gravfield) ?
                    gravfield->strength : 0.0);
       } break;
-      case AZ_OP_SSTR: {
+      CASE(AZ_OP_SSTR): {
         double value;
         STACK_POP(&value);
         az_uid_t uid;
@@ -716,39 +849,39 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
         }
       } break;
       // Camera:
-      case AZ_OP_GCAM:
+      CASE(AZ_OP_GCAM):
         STACK_PUSH(state->camera.center.x, state->camera.center.y);
         break;
-      case AZ_OP_RCAM: {
+      CASE(AZ_OP_RCAM): {
         double value;
         STACK_POP(&value);
         state->camera.r_max_override = value;
       } break;
-      case AZ_OP_DARK:
+      CASE(AZ_OP_DARK):
         state->dark_goal = fmin(fmax(0.0, ins.immediate), 1.0);
         break;
-      case AZ_OP_DARKS: {
+      CASE(AZ_OP_DARKS): {
         double value;
         STACK_POP(&value);
         state->dark_goal = fmin(fmax(0.0, value), 1.0);
       } break;
-      case AZ_OP_BLINK:
+      CASE(AZ_OP_BLINK):
         state->darkness = fmin(fmax(0.0, ins.immediate), 1.0);
         break;
-      case AZ_OP_SHAKE:
+      CASE(AZ_OP_SHAKE):
         az_shake_camera(&state->camera, ins.immediate, ins.immediate * 0.75);
         break;
-      case AZ_OP_QUAKE:
+      CASE(AZ_OP_QUAKE):
         state->camera.quake_vert = fmax(0, ins.immediate);
         break;
       // Pyrotechnics:
-      case AZ_OP_BOOM: {
+      CASE(AZ_OP_BOOM): {
         az_vector_t position;
         STACK_POP(&position.x, &position.y);
         az_add_projectile(state, AZ_PROJ_NUCLEAR_EXPLOSION, position,
                           0.0, 1.0, AZ_NULL_UID);
       } break;
-      case AZ_OP_NUKE: {
+      CASE(AZ_OP_NUKE): {
         if (!state->nuke.active) {
           state->nuke.active = true;
           state->nuke.rho =
@@ -756,7 +889,7 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
           az_play_sound(&state->soundboard, AZ_SND_EXPLODE_MEGA_BOMB);
         }
       } break;
-      case AZ_OP_BOLT: {
+      CASE(AZ_OP_BOLT): {
         az_vector_t p1, p2;
         STACK_POP(&p1.x, &p1.y, &p2.x, &p2.y);
         az_particle_t *particle;
@@ -772,7 +905,7 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
         }
         az_play_sound(&state->soundboard, AZ_SND_ELECTRICITY);
       } break;
-      case AZ_OP_NPS: {
+      CASE(AZ_OP_NPS): {
         az_vector_t position;
         STACK_POP(&position.x, &position.y);
         state->camera.wobble_goal = 0.5 * ins.immediate;
@@ -789,14 +922,14 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
         az_play_sound(&state->soundboard, AZ_SND_NPS_PORTAL);
       } break;
       // Cutscenes:
-      case AZ_OP_FADO:
+      CASE(AZ_OP_FADO):
         assert(state->global_fade.step == AZ_GFS_INACTIVE);
         if (state->skip.active) break;
         state->global_fade.step = AZ_GFS_FADE_OUT;
         state->global_fade.fade_alpha = 0.0;
         state->global_fade.fade_gray = 0.0f;
         SUSPEND(&state->sync_vm);
-      case AZ_OP_FADI:
+      CASE(AZ_OP_FADI):
         assert(state->global_fade.step == AZ_GFS_INACTIVE);
         if (state->skip.active) break;
         state->global_fade.step = AZ_GFS_FADE_IN;
@@ -804,15 +937,15 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
         state->global_fade.fade_gray = 0.0f;
         state->dialogue.hidden = false;
         SUSPEND(&state->sync_vm);
-      case AZ_OP_FLASH:
+      CASE(AZ_OP_FLASH):
         assert(state->global_fade.step == AZ_GFS_INACTIVE);
         if (state->skip.active) break;
         state->global_fade.step = AZ_GFS_FADE_IN;
         state->global_fade.fade_alpha = 1.0;
         state->global_fade.fade_gray = 1.0f;
         SUSPEND(&state->sync_vm);
-      case AZ_OP_SCENE: {
-        const int scene_index = (int)ins.immediate;
+      CASE(AZ_OP_SCENE): {
+        const int scene_index = ins.index;
         if (scene_index < 0 || scene_index > AZ_NUM_SCENES) {
           SCRIPT_ERROR("invalid scene index");
         }
@@ -825,8 +958,8 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
           state->cutscene.fade_alpha = 1.0;
         } else SUSPEND(&state->sync_vm);
       } break;
-      case AZ_OP_SCTXT: {
-        const int paragraph_index = (int)ins.immediate;
+      CASE(AZ_OP_SCTXT): {
+        const int paragraph_index = ins.index;
         if (paragraph_index < 0 ||
             paragraph_index >= state->planet->num_paragraphs) {
           SCRIPT_ERROR("invalid paragraph index");
@@ -840,20 +973,20 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
           state->cutscene.fade_alpha = 1.0;
         } else SUSPEND(&state->sync_vm);
       } break;
-      case AZ_OP_SKIP: {
+      CASE(AZ_OP_SKIP): {
         if (ins.immediate) state->skip.allowed = true;
         else disable_skips(state);
       } break;
       // Messages/dialog:
-      case AZ_OP_MSG: {
-        const int paragraph_index = (int)ins.immediate;
+      CASE(AZ_OP_MSG): {
+        const int paragraph_index = ins.index;
         if (paragraph_index < 0 ||
             paragraph_index >= state->planet->num_paragraphs) {
           SCRIPT_ERROR("invalid paragraph index");
         }
         az_set_message(state, state->planet->paragraphs[paragraph_index]);
       } break;
-      case AZ_OP_DLOG:
+      CASE(AZ_OP_DLOG):
         if (state->skip.active) break;
         if (state->mode == AZ_MODE_NORMAL &&
             state->dialogue.step == AZ_DLS_INACTIVE &&
@@ -862,10 +995,10 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
           SUSPEND(&state->sync_vm);
         }
         SCRIPT_ERROR("can't start dialogue now");
-      case AZ_OP_PT:
+      CASE(AZ_OP_PT):
         if (state->skip.active) break;
         if (state->dialogue.step != AZ_DLS_INACTIVE) {
-          const int portrait = (int)ins.immediate;
+          const int portrait = ins.index;
           if (portrait < 0 || portrait > AZ_NUM_PORTRAITS) {
             SCRIPT_ERROR("invalid portrait");
           } else {
@@ -873,10 +1006,10 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
           }
         } else SCRIPT_ERROR("can't PT when not in dialogue");
         break;
-      case AZ_OP_PB:
+      CASE(AZ_OP_PB):
         if (state->skip.active) break;
         if (state->dialogue.step != AZ_DLS_INACTIVE) {
-          const int portrait = (int)ins.immediate;
+          const int portrait = ins.index;
           if (portrait < 0 || portrait > AZ_NUM_PORTRAITS) {
             SCRIPT_ERROR("invalid portrait");
           } else {
@@ -884,14 +1017,14 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
           }
         } else SCRIPT_ERROR("can't PB when not in dialogue");
         break;
-      case AZ_OP_TT:
+      CASE(AZ_OP_TT):
         if (state->skip.active) break;
         if (state->dialogue.step == AZ_DLS_INACTIVE) {
           SCRIPT_ERROR("can't TT when not in dialogue");
         } else if (state->monologue.step != AZ_MLS_INACTIVE) {
           SCRIPT_ERROR("can't TT during monologue");
         } else {
-          const int paragraph_index = (int)ins.immediate;
+          const int paragraph_index = ins.index;
           if (paragraph_index < 0 ||
               paragraph_index >= state->planet->num_paragraphs) {
             SCRIPT_ERROR("invalid paragraph index");
@@ -901,14 +1034,14 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
                                paragraph, true);
         }
         SUSPEND(&state->sync_vm);
-      case AZ_OP_TB:
+      CASE(AZ_OP_TB):
         if (state->skip.active) break;
         if (state->dialogue.step == AZ_DLS_INACTIVE) {
           SCRIPT_ERROR("can't TB when not in dialogue");
         } else if (state->monologue.step != AZ_MLS_INACTIVE) {
           SCRIPT_ERROR("can't TB during monologue");
         } else {
-          const int paragraph_index = (int)ins.immediate;
+          const int paragraph_index = ins.index;
           if (paragraph_index < 0 ||
               paragraph_index >= state->planet->num_paragraphs) {
             SCRIPT_ERROR("invalid paragraph index");
@@ -918,7 +1051,7 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
                                paragraph, false);
         }
         SUSPEND(&state->sync_vm);
-      case AZ_OP_DEND:
+      CASE(AZ_OP_DEND):
         if (state->dialogue.step == AZ_DLS_INACTIVE) {
           if (state->skip.active) break;
           SCRIPT_ERROR("can't DEND when not in dialogue");
@@ -928,17 +1061,17 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
         }
         state->dialogue = (az_dialogue_state_t){ .step = AZ_DLS_END };
         SUSPEND(&state->sync_vm);
-      case AZ_OP_MLOG:
+      CASE(AZ_OP_MLOG):
         if (state->skip.active) break;
         if (state->monologue.step == AZ_MLS_INACTIVE) {
           state->monologue = (az_monologue_state_t){ .step = AZ_MLS_BEGIN };
           SUSPEND(&state->sync_vm);
         }
         SCRIPT_ERROR("can't MLOG while already in monologue");
-      case AZ_OP_TM:
+      CASE(AZ_OP_TM):
         if (state->skip.active) break;
         if (state->monologue.step != AZ_MLS_INACTIVE) {
-          const int paragraph_index = (int)ins.immediate;
+          const int paragraph_index = ins.index;
           if (paragraph_index < 0 ||
               paragraph_index >= state->planet->num_paragraphs) {
             SCRIPT_ERROR("invalid paragraph index");
@@ -953,7 +1086,7 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
           SUSPEND(&state->sync_vm);
         }
         SCRIPT_ERROR("can't TM when not in monologue");
-      case AZ_OP_MEND:
+      CASE(AZ_OP_MEND):
         if (state->monologue.step != AZ_MLS_INACTIVE) {
           state->monologue.step = AZ_MLS_END;
           state->monologue.progress = 0.0;
@@ -965,18 +1098,18 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
         if (state->skip.active) break;
         SCRIPT_ERROR("can't MEND when not in monologue");
       // Music/sound:
-      case AZ_OP_MUS: {
-        const int music_index = (int)ins.immediate;
+      CASE(AZ_OP_MUS): {
+        const int music_index = ins.index;
         if (music_index < 0 || music_index > AZ_NUM_MUSIC_KEYS) {
           SCRIPT_ERROR("invalid music index");
         }
         az_change_music(&state->soundboard, (az_music_key_t)music_index);
       } break;
-      case AZ_OP_MUSF:
-        az_change_music_flag(&state->soundboard, (int)ins.immediate);
+      CASE(AZ_OP_MUSF):
+        az_change_music_flag(&state->soundboard, ins.index);
         break;
-      case AZ_OP_SND: {
-        const int sound_index = (int)ins.immediate;
+      CASE(AZ_OP_SND): {
+        const int sound_index = ins.index;
         if (sound_index < 0 || sound_index > AZ_NUM_SOUND_KEYS) {
           SCRIPT_ERROR("invalid sound index");
         }
@@ -984,8 +1117,8 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
         az_play_sound(&state->soundboard, (az_sound_key_t)sound_index);
       } break;
       // Timers:
-      case AZ_OP_WAIT:
-      case AZ_OP_WAITS: {
+      CASE(AZ_OP_WAIT):
+      CASE(AZ_OP_WAITS): {
         double wait_duration;
         if (ins.opcode == AZ_OP_WAITS) {
           STACK_POP(&wait_duration);
@@ -1020,7 +1153,7 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
           SCRIPT_ERROR("too many timers");
         }
       } break;
-      case AZ_OP_DOOM:
+      CASE(AZ_OP_DOOM):
         if (state->dialogue.step != AZ_DLS_INACTIVE) {
           SCRIPT_ERROR("can't DOOM during dialogue");
         }
@@ -1030,43 +1163,78 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
         disable_skips(state);
         SUSPEND(&state->countdown.vm);
         break;
-      case AZ_OP_SAFE:
+      CASE(AZ_OP_SAFE):
         state->countdown.is_active = false;
         state->countdown.vm.script = NULL;
         break;
       // Control flow:
-      case AZ_OP_JUMP:
+      CASE(AZ_OP_JUMP):
         DO_JUMP();
         break;
-      case AZ_OP_BEQZ: {
+      CASE(AZ_OP_BEQZ): {
         double p;
         STACK_POP(&p);
         if (p == 0) DO_JUMP();
       } break;
-      case AZ_OP_BNEZ: {
+      CASE(AZ_OP_BNEZ): {
         double p;
         STACK_POP(&p);
         if (p != 0) DO_JUMP();
       } break;
-      case AZ_OP_HALT: goto halt;
-      case AZ_OP_HEQZ: {
+      CASE(AZ_OP_HALT): goto halt;
+      CASE(AZ_OP_HEQZ): {
         double p;
         STACK_POP(&p);
         if (p == 0) goto halt;
       } break;
-      case AZ_OP_HNEZ: {
+      CASE(AZ_OP_HNEZ): {
         double p;
         STACK_POP(&p);
         if (p != 0) goto halt;
       } break;
-      case AZ_OP_VICT:
+      CASE(AZ_OP_VICT):
         state->victory = true;
         goto halt;
-      case AZ_OP_ERROR: SCRIPT_ERROR("ERROR opcode");
+      CASE(AZ_OP_ERROR): SCRIPT_ERROR("ERROR opcode");
+      // Superinstructions:
+      CASE(AZ_SOP_END): goto halt;
+      CASE(AZ_SOP_TEST_BEQZ): {
+        bool flag;
+        FUSED_TEST(&flag);
+        if (!flag) DO_JUMP();
+      } break;
+      CASE(AZ_SOP_TEST_BNEZ): {
+        bool flag;
+        FUSED_TEST(&flag);
+        if (flag) DO_JUMP();
+      } break;
+      CASE(AZ_SOP_TEST_HEQZ): {
+        bool flag;
+        FUSED_TEST(&flag);
+        if (!flag) goto halt;
+      } break;
+      CASE(AZ_SOP_TEST_HNEZ): {
+        bool flag;
+        FUSED_TEST(&flag);
+        if (flag) goto halt;
+      } break;
+      CASE(AZ_SOP_GOTO):
+        // The push still has to fail if the stack is full.
+        if (check_stack && vm->stack_size >= AZ_ARRAY_SIZE(vm->stack)) {
+          SCRIPT_ERROR("stack overflow");
+        }
+        next_pc = ins.target;
+        break;
+      CASE(AZ_SOP_NIX_RUN):
+        // Advance the pc as we go, so that any error is reported at the
+        // right instruction.
+        for (; vm->pc < next_pc; ++vm->pc) {
+          const char *error = nix_object(state, code[vm->pc].index);
+          if (error != NULL) SCRIPT_ERROR(error);
+        }
+        break;
     }
-    ++vm->pc;
-    assert(vm->pc >= 0);
-    assert(vm->pc <= vm->script->num_instructions);
+    vm->pc = next_pc;
   }
 
  halt:
@@ -1081,10 +1249,62 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
   }
 }
 
+#if USE_COMPUTED_GOTO
+#pragma GCC diagnostic pop
+#endif
+
+#if AZ_PROFILING
+// Figure out which of the current room's scripts (if any) this is.
+static az_script_kind_t classify_script(const az_space_state_t *state,
+                                        const az_script_t *script) {
+  const az_planet_t *planet = state->planet;
+  if (script == planet->on_start) return AZ_SCRIPT_PLANET_START;
+  const az_room_key_t room_key = state->ship.player.current_room;
+  if (room_key < 0 || room_key >= planet->num_rooms) return AZ_SCRIPT_OTHER;
+  const az_room_t *room = az_peek_room(planet, room_key);
+  if (script == room->on_start) return AZ_SCRIPT_ON_START;
+  for (int i = 0; i < room->num_baddies; ++i) {
+    if (script == room->baddies[i].on_kill) return AZ_SCRIPT_ON_KILL;
+  }
+  for (int i = 0; i < room->num_doors; ++i) {
+    if (script == room->doors[i].on_open) return AZ_SCRIPT_ON_OPEN;
+  }
+  for (int i = 0; i < room->num_gravfields; ++i) {
+    if (script == room->gravfields[i].on_enter) return AZ_SCRIPT_ON_ENTER;
+  }
+  for (int i = 0; i < room->num_nodes; ++i) {
+    if (script == room->nodes[i].on_use) return AZ_SCRIPT_ON_USE;
+  }
+  return AZ_SCRIPT_OTHER;
+}
+#endif
+
+// Run the VM, charging the run to the script's profile if profiling is
+// enabled.
+static void profile_vm(az_space_state_t *state, az_script_vm_t *vm) {
+#if AZ_PROFILING
+  const az_room_key_t room_key = state->ship.player.current_room;
+  const az_script_kind_t kind = classify_script(state, vm->script);
+  const uint64_t start_instructions = total_instructions_executed;
+  const uint64_t start_ns = az_profile_now_ns();
+  run_vm(state, vm);
+  const uint64_t elapsed_ns = az_profile_now_ns() - start_ns;
+  if (room_key >= 0 && room_key < AZ_MAX_NUM_ROOMS) {
+    az_script_profile_t *profile = &script_profiles[room_key][kind];
+    ++profile->num_runs;
+    profile->num_instructions +=
+      total_instructions_executed - start_instructions;
+    profile->total_ns += elapsed_ns;
+  }
+#else
+  run_vm(state, vm);
+#endif
+}
+
 void az_run_script(az_space_state_t *state, const az_script_t *script) {
   if (script == NULL || script->num_instructions == 0) return;
   az_script_vm_t vm = { .script = script };
-  run_vm(state, &vm);
+  profile_vm(state, &vm);
 }
 
 void az_resume_script(az_space_state_t *state, az_script_vm_t *vm) {
@@ -1092,7 +1312,7 @@ void az_resume_script(az_space_state_t *state, az_script_vm_t *vm) {
   assert(vm->script != NULL);
   az_script_vm_t local_vm = *vm;
   vm->script = NULL;
-  run_vm(state, &local_vm);
+  profile_vm(state, &local_vm);
 }
 
 /*===========================================================================*/
@@ -1112,3 +1332,127 @@ void az_tick_timers(az_space_state_t *state, double time) {
 }
 
 /*===========================================================================*/
+
+static const char *script_kind_name(az_script_kind_t kind) {
+  switch (kind) {
+    case AZ_SCRIPT_OTHER: return "other";
+    case AZ_SCRIPT_PLANET_START: return "planet";
+    case AZ_SCRIPT_ON_START: return "on_start";
+    case AZ_SCRIPT_ON_KILL: return "on_kill";
+    case AZ_SCRIPT_ON_OPEN: return "on_open";
+    case AZ_SCRIPT_ON_ENTER: return "on_enter";
+    case AZ_SCRIPT_ON_USE: return "on_use";
+  }
+  AZ_ASSERT_UNREACHABLE();
+}
+
+const az_script_profile_t *az_get_script_profile(az_room_key_t room,
+                                                 az_script_kind_t kind) {
+  assert(room >= 0 && room < AZ_MAX_NUM_ROOMS);
+  assert(kind >= 0 && kind < AZ_NUM_SCRIPT_KINDS);
+#if AZ_PROFILING
+  return &script_profiles[room][kind];
+#else
+  static const az_script_profile_t empty_profile;
+  return &empty_profile;
+#endif
+}
+
+uint64_t az_get_script_opcode_count(az_opcode_t opcode) {
+  assert(opcode >= AZ_OP_NOP && opcode <= AZ_OP_ERROR);
+#if AZ_PROFILING
+  return opcode_counts[opcode];
+#else
+  return 0;
+#endif
+}
+
+void az_reset_script_profile(void) {
+#if AZ_PROFILING
+  AZ_ZERO_ARRAY(script_profiles);
+  AZ_ZERO_ARRAY(opcode_counts);
+  total_instructions_executed = 0;
+#endif
+}
+
+typedef struct {
+  az_room_key_t room;
+  az_script_kind_t kind;
+  const az_script_profile_t *profile;
+} script_profile_row_t;
+
+static int compare_profile_rows(const void *v1, const void *v2) {
+  const script_profile_row_t *row1 = v1;
+  const script_profile_row_t *row2 = v2;
+  if (row1->profile->total_ns != row2->profile->total_ns) {
+    return (row1->profile->total_ns > row2->profile->total_ns ? -1 : 1);
+  }
+  if (row1->room != row2->room) return row1->room - row2->room;
+  return (int)row1->kind - (int)row2->kind;
+}
+
+static int compare_opcode_counts(const void *v1, const void *v2) {
+  const az_opcode_t opcode1 = *(const az_opcode_t *)v1;
+  const az_opcode_t opcode2 = *(const az_opcode_t *)v2;
+  const uint64_t count1 = az_get_script_opcode_count(opcode1);
+  const uint64_t count2 = az_get_script_opcode_count(opcode2);
+  if (count1 != count2) return (count1 > count2 ? -1 : 1);
+  return (int)opcode1 - (int)opcode2;
+}
+
+bool az_write_script_profile(az_writer_t *writer) {
+  if (!AZ_PROFILING) {
+    return az_wprintf(writer, "Script profiling requires PROFILING=1.\n");
+  }
+  // Gather up all of the room scripts that have run at all, costliest first.
+  script_profile_row_t *rows =
+    AZ_ALLOC(AZ_MAX_NUM_ROOMS * AZ_NUM_SCRIPT_KINDS, script_profile_row_t);
+  int num_rows = 0;
+  az_script_profile_t total = {0};
+  for (az_room_key_t room = 0; room < AZ_MAX_NUM_ROOMS; ++room) {
+    for (int kind = 0; kind < AZ_NUM_SCRIPT_KINDS; ++kind) {
+      const az_script_profile_t *profile =
+        az_get_script_profile(room, (az_script_kind_t)kind);
+      if (profile->num_runs == 0) continue;
+      rows[num_rows++] = (script_profile_row_t){
+        .room = room, .kind = (az_script_kind_t)kind, .profile = profile };
+      total.num_runs += profile->num_runs;
+      total.num_instructions += profile->num_instructions;
+      total.total_ns += profile->total_ns;
+    }
+  }
+  qsort(rows, num_rows, sizeof(script_profile_row_t), compare_profile_rows);
+  bool ok = az_wprintf(writer, "Scripts: %llu runs, %llu instructions, "
+                       "%.3f ms total\n", (unsigned long long)total.num_runs,
+                       (unsigned long long)total.num_instructions,
+                       total.total_ns * 1e-6);
+  ok = ok && az_wprintf(writer, "  room  kind        runs  instructions  "
+                        "   total ms    us/run\n");
+  for (int i = 0; ok && i < num_rows; ++i) {
+    const az_script_profile_t *profile = rows[i].profile;
+    ok = az_wprintf(writer, "  %4d  %-8s %7llu  %12llu  %11.3f  %8.1f\n",
+                    rows[i].room, script_kind_name(rows[i].kind),
+                    (unsigned long long)profile->num_runs,
+                    (unsigned long long)profile->num_instructions,
+                    profile->total_ns * 1e-6,
+                    profile->total_ns * 1e-3 / profile->num_runs);
+  }
+  free(rows);
+  // Then list the opcodes that have executed, most frequent first.
+  az_opcode_t opcodes[AZ_OP_ERROR + 1];
+  for (int i = 0; i < AZ_ARRAY_SIZE(opcodes); ++i) {
+    opcodes[i] = (az_opcode_t)i;
+  }
+  qsort(opcodes, AZ_ARRAY_SIZE(opcodes), sizeof(az_opcode_t),
+        compare_opcode_counts);
+  ok = ok && az_wprintf(writer, "Opcodes:\n");
+  AZ_ARRAY_LOOP(opcode, opcodes) {
+    const uint64_t count = az_get_script_opcode_count(*opcode);
+    if (!ok || count == 0) break;
+    ok = az_wprintf(writer, "  %-8s %12llu\n", az_opcode_name(*opcode),
+                    (unsigned long long)count);
+  }
+  return ok;
+}
+
+/*===========================================================================*/
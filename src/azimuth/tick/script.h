@@ -21,8 +21,13 @@
 #ifndef AZIMUTH_TICK_SCRIPT_H_
 #define AZIMUTH_TICK_SCRIPT_H_
 
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "azimuth/state/player.h"
 #include "azimuth/state/script.h"
 #include "azimuth/state/space.h"
+#include "azimuth/util/rw.h"
 
 /*===========================================================================*/
 
@@ -38,4 +43,46 @@ void az_tick_timers(az_space_state_t *state, double time);
 
 /*===========================================================================*/
 
+// When AZ_PROFILING is set (see util/profile.h), the script VM counts every
+// instruction it executes by opcode, and charges each run (or resumption) of
+// a script, along with the instructions and time it took, to the room the
+// ship is in and the kind of script it is.  When AZ_PROFILING is disabled,
+// all of the counts stay at zero.
+
+typedef enum {
+  AZ_SCRIPT_OTHER = 0, // not found among the current room's scripts
+  AZ_SCRIPT_PLANET_START, // the planet's on_start script
+  AZ_SCRIPT_ON_START, // the room's on_start script
+  AZ_SCRIPT_ON_KILL, // a baddie's on_kill script
+  AZ_SCRIPT_ON_OPEN, // a door's on_open script
+  AZ_SCRIPT_ON_ENTER, // a gravfield's on_enter script
+  AZ_SCRIPT_ON_USE // a node's on_use script
+} az_script_kind_t;
+
+#define AZ_NUM_SCRIPT_KINDS (AZ_SCRIPT_ON_USE + 1)
+
+typedef struct {
+  uint64_t num_runs; // counting each resumption as a separate run
+  uint64_t num_instructions;
+  uint64_t total_ns;
+} az_script_profile_t;
+
+// Return the totals for the given kind of script in the given room.
+const az_script_profile_t *az_get_script_profile(az_room_key_t room,
+                                                 az_script_kind_t kind);
+
+// Return how many times instructions with the given opcode have executed
+// (counting each instruction within a superinstruction separately).
+uint64_t az_get_script_opcode_count(az_opcode_t opcode);
+
+// Set all script profile totals and opcode counts back to zero.
+void az_reset_script_profile(void);
+
+// Write a human-readable report of the script profile, with the costliest
+// room scripts and the most-executed opcodes first.  Returns true on
+// success, or false on failure.
+bool az_write_script_profile(az_writer_t *writer);
+
+/*===========================================================================*/
+
 #endif // AZIMUTH_TICK_SCRIPT_H_
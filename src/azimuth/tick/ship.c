@@ -396,25 +396,18 @@ static double ordn_power_mult(const az_player_t *player) {
           AZ_HIGH_EXPLOSIVES_POWER_MULTIPLIER : 1.0);
 }
 
-static double auto_aim_angle(const az_space_state_t *state, double limit,
+static double auto_aim_angle(az_space_state_t *state, double limit,
                              az_baddie_flags_t ignore_flag) {
   const az_vector_t start =
     az_vadd(state->ship.position, az_vpolar(18, state->ship.angle));
   const double forward = state->ship.angle;
-  double best_dist = INFINITY;
+  // The direction to the closest baddie within the limit, if it hasn't been
+  // beaten by a door; we only need an atan2 for the winner.
+  az_vector_t best_delta = AZ_VZERO;
+  bool aim_at_baddie = az_find_auto_aim_target(state, start, forward, limit,
+                                               ignore_flag, &best_delta);
+  double best_dist = (aim_at_baddie ? az_vnorm(best_delta) : INFINITY);
   double best_angle = forward;
-  AZ_ARRAY_LOOP(baddie, state->baddies) {
-    if (baddie->kind == AZ_BAD_NOTHING) continue;
-    if (az_baddie_has_flag(baddie, ignore_flag)) continue;
-    const az_vector_t delta = az_vsub(baddie->position, start);
-    const double dist = az_vnorm(delta);
-    if (dist >= best_dist) continue;
-    const double angle = az_vtheta(delta);
-    if (fabs(az_mod2pi(angle - forward)) <= limit) {
-      best_dist = dist;
-      best_angle = angle;
-    }
-  }
   AZ_ARRAY_LOOP(door, state->doors) {
     if (door->kind != AZ_DOOR_NORMAL) continue;
     if (door->is_open) continue;
@@ -424,9 +417,10 @@ static double auto_aim_angle(const az_space_state_t *state, double limit,
     if (az_ray_hits_bounding_circle(start, az_vpolar(dist, forward),
                                     door->position, AZ_DOOR_BOUNDING_RADIUS)) {
       best_dist = dist;
-      best_angle = forward;
+      aim_at_baddie = false;
     }
   }
+  if (aim_at_baddie) best_angle = az_vtheta(best_delta);
   return best_angle;
 }
 
@@ -1203,6 +1197,9 @@ void az_tick_ship(az_space_state_t *state, double time) {
   az_player_t *player = &ship->player;
   az_controls_t *controls = &ship->controls;
   if (ship->autopilot.enabled) AZ_ZERO_OBJECT(controls);
+  // The baddies have moved since the projectiles were ticked, so update the
+  // homing target list before anything auto-aims.
+  az_build_homing_targets(state);
 
   if (controls->ordn_held && !ship->ordn_held) {
     ship->ordn_held = true;
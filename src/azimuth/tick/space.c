@@ -24,6 +24,7 @@
 
 #include "azimuth/state/dialog.h"
 #include "azimuth/state/planet.h"
+#include "azimuth/state/room_builder.h"
 #include "azimuth/state/space.h"
 #include "azimuth/tick/baddie.h"
 #include "azimuth/tick/camera.h"
@@ -40,6 +41,7 @@
 #include "azimuth/tick/speck.h"
 #include "azimuth/tick/wall.h"
 #include "azimuth/util/misc.h"
+#include "azimuth/util/profile.h"
 #include "azimuth/util/random.h"
 #include "azimuth/util/vector.h"
 #include "azimuth/util/warning.h"
@@ -51,6 +53,9 @@
 #define WALL_REMOVAL_RADIUS 40.0
 
 void az_after_entering_room(az_space_state_t *state) {
+  // Discard any room build still around from before we entered this room (we
+  // need the room builder to be idle before we touch the room cache below).
+  if (state->room_builder != NULL) az_cancel_room_build(state->room_builder);
   // Mark the room as visited.
   az_set_room_visited(&state->ship.player, state->ship.player.current_room);
   // Remove destructible walls too near where the ship starts (so that the ship
@@ -61,10 +66,11 @@ void az_after_entering_room(az_space_state_t *state) {
     if (az_circle_touches_wall(
             wall, WALL_REMOVAL_RADIUS, state->ship.position)) {
       wall->kind = AZ_WALL_NOTHING;
+      az_reindex_wall(state, wall);
     }
   }
   const az_room_t *room =
-    &state->planet->rooms[state->ship.player.current_room];
+    az_get_room(state->planet, state->ship.player.current_room);
   state->camera.quake_vert = 0.0;
   state->camera.r_max_override = 0.0;
   state->console_help_message_cooldown = 0.0;
@@ -78,6 +84,35 @@ void az_after_entering_room(az_space_state_t *state) {
   state->camera.center = az_clamp_to_bounds_with_override(
       &room->camera_bounds, state->ship.position,
       state->camera.r_max_override);
+  // Load the rooms we might go to next now, rather than when we go through
+  // the door.
+  az_prefetch_neighbor_rooms(state->planet, state->ship.player.current_room);
+}
+
+// How close the ship must be to a door before we start building the objects
+// for the room on the other side in the background:
+#define DOOR_APPROACH_DISTANCE 200.0
+
+// If the ship is approaching a door, ask the room builder (if any) to start
+// building the room on the other side, so that it's ready by the time we go
+// through the door.
+static void prebuild_approached_room(az_space_state_t *state) {
+  if (state->room_builder == NULL) return;
+  const az_door_t *nearest = NULL;
+  double best_dist = DOOR_APPROACH_DISTANCE;
+  AZ_ARRAY_LOOP(door, state->doors) {
+    if (door->kind == AZ_DOOR_NOTHING) continue;
+    if (door->kind == AZ_DOOR_FORCEFIELD) continue;
+    const double dist = az_vdist(door->position, state->ship.position);
+    if (dist < best_dist) {
+      best_dist = dist;
+      nearest = door;
+    }
+  }
+  if (nearest != NULL) {
+    az_request_room_build(state->room_builder, state->planet,
+                          &state->ship.player, nearest->destination);
+  }
 }
 
 /*===========================================================================*/
@@ -313,6 +348,12 @@ static void tick_doorway_mode(az_space_state_t *state, double time) {
       assert(mode_data->entrance.kind != AZ_DOOR_NOTHING);
       assert(mode_data->entrance.kind != AZ_DOOR_FORCEFIELD);
       assert(mode_data->exit.kind == AZ_DOOR_NOTHING);
+      // Usually the room build will have started as the ship approached the
+      // door, but if not, start it now.
+      if (state->room_builder != NULL) {
+        az_request_room_build(state->room_builder, state->planet,
+                              &state->ship.player, mode_data->destination);
+      }
       mode_data->progress += time / fade_time;
       if (mode_data->progress >= 1.0) {
         // Replace state with new room data.
@@ -322,9 +363,15 @@ static void tick_doorway_mode(az_space_state_t *state, double time) {
         const az_room_key_t dest_key = mode_data->destination;
         az_clear_space(state);
         assert(0 <= dest_key && dest_key < state->planet->num_rooms);
-        const az_room_t *new_room = &state->planet->rooms[dest_key];
+        // Install the prebuilt room objects if we have them, or else build
+        // them now.  (We have to take the build before getting the room; see
+        // room_builder.h.)
+        const bool prebuilt = (state->room_builder != NULL &&
+                               az_take_room_build(state->room_builder, state,
+                                                  dest_key));
+        const az_room_t *new_room = az_get_room(state->planet, dest_key);
         const az_zone_key_t new_zone_key = new_room->zone_key;
-        az_enter_room(state, new_room);
+        if (!prebuilt) az_enter_room(state, new_room);
         state->ship.player.current_room = dest_key;
         // Pick a door to exit out of.
         double best_dist = INFINITY;
@@ -694,13 +741,13 @@ static void tick_nuke(az_space_state_t *state, double time) {
 
 static void tick_most_objects(az_space_state_t *state, double time) {
   tick_darkness(state, time);
-  az_tick_pickups(state, time);
-  az_tick_gravfields(state, time);
-  az_tick_walls(state, time);
-  az_tick_doors(state, time);
-  az_tick_projectiles(state, time);
+  AZ_PROFILE("az_tick_pickups", az_tick_pickups(state, time));
+  AZ_PROFILE("az_tick_gravfields", az_tick_gravfields(state, time));
+  AZ_PROFILE("az_tick_walls", az_tick_walls(state, time));
+  AZ_PROFILE("az_tick_doors", az_tick_doors(state, time));
+  AZ_PROFILE("az_tick_projectiles", az_tick_projectiles(state, time));
   tick_nuke(state, time);
-  az_tick_baddies(state, time);
+  AZ_PROFILE("az_tick_baddies", az_tick_baddies(state, time));
 }
 
 static void tick_all_objects(az_space_state_t *state, double time) {
@@ -708,8 +755,10 @@ static void tick_all_objects(az_space_state_t *state, double time) {
   // We just ticked baddies and projectiles, so the ship might've gotten blown
   // up and we could now be in game-over mode; only tick the ship if that's not
   // the case.
-  if (state->mode != AZ_MODE_GAME_OVER) az_tick_ship(state, time);
-  az_tick_nodes(state, time);
+  if (state->mode != AZ_MODE_GAME_OVER) {
+    AZ_PROFILE("az_tick_ship", az_tick_ship(state, time));
+  }
+  AZ_PROFILE("az_tick_nodes", az_tick_nodes(state, time));
 }
 
 // Hold the ship's persisted sounds for a frame while we're effectively paused
@@ -723,6 +772,9 @@ static void hold_ship_sounds(az_space_state_t *state) {
 /*===========================================================================*/
 
 void az_tick_space_state(az_space_state_t *state, double time) {
+  // Drop objects removed during the last frame from the pools' live lists.
+  az_collect_space_pools(state);
+
   // Cool down skip timer.
   if (state->skip.allowed) {
     assert(state->sync_vm.script != NULL);
@@ -764,9 +816,9 @@ void az_tick_space_state(az_space_state_t *state, double time) {
   // If we're fading the whole screen in or out, do that and then stop.
   if (state->global_fade.step != AZ_GFS_INACTIVE) {
     if (state->nuke.active) {
-      az_tick_particles(state, time);
-      az_tick_specks(state, time);
-      az_tick_projectiles(state, time);
+      AZ_PROFILE("az_tick_particles", az_tick_particles(state, time));
+      AZ_PROFILE("az_tick_specks", az_tick_specks(state, time));
+      AZ_PROFILE("az_tick_projectiles", az_tick_projectiles(state, time));
       tick_nuke(state, time);
     }
     tick_global_fade(state, time);
@@ -785,7 +837,7 @@ void az_tick_space_state(az_space_state_t *state, double time) {
         tick_dialogue(state, time);
       } else assert(false);
     }
-    az_tick_cutscene(state, time);
+    AZ_PROFILE("az_tick_cutscene", az_tick_cutscene(state, time));
     return;
   }
 
@@ -796,8 +848,8 @@ void az_tick_space_state(az_space_state_t *state, double time) {
   }
 
   // These ticks happen even during dialogue/monologue.
-  az_tick_particles(state, time);
-  az_tick_specks(state, time);
+  AZ_PROFILE("az_tick_particles", az_tick_particles(state, time));
+  AZ_PROFILE("az_tick_specks", az_tick_specks(state, time));
   tick_message(&state->message, time);
   tick_countdown(&state->countdown, time);
 
@@ -815,7 +867,7 @@ void az_tick_space_state(az_space_state_t *state, double time) {
 
   // If we're in dialogue, advance the dialogue and then stop.
   if (state->dialogue.step != AZ_DLS_INACTIVE) {
-    az_tick_doors(state, time);
+    AZ_PROFILE("az_tick_doors", az_tick_doors(state, time));
     tick_dialogue(state, time);
     return;
   } else assert(state->dialogue.paragraph == NULL);
@@ -835,25 +887,26 @@ void az_tick_space_state(az_space_state_t *state, double time) {
     case AZ_MODE_CONSOLE:
       tick_console_mode(state, time);
       tick_most_objects(state, time);
-      az_tick_nodes(state, time);
+      AZ_PROFILE("az_tick_nodes", az_tick_nodes(state, time));
       break;
     case AZ_MODE_DOORWAY:
       tick_doorway_mode(state, time);
       if (state->doorway_mode.step == AZ_DWS_FADE_IN) {
         tick_all_objects(state, time);
-        az_tick_timers(state, time);
+        AZ_PROFILE("az_tick_timers", az_tick_timers(state, time));
       } else hold_ship_sounds(state);
       break;
     case AZ_MODE_GAME_OVER:
       tick_game_over_mode(state, time);
       tick_most_objects(state, time);
-      az_tick_nodes(state, time);
+      AZ_PROFILE("az_tick_nodes", az_tick_nodes(state, time));
       break;
     case AZ_MODE_NORMAL:
       tick_console_help(state, time);
       tick_all_objects(state, time);
-      az_tick_timers(state, time);
+      AZ_PROFILE("az_tick_timers", az_tick_timers(state, time));
       check_countdown(state, time);
+      prebuild_approached_room(state);
       break;
     case AZ_MODE_PAUSING:
       AZ_ASSERT_UNREACHABLE(); // this mode is handled above
@@ -868,7 +921,7 @@ void az_tick_space_state(az_space_state_t *state, double time) {
       (state->mode == AZ_MODE_BOSS_DEATH &&
        state->boss_death_mode.boss.kind != AZ_BAD_NOTHING ?
        state->boss_death_mode.boss.position : state->ship.position);
-    az_tick_camera(state, goal, time);
+    AZ_PROFILE("az_tick_camera", az_tick_camera(state, goal, time));
   }
 }
 
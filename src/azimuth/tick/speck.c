@@ -19,9 +19,14 @@
 
 #include "azimuth/tick/speck.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "azimuth/state/space.h"
 #include "azimuth/state/speck.h"
 #include "azimuth/util/misc.h"
+#include "azimuth/util/vector.h"
 
 /*===========================================================================*/
 
@@ -32,10 +37,55 @@ void az_tick_speck(az_speck_t *speck, double time) {
   else az_vpluseq(&speck->position, az_vmul(speck->velocity, time));
 }
 
-void az_tick_specks(az_space_state_t *state, double time) {
-  AZ_ARRAY_LOOP(speck, state->specks) {
-    az_tick_speck(speck, time);
+/*===========================================================================*/
+
+AZ_STATIC_ASSERT(sizeof(az_vector_t) == 2 * sizeof(double));
+
+// Advance the age and position of every speck in the array.  Each SSE2
+// register holds either one whole vector or two ages.
+static void integrate_specks(az_speck_array_t *specks, double time) {
+  const int count = specks->count;
+  int i = 0;
+#if defined(__SSE2__)
+  const __m128d dt = _mm_set1_pd(time);
+  for (; i + 1 < count; i += 2) {
+    _mm_storeu_pd(&specks->age[i],
+                  _mm_add_pd(_mm_loadu_pd(&specks->age[i]), dt));
+    for (int j = i; j < i + 2; ++j) {
+      double *position = &specks->position[j].x;
+      const __m128d velocity = _mm_loadu_pd(&specks->velocity[j].x);
+      _mm_storeu_pd(position, _mm_add_pd(_mm_loadu_pd(position),
+                                         _mm_mul_pd(velocity, dt)));
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    specks->age[i] += time;
+    az_vpluseq(&specks->position[i], az_vmul(specks->velocity[i], time));
   }
 }
 
+// Remove expired specks, shifting the remaining specks down to keep the
+// arrays dense (and preserving their order).
+static void compact_specks(az_speck_array_t *specks) {
+  int num_kept = 0;
+  for (int i = 0; i < specks->count; ++i) {
+    if (specks->age[i] > specks->lifetime[i]) continue;
+    if (num_kept != i) {
+      specks->color[num_kept] = specks->color[i];
+      specks->position[num_kept] = specks->position[i];
+      specks->velocity[num_kept] = specks->velocity[i];
+      specks->age[num_kept] = specks->age[i];
+      specks->lifetime[num_kept] = specks->lifetime[i];
+    }
+    ++num_kept;
+  }
+  specks->count = num_kept;
+}
+
+void az_tick_specks(az_space_state_t *state, double time) {
+  integrate_specks(&state->specks, time);
+  compact_specks(&state->specks);
+}
+
 /*===========================================================================*/
@@ -24,6 +24,7 @@
 #include <stdbool.h>
 
 #include "azimuth/util/misc.h"
+#include "azimuth/util/thread.h"
 #include "azimuth/util/warning.h"
 
 /*===========================================================================*/
@@ -47,19 +48,29 @@ void az_change_music_flag(az_soundboard_t *soundboard, int flag) {
 
 void az_play_sound_data(az_soundboard_t *soundboard,
                         const az_sound_data_t *sound_data, float volume) {
+  az_play_panned_sound_data(soundboard, sound_data, volume, 0.0f);
+}
+
+void az_play_panned_sound_data(az_soundboard_t *soundboard,
+                               const az_sound_data_t *sound_data,
+                               float volume, float pan) {
   assert(volume >= 0.0f && volume <= 1.0f);
+  assert(pan >= -1.0f && pan <= 1.0f);
   if (sound_data == NULL) return;
   if (soundboard->num_oneshots < AZ_ARRAY_SIZE(soundboard->oneshots)) {
     // Don't start the same sound more than once in the same frame.
     for (int i = 0; i < soundboard->num_oneshots; ++i) {
       if (soundboard->oneshots[i].sound_data == sound_data) {
-        soundboard->oneshots[i].volume =
-          fmaxf(volume, soundboard->oneshots[i].volume);
+        if (volume > soundboard->oneshots[i].volume) {
+          soundboard->oneshots[i].volume = volume;
+          soundboard->oneshots[i].pan = pan;
+        }
         return;
       }
     }
     soundboard->oneshots[soundboard->num_oneshots].sound_data = sound_data;
     soundboard->oneshots[soundboard->num_oneshots].volume = volume;
+    soundboard->oneshots[soundboard->num_oneshots].pan = pan;
     ++soundboard->num_oneshots;
   }
 }
@@ -111,3 +122,125 @@ void az_reset_sound_data(az_soundboard_t *soundboard,
 }
 
 /*===========================================================================*/
+
+// The queue's commands array must be a power of two in size, so that masking
+// the counts still works when they wrap around.
+AZ_STATIC_ASSERT((AZ_AUDIO_QUEUE_SIZE & (AZ_AUDIO_QUEUE_SIZE - 1)) == 0);
+
+// Return how many commands the producer can push without overwriting any that
+// the consumer hasn't popped yet.
+static uint32_t queue_space(az_audio_queue_t *queue) {
+  const uint32_t read_count = AZ_ATOMIC_LOAD_ACQUIRE(&queue->read_count);
+  return AZ_AUDIO_QUEUE_SIZE - (queue->write_count - read_count);
+}
+
+// Store a command at the given position past the end of the queue, without
+// yet making it visible to the consumer.
+static void put_command(az_audio_queue_t *queue, uint32_t offset,
+                        const az_audio_command_t *command) {
+  queue->commands[(queue->write_count + offset) &
+                  (AZ_AUDIO_QUEUE_SIZE - 1)] = *command;
+}
+
+bool az_push_soundboard(az_audio_queue_t *queue,
+                        const az_soundboard_t *soundboard) {
+  const uint32_t num_commands = soundboard->num_oneshots +
+    soundboard->num_persists + (soundboard->change_music ? 1 : 0) +
+    (soundboard->change_current_music_flag ? 1 : 0) + 1;
+  if (queue_space(queue) < num_commands) return false;
+  uint32_t offset = 0;
+  if (soundboard->change_current_music_flag) {
+    put_command(queue, offset++, &(az_audio_command_t){
+        .kind = AZ_AUDIO_CMD_SET_MUSIC_FLAG,
+        .flag = soundboard->new_current_music_flag });
+  }
+  if (soundboard->change_music) {
+    put_command(queue, offset++, &(az_audio_command_t){
+        .kind = AZ_AUDIO_CMD_CHANGE_MUSIC, .music = soundboard->next_music,
+        .fade_out_seconds = soundboard->music_fade_out_seconds,
+        .change_flag = soundboard->change_next_music_flag,
+        .flag = soundboard->new_next_music_flag });
+  } else assert(!soundboard->change_next_music_flag);
+  for (int i = 0; i < soundboard->num_persists; ++i) {
+    put_command(queue, offset++, &(az_audio_command_t){
+        .kind = AZ_AUDIO_CMD_PERSIST,
+        .sound_data = soundboard->persists[i].sound_data,
+        .volume = soundboard->persists[i].volume,
+        .play = soundboard->persists[i].play,
+        .loop = soundboard->persists[i].loop,
+        .reset = soundboard->persists[i].reset });
+  }
+  for (int i = 0; i < soundboard->num_oneshots; ++i) {
+    put_command(queue, offset++, &(az_audio_command_t){
+        .kind = AZ_AUDIO_CMD_PLAY,
+        .sound_data = soundboard->oneshots[i].sound_data,
+        .volume = soundboard->oneshots[i].volume,
+        .pan = soundboard->oneshots[i].pan });
+  }
+  put_command(queue, offset++,
+              &(az_audio_command_t){ .kind = AZ_AUDIO_CMD_END_FRAME });
+  assert(offset == num_commands);
+  // Publish all of the commands at once, so that the consumer never sees
+  // part of a soundboard.
+  AZ_ATOMIC_STORE_RELEASE(&queue->write_count, queue->write_count + offset);
+  return true;
+}
+
+bool az_push_audio_command(az_audio_queue_t *queue,
+                           const az_audio_command_t *command) {
+  if (queue_space(queue) < 1) return false;
+  put_command(queue, 0, command);
+  AZ_ATOMIC_STORE_RELEASE(&queue->write_count, queue->write_count + 1);
+  return true;
+}
+
+bool az_pop_audio_command(az_audio_queue_t *queue,
+                          az_audio_command_t *command_out) {
+  const uint32_t write_count = AZ_ATOMIC_LOAD_ACQUIRE(&queue->write_count);
+  if (write_count == queue->read_count) return false;
+  *command_out =
+    queue->commands[queue->read_count & (AZ_AUDIO_QUEUE_SIZE - 1)];
+  AZ_ATOMIC_STORE_RELEASE(&queue->read_count, queue->read_count + 1);
+  return true;
+}
+
+void az_apply_audio_command(const az_audio_command_t *command,
+                            az_soundboard_t *soundboard) {
+  switch (command->kind) {
+    case AZ_AUDIO_CMD_PLAY:
+      if (soundboard->num_oneshots < AZ_ARRAY_SIZE(soundboard->oneshots)) {
+        const int index = soundboard->num_oneshots++;
+        soundboard->oneshots[index].sound_data = command->sound_data;
+        soundboard->oneshots[index].volume = command->volume;
+        soundboard->oneshots[index].pan = command->pan;
+      }
+      break;
+    case AZ_AUDIO_CMD_PERSIST:
+      if (soundboard->num_persists < AZ_ARRAY_SIZE(soundboard->persists)) {
+        const int index = soundboard->num_persists++;
+        soundboard->persists[index].sound_data = command->sound_data;
+        soundboard->persists[index].volume = command->volume;
+        soundboard->persists[index].play = command->play;
+        soundboard->persists[index].loop = command->loop;
+        soundboard->persists[index].reset = command->reset;
+      }
+      break;
+    case AZ_AUDIO_CMD_CHANGE_MUSIC:
+      soundboard->change_music = true;
+      soundboard->next_music = command->music;
+      soundboard->music_fade_out_seconds = command->fade_out_seconds;
+      soundboard->change_next_music_flag = command->change_flag;
+      soundboard->new_next_music_flag = command->flag;
+      break;
+    case AZ_AUDIO_CMD_SET_MUSIC_FLAG:
+      soundboard->change_current_music_flag = true;
+      soundboard->new_current_music_flag = command->flag;
+      break;
+    case AZ_AUDIO_CMD_END_FRAME:
+    case AZ_AUDIO_CMD_MUSIC_VOLUME:
+    case AZ_AUDIO_CMD_SOUND_VOLUME:
+      AZ_ASSERT_UNREACHABLE();
+  }
+}
+
+/*===========================================================================*/
@@ -22,6 +22,7 @@
 #define AZIMUTH_UTIL_AUDIO_H_
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "azimuth/util/music.h"
 #include "azimuth/util/sound.h"
@@ -41,6 +42,7 @@ typedef struct {
   struct {
     const az_sound_data_t *sound_data;
     float volume; // 0 to 1
+    float pan; // -1 (left) to 1 (right)
   } oneshots[10];
   int num_persists;
   struct {
@@ -66,6 +68,13 @@ void az_change_music_flag(az_soundboard_t *soundboard, int flag);
 void az_play_sound_data(az_soundboard_t *soundboard,
                         const az_sound_data_t *sound_data, float volume);
 
+// Like az_play_sound_data, but pan the sound towards the left (-1) or right
+// (1) speaker.  If the same sound is played more than once in a frame, the
+// loudest one determines the pan.
+void az_play_panned_sound_data(az_soundboard_t *soundboard,
+                               const az_sound_data_t *sound_data,
+                               float volume, float pan);
+
 // Indicate that we should start playing, or continue to play, the given sound.
 // To keep the sound going, we must call this function every frame with the
 // same sound, otherwise the sound will stop.  As long as we keep calling this
@@ -96,4 +105,66 @@ void az_reset_sound_data(az_soundboard_t *soundboard,
 
 /*===========================================================================*/
 
+// An audio command is one entry in an az_audio_queue_t.  A soundboard is sent
+// as a series of commands followed by AZ_AUDIO_CMD_END_FRAME.
+typedef enum {
+  AZ_AUDIO_CMD_PLAY, // start a one-shot sound
+  AZ_AUDIO_CMD_PERSIST, // play, loop, hold, or stop a persisted sound
+  AZ_AUDIO_CMD_CHANGE_MUSIC, // fade out to new music
+  AZ_AUDIO_CMD_SET_MUSIC_FLAG, // set the current music's flag
+  AZ_AUDIO_CMD_END_FRAME, // apply the soundboard built up since the last one
+  AZ_AUDIO_CMD_MUSIC_VOLUME, // set the global music volume
+  AZ_AUDIO_CMD_SOUND_VOLUME // set the global sound effect volume
+} az_audio_command_kind_t;
+
+typedef struct {
+  az_audio_command_kind_t kind;
+  const az_sound_data_t *sound_data; // for PLAY and PERSIST
+  const az_music_t *music; // for CHANGE_MUSIC
+  float volume; // for PLAY, PERSIST, and the VOLUME commands
+  float pan; // for PLAY
+  double fade_out_seconds; // for CHANGE_MUSIC
+  int flag; // for SET_MUSIC_FLAG, and CHANGE_MUSIC if change_flag is set
+  bool play, loop, reset; // for PERSIST
+  bool change_flag; // for CHANGE_MUSIC
+} az_audio_command_t;
+
+// Must be a power of two.  A soundboard takes at most 23 commands.
+#define AZ_AUDIO_QUEUE_SIZE 512
+
+// A lock-free ring buffer of audio commands, for sending commands from one
+// producer thread (the game) to one consumer thread (the audio callback)
+// without either one ever having to wait for the other.  Zero it to
+// initialize it.  Only the producer may push, and only the consumer may pop.
+typedef struct {
+  az_audio_command_t commands[AZ_AUDIO_QUEUE_SIZE];
+  // These count up forever (wrapping around at UINT32_MAX), and are masked
+  // to index into the commands array.
+  uint32_t read_count; // written only by the consumer
+  uint32_t write_count; // written only by the producer
+} az_audio_queue_t;
+
+// Push commands for everything in the soundboard, followed by an END_FRAME
+// command.  Either all of the commands are pushed or (if the queue doesn't
+// have room for all of them) none are, in which case this returns false.
+bool az_push_soundboard(az_audio_queue_t *queue,
+                        const az_soundboard_t *soundboard);
+
+// Push a single command.  Returns false if the queue is full.
+bool az_push_audio_command(az_audio_queue_t *queue,
+                           const az_audio_command_t *command);
+
+// Pop the oldest command from the queue.  Returns false if the queue is
+// empty.
+bool az_pop_audio_command(az_audio_queue_t *queue,
+                          az_audio_command_t *command_out);
+
+// Add a PLAY, PERSIST, CHANGE_MUSIC, or SET_MUSIC_FLAG command back into a
+// soundboard, so that the soundboards built up between END_FRAME commands
+// match the soundboards that were pushed.
+void az_apply_audio_command(const az_audio_command_t *command,
+                            az_soundboard_t *soundboard);
+
+/*===========================================================================*/
+
 #endif // AZIMUTH_UTIL_AUDIO_H_
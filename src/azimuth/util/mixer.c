@@ -0,0 +1,251 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#include "azimuth/util/mixer.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "azimuth/util/misc.h"
+#include "azimuth/util/sound.h"
+#include "azimuth/util/vector.h"
+
+/*===========================================================================*/
+
+// Samples whose magnitude (on a scale of 0 to 1) is below this pass through
+// az_soft_clip unchanged:
+#define SOFT_CLIP_THRESHOLD 0.75f
+
+// The scale of the mix, which matches that of 16-bit samples:
+#define MIX_SCALE 32768.0f
+
+// Convert the fractional part of a 32.32 fixed-point position to a float:
+#define FRACTION(position) \
+  ((float)((position) & UINT64_C(0xffffffff)) * (1.0f / 4294967296.0f))
+
+void az_pan_gains(float pan, float *left_out, float *right_out) {
+  const float theta =
+    (fminf(fmaxf(pan, -1.0f), 1.0f) + 1.0f) * (float)(AZ_PI / 4.0);
+  *left_out = fminf(1.0f, 1.41421356f * cosf(theta));
+  *right_out = fminf(1.0f, 1.41421356f * sinf(theta));
+}
+
+float az_soft_clip(float sample) {
+  // Past the threshold, map the excess x to x/(1+x), which has unit slope at
+  // zero (so the curve is smooth) and approaches one (so it never clips).
+  const float magnitude = fabsf(sample);
+  const float excess = fmaxf(magnitude - SOFT_CLIP_THRESHOLD, 0.0f) /
+    (1.0f - SOFT_CLIP_THRESHOLD);
+  return copysignf(fminf(magnitude, SOFT_CLIP_THRESHOLD) +
+                   (1.0f - SOFT_CLIP_THRESHOLD) * excess / (1.0f + excess),
+                   sample);
+}
+
+/*===========================================================================*/
+
+void az_init_mixer(az_mixer_t *mixer, int output_rate, int num_channels) {
+  assert(output_rate >= AZ_AUDIO_RATE);
+  assert(num_channels >= 1 && num_channels <= AZ_MIXER_MAX_CHANNELS);
+  AZ_ZERO_OBJECT(mixer);
+  mixer->output_rate = output_rate;
+  mixer->num_channels = num_channels;
+  mixer->step = ((uint64_t)AZ_AUDIO_RATE << 32) / (uint64_t)output_rate;
+}
+
+az_mixer_voice_t *az_start_mixer_voice(az_mixer_t *mixer,
+                                       const az_sound_data_t *data,
+                                       int priority) {
+  assert(data != NULL);
+  assert(data->num_samples > 0);
+  az_mixer_voice_t *chosen = NULL;
+  AZ_ARRAY_LOOP(voice, mixer->voices) {
+    if (voice->data == NULL) {
+      chosen = voice;
+      break;
+    }
+    if (chosen == NULL || voice->priority < chosen->priority ||
+        (voice->priority == chosen->priority &&
+         voice->start_count < chosen->start_count)) {
+      chosen = voice;
+    }
+  }
+  assert(chosen != NULL);
+  if (chosen->data != NULL && chosen->priority > priority) return NULL;
+  AZ_ZERO_OBJECT(chosen);
+  chosen->data = data;
+  chosen->volume = 1.0f;
+  chosen->priority = priority;
+  chosen->start_count = ++mixer->num_started;
+  return chosen;
+}
+
+/*===========================================================================*/
+
+// Add a mono block to each channel of the mix, with a separate gain for each
+// channel.  With SSE2, four frames are handled at a time; the scalar loops
+// finish off whatever is left (or do all the work without SSE2).
+static void add_to_mix(const az_mixer_t *mixer, const float *restrict block,
+                       const float *gains, float *restrict mix,
+                       int num_frames) {
+  int i = 0;
+  if (mixer->num_channels == 1) {
+    const float gain = gains[0];
+#if defined(__SSE2__)
+    const __m128 gain4 = _mm_set1_ps(gain);
+    for (; i + 3 < num_frames; i += 4) {
+      const __m128 in = _mm_loadu_ps(block + i);
+      _mm_storeu_ps(mix + i, _mm_add_ps(_mm_loadu_ps(mix + i),
+                                        _mm_mul_ps(gain4, in)));
+    }
+#endif
+    for (; i < num_frames; ++i) mix[i] += gain * block[i];
+  } else {
+    assert(mixer->num_channels == 2);
+    const float left = gains[0], right = gains[1];
+#if defined(__SSE2__)
+    // Duplicate each input sample into a left/right pair, so that two frames
+    // of input line up with one register of interleaved output.
+    const __m128 pan = _mm_setr_ps(left, right, left, right);
+    for (; i + 3 < num_frames; i += 4) {
+      const __m128 in = _mm_loadu_ps(block + i);
+      float *out = mix + 2 * i;
+      _mm_storeu_ps(out, _mm_add_ps(_mm_loadu_ps(out), _mm_mul_ps(
+          pan, _mm_unpacklo_ps(in, in))));
+      _mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(out + 4), _mm_mul_ps(
+          pan, _mm_unpackhi_ps(in, in))));
+    }
+#endif
+    for (; i < num_frames; ++i) {
+      mix[2 * i] += left * block[i];
+      mix[2 * i + 1] += right * block[i];
+    }
+  }
+}
+
+int az_music_samples_needed(const az_mixer_t *mixer, int num_frames) {
+  assert(num_frames >= 0);
+  return (int)((mixer->music_phase + (uint64_t)num_frames * mixer->step) >>
+               32);
+}
+
+void az_mix_music(az_mixer_t *mixer, const int16_t *samples, float start_gain,
+                  float gain_step, float *mix, int num_frames) {
+  assert(num_frames <= AZ_MIXER_BLOCK_FRAMES);
+  const int num_samples = az_music_samples_needed(mixer, num_frames);
+  // Since the step is at most one, we need at most one input sample per
+  // output frame, plus the two we're already between.
+  float input[AZ_MIXER_BLOCK_FRAMES + 2];
+  assert(num_samples <= AZ_MIXER_BLOCK_FRAMES);
+  input[0] = mixer->music_prev;
+  input[1] = mixer->music_next;
+  for (int i = 0; i < num_samples; ++i) input[i + 2] = samples[i];
+  float block[AZ_MIXER_BLOCK_FRAMES];
+  for (int i = 0; i < num_frames; ++i) {
+    const uint64_t position = mixer->music_phase + (uint64_t)i * mixer->step;
+    const float *in = input + (position >> 32);
+    const float gain = fmaxf(0.0f, start_gain + gain_step * i);
+    block[i] = gain * (in[0] + (in[1] - in[0]) * FRACTION(position));
+  }
+  const float gains[AZ_MIXER_MAX_CHANNELS] = {1.0f, 1.0f};
+  add_to_mix(mixer, block, gains, mix, num_frames);
+  const uint64_t end = mixer->music_phase + (uint64_t)num_frames * mixer->step;
+  assert((end >> 32) == (uint64_t)num_samples);
+  mixer->music_prev = input[num_samples];
+  mixer->music_next = input[num_samples + 1];
+  mixer->music_phase = (uint32_t)end;
+}
+
+// Resample the next num_frames frames of the voice's sound into the block,
+// advancing the voice.  Returns false (after filling the rest of the block
+// with silence) if a non-looping sound reaches its end.
+static bool render_voice(az_mixer_voice_t *voice, uint64_t step, float *block,
+                         int num_frames) {
+  const int16_t *samples = voice->data->samples;
+  const uint64_t num_samples = voice->data->num_samples;
+  // The position of the last sample; before this, we can interpolate between
+  // two samples without worrying about the end of the sound.
+  const uint64_t last = (num_samples - 1) << 32;
+  int index = 0;
+  while (index < num_frames) {
+    const uint64_t position = voice->position;
+    if (position < last) {
+      const int run = az_imin(num_frames - index,
+                              (int)((last - position + step - 1) / step));
+      for (int i = 0; i < run; ++i) {
+        const uint64_t pos = position + (uint64_t)i * step;
+        const int16_t *in = samples + (pos >> 32);
+        block[index + i] = in[0] + (in[1] - in[0]) * FRACTION(pos);
+      }
+      voice->position += (uint64_t)run * step;
+      index += run;
+    } else if (position < (num_samples << 32)) {
+      // Between the last sample and whatever comes after the sound:
+      const float prev = samples[num_samples - 1];
+      const float next = (voice->loop ? samples[0] : 0.0f);
+      block[index++] = prev + (next - prev) * FRACTION(position);
+      voice->position += step;
+    } else if (voice->loop) {
+      voice->position -= num_samples << 32;
+    } else {
+      for (; index < num_frames; ++index) block[index] = 0.0f;
+      return false;
+    }
+  }
+  return true;
+}
+
+void az_mix_voices(az_mixer_t *mixer, float gain, float *mix, int num_frames) {
+  assert(num_frames <= AZ_MIXER_BLOCK_FRAMES);
+  AZ_ARRAY_LOOP(voice, mixer->voices) {
+    if (voice->data == NULL) continue;
+    if (voice->paused || voice->finished) {
+      assert(voice->persisted);
+      continue;
+    }
+    assert(!voice->loop || voice->persisted);
+    float block[AZ_MIXER_BLOCK_FRAMES];
+    const bool playing = render_voice(voice, mixer->step, block, num_frames);
+    float gains[AZ_MIXER_MAX_CHANNELS];
+    if (mixer->num_channels == 1) gains[0] = 1.0f;
+    else az_pan_gains(voice->pan, &gains[0], &gains[1]);
+    for (int i = 0; i < mixer->num_channels; ++i) {
+      gains[i] *= gain * voice->volume;
+    }
+    add_to_mix(mixer, block, gains, mix, num_frames);
+    if (!playing) {
+      if (voice->persisted) voice->finished = true;
+      else AZ_ZERO_OBJECT(voice);
+    }
+  }
+}
+
+void az_soft_clip_mix(const float *mix, int16_t *samples, int num_samples) {
+  for (int i = 0; i < num_samples; ++i) {
+    const float sample = MIX_SCALE * az_soft_clip(mix[i] * (1.0f / MIX_SCALE));
+    samples[i] = (int16_t)fminf(sample, MIX_SCALE - 1.0f);
+  }
+}
+
+/*===========================================================================*/
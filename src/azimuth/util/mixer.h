@@ -0,0 +1,120 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#pragma once
+#ifndef AZIMUTH_UTIL_MIXER_H_
+#define AZIMUTH_UTIL_MIXER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "azimuth/util/sound.h"
+
+/*===========================================================================*/
+
+// How many sound effects a mixer can play simultaneously:
+#define AZ_MIXER_MAX_VOICES 32
+// The most output channels a mixer supports (i.e. stereo):
+#define AZ_MIXER_MAX_CHANNELS 2
+// The most frames that can be mixed by one call to az_mix_music or
+// az_mix_voices; callers should mix larger buffers in blocks of this size.
+#define AZ_MIXER_BLOCK_FRAMES 256
+
+// One sound effect being played by a mixer.  A voice is free if its data
+// field is NULL.
+typedef struct {
+  const az_sound_data_t *data;
+  // Position within data->samples, as 32.32 fixed point:
+  uint64_t position;
+  float volume; // 0 to 1
+  float pan; // -1 (left) to 1 (right)
+  // When all voices are busy, a new sound may take over the voice with the
+  // lowest priority (and, among those, the oldest), but only if that
+  // priority is no higher than its own (see az_start_mixer_voice).
+  int priority;
+  uint64_t start_count; // larger for more recently started voices
+  bool loop, persisted, paused, finished;
+} az_mixer_voice_t;
+
+// A mixer combines music and sound effects (which are all generated at
+// AZ_AUDIO_RATE) into interleaved frames at its own output rate, which may be
+// higher.  The mix is accumulated as floats in the scale of 16-bit samples,
+// and converted to 16-bit output with az_soft_clip_mix.
+typedef struct {
+  int output_rate; // frames per second; at least AZ_AUDIO_RATE
+  int num_channels; // 1 or 2
+  // How far to advance through the input for each output frame, as 32.32
+  // fixed point:
+  uint64_t step;
+  uint64_t num_started;
+  az_mixer_voice_t voices[AZ_MIXER_MAX_VOICES];
+  // Music is resampled by interpolating between the last two input samples
+  // consumed; music_phase is how far we are between them, as 0.32 fixed
+  // point.
+  uint32_t music_phase;
+  float music_prev, music_next;
+} az_mixer_t;
+
+// Reset the mixer to play nothing, with the given output format.
+void az_init_mixer(az_mixer_t *mixer, int output_rate, int num_channels);
+
+// Find a voice for a new sound, stealing one from a lower-priority (or older
+// equal-priority) sound if necessary.  Returns NULL if every voice is busy
+// with a higher-priority sound.  The returned voice is set to the start of
+// the given sound with full volume, no pan, and no other flags set.
+az_mixer_voice_t *az_start_mixer_voice(az_mixer_t *mixer,
+                                       const az_sound_data_t *data,
+                                       int priority);
+
+// Return the number of music samples that az_mix_music needs in order to
+// produce the given number of output frames.
+int az_music_samples_needed(const az_mixer_t *mixer, int num_frames);
+
+// Resample the given music samples (of which there must be exactly
+// az_music_samples_needed(mixer, num_frames)) and add them to all channels of
+// the mix, scaled by a gain that starts at start_gain and changes by
+// gain_step each frame (but never drops below zero).
+void az_mix_music(az_mixer_t *mixer, const int16_t *samples, float start_gain,
+                  float gain_step, float *mix, int num_frames);
+
+// Add all unpaused voices to the mix, scaled by their volumes and the given
+// gain, and panned according to their pan values.  Voices that reach the end
+// of their sound either loop, become finished (if persisted), or are freed.
+void az_mix_voices(az_mixer_t *mixer, float gain, float *mix, int num_frames);
+
+// Convert mixed samples to 16-bit, softly limiting any that would otherwise
+// clip.
+void az_soft_clip_mix(const float *mix, int16_t *samples, int num_samples);
+
+/*===========================================================================*/
+
+// Get the left and right gains for a given pan (-1 to 1).  These follow a
+// constant-power curve, but are capped at one, so that a centered sound plays
+// at full volume in both channels.
+void az_pan_gains(float pan, float *left_out, float *right_out);
+
+// Limit a sample (nominally from -1 to 1) to strictly between -1 and 1.
+// Samples below a threshold pass through unchanged, and larger ones are
+// compressed smoothly towards the limit, so that loud mixes saturate rather
+// than clip.
+float az_soft_clip(float sample);
+
+/*===========================================================================*/
+
+#endif // AZIMUTH_UTIL_MIXER_H_
@@ -726,12 +726,11 @@ void az_destroy_music(az_music_t *music) {
 // The wave amplitude produced by an L100 note:
 #define BASE_LOUDNESS 6500.0
 
-static uint64_t generate_noise(void) {
+static uint64_t generate_noise(uint64_t *seed) {
   // This is a simple linear congruential generator, using the parameters
   // suggested by http://nuclear.llnl.gov/CNP/rng/rngman/node4.html
-  static uint64_t seed = UINT64_C(123456789123456789);
-  seed = UINT64_C(2862933555777941757) * seed + UINT64_C(3037000493);
-  return seed;
+  *seed = UINT64_C(2862933555777941757) * *seed + UINT64_C(3037000493);
+  return *seed;
 }
 
 static void synth_begin_next_part(az_music_synth_t *synth) {
@@ -774,67 +773,73 @@ static void synth_begin_next_part(az_music_synth_t *synth) {
   synth->stopped = true;
 }
 
-static void synth_advance(az_music_synth_t *synth) {
-  while (true) {
-    assert(synth->music != NULL);
-    if (synth->stopped) return;
-    int num_tracks_finished = 0;
-    AZ_ARRAY_LOOP(voice, synth->voices) {
-      while (true) {
-        assert(voice->track != NULL);
-        if (voice->note_index >= voice->track->num_notes) {
-          ++num_tracks_finished;
+// Move each voice on past any notes it has finished.  Returns true if every
+// track has finished all of its notes, meaning that it's time to begin the
+// next part.
+static bool synth_advance_voices(az_music_synth_t *synth) {
+  assert(synth->music != NULL);
+  assert(!synth->stopped);
+  int num_tracks_finished = 0;
+  AZ_ARRAY_LOOP(voice, synth->voices) {
+    while (true) {
+      assert(voice->track != NULL);
+      if (voice->note_index >= voice->track->num_notes) {
+        ++num_tracks_finished;
+        break;
+      }
+      const az_music_note_t *note = &voice->track->notes[voice->note_index];
+      switch (note->type) {
+        case AZ_NOTE_REST:
+          if (voice->time_from_note_start < note->attributes.rest.duration) {
+            goto sustain;
+          }
+          voice->time_from_note_start -= note->attributes.rest.duration;
+          break;
+        case AZ_NOTE_TONE:
+          if (voice->time_from_note_start < note->attributes.tone.duration) {
+            goto sustain;
+          }
+          voice->time_from_note_start -= note->attributes.tone.duration;
+          break;
+        case AZ_NOTE_DRUM:
+          if (voice->time_from_note_start <
+              note->attributes.drum.duration) {
+            goto sustain;
+          }
+          voice->time_from_note_start -= note->attributes.drum.duration;
+          break;
+        case AZ_NOTE_DUTYMOD:
+          voice->dutymod_depth = note->attributes.dutymod.depth;
+          voice->dutymod_speed = note->attributes.dutymod.speed;
+          break;
+        case AZ_NOTE_ENVELOPE:
+          voice->attack_time = note->attributes.envelope.attack_time;
+          voice->decay_fraction = note->attributes.envelope.decay_fraction;
+          break;
+        case AZ_NOTE_LOUDNESS:
+          voice->loudness = BASE_LOUDNESS * note->attributes.loudness.volume;
+          assert(voice->loudness >= 0.0);
+          break;
+        case AZ_NOTE_VIBRATO:
+          voice->vibrato_depth = note->attributes.vibrato.depth;
+          voice->vibrato_speed = note->attributes.vibrato.speed;
+          break;
+        case AZ_NOTE_WAVEFORM:
+          voice->waveform = note->attributes.waveform.kind;
+          voice->duty = note->attributes.waveform.duty;
           break;
-        }
-        const az_music_note_t *note = &voice->track->notes[voice->note_index];
-        switch (note->type) {
-          case AZ_NOTE_REST:
-            if (voice->time_from_note_start < note->attributes.rest.duration) {
-              goto sustain;
-            }
-            voice->time_from_note_start -= note->attributes.rest.duration;
-            break;
-          case AZ_NOTE_TONE:
-            if (voice->time_from_note_start < note->attributes.tone.duration) {
-              goto sustain;
-            }
-            voice->time_from_note_start -= note->attributes.tone.duration;
-            break;
-          case AZ_NOTE_DRUM:
-            if (voice->time_from_note_start <
-                note->attributes.drum.duration) {
-              goto sustain;
-            }
-            voice->time_from_note_start -= note->attributes.drum.duration;
-            break;
-          case AZ_NOTE_DUTYMOD:
-            voice->dutymod_depth = note->attributes.dutymod.depth;
-            voice->dutymod_speed = note->attributes.dutymod.speed;
-            break;
-          case AZ_NOTE_ENVELOPE:
-            voice->attack_time = note->attributes.envelope.attack_time;
-            voice->decay_fraction = note->attributes.envelope.decay_fraction;
-            break;
-          case AZ_NOTE_LOUDNESS:
-            voice->loudness = BASE_LOUDNESS * note->attributes.loudness.volume;
-            assert(voice->loudness >= 0.0);
-            break;
-          case AZ_NOTE_VIBRATO:
-            voice->vibrato_depth = note->attributes.vibrato.depth;
-            voice->vibrato_speed = note->attributes.vibrato.speed;
-            break;
-          case AZ_NOTE_WAVEFORM:
-            voice->waveform = note->attributes.waveform.kind;
-            voice->duty = note->attributes.waveform.duty;
-            break;
-        }
-        ++voice->note_index;
-        voice->drum_index = 0;
       }
-    sustain:
-      synth->steps_since_last_sustain = 0;
+      ++voice->note_index;
+      voice->drum_index = 0;
     }
-    if (num_tracks_finished < AZ_MUSIC_NUM_TRACKS) return;
+  sustain:
+    synth->steps_since_last_sustain = 0;
+  }
+  return num_tracks_finished == AZ_MUSIC_NUM_TRACKS;
+}
+
+static void synth_advance(az_music_synth_t *synth) {
+  while (!synth->stopped && synth_advance_voices(synth)) {
     synth_begin_next_part(synth);
   }
 }
@@ -850,96 +855,271 @@ void az_reset_music_synth(az_music_synth_t *synth, const az_music_t *music,
     voice->waveform = AZ_SQUARE_WAVE;
     voice->duty = 0.5;
     voice->loudness = BASE_LOUDNESS;
-    voice->noise_bits = generate_noise();
+    // Give each voice its own noise generator, so that the noise doesn't
+    // depend on what order the voices are rendered in.
+    voice->noise_seed = UINT64_C(123456789123456789) +
+      UINT64_C(0x9e3779b97f4a7c15) * (uint64_t)(voice - synth->voices);
+    voice->noise_bits = generate_noise(&voice->noise_seed);
   }
   synth_begin_next_part(synth);
   synth_advance(synth);
 }
 
-void az_synthesize_music(az_music_synth_t *synth, int16_t *samples,
-                         int num_samples) {
+// The most samples we'll render in one block.  Blocks are also cut short at
+// the next point where any voice might move on to its next note.
+#define MAX_BLOCK_SAMPLES 256
+
+// Return sin(2 * pi * turns), to within about 1e-8, using a polynomial rather
+// than calling sin().
+static double sin_turns(double turns) {
+  double q = turns - floor(turns + 0.5); // now -0.5 <= q < 0.5
+  if (q > 0.25) q = 0.5 - q;
+  else if (q < -0.25) q = -0.5 - q;
+  const double x = AZ_TWO_PI * q, x2 = x * x; // now -pi/2 <= x <= pi/2
+  return x * (1.0 + x2 * (-1.0 / 6.0 + x2 * (1.0 / 120.0 + x2 *
+              (-1.0 / 5040.0 + x2 * (1.0 / 362880.0 + x2 *
+               (-1.0 / 39916800.0))))));
+}
+
+// The per-period quantities for a tone oscillator, which only need to be
+// recomputed when the period changes (which, in the absence of vibrato, is
+// once per note).
+typedef struct {
+  int iperiod; // period, in virtual (supersampled) samples
+  double inv_period; // 1.0 / iperiod
+  // For sine waves, the sum of sin(a + j * d) for j from 1 to
+  // SYNTH_SUPERSAMPLE, where d = 2pi / iperiod, is sine_sum_scale times
+  // sin(a + (SYNTH_SUPERSAMPLE + 1) / 2 * d).
+  double sine_sum_scale;
+} az_oscillator_t;
+
+static void set_oscillator_period(az_oscillator_t *osc, double frequency,
+                                  double vibrato) {
+  const double period = 1.0 / (frequency * vibrato);
+  const int iperiod = (int)(AZ_AUDIO_RATE * SYNTH_SUPERSAMPLE * period);
+  if (iperiod == osc->iperiod) return;
+  osc->iperiod = iperiod;
+  osc->inv_period = 1.0 / iperiod;
+  const double half_step = 0.5 * osc->inv_period;
+  osc->sine_sum_scale =
+    sin_turns(SYNTH_SUPERSAMPLE * half_step) / sin_turns(half_step);
+}
+
+// Advance the voice's oscillator by one virtual sample at a time, the slow
+// way, and return the sum of the waveform over SYNTH_SUPERSAMPLE virtual
+// samples.  This handles the cases that oscillate() has no shortcut for.
+static double oscillate_slowly(az_music_voice_t *voice,
+                               const az_oscillator_t *osc, double duty) {
+  const int iperiod = osc->iperiod;
+  double amplitude = 0.0;
+  for (int s = 0; s < SYNTH_SUPERSAMPLE; ++s) {
+    ++voice->iphase;
+    if (voice->iphase >= iperiod) {
+      voice->iphase %= iperiod;
+      if (voice->waveform == AZ_NOISE_WAVE) {
+        voice->noise_bits = generate_noise(&voice->noise_seed);
+      }
+    }
+    const double phase = voice->iphase * osc->inv_period;
+    switch (voice->waveform) {
+      case AZ_NOISE_WAVE:
+        amplitude += ((voice->noise_bits >>
+                       (64 * voice->iphase / iperiod)) & 0x1 ? 1.0 : -1.0);
+        break;
+      case AZ_SINE_WAVE:
+        amplitude += sin_turns(phase);
+        break;
+      case AZ_SQUARE_WAVE:
+        amplitude += (phase < duty ? 1.0 : -1.0);
+        break;
+      case AZ_TRIANGLE_WAVE:
+        amplitude += (phase < duty ? 2.0 * (phase / duty) - 1.0 :
+                      1.0 - 2.0 * ((phase - duty) / (1.0 - duty)));
+        break;
+      case AZ_SAWTOOTH_WAVE:
+      case AZ_WOBBLE_WAVE:
+        AZ_ASSERT_UNREACHABLE();
+    }
+  }
+  return amplitude;
+}
+
+// Advance the voice's oscillator by SYNTH_SUPERSAMPLE virtual samples, and
+// return the sum of the waveform over those samples.  When the samples don't
+// wrap around the end of the period (or straddle the duty point, for
+// triangle waves), the waveform is a simple enough function of the phase
+// that we can sum it directly rather than visiting each virtual sample.
+static double oscillate(az_music_voice_t *voice, const az_oscillator_t *osc,
+                        double duty) {
+  const int iperiod = osc->iperiod;
+  const int first = voice->iphase + 1;
+  const int last = voice->iphase + SYNTH_SUPERSAMPLE;
+  if (voice->waveform == AZ_SINE_WAVE) {
+    // The sine wave's phase is periodic anyway, so wrapping doesn't matter.
+    voice->iphase = (last < iperiod ? last : last % iperiod);
+    return osc->sine_sum_scale *
+      sin_turns(0.5 * (first + last) * osc->inv_period);
+  }
+  if (last >= iperiod) return oscillate_slowly(voice, osc, duty);
+  // The duty point, in virtual samples; samples before this are in the
+  // first half of the waveform.
+  const double threshold = duty * iperiod;
+  if (voice->waveform == AZ_SQUARE_WAVE) {
+    voice->iphase = last;
+    const int num_high =
+      az_imin(SYNTH_SUPERSAMPLE, az_imax(0, (int)ceil(threshold) - first));
+    return 2.0 * num_high - SYNTH_SUPERSAMPLE;
+  }
+  if (voice->waveform == AZ_TRIANGLE_WAVE) {
+    const double phase_sum =
+      0.5 * SYNTH_SUPERSAMPLE * (first + last) * osc->inv_period;
+    if (last < threshold) {
+      voice->iphase = last;
+      return 2.0 * (phase_sum / duty) - SYNTH_SUPERSAMPLE;
+    } else if (first >= threshold) {
+      voice->iphase = last;
+      return SYNTH_SUPERSAMPLE -
+        2.0 * ((phase_sum - SYNTH_SUPERSAMPLE * duty) / (1.0 - duty));
+    }
+  }
+  return oscillate_slowly(voice, osc, duty);
+}
+
+// Add the next num_samples samples of the voice's current tone to mix.
+static void render_tone(az_music_voice_t *voice, const az_music_note_t *note,
+                        int *mix, int num_samples) {
+  assert(note->type == AZ_NOTE_TONE);
+  const double frequency = note->attributes.tone.frequency;
+  const double duration = note->attributes.tone.duration;
+  const double decay_time = duration * voice->decay_fraction;
+  assert(decay_time >= 0.0);
+  const double vibrato_turns_per_second =
+    voice->vibrato_speed * (1.0 / AZ_TWO_PI);
+  const double dutymod_turns_per_second =
+    voice->dutymod_speed * (1.0 / AZ_TWO_PI);
+  const double scale = voice->loudness * (1.0 / SYNTH_SUPERSAMPLE);
+  az_oscillator_t osc = {.iperiod = 0};
+  if (voice->vibrato_depth == 0.0) set_oscillator_period(&osc, frequency, 1.0);
+  double time = voice->time_from_note_start;
+  for (int i = 0; i < num_samples; ++i) {
+    if (voice->vibrato_depth != 0.0) {
+      set_oscillator_period(&osc, frequency, 1.0 + voice->vibrato_depth *
+                            sin_turns(time * vibrato_turns_per_second));
+    }
+    const double duty = (voice->dutymod_depth == 0.0 ? voice->duty :
+                         voice->duty * (1.0 + voice->dutymod_depth *
+                                        sin_turns(time *
+                                                  dutymod_turns_per_second)));
+    const double amplitude = oscillate(voice, &osc, duty);
+    const double time_remaining = duration - time;
+    assert(time_remaining > 0.0);
+    const double envelope =
+      (time < voice->attack_time ? time / voice->attack_time : 1.0) *
+      (time_remaining < decay_time ? time_remaining / decay_time : 1.0);
+    mix[i] += amplitude * scale * envelope;
+    time += SECONDS_PER_SAMPLE;
+  }
+}
+
+// Add the next num_samples samples of the voice's current drum to mix.
+static void render_drum(az_music_voice_t *voice, const az_music_note_t *note,
+                        int *mix, int num_samples) {
+  assert(note->type == AZ_NOTE_DRUM);
+  const az_sound_data_t *data = note->attributes.drum.data;
+  const double scale = (1.0 / BASE_LOUDNESS) * voice->loudness;
+  const int count = (voice->drum_index >= data->num_samples ? 0 :
+                     az_imin(num_samples,
+                             data->num_samples - voice->drum_index));
+  const int16_t *drum_samples = data->samples + voice->drum_index;
+  for (int i = 0; i < count; ++i) mix[i] += scale * drum_samples[i];
+  voice->drum_index += count;
+}
+
+static double note_duration(const az_music_note_t *note) {
+  switch (note->type) {
+    case AZ_NOTE_REST: return note->attributes.rest.duration;
+    case AZ_NOTE_TONE: return note->attributes.tone.duration;
+    case AZ_NOTE_DRUM: return note->attributes.drum.duration;
+    default: AZ_ASSERT_UNREACHABLE();
+  }
+}
+
+// Determine how many samples we can render before any voice might need to
+// move on to its next note (but no more than max_samples).  We leave a margin
+// of one sample, so that rounding error in adding up SECONDS_PER_SAMPLE can't
+// make us miss a note boundary.
+static int block_length(const az_music_synth_t *synth, int max_samples) {
+  int length = az_imin(max_samples, MAX_BLOCK_SAMPLES);
+  AZ_ARRAY_LOOP(voice, synth->voices) {
+    if (voice->note_index >= voice->track->num_notes) continue;
+    const double time_remaining =
+      note_duration(&voice->track->notes[voice->note_index]) -
+      voice->time_from_note_start;
+    const double safe_samples = floor(time_remaining / SECONDS_PER_SAMPLE);
+    if (safe_samples < length) length = az_imax(1, (int)safe_samples);
+  }
+  return length;
+}
+
+static int synthesize(az_music_synth_t *synth, int16_t *samples,
+                      int num_samples, bool stop_at_part_end) {
   assert(synth != NULL);
   if (synth->music == NULL) {
     memset(samples, 0, num_samples * sizeof(int16_t));
-    return;
+    return num_samples;
   }
-  for (int sample_index = 0; sample_index < num_samples; ++sample_index) {
-    if (synth->stopped) break;
-    int sample = 0;
-    AZ_ARRAY_LOOP(voice, synth->voices) {
-      if (voice->loudness <= 0.0) continue;
-      const az_music_track_t *track = voice->track;
-      if (voice->note_index >= track->num_notes) continue;
-      const az_music_note_t *note = &track->notes[voice->note_index];
-      if (note->type == AZ_NOTE_TONE) {
-        const double vibrato = 1.0 + voice->vibrato_depth *
-          sin(voice->time_from_note_start * voice->vibrato_speed);
-        const double period =
-          1.0 / (note->attributes.tone.frequency * vibrato);
-        const int iperiod = (int)(AZ_AUDIO_RATE * SYNTH_SUPERSAMPLE * period);
-        double amplitude = 0.0;
-        for (int s = 0; s < SYNTH_SUPERSAMPLE; ++s) {
-          ++voice->iphase;
-          if (voice->iphase >= iperiod) {
-            voice->iphase %= iperiod;
-            if (voice->waveform == AZ_NOISE_WAVE) {
-              voice->noise_bits = generate_noise();
-            }
-          }
-          const double phase = (double)voice->iphase / (double)iperiod;
-          const double duty = voice->duty *
-            (1.0 + voice->dutymod_depth *
-             sin(voice->time_from_note_start * voice->dutymod_speed));
-          switch (voice->waveform) {
-            case AZ_NOISE_WAVE:
-              amplitude += ((voice->noise_bits >>
-                             (64 * voice->iphase / iperiod)) & 0x1 ?
-                            1.0 : -1.0);
-              break;
-            case AZ_SINE_WAVE:
-              amplitude += sin(phase * AZ_TWO_PI);
-              break;
-            case AZ_SQUARE_WAVE:
-              amplitude += (phase < duty ? 1.0 : -1.0);
-              break;
-            case AZ_TRIANGLE_WAVE:
-              amplitude += (phase < duty ? 2.0 * (phase / duty) - 1.0 :
-                            1.0 - 2.0 * ((phase - duty) / (1.0 - duty)));
-              break;
-            case AZ_SAWTOOTH_WAVE:
-            case AZ_WOBBLE_WAVE:
-              AZ_ASSERT_UNREACHABLE();
-          }
-        }
-        const double decay_time =
-          note->attributes.tone.duration * voice->decay_fraction;
-        assert(decay_time >= 0.0);
-        const double time_remaining =
-          note->attributes.tone.duration - voice->time_from_note_start;
-        assert(time_remaining > 0.0);
-        const double envelope =
-          (voice->time_from_note_start < voice->attack_time ?
-           voice->time_from_note_start / voice->attack_time : 1.0) *
-          (time_remaining < decay_time ? time_remaining / decay_time : 1.0);
-        sample += (amplitude / SYNTH_SUPERSAMPLE) * envelope * voice->loudness;
-      } else if (note->type == AZ_NOTE_DRUM) {
-        const az_sound_data_t *data = note->attributes.drum.data;
-        if (voice->drum_index < data->num_samples) {
-          sample += ((1.0 / BASE_LOUDNESS) * voice->loudness *
-                     data->samples[voice->drum_index]);
-          ++voice->drum_index;
-        }
-      } else assert(note->type == AZ_NOTE_REST);
-    }
-    samples[sample_index] = az_imin(az_imax(INT16_MIN, sample), INT16_MAX);
-
+  // If we stopped at the end of a part last time, pick up where we left off.
+  if (synth->part_ended) {
+    synth->part_ended = false;
+    synth_begin_next_part(synth);
+    synth_advance(synth);
+  }
+  int mix[MAX_BLOCK_SAMPLES];
+  int sample_index = 0;
+  while (sample_index < num_samples && !synth->stopped) {
+    // Within a block, no voice changes notes, so each voice can render its
+    // whole share of the block in one go.
+    const int length = block_length(synth, num_samples - sample_index);
+    memset(mix, 0, length * sizeof(int));
     AZ_ARRAY_LOOP(voice, synth->voices) {
-      if (voice->note_index < voice->track->num_notes) {
+      if (voice->note_index >= voice->track->num_notes) continue;
+      if (voice->loudness > 0.0) {
+        const az_music_note_t *note = &voice->track->notes[voice->note_index];
+        if (note->type == AZ_NOTE_TONE) {
+          render_tone(voice, note, mix, length);
+        } else if (note->type == AZ_NOTE_DRUM) {
+          render_drum(voice, note, mix, length);
+        } else assert(note->type == AZ_NOTE_REST);
+      }
+      for (int i = 0; i < length; ++i) {
         voice->time_from_note_start += SECONDS_PER_SAMPLE;
       }
     }
-    synth_advance(synth);
+    for (int i = 0; i < length; ++i) {
+      samples[sample_index + i] = az_imin(az_imax(INT16_MIN, mix[i]),
+                                          INT16_MAX);
+    }
+    sample_index += length;
+    if (!stop_at_part_end) synth_advance(synth);
+    else if (synth_advance_voices(synth)) {
+      synth->part_ended = true;
+      return sample_index;
+    }
   }
+  // Once the music has stopped, it stays silent.
+  memset(samples + sample_index, 0,
+         (num_samples - sample_index) * sizeof(int16_t));
+  return num_samples;
+}
+
+void az_synthesize_music(az_music_synth_t *synth, int16_t *samples,
+                         int num_samples) {
+  synthesize(synth, samples, num_samples, false);
+}
+
+int az_synthesize_music_part(az_music_synth_t *synth, int16_t *samples,
+                             int num_samples) {
+  return synthesize(synth, samples, num_samples, true);
 }
 
 /*===========================================================================*/
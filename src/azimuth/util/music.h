@@ -118,35 +118,52 @@ void az_destroy_music(az_music_t *music);
 
 /*===========================================================================*/
 
+typedef struct {
+  const az_music_track_t *track;
+  int note_index;
+  size_t drum_index;
+  double time_from_note_start;
+  az_sound_wave_kind_t waveform;
+  double duty;
+  double loudness;
+  double attack_time, decay_fraction;
+  double dutymod_depth, dutymod_speed;
+  double vibrato_depth, vibrato_speed;
+  int iphase;
+  uint64_t noise_seed, noise_bits;
+} az_music_voice_t;
+
 typedef struct {
   const az_music_t *music;
   int flag;
   int pc;
   int steps_since_last_sustain;
   double time_index;
-  struct {
-    const az_music_track_t *track;
-    int note_index;
-    size_t drum_index;
-    double time_from_note_start;
-    az_sound_wave_kind_t waveform;
-    double duty;
-    double loudness;
-    double attack_time, decay_fraction;
-    double dutymod_depth, dutymod_speed;
-    double vibrato_depth, vibrato_speed;
-    int iphase;
-    uint64_t noise_bits;
-  } voices[AZ_MUSIC_NUM_TRACKS];
+  az_music_voice_t voices[AZ_MUSIC_NUM_TRACKS];
   bool stopped;
+  // True if az_synthesize_music_part stopped at the end of a part, in which
+  // case the next part (and thus any flag-dependent jumps) hasn't been chosen
+  // yet.
+  bool part_ended;
 } az_music_synth_t;
 
 void az_reset_music_synth(az_music_synth_t *synth, const az_music_t *music,
                           int flag);
 
+// Generate the next num_samples samples of music.  Rendering is done in
+// blocks that end at note boundaries, so the results are the same no matter
+// how the output is divided up between calls.
 void az_synthesize_music(az_music_synth_t *synth, int16_t *samples,
                          int num_samples);
 
+// Like az_synthesize_music, but if the current part ends before num_samples
+// samples have been generated, stop there (setting synth->part_ended) and
+// return the number of samples generated.  The synth's flag is next consulted
+// when synthesis resumes, so a copy of the synth taken at that point can be
+// used to re-render the rest of the music with a different flag.
+int az_synthesize_music_part(az_music_synth_t *synth, int16_t *samples,
+                             int num_samples);
+
 /*===========================================================================*/
 
 #endif // AZIMUTH_UTIL_MUSIC_H_
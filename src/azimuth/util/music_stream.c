@@ -0,0 +1,194 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#include "azimuth/util/music_stream.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "azimuth/util/misc.h"
+#include "azimuth/util/music.h"
+#include "azimuth/util/thread.h"
+#include "azimuth/util/vector.h"
+
+/*===========================================================================*/
+
+#define INDEX_MASK ((uint64_t)(AZ_MUSIC_STREAM_SIZE - 1))
+
+AZ_STATIC_ASSERT((AZ_MUSIC_STREAM_SIZE & (AZ_MUSIC_STREAM_SIZE - 1)) == 0);
+AZ_STATIC_ASSERT(AZ_MUSIC_STREAM_CHUNK <= AZ_MUSIC_STREAM_SIZE);
+
+void az_init_music_stream(az_music_stream_t *stream) {
+  AZ_ZERO_OBJECT(stream);
+  stream->mutex = az_create_mutex();
+  stream->condvar = az_create_condvar();
+  az_reset_music_synth(&stream->synth, NULL, 0);
+}
+
+void az_destroy_music_stream(az_music_stream_t *stream) {
+  az_destroy_condvar(stream->condvar);
+  az_destroy_mutex(stream->mutex);
+  AZ_ZERO_OBJECT(stream);
+}
+
+// Return how many more samples the producer may render right now (which may
+// be zero).  The mutex must be held.
+static int room_to_render(const az_music_stream_t *stream) {
+  if (stream->num_checkpoints >= AZ_MUSIC_STREAM_MAX_CHECKPOINTS) return 0;
+  assert(stream->write_count - stream->read_count <= AZ_MUSIC_STREAM_SIZE);
+  return (int)(AZ_MUSIC_STREAM_SIZE -
+               (stream->write_count - stream->read_count));
+}
+
+// Copy samples into the ring buffer (or out of it, if to_ring is false)
+// starting at the given sample count.  The mutex must be held.
+static void copy_ring(az_music_stream_t *stream, uint64_t count,
+                      int16_t *samples, int num_samples, bool to_ring) {
+  int done = 0;
+  while (done < num_samples) {
+    const int index = (int)((count + done) & INDEX_MASK);
+    const int run = az_imin(num_samples - done, AZ_MUSIC_STREAM_SIZE - index);
+    if (to_ring) {
+      memcpy(stream->samples + index, samples + done, run * sizeof(int16_t));
+    } else {
+      memcpy(samples + done, stream->samples + index, run * sizeof(int16_t));
+    }
+    done += run;
+  }
+}
+
+/*===========================================================================*/
+
+void az_change_stream_music(az_music_stream_t *stream, const az_music_t *music,
+                            int flag) {
+  az_lock_mutex(stream->mutex);
+  az_reset_music_synth(&stream->synth, music, flag);
+  stream->write_count = stream->read_count;
+  stream->num_checkpoints = 0;
+  ++stream->generation;
+  az_broadcast_condvar(stream->condvar);
+  az_unlock_mutex(stream->mutex);
+}
+
+void az_set_stream_music_flag(az_music_stream_t *stream, int flag) {
+  az_lock_mutex(stream->mutex);
+  // Checkpoints at or before read_count have already been pruned, so the
+  // first remaining one (if any) is the first part boundary not yet played.
+  // Everything rendered past it was rendered with the old flag, so rewind.
+  if (stream->num_checkpoints > 0) {
+    const az_music_checkpoint_t *checkpoint = &stream->checkpoints[0];
+    assert(checkpoint->position > stream->read_count);
+    stream->synth = checkpoint->synth;
+    stream->write_count = checkpoint->position;
+    stream->num_checkpoints = 0;
+  }
+  stream->synth.flag = flag;
+  ++stream->generation;
+  az_broadcast_condvar(stream->condvar);
+  az_unlock_mutex(stream->mutex);
+}
+
+int az_read_music_stream(az_music_stream_t *stream, int16_t *samples,
+                         int num_samples) {
+  assert(num_samples >= 0);
+  az_lock_mutex(stream->mutex);
+  const int num_read = az_imin(
+      num_samples, (int)(stream->write_count - stream->read_count));
+  copy_ring(stream, stream->read_count, samples, num_read, false);
+  stream->read_count += num_read;
+  int num_pruned = 0;
+  while (num_pruned < stream->num_checkpoints &&
+         stream->checkpoints[num_pruned].position <= stream->read_count) {
+    ++num_pruned;
+  }
+  if (num_pruned > 0) {
+    stream->num_checkpoints -= num_pruned;
+    memmove(stream->checkpoints, stream->checkpoints + num_pruned,
+            stream->num_checkpoints * sizeof(az_music_checkpoint_t));
+  }
+  if (num_read > 0) az_broadcast_condvar(stream->condvar);
+  az_unlock_mutex(stream->mutex);
+  memset(samples + num_read, 0, (num_samples - num_read) * sizeof(int16_t));
+  return num_read;
+}
+
+/*===========================================================================*/
+
+bool az_render_music_stream(az_music_stream_t *stream) {
+  az_lock_mutex(stream->mutex);
+  const int num_samples = az_imin(room_to_render(stream),
+                                  AZ_MUSIC_STREAM_CHUNK);
+  if (num_samples <= 0) {
+    az_unlock_mutex(stream->mutex);
+    return false;
+  }
+  az_music_synth_t synth = stream->synth;
+  const uint64_t generation = stream->generation;
+  az_unlock_mutex(stream->mutex);
+
+  // Synthesize without holding the mutex, so that the consumer never has to
+  // wait for us.  If the consumer changes the synth in the meantime, the
+  // generation will have changed, and we throw this chunk away.
+  int16_t chunk[AZ_MUSIC_STREAM_CHUNK];
+  const int num_rendered = az_synthesize_music_part(&synth, chunk,
+                                                    num_samples);
+
+  az_lock_mutex(stream->mutex);
+  if (stream->generation == generation) {
+    assert(room_to_render(stream) >= num_rendered);
+    copy_ring(stream, stream->write_count, chunk, num_rendered, true);
+    stream->write_count += num_rendered;
+    stream->synth = synth;
+    if (synth.part_ended) {
+      assert(stream->num_checkpoints < AZ_MUSIC_STREAM_MAX_CHECKPOINTS);
+      az_music_checkpoint_t *checkpoint =
+        &stream->checkpoints[stream->num_checkpoints++];
+      checkpoint->position = stream->write_count;
+      checkpoint->synth = synth;
+    }
+  }
+  az_unlock_mutex(stream->mutex);
+  return true;
+}
+
+void az_run_music_stream(void *arg) {
+  az_music_stream_t *stream = arg;
+  az_lock_mutex(stream->mutex);
+  while (!stream->stopping) {
+    if (room_to_render(stream) <= 0) {
+      az_wait_condvar(stream->condvar, stream->mutex);
+    } else {
+      az_unlock_mutex(stream->mutex);
+      az_render_music_stream(stream);
+      az_lock_mutex(stream->mutex);
+    }
+  }
+  az_unlock_mutex(stream->mutex);
+}
+
+void az_stop_music_stream(az_music_stream_t *stream) {
+  az_lock_mutex(stream->mutex);
+  stream->stopping = true;
+  az_broadcast_condvar(stream->condvar);
+  az_unlock_mutex(stream->mutex);
+}
+
+/*===========================================================================*/
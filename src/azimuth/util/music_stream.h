@@ -0,0 +1,117 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#pragma once
+#ifndef AZIMUTH_UTIL_MUSIC_STREAM_H_
+#define AZIMUTH_UTIL_MUSIC_STREAM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "azimuth/util/music.h"
+#include "azimuth/util/thread.h"
+
+/*===========================================================================*/
+
+// How many samples a music stream can render ahead of playback (about 370
+// milliseconds at AZ_AUDIO_RATE).  Must be a power of two.
+#define AZ_MUSIC_STREAM_SIZE 8192
+// How many samples the producer renders at a time:
+#define AZ_MUSIC_STREAM_CHUNK 512
+// How many part boundaries the stream can keep track of at once.  If parts
+// are short enough for this to fill up, the producer waits for playback to
+// catch up, rather than rendering further ahead.
+#define AZ_MUSIC_STREAM_MAX_CHECKPOINTS 8
+
+// The state of the synth at a part boundary within the stream's buffer, just
+// before it chooses the next part (see az_synthesize_music_part).
+typedef struct {
+  uint64_t position; // how many samples into the stream the boundary is
+  az_music_synth_t synth;
+} az_music_checkpoint_t;
+
+// A music stream renders music ahead of playback into a ring buffer, so that
+// an audio callback can read music without having to synthesize it.  One
+// producer (usually a background thread running az_run_music_stream) renders
+// the music, and one consumer reads samples and controls what plays.  The
+// stream is guarded by a mutex, but the producer never holds it while
+// synthesizing, so the consumer only ever waits for a few memcpys.
+typedef struct {
+  az_mutex_t *mutex;
+  az_condvar_t *condvar; // signalled when the producer may have work to do
+  bool stopping;
+  // The synth state as of write_count:
+  az_music_synth_t synth;
+  // Bumped whenever the consumer changes the synth state, so that the
+  // producer can throw away anything it rendered from the old state:
+  uint64_t generation;
+  // These count samples since the stream was created, and are masked to
+  // index into the samples array.
+  uint64_t read_count, write_count;
+  // Part boundaries between read_count and write_count, oldest first:
+  int num_checkpoints;
+  az_music_checkpoint_t checkpoints[AZ_MUSIC_STREAM_MAX_CHECKPOINTS];
+  int16_t samples[AZ_MUSIC_STREAM_SIZE];
+} az_music_stream_t;
+
+// Set up a stream that plays no music.  The stream must not be in use by any
+// other thread.
+void az_init_music_stream(az_music_stream_t *stream);
+
+// Free the stream's resources.  Any producer thread must be stopped first.
+void az_destroy_music_stream(az_music_stream_t *stream);
+
+/*===========================================================================*/
+// Consumer functions:
+
+// Throw away any music rendered ahead, and start playing the given music
+// (which may be NULL for silence) from the beginning, with the given flag.
+void az_change_stream_music(az_music_stream_t *stream, const az_music_t *music,
+                            int flag);
+
+// Change the music's flag.  The new flag takes effect at the first part
+// boundary that hasn't been played yet, even if the producer has already
+// rendered past it, in which case the stream is rewound to that boundary.
+void az_set_stream_music_flag(az_music_stream_t *stream, int flag);
+
+// Read up to num_samples samples from the stream and return how many were
+// available; the rest of the buffer is filled with silence.  Running out
+// delays the music rather than skipping any of it.
+int az_read_music_stream(az_music_stream_t *stream, int16_t *samples,
+                         int num_samples);
+
+/*===========================================================================*/
+// Producer functions:
+
+// Render up to AZ_MUSIC_STREAM_CHUNK more samples into the stream.  Returns
+// false if there was no room to render anything.
+bool az_render_music_stream(az_music_stream_t *stream);
+
+// Render into the stream whenever there's room, sleeping otherwise, until
+// az_stop_music_stream is called.  The argument must be an
+// az_music_stream_t*; this is meant to be passed to az_start_thread.
+void az_run_music_stream(void *stream);
+
+// Make az_run_music_stream return (after which the thread running it can be
+// joined).
+void az_stop_music_stream(az_music_stream_t *stream);
+
+/*===========================================================================*/
+
+#endif // AZIMUTH_UTIL_MUSIC_STREAM_H_
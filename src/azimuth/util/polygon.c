@@ -23,7 +23,14 @@
 #include <math.h>
 #include <stdbool.h>
 #include <stddef.h> // for NULL
+#include <stdint.h>
+#include <stdlib.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "azimuth/util/misc.h"
 #include "azimuth/util/vector.h"
 
 /*===========================================================================*/
@@ -50,6 +57,139 @@ static bool circle_touches_line_segment_internal(
 
 /*===========================================================================*/
 
+// Query bounding boxes are padded by this much before being checked against a
+// compiled polygon's edges, to guard against rounding error.
+#define EDGE_QUERY_MARGIN 1e-6
+
+void az_compile_polygon(az_polygon_t *polygon) {
+  const int num_vertices = polygon->num_vertices;
+  if (num_vertices <= 0 ||
+      num_vertices > AZ_MAX_COMPILED_POLYGON_VERTICES) return;
+  az_compiled_polygon_t *compiled = AZ_ALLOC(1, az_compiled_polygon_t);
+  double *bounds = AZ_ALLOC(4 * num_vertices, double);
+  compiled->min_x = bounds;
+  compiled->max_x = bounds + num_vertices;
+  compiled->min_y = bounds + 2 * num_vertices;
+  compiled->max_y = bounds + 3 * num_vertices;
+  for (int i = 0; i < num_vertices; ++i) {
+    const az_vector_t p1 = polygon->vertices[i];
+    const az_vector_t p2 = polygon->vertices[(i + 1) % num_vertices];
+    compiled->min_x[i] = fmin(p1.x, p2.x);
+    compiled->max_x[i] = fmax(p1.x, p2.x);
+    compiled->min_y[i] = fmin(p1.y, p2.y);
+    compiled->max_y[i] = fmax(p1.y, p2.y);
+  }
+  polygon->compiled = compiled;
+}
+
+void az_uncompile_polygon(az_polygon_t *polygon) {
+  az_compiled_polygon_t *compiled = (az_compiled_polygon_t *)polygon->compiled;
+  if (compiled == NULL) return;
+  free(compiled->min_x);
+  free(compiled);
+  polygon->compiled = NULL;
+}
+
+// find_nearby_edges returns one bit per edge in a uint64_t.
+AZ_STATIC_ASSERT(AZ_MAX_COMPILED_POLYGON_VERTICES <= 64);
+
+// If the polygon is compiled, set bit i of *near_out to whether the bounding
+// box of edge i (which also contains vertex i) overlaps the given box, and
+// return true.  A query whose path lies within the box can only hit edges (or
+// vertices) whose bits are set.  If the polygon isn't compiled, return false
+// without setting anything, in which case every edge must be checked.
+static bool find_nearby_edges(az_polygon_t polygon, double xlo, double xhi,
+                              double ylo, double yhi, uint64_t *near_out) {
+  const az_compiled_polygon_t *compiled = polygon.compiled;
+  if (compiled == NULL) return false;
+  assert(polygon.num_vertices <= AZ_MAX_COMPILED_POLYGON_VERTICES);
+  xlo -= EDGE_QUERY_MARGIN;
+  xhi += EDGE_QUERY_MARGIN;
+  ylo -= EDGE_QUERY_MARGIN;
+  yhi += EDGE_QUERY_MARGIN;
+  const int num_edges = polygon.num_vertices;
+  uint64_t near = 0;
+  int i = 0;
+#if defined(__SSE2__)
+  // Check four edges per iteration, two per SSE2 register.
+  const __m128d query_xlo = _mm_set1_pd(xlo), query_xhi = _mm_set1_pd(xhi);
+  const __m128d query_ylo = _mm_set1_pd(ylo), query_yhi = _mm_set1_pd(yhi);
+  for (; i + 3 < num_edges; i += 4) {
+    for (int j = i; j < i + 4; j += 2) {
+      const __m128d overlaps_x = _mm_and_pd(
+          _mm_cmple_pd(_mm_loadu_pd(&compiled->min_x[j]), query_xhi),
+          _mm_cmpge_pd(_mm_loadu_pd(&compiled->max_x[j]), query_xlo));
+      const __m128d overlaps_y = _mm_and_pd(
+          _mm_cmple_pd(_mm_loadu_pd(&compiled->min_y[j]), query_yhi),
+          _mm_cmpge_pd(_mm_loadu_pd(&compiled->max_y[j]), query_ylo));
+      near |= (uint64_t)_mm_movemask_pd(_mm_and_pd(overlaps_x, overlaps_y))
+        << j;
+    }
+  }
+#endif
+  // Use & rather than && so that there are no branches in the loop.
+  for (; i < num_edges; ++i) {
+    near |= (uint64_t)((compiled->min_x[i] <= xhi) &
+                       (compiled->max_x[i] >= xlo) &
+                       (compiled->min_y[i] <= yhi) &
+                       (compiled->max_y[i] >= ylo)) << i;
+  }
+  *near_out = near;
+  return true;
+}
+
+// Return true if edge i should be checked, given the results of
+// find_nearby_edges.
+static bool edge_is_near(bool filtered, uint64_t near, int i) {
+  return !filtered || (near & (UINT64_C(1) << i)) != 0;
+}
+
+// Like find_nearby_edges, for a circle with the given radius travelling delta
+// from start.
+static bool find_edges_near_sweep(az_polygon_t polygon, double radius,
+                                  az_vector_t start, az_vector_t delta,
+                                  uint64_t *near_out) {
+  const az_vector_t end = az_vadd(start, delta);
+  return find_nearby_edges(polygon, fmin(start.x, end.x) - radius,
+                           fmax(start.x, end.x) + radius,
+                           fmin(start.y, end.y) - radius,
+                           fmax(start.y, end.y) + radius, near_out);
+}
+
+// Like find_nearby_edges, for a circle with the given radius travelling from
+// start around spin_center by spin_angle radians.
+static bool find_edges_near_arc(az_polygon_t polygon, double radius,
+                                az_vector_t start, az_vector_t spin_center,
+                                double spin_angle, uint64_t *near_out) {
+  if (polygon.compiled == NULL) return false;
+  // The bounding box of the arc is determined by its endpoints plus any of
+  // the four axis-aligned extreme points that the arc sweeps past.
+  const az_vector_t rel = az_vsub(start, spin_center);
+  const az_vector_t end = az_vadd(spin_center, az_vrotate(rel, spin_angle));
+  double xlo = fmin(start.x, end.x), xhi = fmax(start.x, end.x);
+  double ylo = fmin(start.y, end.y), yhi = fmax(start.y, end.y);
+  const double arc_radius = az_vnorm(rel);
+  const double span = fabs(spin_angle);
+  const double theta0 =
+    az_vtheta(rel) + (spin_angle < 0.0 ? spin_angle : 0.0);
+  for (int i = 0; i < 4; ++i) {
+    const double axis_theta = i * AZ_HALF_PI;
+    if (span < AZ_TWO_PI && az_mod2pi_nonneg(axis_theta - theta0) > span) {
+      continue;
+    }
+    const az_vector_t extreme =
+      az_vadd(spin_center, az_vpolar(arc_radius, axis_theta));
+    xlo = fmin(xlo, extreme.x);
+    xhi = fmax(xhi, extreme.x);
+    ylo = fmin(ylo, extreme.y);
+    yhi = fmax(yhi, extreme.y);
+  }
+  return find_nearby_edges(polygon, xlo - radius, xhi + radius,
+                           ylo - radius, yhi + radius, near_out);
+}
+
+/*===========================================================================*/
+
 bool az_polygon_contains(az_polygon_t polygon, az_vector_t point) {
   const az_vector_t *vertices = polygon.vertices;
   // We're going to do a simple ray-casting test, where we imagine casting a
@@ -125,10 +265,15 @@ bool az_circle_touches_line_segment(
 
 bool az_circle_touches_polygon(
     az_polygon_t polygon, double radius, az_vector_t center) {
+  uint64_t near = 0;
+  const bool filtered =
+    find_edges_near_sweep(polygon, radius, center, AZ_VZERO, &near);
   for (int i = 0; i < polygon.num_vertices; ++i) {
+    if (!edge_is_near(filtered, near, i)) continue;
     if (az_vwithin(center, polygon.vertices[i], radius)) return true;
   }
   for (int i = polygon.num_vertices - 1, j = 0; i >= 0; j = i--) {
+    if (!edge_is_near(filtered, near, i)) continue;
     if (circle_touches_line_segment_internal(
             polygon.vertices[i], polygon.vertices[j],
             radius, center)) return true;
@@ -251,7 +396,11 @@ bool az_ray_hits_polygon(
   bool hit = false;
   az_vector_t pos;
   // Check if the ray hits any edges of the polygon.
+  uint64_t near = 0;
+  const bool filtered =
+    find_edges_near_sweep(polygon, 0.0, start, delta, &near);
   for (int i = polygon.num_vertices - 1, j = 0; i >= 0; j = i--) {
+    if (!edge_is_near(filtered, near, i)) continue;
     if (az_ray_hits_line_segment(
             polygon.vertices[i], polygon.vertices[j], start, delta,
             &pos, normal_out)) {
@@ -410,8 +559,12 @@ bool az_circle_hits_polygon(
   }
   bool hit = false;
   az_vector_t pos;
+  uint64_t near = 0;
+  const bool filtered =
+    find_edges_near_sweep(polygon, radius, start, delta, &near);
   // Check if the circle hits any corners of the polygon.
   for (int i = 0; i < polygon.num_vertices; ++i) {
+    if (!edge_is_near(filtered, near, i)) continue;
     if (az_circle_hits_point(polygon.vertices[i], radius, start, delta,
                              &pos, normal_out)) {
       hit = true;
@@ -420,6 +573,7 @@ bool az_circle_hits_polygon(
   }
   // Check if the circle hits any edges of the polygon.
   for (int i = polygon.num_vertices - 1, j = 0; i >= 0; j = i--) {
+    if (!edge_is_near(filtered, near, i)) continue;
     if (circle_hits_line_segment_internal(
             polygon.vertices[i], polygon.vertices[j], radius, start, delta,
             &pos, normal_out)) {
@@ -665,7 +819,11 @@ bool az_arc_ray_hits_polygon(
   }
   // Check if the ray hits any edges of the polygon.
   bool hit = false;
+  uint64_t near = 0;
+  const bool filtered = find_edges_near_arc(polygon, 0.0, start, spin_center,
+                                            spin_angle, &near);
   for (int i = polygon.num_vertices - 1, j = 0; i >= 0; j = i--) {
+    if (!edge_is_near(filtered, near, i)) continue;
     if (az_arc_ray_hits_line_segment(
             polygon.vertices[i], polygon.vertices[j], start, spin_center,
             spin_angle, &spin_angle, point_out, normal_out)) {
@@ -800,8 +958,12 @@ bool az_arc_circle_hits_polygon(
     return true;
   }
   bool hit = false;
+  uint64_t near = 0;
+  const bool filtered = find_edges_near_arc(polygon, circle_radius, start,
+                                            spin_center, spin_angle, &near);
   // Check if the circle hits any corners of the polygon.
   for (int i = 0; i < polygon.num_vertices; ++i) {
+    if (!edge_is_near(filtered, near, i)) continue;
     if (az_arc_circle_hits_point(
             polygon.vertices[i], circle_radius, start, spin_center, spin_angle,
             &spin_angle, pos_out, normal_out)) {
@@ -810,6 +972,7 @@ bool az_arc_circle_hits_polygon(
   }
   // Check if the circle hits any edges of the polygon.
   for (int i = polygon.num_vertices - 1, j = 0; i >= 0; j = i--) {
+    if (!edge_is_near(filtered, near, i)) continue;
     if (arc_circle_hits_line_segment_internal(
             polygon.vertices[i], polygon.vertices[j], circle_radius, start,
             spin_center, spin_angle, &spin_angle, pos_out, normal_out)) {
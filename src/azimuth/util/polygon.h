@@ -31,13 +31,40 @@
 #define AZ_INIT_POLYGON(array) \
   { .num_vertices = AZ_ARRAY_SIZE(array), .vertices = (array) }
 
+// The most vertices a polygon can have and still be compiled (see
+// az_compile_polygon).
+#define AZ_MAX_COMPILED_POLYGON_VERTICES 64
+
+// Precomputed bounding boxes for the edges of a polygon, where edge i runs
+// from vertex i to vertex i+1 (wrapping around).  The bounds are kept in
+// separate arrays, so that a query's bounding box can be checked against
+// several edges at once (see find_nearby_edges in polygon.c).
+typedef struct {
+  double *min_x, *max_x, *min_y, *max_y;
+} az_compiled_polygon_t;
+
 // Represents a closed 2D polygon.  It is usually expected that the polygon is
 // non-self-intersecting.
 typedef struct {
   int num_vertices;
   const az_vector_t *vertices;
+  // If non-NULL, collision tests use this to skip edges that are nowhere near
+  // the query; it must match the vertices.
+  const az_compiled_polygon_t *compiled;
 } az_polygon_t;
 
+// Precompute edge data for a polygon whose vertices will never change (such
+// as a wall's or a baddie component's), and attach it to the polygon, so that
+// collision tests against it can skip most edges.  Polygons with no
+// vertices, or with more than AZ_MAX_COMPILED_POLYGON_VERTICES vertices, are
+// left uncompiled.
+void az_compile_polygon(az_polygon_t *polygon);
+
+// Free a polygon's compiled data (if any), and set its compiled field to NULL.
+// Any copies of the polygon made while it was compiled must not be used
+// afterwards.
+void az_uncompile_polygon(az_polygon_t *polygon);
+
 /*===========================================================================*/
 
 // Test if the point is in the polygon.  The polygon must be
@@ -0,0 +1,165 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+// We need this for clock_gettime, which isn't part of C99.
+#if !defined(_WIN32) && !defined(__APPLE__)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "azimuth/util/profile.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <mach/mach_time.h>
+#else
+#include <time.h>
+#endif
+
+/*===========================================================================*/
+
+static az_profile_counter_t *first_counter = NULL;
+
+// Total frame times for the last AZ_PROFILE_HISTORY frames, as a ring buffer
+// indexed the same way as each counter's history_ns array:
+static uint32_t frame_history_ns[AZ_PROFILE_HISTORY];
+static int history_next = 0; // index at which the next frame will be stored
+static int history_size = 0;
+static uint64_t last_frame_end_ns = 0;
+
+uint64_t az_profile_now_ns(void) {
+#if defined(_WIN32)
+  LARGE_INTEGER frequency, counter;
+  QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&counter);
+  return (uint64_t)((double)counter.QuadPart *
+                    (1e9 / (double)frequency.QuadPart));
+#elif defined(__APPLE__)
+  static mach_timebase_info_data_t timebase;
+  if (timebase.denom == 0) mach_timebase_info(&timebase);
+  return mach_absolute_time() * timebase.numer / timebase.denom;
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * UINT64_C(1000000000) + (uint64_t)now.tv_nsec;
+#endif
+}
+
+const az_profile_counter_t *az_first_profile_counter(void) {
+  return first_counter;
+}
+
+void az_reset_profile_counters(void) {
+  for (az_profile_counter_t *counter = first_counter; counter != NULL;
+       counter = counter->next) {
+    counter->total_ns = 0;
+    counter->num_calls = 0;
+  }
+}
+
+int az_profile_history_size(void) {
+  return history_size;
+}
+
+uint64_t az_profile_history_ns(const az_profile_counter_t *counter,
+                               int frames_ago) {
+  assert(frames_ago >= 0);
+  assert(frames_ago < history_size);
+  const int index = (history_next + AZ_PROFILE_HISTORY - 1 - frames_ago) %
+    AZ_PROFILE_HISTORY;
+  return (counter == NULL ? frame_history_ns[index] :
+          counter->history_ns[index]);
+}
+
+bool az_write_profile_csv(const char *path) {
+  FILE *file = fopen(path, "w");
+  if (file == NULL) return false;
+  bool ok = (fputs("frame", file) >= 0);
+  for (const az_profile_counter_t *counter = first_counter; counter != NULL;
+       counter = counter->next) {
+    ok = ok && (fprintf(file, ",%s", counter->name) >= 0);
+  }
+  ok = ok && (fputs(",total\n", file) >= 0);
+  for (int frames_ago = history_size - 1; ok && frames_ago >= 0;
+       --frames_ago) {
+    ok = (fprintf(file, "%d", history_size - 1 - frames_ago) >= 0);
+    for (const az_profile_counter_t *counter = first_counter; counter != NULL;
+         counter = counter->next) {
+      ok = ok && (fprintf(file, ",%.3f", 1e-6 *
+                          az_profile_history_ns(counter, frames_ago)) >= 0);
+    }
+    ok = ok && (fprintf(file, ",%.3f\n", 1e-6 *
+                        az_profile_history_ns(NULL, frames_ago)) >= 0);
+  }
+  if (fclose(file) != 0) ok = false;
+  return ok;
+}
+
+static uint32_t clamp_to_uint32(uint64_t value) {
+  return (value > UINT32_MAX ? UINT32_MAX : (uint32_t)value);
+}
+
+void az_profile_add_(az_profile_counter_t *counter, uint64_t start_ns) {
+  if (!counter->registered) {
+    counter->registered = true;
+    counter->target = counter;
+    // If some other call site already registered a counter with this name,
+    // send our time there instead of listing a second counter.
+    for (az_profile_counter_t *other = first_counter; other != NULL;
+         other = other->next) {
+      if (strcmp(other->name, counter->name) == 0) {
+        counter->target = other;
+        break;
+      }
+    }
+    if (counter->target == counter) {
+      counter->next = first_counter;
+      first_counter = counter;
+    }
+  }
+  const uint64_t elapsed_ns = az_profile_now_ns() - start_ns;
+  az_profile_counter_t *target = counter->target;
+  target->total_ns += elapsed_ns;
+  target->frame_ns += elapsed_ns;
+  ++target->num_calls;
+}
+
+void az_profile_end_frame_(void) {
+  const uint64_t now_ns = az_profile_now_ns();
+  frame_history_ns[history_next] = (last_frame_end_ns == 0 ? 0 :
+                                    clamp_to_uint32(now_ns -
+                                                    last_frame_end_ns));
+  last_frame_end_ns = now_ns;
+  for (az_profile_counter_t *counter = first_counter; counter != NULL;
+       counter = counter->next) {
+    counter->history_ns[history_next] = clamp_to_uint32(counter->frame_ns);
+    counter->frame_ns = 0;
+  }
+  history_next = (history_next + 1) % AZ_PROFILE_HISTORY;
+  if (history_size < AZ_PROFILE_HISTORY) ++history_size;
+}
+
+/*===========================================================================*/
@@ -0,0 +1,110 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#pragma once
+#ifndef AZIMUTH_UTIL_PROFILE_H_
+#define AZIMUTH_UTIL_PROFILE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*===========================================================================*/
+
+// AZ_PROFILING is set by the Makefile (see the PROFILING variable there).
+// When it is zero, AZ_PROFILE compiles down to just the profiled statement.
+#ifndef AZ_PROFILING
+#define AZ_PROFILING 0
+#endif
+
+// How many frames of history each profile counter keeps (see
+// AZ_PROFILE_END_FRAME):
+#define AZ_PROFILE_HISTORY 120
+
+// A profile counter accumulates the time spent in one profiled section of
+// code.  Counters register themselves in a global list the first time they
+// are used.  Several call sites may share a name, in which case only the
+// first one to run is put in the list, and the others add their time to it.
+typedef struct az_profile_counter {
+  const char *name;
+  uint64_t total_ns; // total time spent in the section, in nanoseconds
+  uint64_t num_calls; // number of times the section has been executed
+  uint64_t frame_ns; // time spent in the section so far this frame
+  // Time spent in the section during each of the last AZ_PROFILE_HISTORY
+  // frames, as a ring buffer (see az_profile_history_ns):
+  uint32_t history_ns[AZ_PROFILE_HISTORY];
+  bool registered;
+  struct az_profile_counter *target; // the listed counter with this name
+  struct az_profile_counter *next;
+} az_profile_counter_t;
+
+// Run the given statement, and add the time it took to the profile counter
+// for this call site, which will be named by the given string literal.
+#if AZ_PROFILING
+#define AZ_PROFILE(label, statement) do { \
+    static az_profile_counter_t az_profile_counter_ = { .name = (label) }; \
+    const uint64_t az_profile_start_ = az_profile_now_ns(); \
+    statement; \
+    az_profile_add_(&az_profile_counter_, az_profile_start_); \
+  } while (false)
+#else
+#define AZ_PROFILE(label, statement) do { statement; } while (false)
+#endif
+
+// Mark the end of a frame, saving each counter's time for the frame into its
+// history, along with the total time since the previous end of frame.  Like
+// AZ_PROFILE, this compiles to nothing when AZ_PROFILING is disabled.
+#if AZ_PROFILING
+#define AZ_PROFILE_END_FRAME() az_profile_end_frame_()
+#else
+#define AZ_PROFILE_END_FRAME() do {} while (false)
+#endif
+
+// Return the current value of a monotonic high-resolution clock, in
+// nanoseconds.  This is available even when AZ_PROFILING is disabled.
+uint64_t az_profile_now_ns(void);
+
+// Return the first registered profile counter (the rest can be reached by
+// following the next pointers), or NULL if no counters are registered.
+const az_profile_counter_t *az_first_profile_counter(void);
+
+// Set the totals of all registered profile counters back to zero.
+void az_reset_profile_counters(void);
+
+// Return the number of frames of history available (at most
+// AZ_PROFILE_HISTORY).
+int az_profile_history_size(void);
+
+// Return the time spent in the given counter (or, if counter is NULL, the
+// total frame time) during the frame the given number of frames ago, where
+// zero is the most recently finished frame.  The frames_ago argument must be
+// less than az_profile_history_size().
+uint64_t az_profile_history_ns(const az_profile_counter_t *counter,
+                               int frames_ago);
+
+// Write the frame history to a CSV file, oldest frame first, with a column
+// of milliseconds for the total frame time and one for each counter.  Returns
+// true on success, or false on failure.
+bool az_write_profile_csv(const char *path);
+
+void az_profile_add_(az_profile_counter_t *counter, uint64_t start_ns);
+void az_profile_end_frame_(void);
+
+/*===========================================================================*/
+
+#endif // AZIMUTH_UTIL_PROFILE_H_
@@ -46,6 +46,10 @@ double az_rand_sdouble(az_random_seed_t *seed) {
 
 static az_random_seed_t global_seed = {1, 1};
 
+void az_set_global_random_seed(az_random_seed_t seed) {
+  global_seed = seed;
+}
+
 double az_random(double min, double max) {
   assert(isfinite(min));
   assert(isfinite(max));
@@ -48,6 +48,10 @@ double az_rand_sdouble(az_random_seed_t *seed);
 
 /*===========================================================================*/
 
+// Reset the global random seed (used by the functions below) to the given
+// value.  This is useful for making a simulation repeatable.
+void az_set_global_random_seed(az_random_seed_t seed);
+
 // Returns a random double from min (inclusive) to max (exclusive), using the
 // global random seed.  Both min and max must be finite, and min must not be
 // greater than max (for convenience, if min == max, min is returned; otherwise
@@ -17,11 +17,23 @@
 | with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
 =============================================================================*/
 
+// We need this for fileno and mmap, which aren't part of C99.
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
 #include "azimuth/util/rw.h"
 
+#include <assert.h>
 #include <stdarg.h>
+#include <stdlib.h>
 #include <string.h>
 
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #include "azimuth/util/misc.h"
 
 /*===========================================================================*/
@@ -60,6 +72,13 @@ void az_cstring_reader(const char *str, az_reader_t *reader) {
   az_charbuf_reader(str, strlen(str), reader);
 }
 
+void az_membuf_reader(const char *buffer, size_t size, az_reader_t *reader) {
+  reader->type = AZ_RW_STRING;
+  reader->data.string.buffer = buffer;
+  reader->data.string.size = size;
+  reader->data.string.position = 0;
+}
+
 bool az_rgetpos(az_reader_t *reader, az_rw_pos_t *pos) {
   bool success = false;
   switch (reader->type) {
@@ -145,6 +164,69 @@ int az_rscanf(az_reader_t *reader, const char *format, ...) {
   return result;
 }
 
+// Read the whole of a file into a newly allocated buffer.
+static bool copy_file_contents(FILE *file, az_rmapping_t *mapping_out) {
+  if (fseek(file, 0, SEEK_END) != 0) return false;
+  const long length = ftell(file);
+  if (length < 0 || fseek(file, 0, SEEK_SET) != 0) return false;
+  char *buffer = AZ_ALLOC(length + 1, char);
+  if (fread(buffer, sizeof(char), length, file) != (size_t)length) {
+    free(buffer);
+    return false;
+  }
+  mapping_out->data = buffer;
+  mapping_out->size = length;
+  mapping_out->memory_ = buffer;
+  return true;
+}
+
+bool az_rmap(az_reader_t *reader, az_rmapping_t *mapping_out) {
+  AZ_ZERO_OBJECT(mapping_out);
+  switch (reader->type) {
+    case AZ_RW_CLOSED: return false;
+    case AZ_RW_STREAM:
+    case AZ_RW_FILE: {
+#if !defined(_WIN32)
+      const int fd = fileno(reader->data.file);
+      struct stat info;
+      if (fd >= 0 && fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+        if (info.st_size == 0) {
+          mapping_out->data = "";
+          return true;
+        }
+        void *memory = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (memory != MAP_FAILED) {
+          mapping_out->data = memory;
+          mapping_out->size = info.st_size;
+          mapping_out->memory_ = memory;
+          mapping_out->memory_size_ = info.st_size;
+          mapping_out->is_mapped_ = true;
+          return true;
+        }
+      }
+#endif
+      return copy_file_contents(reader->data.file, mapping_out);
+    }
+    case AZ_RW_STRING:
+      mapping_out->data = reader->data.string.buffer;
+      mapping_out->size = reader->data.string.size;
+      return true;
+  }
+  AZ_ASSERT_UNREACHABLE();
+}
+
+void az_runmap(az_rmapping_t *mapping) {
+  if (mapping->memory_ != NULL) {
+#if !defined(_WIN32)
+    if (mapping->is_mapped_) munmap(mapping->memory_, mapping->memory_size_);
+    else free(mapping->memory_);
+#else
+    free(mapping->memory_);
+#endif
+  }
+  AZ_ZERO_OBJECT(mapping);
+}
+
 void az_rclose(az_reader_t *reader) {
   switch (reader->type) {
     case AZ_RW_CLOSED: return;
@@ -219,6 +301,11 @@ bool az_wprintf(az_writer_t *writer, const char *format, ...) {
   return success;
 }
 
+size_t az_charbuf_writer_length(const az_writer_t *writer) {
+  assert(writer->type == AZ_RW_STRING);
+  return writer->data.string.position;
+}
+
 void az_wclose(az_writer_t *writer) {
   switch (writer->type) {
     case AZ_RW_CLOSED: return;
@@ -62,6 +62,15 @@ typedef union {
   size_t string_pos;
 } az_rw_pos_t;
 
+// A read-only view of the full contents of a reader (see az_rmap).
+typedef struct {
+  const char *data;
+  size_t size;
+  void *memory_; // memory to be unmapped or freed by az_runmap, if any
+  size_t memory_size_;
+  bool is_mapped_;
+} az_rmapping_t;
+
 typedef bool (*az_resource_reader_fn_t)(const char *name, az_reader_t *reader);
 typedef bool (*az_resource_writer_fn_t)(const char *name, az_writer_t *writer);
 
@@ -73,6 +82,10 @@ void az_stdin_reader(az_reader_t *reader);
 bool az_file_reader(const char *path, az_reader_t *reader);
 void az_charbuf_reader(const char *buffer, size_t size, az_reader_t *reader);
 void az_cstring_reader(const char *str, az_reader_t *reader);
+// Unlike az_charbuf_reader, this reads directly from the given buffer rather
+// than copying it, so the buffer must outlive the reader.  The resulting
+// reader does not yet support az_rscanf, so it is meant for binary data.
+void az_membuf_reader(const char *buffer, size_t size, az_reader_t *reader);
 
 // Get/set position:
 bool az_rgetpos(az_reader_t *reader, az_rw_pos_t *pos);
@@ -84,6 +97,15 @@ int az_rpeek(az_reader_t *reader);
 int az_rscanf(az_reader_t *reader, const char *format, ...)
   __attribute__((__format__(__scanf__,2,3)));
 
+// Get direct access to the full contents of the reader, without parsing.
+// For a memory-buffer reader this is the reader's own buffer; for a file it is
+// a read-only memory mapping of the file where the OS supports that, or a
+// copy of the file otherwise.  The data stays valid until az_runmap is called
+// (even if the reader is closed first).  Returns false on failure.
+bool az_rmap(az_reader_t *reader, az_rmapping_t *mapping_out);
+// Release a mapping made by az_rmap.  Does nothing if the mapping is zeroed.
+void az_runmap(az_rmapping_t *mapping);
+
 // Close:
 void az_rclose(az_reader_t *reader);
 
@@ -100,6 +122,11 @@ void az_charbuf_writer(char *buffer, size_t size, az_writer_t *writer);
 bool az_wprintf(az_writer_t *writer, const char *format, ...)
   __attribute__((__format__(__printf__,2,3)));
 
+// Return the number of characters written so far to a writer made by
+// az_charbuf_writer (not counting the terminating NUL added on close).  The
+// writer must not have been closed yet.
+size_t az_charbuf_writer_length(const az_writer_t *writer);
+
 // Close:
 void az_wclose(az_writer_t *writer);
 
@@ -21,12 +21,16 @@
 
 #include <assert.h>
 #include <math.h>
+#include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "azimuth/util/misc.h"
+#include "azimuth/util/thread.h"
 #include "azimuth/util/vector.h"
+#include "azimuth/util/warning.h"
 
 /*===========================================================================*/
 // Synthesizer:
@@ -65,7 +69,11 @@
 // Many thanks to DrPetter for developing sfxr, and for releasing it as Free
 // Software.
 
-static struct {
+// The state of the synthesizer while generating one sound.  Each sound is
+// rendered into its own az_synth_t, so that several sounds can be rendered at
+// once on different threads.
+typedef struct {
+  uint32_t noise_x, noise_y, noise_z, noise_w; // xorshift RNG state
   int phase;
   double fperiod, fmaxperiod, fslide, fdslide;
   int period;
@@ -87,177 +95,184 @@ static struct {
   double arp_mod;
   size_t num_samples;
   int16_t samples[128 * 1024];
-} synth;
+} az_synth_t;
 
 // Fill each entry in synth.noise_buffer with a random float from -1 to 1.
-static void refill_noise_buffer(void) {
+static void refill_noise_buffer(az_synth_t *synth) {
   // Xorshift RNG (see http://en.wikipedia.org/wiki/Xorshift)
-  static uint32_t x = 123456789;
-  static uint32_t y = 362436069;
-  static uint32_t z = 521288629;
-  static uint32_t w = 88675123;
+  uint32_t x = synth->noise_x, y = synth->noise_y;
+  uint32_t z = synth->noise_z, w = synth->noise_w;
   for (int i = 0; i < 32; ++i) {
     const uint32_t t = x ^ (x << 11);
     x = y; y = z; z = w;
     w = w ^ (w >> 19) ^ t ^ (t >> 8);
-    synth.noise_buffer[i] = (float)((w * 4.656612874161595e-10) - 1.0);
+    synth->noise_buffer[i] = (float)((w * 4.656612874161595e-10) - 1.0);
   }
+  synth->noise_x = x; synth->noise_y = y;
+  synth->noise_z = z; synth->noise_w = w;
 }
 
 // Reset the sfxr synth.  This code is taken directly from sfxr, with only
 // minor changes.
-static void reset_synth(const az_sound_spec_t *spec, bool restart) {
-  if (!restart) synth.phase = 0;
-  synth.fperiod = 100.0 / (spec->start_freq * spec->start_freq + 0.001);
-  synth.period = (int)synth.fperiod;
-  synth.fmaxperiod = 100.0 / (spec->freq_limit * spec->freq_limit + 0.001);
-  synth.fslide = 1.0 - pow(spec->freq_slide, 3) * 0.01;
-  synth.fdslide = -pow(spec->freq_delta_slide, 3) * 0.000001;
-  synth.square_duty = 0.5f - spec->square_duty * 0.5f;
-  synth.square_slide = -spec->duty_sweep * 0.00005f;
+static void reset_synth(az_synth_t *synth, const az_sound_spec_t *spec,
+                        bool restart) {
+  if (!restart) synth->phase = 0;
+  synth->fperiod = 100.0 / (spec->start_freq * spec->start_freq + 0.001);
+  synth->period = (int)synth->fperiod;
+  synth->fmaxperiod = 100.0 / (spec->freq_limit * spec->freq_limit + 0.001);
+  synth->fslide = 1.0 - pow(spec->freq_slide, 3) * 0.01;
+  synth->fdslide = -pow(spec->freq_delta_slide, 3) * 0.000001;
+  synth->square_duty = 0.5f - spec->square_duty * 0.5f;
+  synth->square_slide = -spec->duty_sweep * 0.00005f;
   if (spec->arp_mod >= 0.0f) {
-    synth.arp_mod = 1.0 - pow(spec->arp_mod, 2) * 0.9;
+    synth->arp_mod = 1.0 - pow(spec->arp_mod, 2) * 0.9;
   } else {
-    synth.arp_mod = 1.0 + pow(spec->arp_mod, 2) * 10.0;
+    synth->arp_mod = 1.0 + pow(spec->arp_mod, 2) * 10.0;
   }
-  synth.arp_time = 0;
-  synth.arp_limit = (int)(pow(1.0 - spec->arp_speed, 2) * 20000 + 32);
-  if (spec->arp_speed == 1.0f) synth.arp_limit = 0;
+  synth->arp_time = 0;
+  synth->arp_limit = (int)(pow(1.0 - spec->arp_speed, 2) * 20000 + 32);
+  if (spec->arp_speed == 1.0f) synth->arp_limit = 0;
   if (!restart) {
     // Reset filter:
-    synth.fltp = 0.0f;
-    synth.fltdp = 0.0f;
-    synth.fltw = powf(1.0f - spec->lpf_cutoff, 3) * 0.1f;
-    synth.fltw_d = 1.0f + spec->lpf_ramp * 0.0001f;
-    synth.fltdmp = 5.0f / (1.0f + powf(spec->lpf_resonance, 2) * 20.0f) *
-      (0.01f + synth.fltw);
-    if (synth.fltdmp > 0.8f) synth.fltdmp = 0.8f;
-    synth.fltphp = 0.0f;
-    synth.flthp = powf(spec->hpf_cutoff, 2) * 0.1f;
-    synth.flthp_d = 1.0f + spec->hpf_ramp * 0.0003f;
+    synth->fltp = 0.0f;
+    synth->fltdp = 0.0f;
+    synth->fltw = powf(1.0f - spec->lpf_cutoff, 3) * 0.1f;
+    synth->fltw_d = 1.0f + spec->lpf_ramp * 0.0001f;
+    synth->fltdmp = 5.0f / (1.0f + powf(spec->lpf_resonance, 2) * 20.0f) *
+      (0.01f + synth->fltw);
+    if (synth->fltdmp > 0.8f) synth->fltdmp = 0.8f;
+    synth->fltphp = 0.0f;
+    synth->flthp = powf(spec->hpf_cutoff, 2) * 0.1f;
+    synth->flthp_d = 1.0f + spec->hpf_ramp * 0.0003f;
     // Reset vibrato:
-    synth.vib_phase = 0.0f;
-    synth.vib_speed = powf(spec->vibrato_speed, 2) * 0.01f;
-    synth.vib_amp = spec->vibrato_depth * 0.5f;
+    synth->vib_phase = 0.0f;
+    synth->vib_speed = powf(spec->vibrato_speed, 2) * 0.01f;
+    synth->vib_amp = spec->vibrato_depth * 0.5f;
     // Reset envelope:
-    synth.env_vol = 0.0f;
-    synth.env_stage = 0;
-    synth.env_time = 0;
-    synth.env_length[0] =
+    synth->env_vol = 0.0f;
+    synth->env_stage = 0;
+    synth->env_time = 0;
+    synth->env_length[0] =
       (int)(spec->env_attack * spec->env_attack * 100000.0f);
-    synth.env_length[1] =
+    synth->env_length[1] =
       (int)(spec->env_sustain * spec->env_sustain * 100000.0f);
-    synth.env_length[2] =
+    synth->env_length[2] =
       (int)(spec->env_decay * spec->env_decay * 100000.0f);
     // Reset phaser:
-    synth.fphase = powf(spec->phaser_offset, 2) * 1020.0f;
-    if (spec->phaser_offset < 0.0f) synth.fphase = -synth.fphase;
-    synth.fdphase = powf(spec->phaser_sweep, 2);
-    if (spec->phaser_sweep < 0.0f) synth.fdphase = -synth.fdphase;
-    synth.iphase = abs((int)synth.fphase);
-    synth.ipp = 0;
-    AZ_ZERO_ARRAY(synth.phaser_buffer);
+    synth->fphase = powf(spec->phaser_offset, 2) * 1020.0f;
+    if (spec->phaser_offset < 0.0f) synth->fphase = -synth->fphase;
+    synth->fdphase = powf(spec->phaser_sweep, 2);
+    if (spec->phaser_sweep < 0.0f) synth->fdphase = -synth->fdphase;
+    synth->iphase = abs((int)synth->fphase);
+    synth->ipp = 0;
+    AZ_ZERO_ARRAY(synth->phaser_buffer);
     // Refill noise buffer:
-    refill_noise_buffer();
+    refill_noise_buffer(synth);
     // Reset repeat:
-    synth.rep_time = 0;
-    synth.rep_limit =
+    synth->rep_time = 0;
+    synth->rep_limit =
       (int)(powf(1.0f - spec->repeat_speed, 2) * 20000 + 32);
-    if (spec->repeat_speed == 0.0f) synth.rep_limit = 0;
+    if (spec->repeat_speed == 0.0f) synth->rep_limit = 0;
   }
 }
 
 // Generate the given sound effect and populate the synth.samples array.
 // This code is taken directly from sfxr, with only minor changes.
-static void synth_sound(const az_sound_spec_t *spec) {
-  synth.num_samples = 0;
-  reset_synth(spec, false);
+static void synth_sound(az_synth_t *synth, const az_sound_spec_t *spec) {
+  // Every sound starts its noise from the same seed, so that it comes out
+  // the same no matter what order sounds are generated in.
+  synth->noise_x = 123456789;
+  synth->noise_y = 362436069;
+  synth->noise_z = 521288629;
+  synth->noise_w = 88675123;
+  synth->num_samples = 0;
+  reset_synth(synth, spec, false);
   float filesample = 0.0f;
   int fileacc = 0;
   bool finished = false;
 
-  while (synth.num_samples < AZ_ARRAY_SIZE(synth.samples) && !finished) {
-    ++synth.rep_time;
-    if (synth.rep_limit != 0 && synth.rep_time >= synth.rep_limit) {
-      synth.rep_time = 0;
-      reset_synth(spec, true);
+  while (synth->num_samples < AZ_ARRAY_SIZE(synth->samples) && !finished) {
+    ++synth->rep_time;
+    if (synth->rep_limit != 0 && synth->rep_time >= synth->rep_limit) {
+      synth->rep_time = 0;
+      reset_synth(synth, spec, true);
     }
 
     // frequency envelopes/arpeggios
-    ++synth.arp_time;
-    if (synth.arp_limit != 0 && synth.arp_time >= synth.arp_limit) {
-      synth.arp_limit = 0;
-      synth.fperiod *= synth.arp_mod;
+    ++synth->arp_time;
+    if (synth->arp_limit != 0 && synth->arp_time >= synth->arp_limit) {
+      synth->arp_limit = 0;
+      synth->fperiod *= synth->arp_mod;
     }
-    synth.fslide += synth.fdslide;
-    synth.fperiod *= synth.fslide;
-    if (synth.fperiod > synth.fmaxperiod) {
-      synth.fperiod = synth.fmaxperiod;
+    synth->fslide += synth->fdslide;
+    synth->fperiod *= synth->fslide;
+    if (synth->fperiod > synth->fmaxperiod) {
+      synth->fperiod = synth->fmaxperiod;
       if (spec->freq_limit > 0.0f) finished = true;
     }
-    float rfperiod = (float)synth.fperiod;
-    if (synth.vib_amp > 0.0f) {
-      synth.vib_phase += synth.vib_speed;
-      rfperiod =
-        (float)(synth.fperiod * (1.0 + sin(synth.vib_phase) * synth.vib_amp));
+    float rfperiod = (float)synth->fperiod;
+    if (synth->vib_amp > 0.0f) {
+      synth->vib_phase += synth->vib_speed;
+      rfperiod = (float)(synth->fperiod *
+                         (1.0 + sin(synth->vib_phase) * synth->vib_amp));
     }
-    synth.period = (int)rfperiod;
-    if (synth.period < 8) synth.period = 8;
-    synth.square_duty += synth.square_slide;
-    if (synth.square_duty < 0.0f) synth.square_duty = 0.0f;
-    if (synth.square_duty > 0.5f) synth.square_duty = 0.5f;
+    synth->period = (int)rfperiod;
+    if (synth->period < 8) synth->period = 8;
+    synth->square_duty += synth->square_slide;
+    if (synth->square_duty < 0.0f) synth->square_duty = 0.0f;
+    if (synth->square_duty > 0.5f) synth->square_duty = 0.5f;
     // volume envelope
-    synth.env_time++;
-    if (synth.env_time > synth.env_length[synth.env_stage]) {
-      synth.env_time = 0;
-      ++synth.env_stage;
-      if (synth.env_stage == 3) finished = true;
+    synth->env_time++;
+    if (synth->env_time > synth->env_length[synth->env_stage]) {
+      synth->env_time = 0;
+      ++synth->env_stage;
+      if (synth->env_stage == 3) finished = true;
     }
-    if (synth.env_stage == 0) {
-      assert(synth.env_length[0] > 0);
-      synth.env_vol = (float)synth.env_time / synth.env_length[0];
+    if (synth->env_stage == 0) {
+      assert(synth->env_length[0] > 0);
+      synth->env_vol = (float)synth->env_time / synth->env_length[0];
     }
-    if (synth.env_stage == 1) {
-      synth.env_vol = 1.0f;
-      if (synth.env_length[1] > 0) {
-        synth.env_vol +=
-          powf(1.0f - (float)synth.env_time / synth.env_length[1], 1.0f) *
+    if (synth->env_stage == 1) {
+      synth->env_vol = 1.0f;
+      if (synth->env_length[1] > 0) {
+        synth->env_vol +=
+          powf(1.0f - (float)synth->env_time / synth->env_length[1], 1.0f) *
           2.0f * spec->env_punch;
       }
     }
-    if (synth.env_stage == 2) {
-      synth.env_vol = (synth.env_length[2] > 0 ?
-                       1.0f - (float)synth.env_time / synth.env_length[2] :
+    if (synth->env_stage == 2) {
+      synth->env_vol = (synth->env_length[2] > 0 ?
+                       1.0f - (float)synth->env_time / synth->env_length[2] :
                        1.0f);
     }
 
     // phaser step
-    synth.fphase += synth.fdphase;
-    synth.iphase = abs((int)synth.fphase);
-    if (synth.iphase > 1023) synth.iphase = 1023;
-
-    if (synth.flthp_d != 0.0f) {
-      synth.flthp *= synth.flthp_d;
-      if (synth.flthp < 0.00001f) synth.flthp=0.00001f;
-      if (synth.flthp > 0.1f) synth.flthp=0.1f;
+    synth->fphase += synth->fdphase;
+    synth->iphase = abs((int)synth->fphase);
+    if (synth->iphase > 1023) synth->iphase = 1023;
+
+    if (synth->flthp_d != 0.0f) {
+      synth->flthp *= synth->flthp_d;
+      if (synth->flthp < 0.00001f) synth->flthp=0.00001f;
+      if (synth->flthp > 0.1f) synth->flthp=0.1f;
     }
 
     float ssample = 0.0f;
     for (int si = 0; si < 8; ++si) { // 8x supersampling
       float sample = 0.0f;
-      synth.phase++;
-      if (synth.phase >= synth.period) {
-        synth.phase %= synth.period;
+      synth->phase++;
+      if (synth->phase >= synth->period) {
+        synth->phase %= synth->period;
         if (spec->wave_kind == AZ_NOISE_WAVE) {
-          refill_noise_buffer();
+          refill_noise_buffer(synth);
         }
       }
       // base waveform
-      assert(synth.period > 0);
-      float fp = (float)synth.phase / synth.period;
+      assert(synth->period > 0);
+      float fp = (float)synth->phase / synth->period;
       switch (spec->wave_kind) {
         case AZ_NOISE_WAVE:
-          sample = synth.noise_buffer[synth.phase * 32 / synth.period];
+          sample = synth->noise_buffer[synth->phase * 32 / synth->period];
           break;
         case AZ_SAWTOOTH_WAVE:
           sample = 1.0f - fp * 2.0f;
@@ -266,7 +281,7 @@ static void synth_sound(const az_sound_spec_t *spec) {
           sample = (float)sin(fp * AZ_TWO_PI);
           break;
         case AZ_SQUARE_WAVE:
-          sample = (fp < synth.square_duty ? 0.5f : -0.5f);
+          sample = (fp < synth->square_duty ? 0.5f : -0.5f);
           break;
         case AZ_TRIANGLE_WAVE:
           sample = 4.0f * fabsf(fp - 0.5f) - 1.0f;
@@ -277,28 +292,29 @@ static void synth_sound(const az_sound_spec_t *spec) {
           break;
       }
       // lp filter
-      float pp = synth.fltp;
-      synth.fltw *= synth.fltw_d;
-      if (synth.fltw < 0.0f) synth.fltw = 0.0f;
-      if (synth.fltw > 0.1f) synth.fltw = 0.1f;
+      float pp = synth->fltp;
+      synth->fltw *= synth->fltw_d;
+      if (synth->fltw < 0.0f) synth->fltw = 0.0f;
+      if (synth->fltw > 0.1f) synth->fltw = 0.1f;
       if (spec->lpf_cutoff != 0.0f) {
-        synth.fltdp += (sample - synth.fltp) * synth.fltw;
-        synth.fltdp -= synth.fltdp * synth.fltdmp;
+        synth->fltdp += (sample - synth->fltp) * synth->fltw;
+        synth->fltdp -= synth->fltdp * synth->fltdmp;
       } else {
-        synth.fltp = sample;
-        synth.fltdp = 0.0f;
+        synth->fltp = sample;
+        synth->fltdp = 0.0f;
       }
-      synth.fltp += synth.fltdp;
+      synth->fltp += synth->fltdp;
       // hp filter
-      synth.fltphp += synth.fltp - pp;
-      synth.fltphp -= synth.fltphp * synth.flthp;
-      sample = synth.fltphp;
+      synth->fltphp += synth->fltp - pp;
+      synth->fltphp -= synth->fltphp * synth->flthp;
+      sample = synth->fltphp;
       // phaser
-      synth.phaser_buffer[synth.ipp & 1023] = sample;
-      sample += synth.phaser_buffer[(synth.ipp - synth.iphase + 1024) & 1023];
-      synth.ipp = (synth.ipp + 1) & 1023;
+      synth->phaser_buffer[synth->ipp & 1023] = sample;
+      sample +=
+        synth->phaser_buffer[(synth->ipp - synth->iphase + 1024) & 1023];
+      synth->ipp = (synth->ipp + 1) & 1023;
       // final accumulation and envelope application
-      ssample += sample * synth.env_vol;
+      ssample += sample * synth->env_vol;
     }
     const float master_vol = 0.05f;
     ssample = ssample / 8 * master_vol;
@@ -313,15 +329,15 @@ static void synth_sound(const az_sound_spec_t *spec) {
     if (fileacc == 2) {
       filesample /= fileacc;
       fileacc = 0;
-      synth.samples[synth.num_samples++] = (int16_t)(filesample * 32000);
+      synth->samples[synth->num_samples++] = (int16_t)(filesample * 32000);
       filesample = 0.0f;
     }
   }
 
   // Trim unneeded zeros off the end.
-  while (synth.num_samples > 0 &&
-         synth.samples[synth.num_samples - 1] == 0) {
-    --synth.num_samples;
+  while (synth->num_samples > 0 &&
+         synth->samples[synth->num_samples - 1] == 0) {
+    --synth->num_samples;
   }
 }
 
@@ -330,10 +346,12 @@ static void synth_sound(const az_sound_spec_t *spec) {
 void az_create_sound_data(const az_sound_spec_t *spec, az_sound_data_t *data) {
   assert(spec != NULL);
   assert(data != NULL);
-  synth_sound(spec);
-  data->num_samples = synth.num_samples;
-  data->samples = AZ_ALLOC(synth.num_samples, int16_t);
-  memcpy(data->samples, synth.samples, synth.num_samples * sizeof(int16_t));
+  az_synth_t *synth = AZ_ALLOC(1, az_synth_t);
+  synth_sound(synth, spec);
+  data->num_samples = synth->num_samples;
+  data->samples = AZ_ALLOC(synth->num_samples, int16_t);
+  memcpy(data->samples, synth->samples, synth->num_samples * sizeof(int16_t));
+  free(synth);
 }
 
 void az_destroy_sound_data(az_sound_data_t *data) {
@@ -343,3 +361,211 @@ void az_destroy_sound_data(az_sound_data_t *data) {
 }
 
 /*===========================================================================*/
+// Sound cache:
+
+// A sound cache file starts with a header of CACHE_MAGIC, the
+// CACHE_VERSION, and the number of entries.  Each entry is a spec hash (see
+// az_sound_spec_hash), a sample count, and that many samples.  All integers
+// are little-endian.  Bump CACHE_VERSION whenever the synthesizer changes in
+// a way that changes its output, so that stale caches get thrown away.
+#define CACHE_MAGIC UINT32_C(0x43534641) // "AFSC"
+#define CACHE_VERSION UINT32_C(1)
+#define CACHE_HEADER_SIZE 12
+#define CACHE_ENTRY_HEADER_SIZE 12
+
+static uint64_t hash_u32(uint64_t hash, uint32_t value) {
+  // 64-bit FNV-1a, one byte at a time.
+  for (int i = 0; i < 4; ++i) {
+    hash ^= (value >> (8 * i)) & 0xff;
+    hash *= UINT64_C(0x100000001b3);
+  }
+  return hash;
+}
+
+static uint64_t hash_float(uint64_t hash, float value) {
+  AZ_STATIC_ASSERT(sizeof(float) == sizeof(uint32_t));
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return hash_u32(hash, bits);
+}
+
+uint64_t az_sound_spec_hash(const az_sound_spec_t *spec) {
+  uint64_t hash = UINT64_C(0xcbf29ce484222325);
+  hash = hash_u32(hash, (uint32_t)spec->wave_kind);
+  const float fields[] = {
+    spec->env_attack, spec->env_sustain, spec->env_punch, spec->env_decay,
+    spec->start_freq, spec->freq_limit, spec->freq_slide,
+    spec->freq_delta_slide, spec->vibrato_depth, spec->vibrato_speed,
+    spec->arp_mod, spec->arp_speed, spec->square_duty, spec->duty_sweep,
+    spec->repeat_speed, spec->phaser_offset, spec->phaser_sweep,
+    spec->lpf_cutoff, spec->lpf_ramp, spec->lpf_resonance, spec->hpf_cutoff,
+    spec->hpf_ramp, spec->volume_adjust
+  };
+  AZ_ARRAY_LOOP(field, fields) hash = hash_float(hash, *field);
+  return hash;
+}
+
+static uint32_t get_u32(const unsigned char *bytes) {
+  return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) |
+    ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+static void put_u32(unsigned char *bytes, uint32_t value) {
+  for (int i = 0; i < 4; ++i) bytes[i] = (value >> (8 * i)) & 0xff;
+}
+
+// Read the whole file at the given path into a newly allocated buffer.
+// Returns NULL if the file can't be read.
+static unsigned char *read_file(const char *path, size_t *size_out) {
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) return NULL;
+  unsigned char *buffer = NULL;
+  long size;
+  if (fseek(file, 0, SEEK_END) == 0 && (size = ftell(file)) > 0 &&
+      fseek(file, 0, SEEK_SET) == 0) {
+    buffer = AZ_ALLOC(size, unsigned char);
+    if (fread(buffer, 1, size, file) != (size_t)size) {
+      free(buffer);
+      buffer = NULL;
+    }
+    *size_out = size;
+  }
+  fclose(file);
+  return buffer;
+}
+
+// Fill in each sound whose spec hash matches an entry in the cache file, and
+// mark it as found.  Returns the number of entries in the cache, or zero if
+// the cache is missing or invalid.
+static int load_from_cache(const char *cache_path, int num_sounds,
+                           const uint64_t *hashes, az_sound_data_t *datas,
+                           bool *found) {
+  size_t size = 0;
+  unsigned char *buffer = read_file(cache_path, &size);
+  if (buffer == NULL) return 0;
+  int num_entries = 0;
+  if (size >= CACHE_HEADER_SIZE && get_u32(buffer) == CACHE_MAGIC &&
+      get_u32(buffer + 4) == CACHE_VERSION) {
+    const uint32_t max_entries = get_u32(buffer + 8);
+    size_t offset = CACHE_HEADER_SIZE;
+    while ((uint32_t)num_entries < max_entries &&
+           size - offset >= CACHE_ENTRY_HEADER_SIZE) {
+      const uint64_t hash = (uint64_t)get_u32(buffer + offset) |
+        ((uint64_t)get_u32(buffer + offset + 4) << 32);
+      const uint32_t num_samples = get_u32(buffer + offset + 8);
+      offset += CACHE_ENTRY_HEADER_SIZE;
+      if ((size - offset) / 2 < num_samples) break;
+      for (int i = 0; i < num_sounds; ++i) {
+        if (found[i] || hashes[i] != hash) continue;
+        found[i] = true;
+        datas[i].num_samples = num_samples;
+        datas[i].samples = AZ_ALLOC(num_samples, int16_t);
+        for (uint32_t j = 0; j < num_samples; ++j) {
+          const unsigned char *sample = buffer + offset + 2 * j;
+          datas[i].samples[j] = (int16_t)(uint16_t)(sample[0] |
+                                                    (sample[1] << 8));
+        }
+      }
+      offset += 2 * (size_t)num_samples;
+      ++num_entries;
+    }
+  }
+  free(buffer);
+  return num_entries;
+}
+
+// Write all the given sounds to the cache file, replacing it atomically (so
+// that a crash partway through can't leave a truncated cache behind).
+static bool save_to_cache(const char *cache_path, int num_sounds,
+                          const uint64_t *hashes,
+                          const az_sound_data_t *datas) {
+  size_t size = CACHE_HEADER_SIZE;
+  for (int i = 0; i < num_sounds; ++i) {
+    size += CACHE_ENTRY_HEADER_SIZE + 2 * datas[i].num_samples;
+  }
+  unsigned char *buffer = AZ_ALLOC(size, unsigned char);
+  put_u32(buffer, CACHE_MAGIC);
+  put_u32(buffer + 4, CACHE_VERSION);
+  put_u32(buffer + 8, (uint32_t)num_sounds);
+  unsigned char *ptr = buffer + CACHE_HEADER_SIZE;
+  for (int i = 0; i < num_sounds; ++i) {
+    put_u32(ptr, (uint32_t)hashes[i]);
+    put_u32(ptr + 4, (uint32_t)(hashes[i] >> 32));
+    put_u32(ptr + 8, (uint32_t)datas[i].num_samples);
+    ptr += CACHE_ENTRY_HEADER_SIZE;
+    for (size_t j = 0; j < datas[i].num_samples; ++j) {
+      const uint16_t sample = (uint16_t)datas[i].samples[j];
+      *ptr++ = sample & 0xff;
+      *ptr++ = sample >> 8;
+    }
+  }
+  assert(ptr == buffer + size);
+  char *temp_path = AZ_ALLOC(strlen(cache_path) + 5, char);
+  strcpy(temp_path, cache_path);
+  strcat(temp_path, ".tmp");
+  bool ok = false;
+  FILE *file = fopen(temp_path, "wb");
+  if (file != NULL) {
+    ok = (fwrite(buffer, 1, size, file) == size);
+    if (fclose(file) != 0) ok = false;
+#if defined(_WIN32)
+    // On Windows, rename() won't replace an existing file.
+    if (ok) remove(cache_path);
+#endif
+    if (ok) ok = (rename(temp_path, cache_path) == 0);
+    if (!ok) remove(temp_path);
+  }
+  free(temp_path);
+  free(buffer);
+  return ok;
+}
+
+typedef struct {
+  const az_sound_spec_t *specs;
+  az_sound_data_t *datas;
+  const int *indices;
+} az_render_job_t;
+
+static void render_sound(void *arg, int index) {
+  const az_render_job_t *job = arg;
+  const int sound = job->indices[index];
+  az_create_sound_data(&job->specs[sound], &job->datas[sound]);
+}
+
+void az_create_sound_datas(int num_sounds, const az_sound_spec_t *specs,
+                           az_sound_data_t *datas_out,
+                           const char *cache_path) {
+  assert(num_sounds >= 0);
+  if (num_sounds == 0) return;
+  uint64_t *hashes = AZ_ALLOC(num_sounds, uint64_t);
+  bool *found = AZ_ALLOC(num_sounds, bool);
+  for (int i = 0; i < num_sounds; ++i) {
+    hashes[i] = az_sound_spec_hash(&specs[i]);
+  }
+  const int num_cached = (cache_path == NULL ? 0 :
+                          load_from_cache(cache_path, num_sounds, hashes,
+                                          datas_out, found));
+  // Render whatever the cache didn't have, in parallel.
+  int *indices = AZ_ALLOC(num_sounds, int);
+  int num_missing = 0;
+  for (int i = 0; i < num_sounds; ++i) {
+    if (!found[i]) indices[num_missing++] = i;
+  }
+  az_render_job_t job = {
+    .specs = specs, .datas = datas_out, .indices = indices
+  };
+  az_parallel_for(num_missing, render_sound, &job);
+  // If the cache was missing anything, or had anything we no longer need,
+  // rewrite it.  Failing to write the cache isn't fatal; we'll just have to
+  // render the sounds again next time.
+  if (cache_path != NULL && (num_missing > 0 || num_cached != num_sounds)) {
+    if (!save_to_cache(cache_path, num_sounds, hashes, datas_out)) {
+      AZ_WARNING_ONCE("Failed to write sound cache to %s\n", cache_path);
+    }
+  }
+  free(indices);
+  free(found);
+  free(hashes);
+}
+
+/*===========================================================================*/
@@ -59,6 +59,17 @@ typedef struct {
 
 void az_create_sound_data(const az_sound_spec_t *spec, az_sound_data_t *data);
 
+// Like calling az_create_sound_data for each of the given specs, but render
+// the sounds in parallel.  If cache_path is non-NULL, any sounds found in the
+// cache file at that path are loaded from there instead of being rendered,
+// and the cache file is then updated to hold exactly the given sounds.
+void az_create_sound_datas(int num_sounds, const az_sound_spec_t *specs,
+                           az_sound_data_t *datas_out,
+                           const char *cache_path);
+
+// Return a hash of all the fields of the spec, used to key the sound cache.
+uint64_t az_sound_spec_hash(const az_sound_spec_t *spec);
+
 void az_destroy_sound_data(az_sound_data_t *data);
 
 /*===========================================================================*/
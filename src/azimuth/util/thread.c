@@ -0,0 +1,291 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+// We need this for pthreads, which aren't part of C99.
+#if !defined(_WIN32) && !defined(__APPLE__)
+#define _POSIX_C_SOURCE 200112L
+#endif
+// We need this for condition variables, which are new as of Windows Vista.
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0600
+#endif
+
+#include "azimuth/util/thread.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include "azimuth/util/misc.h"
+
+/*===========================================================================*/
+
+struct az_thread {
+  void (*func)(void *arg);
+  void *arg;
+#if defined(_WIN32)
+  HANDLE handle;
+#else
+  pthread_t handle;
+#endif
+};
+
+#if defined(_WIN32)
+static DWORD WINAPI thread_main(LPVOID param) {
+  az_thread_t *thread = param;
+  thread->func(thread->arg);
+  return 0;
+}
+#else
+static void *thread_main(void *param) {
+  az_thread_t *thread = param;
+  thread->func(thread->arg);
+  return NULL;
+}
+#endif
+
+az_thread_t *az_start_thread(void (*func)(void *arg), void *arg) {
+  az_thread_t *thread = AZ_ALLOC(1, az_thread_t);
+  thread->func = func;
+  thread->arg = arg;
+#if defined(_WIN32)
+  thread->handle = CreateThread(NULL, 0, thread_main, thread, 0, NULL);
+  if (thread->handle == NULL) AZ_FATAL("Failed to start thread.\n");
+#else
+  if (pthread_create(&thread->handle, NULL, thread_main, thread) != 0) {
+    AZ_FATAL("Failed to start thread.\n");
+  }
+#endif
+  return thread;
+}
+
+void az_join_thread(az_thread_t *thread) {
+#if defined(_WIN32)
+  WaitForSingleObject(thread->handle, INFINITE);
+  CloseHandle(thread->handle);
+#else
+  pthread_join(thread->handle, NULL);
+#endif
+  free(thread);
+}
+
+/*===========================================================================*/
+
+struct az_mutex {
+#if defined(_WIN32)
+  CRITICAL_SECTION section;
+#else
+  pthread_mutex_t mutex;
+#endif
+};
+
+az_mutex_t *az_create_mutex(void) {
+  az_mutex_t *mutex = AZ_ALLOC(1, az_mutex_t);
+#if defined(_WIN32)
+  InitializeCriticalSection(&mutex->section);
+#else
+  if (pthread_mutex_init(&mutex->mutex, NULL) != 0) {
+    AZ_FATAL("Failed to create mutex.\n");
+  }
+#endif
+  return mutex;
+}
+
+void az_destroy_mutex(az_mutex_t *mutex) {
+  if (mutex == NULL) return;
+#if defined(_WIN32)
+  DeleteCriticalSection(&mutex->section);
+#else
+  pthread_mutex_destroy(&mutex->mutex);
+#endif
+  free(mutex);
+}
+
+void az_lock_mutex(az_mutex_t *mutex) {
+#if defined(_WIN32)
+  EnterCriticalSection(&mutex->section);
+#else
+  pthread_mutex_lock(&mutex->mutex);
+#endif
+}
+
+void az_unlock_mutex(az_mutex_t *mutex) {
+#if defined(_WIN32)
+  LeaveCriticalSection(&mutex->section);
+#else
+  pthread_mutex_unlock(&mutex->mutex);
+#endif
+}
+
+/*===========================================================================*/
+
+struct az_condvar {
+#if defined(_WIN32)
+  CONDITION_VARIABLE cond;
+#else
+  pthread_cond_t cond;
+#endif
+};
+
+az_condvar_t *az_create_condvar(void) {
+  az_condvar_t *condvar = AZ_ALLOC(1, az_condvar_t);
+#if defined(_WIN32)
+  InitializeConditionVariable(&condvar->cond);
+#else
+  if (pthread_cond_init(&condvar->cond, NULL) != 0) {
+    AZ_FATAL("Failed to create condition variable.\n");
+  }
+#endif
+  return condvar;
+}
+
+void az_destroy_condvar(az_condvar_t *condvar) {
+  if (condvar == NULL) return;
+#if !defined(_WIN32)
+  pthread_cond_destroy(&condvar->cond);
+#endif
+  free(condvar);
+}
+
+void az_wait_condvar(az_condvar_t *condvar, az_mutex_t *mutex) {
+#if defined(_WIN32)
+  SleepConditionVariableCS(&condvar->cond, &mutex->section, INFINITE);
+#else
+  pthread_cond_wait(&condvar->cond, &mutex->mutex);
+#endif
+}
+
+void az_broadcast_condvar(az_condvar_t *condvar) {
+#if defined(_WIN32)
+  WakeAllConditionVariable(&condvar->cond);
+#else
+  pthread_cond_broadcast(&condvar->cond);
+#endif
+}
+
+/*===========================================================================*/
+
+#if defined(_WIN32) && !defined(CREATE_WAITABLE_TIMER_HIGH_RESOLUTION)
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+void az_sleep_ns(uint64_t nanoseconds) {
+#if defined(_WIN32)
+  // Plain Sleep() only has the resolution of the system timer (typically
+  // 15.6 ms), so use a high-resolution waitable timer if this version of
+  // Windows supports them (Windows 10 version 1803 and later).
+  static bool initialized = false;
+  static HANDLE timer = NULL;
+  if (!initialized) {
+    initialized = true;
+    timer = CreateWaitableTimerExW(NULL, NULL,
+                                   CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+                                   TIMER_ALL_ACCESS);
+  }
+  if (timer != NULL) {
+    LARGE_INTEGER due_time; // negative means relative, in units of 100 ns
+    due_time.QuadPart = -(LONGLONG)(nanoseconds / 100);
+    if (SetWaitableTimer(timer, &due_time, 0, NULL, NULL, FALSE)) {
+      WaitForSingleObject(timer, INFINITE);
+      return;
+    }
+  }
+  Sleep((DWORD)(nanoseconds / 1000000));
+#else
+  struct timespec duration = {
+    .tv_sec = (time_t)(nanoseconds / 1000000000u),
+    .tv_nsec = (long)(nanoseconds % 1000000000u)
+  };
+  // If we get interrupted by a signal, go back to sleep for the remainder.
+  while (nanosleep(&duration, &duration) != 0 && errno == EINTR) {}
+#endif
+}
+
+/*===========================================================================*/
+
+// We never use more than this many threads for az_parallel_for, since the
+// tasks it's used for stop scaling well long before this.
+#define MAX_POOL_THREADS 16
+
+int az_num_cpus(void) {
+#if defined(_WIN32)
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return (info.dwNumberOfProcessors < 1 ? 1 :
+          (int)info.dwNumberOfProcessors);
+#else
+  const long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  return (num_cpus < 1 ? 1 : num_cpus > INT_MAX ? INT_MAX : (int)num_cpus);
+#endif
+}
+
+typedef struct {
+  void (*func)(void *arg, int index);
+  void *arg;
+  int count;
+  az_mutex_t *mutex;
+  int next_index; // protected by mutex
+} az_parallel_for_t;
+
+static void parallel_for_worker(void *param) {
+  az_parallel_for_t *job = param;
+  while (true) {
+    az_lock_mutex(job->mutex);
+    const int index = job->next_index;
+    if (index < job->count) ++job->next_index;
+    az_unlock_mutex(job->mutex);
+    if (index >= job->count) break;
+    job->func(job->arg, index);
+  }
+}
+
+void az_parallel_for(int count, void (*func)(void *arg, int index),
+                     void *arg) {
+  if (count <= 0) return;
+  int num_threads = az_num_cpus();
+  if (num_threads > MAX_POOL_THREADS) num_threads = MAX_POOL_THREADS;
+  if (num_threads > count) num_threads = count;
+  if (num_threads <= 1) {
+    for (int i = 0; i < count; ++i) func(arg, i);
+    return;
+  }
+  az_parallel_for_t job = {
+    .func = func, .arg = arg, .count = count, .mutex = az_create_mutex(),
+    .next_index = 0
+  };
+  az_thread_t *threads[MAX_POOL_THREADS];
+  for (int i = 1; i < num_threads; ++i) {
+    threads[i] = az_start_thread(parallel_for_worker, &job);
+  }
+  parallel_for_worker(&job);
+  for (int i = 1; i < num_threads; ++i) az_join_thread(threads[i]);
+  az_destroy_mutex(job.mutex);
+}
+
+/*===========================================================================*/
@@ -0,0 +1,90 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#pragma once
+#ifndef AZIMUTH_UTIL_THREAD_H_
+#define AZIMUTH_UTIL_THREAD_H_
+
+#include <stdint.h>
+
+/*===========================================================================*/
+
+// A thin portable wrapper around the platform's threads (pthreads on POSIX
+// systems, native threads on Windows).  We don't use SDL's threads for this,
+// since these are needed by code (such as simbench and the unit tests) that
+// doesn't link against SDL.
+
+typedef struct az_thread az_thread_t;
+typedef struct az_mutex az_mutex_t;
+typedef struct az_condvar az_condvar_t;
+
+// Start a new thread running func(arg).  Failing to create a thread is a
+// fatal error.
+az_thread_t *az_start_thread(void (*func)(void *arg), void *arg);
+
+// Wait for a thread to finish, and then free it.
+void az_join_thread(az_thread_t *thread);
+
+az_mutex_t *az_create_mutex(void);
+void az_destroy_mutex(az_mutex_t *mutex);
+void az_lock_mutex(az_mutex_t *mutex);
+void az_unlock_mutex(az_mutex_t *mutex);
+
+az_condvar_t *az_create_condvar(void);
+void az_destroy_condvar(az_condvar_t *condvar);
+
+// Atomically unlock the mutex (which must be locked by the calling thread)
+// and wait for the condition variable to be signalled, then relock the mutex
+// before returning.  As with any condition variable, this may wake up
+// spuriously, so the caller should always wait in a loop that checks the
+// condition it is waiting for.
+void az_wait_condvar(az_condvar_t *condvar, az_mutex_t *mutex);
+
+// Wake up all threads waiting on the condition variable.
+void az_broadcast_condvar(az_condvar_t *condvar);
+
+// Atomically load/store an integer variable that is shared between threads
+// without a mutex.  A store-release makes all of the storing thread's earlier
+// writes visible to any thread whose load-acquire sees the stored value.
+// (All of our supported compilers provide these builtins.)
+#define AZ_ATOMIC_LOAD_ACQUIRE(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define AZ_ATOMIC_STORE_RELEASE(ptr, value) \
+  __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+
+// Put the calling thread to sleep for about the given number of nanoseconds,
+// using the finest-grained sleep that the platform offers.  This may still
+// overshoot by up to a millisecond or so (or more, on older versions of
+// Windows), so callers that need precise timing should sleep for a little
+// less than they need and then spin (see az_sleep_until in gui/screen.c).
+void az_sleep_ns(uint64_t nanoseconds);
+
+// Return the number of processors available to this process (at least 1).
+int az_num_cpus(void);
+
+// Call func(arg, index) for each index from 0 to count - 1, spreading the
+// calls across a pool of up to az_num_cpus() threads (one of which is the
+// calling thread), and return once all of the calls have finished.  The calls
+// may happen in any order and concurrently with each other, so func must be
+// safe to run on several threads at once.
+void az_parallel_for(int count, void (*func)(void *arg, int index),
+                     void *arg);
+
+/*===========================================================================*/
+
+#endif // AZIMUTH_UTIL_THREAD_H_
@@ -141,11 +141,12 @@ AZ_STATIC_ASSERT(AZ_ARRAY_SIZE(background_datas) == AZ_NUM_BG_PATTERNS);
 static void draw_rivet(az_color_t color1, az_color_t color2,
                        float x, float y) {
   const float r = 3;
-  glBegin(GL_TRIANGLE_FAN); {
-    az_gl_color(color1); glVertex2f(x, y); az_gl_color(color2);
-    glVertex2f(x + r, y); glVertex2f(x, y + r); glVertex2f(x - r, y);
-    glVertex2f(x, y - r); glVertex2f(x + r, y);
-  } glEnd();
+  az_batch_begin(GL_TRIANGLE_FAN); {
+    az_batch_color(color1); az_batch_vertex2d(x, y); az_batch_color(color2);
+    az_batch_vertex2d(x + r, y); az_batch_vertex2d(x, y + r);
+    az_batch_vertex2d(x - r, y); az_batch_vertex2d(x, y - r);
+    az_batch_vertex2d(x + r, y);
+  } az_batch_end();
 }
 
 static void draw_panel(az_color_t color1, az_color_t color2,
@@ -154,18 +155,18 @@ static void draw_panel(az_color_t color1, az_color_t color2,
   const float thick = 5;
   const float space = 20;
   const float hspace = space / 2;
-  glBegin(GL_TRIANGLE_STRIP); {
-    az_gl_color(color1); glVertex2f(x_min + gap, y_min + gap);
-    az_gl_color(color2); glVertex2f(x_min + thick, y_min + thick);
-    az_gl_color(color1); glVertex2f(x_max - gap, y_min + gap);
-    az_gl_color(color2); glVertex2f(x_max - thick, y_min + thick);
-    az_gl_color(color1); glVertex2f(x_max - gap, y_max - gap);
-    az_gl_color(color2); glVertex2f(x_max - thick, y_max - thick);
-    az_gl_color(color1); glVertex2f(x_min + gap, y_max - gap);
-    az_gl_color(color2); glVertex2f(x_min + thick, y_max - thick);
-    az_gl_color(color1); glVertex2f(x_min + gap, y_min + gap);
-    az_gl_color(color2); glVertex2f(x_min + thick, y_min + thick);
-  } glEnd();
+  az_batch_begin(GL_TRIANGLE_STRIP); {
+    az_batch_color(color1); az_batch_vertex2d(x_min + gap, y_min + gap);
+    az_batch_color(color2); az_batch_vertex2d(x_min + thick, y_min + thick);
+    az_batch_color(color1); az_batch_vertex2d(x_max - gap, y_min + gap);
+    az_batch_color(color2); az_batch_vertex2d(x_max - thick, y_min + thick);
+    az_batch_color(color1); az_batch_vertex2d(x_max - gap, y_max - gap);
+    az_batch_color(color2); az_batch_vertex2d(x_max - thick, y_max - thick);
+    az_batch_color(color1); az_batch_vertex2d(x_min + gap, y_max - gap);
+    az_batch_color(color2); az_batch_vertex2d(x_min + thick, y_max - thick);
+    az_batch_color(color1); az_batch_vertex2d(x_min + gap, y_min + gap);
+    az_batch_color(color2); az_batch_vertex2d(x_min + thick, y_min + thick);
+  } az_batch_end();
   for (float x = x_min + hspace; x < x_max; x += space) {
     draw_rivet(color1, color2, x, y_min + hspace);
     draw_rivet(color1, color2, x, y_max - hspace);
@@ -178,59 +179,73 @@ static void draw_panel(az_color_t color1, az_color_t color2,
 
 static void draw_rock_wall(az_color_t color1, az_color_t color2,
                            float width, float height) {
-  glPushMatrix(); {
-    glScalef(width / 200.0f, height / 200.0f, 1.0f);
-    glBegin(GL_TRIANGLE_FAN); {
-      az_gl_color(color1); glVertex2f(-40, 0); az_gl_color(color2);
-      glVertex2f(-100, 0); glVertex2f(-30, -30); glVertex2f(20, 0);
-    } glEnd();
-    glBegin(GL_TRIANGLE_FAN); {
-      az_gl_color(color1); glVertex2f(70, 0); az_gl_color(color2);
-      glVertex2f(20, 0); glVertex2f(-30, -30); glVertex2f(0, -56);
-      glVertex2f(75, -40); glVertex2f(100, 0);
-    } glEnd();
-    glBegin(GL_TRIANGLE_FAN); {
-      az_gl_color(color1); glVertex2f(100, -44); az_gl_color(color2);
-      glVertex2f(100, 0); glVertex2f(75, -40); glVertex2f(100, -109);
-    } glEnd();
-    glBegin(GL_TRIANGLE_FAN); {
-      az_gl_color(color1); glVertex2f(-100, -44); az_gl_color(color2);
-      glVertex2f(-100, 0); glVertex2f(-30, -30); glVertex2f(0, -56);
-      glVertex2f(-40, -85); glVertex2f(-100, -109);
-    } glEnd();
-    glBegin(GL_TRIANGLE_FAN); {
-      az_gl_color(color1); glVertex2f(40, -80); az_gl_color(color2);
-      glVertex2f(100, -109); glVertex2f(75, -40); glVertex2f(0, -56);
-      glVertex2f(-40, -85); glVertex2f(10, -121); glVertex2f(100, -109);
-    } glEnd();
-    glBegin(GL_TRIANGLE_FAN); {
-      az_gl_color(color1); glVertex2f(-50, -135); az_gl_color(color2);
-      glVertex2f(-100, -109); glVertex2f(-57, -170); glVertex2f(-15, -162);
-      glVertex2f(10, -121); glVertex2f(-40, -85); glVertex2f(-100, -109);
-    } glEnd();
-    glBegin(GL_TRIANGLE_FAN); {
-      az_gl_color(color1); glVertex2f(-100, -161); az_gl_color(color2);
-      glVertex2f(-100, -109); glVertex2f(-57, -170); glVertex2f(-100, -200);
-    } glEnd();
-    glBegin(GL_TRIANGLE_FAN); {
-      az_gl_color(color1); glVertex2f(-40, -200); az_gl_color(color2);
-      glVertex2f(-100, -200); glVertex2f(-57, -170); glVertex2f(-15, -162);
-      glVertex2f(20, -200);
-    } glEnd();
-    glBegin(GL_TRIANGLE_FAN); {
-      az_gl_color(color1); glVertex2f(40, -160); az_gl_color(color2);
-      glVertex2f(100, -109); glVertex2f(10, -121); glVertex2f(-15, -162);
-      glVertex2f(20, -200); glVertex2f(65, -179); glVertex2f(100, -109);
-    } glEnd();
-    glBegin(GL_TRIANGLE_FAN); {
-      az_gl_color(color1); glVertex2f(100, -161); az_gl_color(color2);
-      glVertex2f(100, -109); glVertex2f(65, -179); glVertex2f(100, -200);
-    } glEnd();
-    glBegin(GL_TRIANGLE_FAN); {
-      az_gl_color(color1); glVertex2f(70, -200); az_gl_color(color2);
-      glVertex2f(100, -200); glVertex2f(65, -179); glVertex2f(20, -200);
-    } glEnd();
-  } glPopMatrix();
+  az_batch_push_transform(); {
+    az_batch_scale(width / 200.0f, height / 200.0f);
+    az_batch_begin(GL_TRIANGLE_FAN); {
+      az_batch_color(color1); az_batch_vertex2d(-40, 0); az_batch_color(color2);
+      az_batch_vertex2d(-100, 0); az_batch_vertex2d(-30, -30);
+      az_batch_vertex2d(20, 0);
+    } az_batch_end();
+    az_batch_begin(GL_TRIANGLE_FAN); {
+      az_batch_color(color1); az_batch_vertex2d(70, 0); az_batch_color(color2);
+      az_batch_vertex2d(20, 0); az_batch_vertex2d(-30, -30);
+      az_batch_vertex2d(0, -56); az_batch_vertex2d(75, -40);
+      az_batch_vertex2d(100, 0);
+    } az_batch_end();
+    az_batch_begin(GL_TRIANGLE_FAN); {
+      az_batch_color(color1); az_batch_vertex2d(100, -44);
+      az_batch_color(color2); az_batch_vertex2d(100, 0);
+      az_batch_vertex2d(75, -40); az_batch_vertex2d(100, -109);
+    } az_batch_end();
+    az_batch_begin(GL_TRIANGLE_FAN); {
+      az_batch_color(color1); az_batch_vertex2d(-100, -44);
+      az_batch_color(color2); az_batch_vertex2d(-100, 0);
+      az_batch_vertex2d(-30, -30); az_batch_vertex2d(0, -56);
+      az_batch_vertex2d(-40, -85); az_batch_vertex2d(-100, -109);
+    } az_batch_end();
+    az_batch_begin(GL_TRIANGLE_FAN); {
+      az_batch_color(color1); az_batch_vertex2d(40, -80);
+      az_batch_color(color2); az_batch_vertex2d(100, -109);
+      az_batch_vertex2d(75, -40); az_batch_vertex2d(0, -56);
+      az_batch_vertex2d(-40, -85); az_batch_vertex2d(10, -121);
+      az_batch_vertex2d(100, -109);
+    } az_batch_end();
+    az_batch_begin(GL_TRIANGLE_FAN); {
+      az_batch_color(color1); az_batch_vertex2d(-50, -135);
+      az_batch_color(color2); az_batch_vertex2d(-100, -109);
+      az_batch_vertex2d(-57, -170); az_batch_vertex2d(-15, -162);
+      az_batch_vertex2d(10, -121); az_batch_vertex2d(-40, -85);
+      az_batch_vertex2d(-100, -109);
+    } az_batch_end();
+    az_batch_begin(GL_TRIANGLE_FAN); {
+      az_batch_color(color1); az_batch_vertex2d(-100, -161);
+      az_batch_color(color2); az_batch_vertex2d(-100, -109);
+      az_batch_vertex2d(-57, -170); az_batch_vertex2d(-100, -200);
+    } az_batch_end();
+    az_batch_begin(GL_TRIANGLE_FAN); {
+      az_batch_color(color1); az_batch_vertex2d(-40, -200);
+      az_batch_color(color2); az_batch_vertex2d(-100, -200);
+      az_batch_vertex2d(-57, -170); az_batch_vertex2d(-15, -162);
+      az_batch_vertex2d(20, -200);
+    } az_batch_end();
+    az_batch_begin(GL_TRIANGLE_FAN); {
+      az_batch_color(color1); az_batch_vertex2d(40, -160);
+      az_batch_color(color2); az_batch_vertex2d(100, -109);
+      az_batch_vertex2d(10, -121); az_batch_vertex2d(-15, -162);
+      az_batch_vertex2d(20, -200); az_batch_vertex2d(65, -179);
+      az_batch_vertex2d(100, -109);
+    } az_batch_end();
+    az_batch_begin(GL_TRIANGLE_FAN); {
+      az_batch_color(color1); az_batch_vertex2d(100, -161);
+      az_batch_color(color2); az_batch_vertex2d(100, -109);
+      az_batch_vertex2d(65, -179); az_batch_vertex2d(100, -200);
+    } az_batch_end();
+    az_batch_begin(GL_TRIANGLE_FAN); {
+      az_batch_color(color1); az_batch_vertex2d(70, -200);
+      az_batch_color(color2); az_batch_vertex2d(100, -200);
+      az_batch_vertex2d(65, -179); az_batch_vertex2d(20, -200);
+    } az_batch_end();
+  } az_batch_pop_transform();
 }
 
 static void draw_hex_trellis(void) {
@@ -238,118 +253,123 @@ static void draw_hex_trellis(void) {
   const az_color_t color2 = {24, 24, 24, 255};
   const float thick1 = 3.0f;
   const float thick2 = thick1 * (0.25 + 0.5 * sqrt(3));
-  glBegin(GL_TRIANGLE_STRIP); {
-    az_gl_color(color1); glVertex2f(-45 - thick2, 0);
-    az_gl_color(color2); glVertex2f(-45 + thick2, 0);
-    az_gl_color(color1); glVertex2f(-60 - thick2, -26);
-    az_gl_color(color2); glVertex2f(-60 + thick2, -26);
-    az_gl_color(color1); glVertex2f(-30 - thick2, -78);
-    az_gl_color(color2); glVertex2f(-30 + thick2, -78);
-    az_gl_color(color1); glVertex2f(-45 - thick2, -104);
-    az_gl_color(color2); glVertex2f(-45 + thick2, -104);
-  } glEnd();
-  glBegin(GL_TRIANGLE_STRIP); {
-    az_gl_color(color1); glVertex2f(45 - thick2, 0);
-    az_gl_color(color2); glVertex2f(45 + thick2, 0);
-    az_gl_color(color1); glVertex2f(60 - thick2, -26);
-    az_gl_color(color2); glVertex2f(60 + thick2, -26);
-    az_gl_color(color1); glVertex2f(30 - thick2, -78);
-    az_gl_color(color2); glVertex2f(30 + thick2, -78);
-    az_gl_color(color1); glVertex2f(45 - thick2, -104);
-    az_gl_color(color2); glVertex2f(45 + thick2, -104);
-  } glEnd();
-  glBegin(GL_TRIANGLE_STRIP); {
-    az_gl_color(color1);
-    glVertex2f(-90, -26 + thick1); glVertex2f(-61, -26 + thick1);
-    az_gl_color(color2);
-    glVertex2f(-90, -26 - thick1); glVertex2f(-61, -26 - thick1);
-  } glEnd();
-  glBegin(GL_TRIANGLE_STRIP); {
-    az_gl_color(color1);
-    glVertex2f(90, -26 + thick1); glVertex2f(61, -26 + thick1);
-    az_gl_color(color2);
-    glVertex2f(90, -26 - thick1); glVertex2f(61, -26 - thick1);
-  } glEnd();
-  glBegin(GL_TRIANGLE_STRIP); {
-    az_gl_color(color1);
-    glVertex2f(-29, -78 + thick1); glVertex2f(29, -78 + thick1);
-    az_gl_color(color2);
-    glVertex2f(-29, -78 - thick1); glVertex2f(29, -78 - thick1);
-  } glEnd();
+  az_batch_begin(GL_TRIANGLE_STRIP); {
+    az_batch_color(color1); az_batch_vertex2d(-45 - thick2, 0);
+    az_batch_color(color2); az_batch_vertex2d(-45 + thick2, 0);
+    az_batch_color(color1); az_batch_vertex2d(-60 - thick2, -26);
+    az_batch_color(color2); az_batch_vertex2d(-60 + thick2, -26);
+    az_batch_color(color1); az_batch_vertex2d(-30 - thick2, -78);
+    az_batch_color(color2); az_batch_vertex2d(-30 + thick2, -78);
+    az_batch_color(color1); az_batch_vertex2d(-45 - thick2, -104);
+    az_batch_color(color2); az_batch_vertex2d(-45 + thick2, -104);
+  } az_batch_end();
+  az_batch_begin(GL_TRIANGLE_STRIP); {
+    az_batch_color(color1); az_batch_vertex2d(45 - thick2, 0);
+    az_batch_color(color2); az_batch_vertex2d(45 + thick2, 0);
+    az_batch_color(color1); az_batch_vertex2d(60 - thick2, -26);
+    az_batch_color(color2); az_batch_vertex2d(60 + thick2, -26);
+    az_batch_color(color1); az_batch_vertex2d(30 - thick2, -78);
+    az_batch_color(color2); az_batch_vertex2d(30 + thick2, -78);
+    az_batch_color(color1); az_batch_vertex2d(45 - thick2, -104);
+    az_batch_color(color2); az_batch_vertex2d(45 + thick2, -104);
+  } az_batch_end();
+  az_batch_begin(GL_TRIANGLE_STRIP); {
+    az_batch_color(color1);
+    az_batch_vertex2d(-90, -26 + thick1); az_batch_vertex2d(-61, -26 + thick1);
+    az_batch_color(color2);
+    az_batch_vertex2d(-90, -26 - thick1); az_batch_vertex2d(-61, -26 - thick1);
+  } az_batch_end();
+  az_batch_begin(GL_TRIANGLE_STRIP); {
+    az_batch_color(color1);
+    az_batch_vertex2d(90, -26 + thick1); az_batch_vertex2d(61, -26 + thick1);
+    az_batch_color(color2);
+    az_batch_vertex2d(90, -26 - thick1); az_batch_vertex2d(61, -26 - thick1);
+  } az_batch_end();
+  az_batch_begin(GL_TRIANGLE_STRIP); {
+    az_batch_color(color1);
+    az_batch_vertex2d(-29, -78 + thick1); az_batch_vertex2d(29, -78 + thick1);
+    az_batch_color(color2);
+    az_batch_vertex2d(-29, -78 - thick1); az_batch_vertex2d(29, -78 - thick1);
+  } az_batch_end();
 }
 
 static void draw_girders(az_color_t color1, az_color_t color2,
                          az_color_t color3, float bottom) {
   for (int sign = -1; sign <= 1; sign += 2) {
-    glBegin(GL_TRIANGLE_STRIP); {
-      az_gl_color(color1);
-      glVertex2f(sign * 100, 0); glVertex2f(sign * -100, -185);
-      az_gl_color(color3);
-      glVertex2f(sign * 100, -15); glVertex2f(sign * -100, -200);
-    } glEnd();
+    az_batch_begin(GL_TRIANGLE_STRIP); {
+      az_batch_color(color1);
+      az_batch_vertex2d(sign * 100, 0); az_batch_vertex2d(sign * -100, -185);
+      az_batch_color(color3);
+      az_batch_vertex2d(sign * 100, -15); az_batch_vertex2d(sign * -100, -200);
+    } az_batch_end();
   }
   for (int sign = -1; sign <= 1; sign += 2) {
-    glBegin(GL_TRIANGLE_STRIP); {
-      az_gl_color(color3);
-      glVertex2f(sign * 115, 0); glVertex2f(sign * 115, bottom);
-      glVertex2f(sign * 105, 0); glVertex2f(sign * 105, bottom);
-    } glEnd();
-    glBegin(GL_TRIANGLE_STRIP); {
-      az_gl_color(color1);
-      glVertex2f(sign * 105, 0); glVertex2f(sign * 105, bottom);
-      az_gl_color(color2);
-      glVertex2f(sign * 100, 0); glVertex2f(sign * 100, bottom);
-    } glEnd();
+    az_batch_begin(GL_TRIANGLE_STRIP); {
+      az_batch_color(color3);
+      az_batch_vertex2d(sign * 115, 0); az_batch_vertex2d(sign * 115, bottom);
+      az_batch_vertex2d(sign * 105, 0); az_batch_vertex2d(sign * 105, bottom);
+    } az_batch_end();
+    az_batch_begin(GL_TRIANGLE_STRIP); {
+      az_batch_color(color1);
+      az_batch_vertex2d(sign * 105, 0); az_batch_vertex2d(sign * 105, bottom);
+      az_batch_color(color2);
+      az_batch_vertex2d(sign * 100, 0); az_batch_vertex2d(sign * 100, bottom);
+    } az_batch_end();
   }
 }
 
 static void draw_half_stone_brick(float width, float height, float rr) {
   const az_color_t color1 = {30, 30, 38, 255};
   const az_color_t color2 = {15, 15, 15, 255};
-  glBegin(GL_TRIANGLE_STRIP); {
-    az_gl_color(color2); glVertex2f(rr, 0); glVertex2f(width, 0);
-    az_gl_color(color1); glVertex2f(rr, -rr); glVertex2f(width, -rr);
-    glVertex2f(rr, -height + rr); glVertex2f(width, -height + rr);
-    az_gl_color(color2); glVertex2f(rr, -height); glVertex2f(width, -height);
-  } glEnd();
-  glBegin(GL_TRIANGLE_STRIP); {
-    az_gl_color(color2); glVertex2f(0, -rr); glVertex2f(0, -height + rr);
-    az_gl_color(color1); glVertex2f(rr, -rr); glVertex2f(rr, -height + rr);
-  } glEnd();
-  glBegin(GL_TRIANGLE_FAN); {
-    az_gl_color(color1); glVertex2f(rr, -rr); az_gl_color(color2);
+  az_batch_begin(GL_TRIANGLE_STRIP); {
+    az_batch_color(color2); az_batch_vertex2d(rr, 0);
+    az_batch_vertex2d(width, 0); az_batch_color(color1);
+    az_batch_vertex2d(rr, -rr); az_batch_vertex2d(width, -rr);
+    az_batch_vertex2d(rr, -height + rr); az_batch_vertex2d(width, -height + rr);
+    az_batch_color(color2); az_batch_vertex2d(rr, -height);
+    az_batch_vertex2d(width, -height);
+  } az_batch_end();
+  az_batch_begin(GL_TRIANGLE_STRIP); {
+    az_batch_color(color2); az_batch_vertex2d(0, -rr);
+    az_batch_vertex2d(0, -height + rr); az_batch_color(color1);
+    az_batch_vertex2d(rr, -rr); az_batch_vertex2d(rr, -height + rr);
+  } az_batch_end();
+  az_batch_begin(GL_TRIANGLE_FAN); {
+    az_batch_color(color1); az_batch_vertex2d(rr, -rr); az_batch_color(color2);
     for (int i = 90; i <= 180; i += 30) {
-      glVertex2d(rr + rr * cos(AZ_DEG2RAD(i)), -rr + rr * sin(AZ_DEG2RAD(i)));
+      az_batch_vertex2d(rr + rr * cos(AZ_DEG2RAD(i)),
+                        -rr + rr * sin(AZ_DEG2RAD(i)));
     }
-  } glEnd();
-  glBegin(GL_TRIANGLE_FAN); {
-    az_gl_color(color1); glVertex2f(rr, -height + rr); az_gl_color(color2);
+  } az_batch_end();
+  az_batch_begin(GL_TRIANGLE_FAN); {
+    az_batch_color(color1); az_batch_vertex2d(rr, -height + rr);
+    az_batch_color(color2);
     for (int i = 180; i <= 270; i += 30) {
-      glVertex2d(rr + rr * cos(AZ_DEG2RAD(i)),
-                 -height + rr + rr * sin(AZ_DEG2RAD(i)));
+      az_batch_vertex2d(rr + rr * cos(AZ_DEG2RAD(i)),
+                        -height + rr + rr * sin(AZ_DEG2RAD(i)));
     }
-  } glEnd();
+  } az_batch_end();
 }
 
 static void draw_half_cinderblock(float width, float height) {
   const az_color_t color1 = {64, 8, 8, 255};
   const az_color_t color2 = {24, 18, 18, 255};
   const float bezel = 13.5;
-  glBegin(GL_TRIANGLE_STRIP); {
-    az_gl_color(color2);
-    glVertex2f(0, 0); glVertex2f(width, 0);
-    glVertex2f(0, -height); glVertex2f(width, -height);
-  } glEnd();
-  glBegin(GL_TRIANGLE_STRIP); {
-    az_gl_color(color1); glVertex2f(width, 0);
-    az_gl_color(color2); glVertex2f(width, -bezel);
-    az_gl_color(color1); glVertex2f(0, 0);
-    az_gl_color(color2); glVertex2f(bezel, -bezel);
-    az_gl_color(color1); glVertex2f(0, -height);
-    az_gl_color(color2); glVertex2f(bezel, -height + bezel);
-    az_gl_color(color1); glVertex2f(width, -height);
-    az_gl_color(color2); glVertex2f(width, -height + bezel);
-  } glEnd();
+  az_batch_begin(GL_TRIANGLE_STRIP); {
+    az_batch_color(color2);
+    az_batch_vertex2d(0, 0); az_batch_vertex2d(width, 0);
+    az_batch_vertex2d(0, -height); az_batch_vertex2d(width, -height);
+  } az_batch_end();
+  az_batch_begin(GL_TRIANGLE_STRIP); {
+    az_batch_color(color1); az_batch_vertex2d(width, 0);
+    az_batch_color(color2); az_batch_vertex2d(width, -bezel);
+    az_batch_color(color1); az_batch_vertex2d(0, 0);
+    az_batch_color(color2); az_batch_vertex2d(bezel, -bezel);
+    az_batch_color(color1); az_batch_vertex2d(0, -height);
+    az_batch_color(color2); az_batch_vertex2d(bezel, -height + bezel);
+    az_batch_color(color1); az_batch_vertex2d(width, -height);
+    az_batch_color(color2); az_batch_vertex2d(width, -height + bezel);
+  } az_batch_end();
 }
 
 static void draw_bubble(double center_x, double center_y, double radius,
@@ -357,28 +377,28 @@ static void draw_bubble(double center_x, double center_y, double radius,
                         az_color_t mid, az_color_t outer) {
   const double mid_radius =
     radius * (0.4 + 0.01 * az_clock_zigzag(20, slowdown, clock));
-  glPushMatrix(); {
-    glTranslated(center_x, center_y, 0);
-    glBegin(GL_TRIANGLE_FAN); {
-      az_gl_color(inner);
-      glVertex2f(-0.1 * radius, 0.1 * radius);
-      az_gl_color(mid);
+  az_batch_push_transform(); {
+    az_batch_translate((az_vector_t){center_x, center_y});
+    az_batch_begin(GL_TRIANGLE_FAN); {
+      az_batch_color(inner);
+      az_batch_vertex2d(-0.1 * radius, 0.1 * radius);
+      az_batch_color(mid);
       for (int i = 0; i <= 360; i += 30) {
-        glVertex2d(mid_radius * cos(AZ_DEG2RAD(i)),
-                   mid_radius * sin(AZ_DEG2RAD(i)));
+        az_batch_vertex2d(mid_radius * cos(AZ_DEG2RAD(i)),
+                          mid_radius * sin(AZ_DEG2RAD(i)));
       }
-    } glEnd();
-    glBegin(GL_TRIANGLE_STRIP); {
+    } az_batch_end();
+    az_batch_begin(GL_TRIANGLE_STRIP); {
       for (int i = 0; i <= 360; i += 30) {
-        az_gl_color(mid);
-        glVertex2d(mid_radius * cos(AZ_DEG2RAD(i)),
-                   mid_radius * sin(AZ_DEG2RAD(i)));
-        az_gl_color(outer);
-        glVertex2d(1.5 * radius * cos(AZ_DEG2RAD(i)),
-                   radius * sin(AZ_DEG2RAD(i)));
+        az_batch_color(mid);
+        az_batch_vertex2d(mid_radius * cos(AZ_DEG2RAD(i)),
+                          mid_radius * sin(AZ_DEG2RAD(i)));
+        az_batch_color(outer);
+        az_batch_vertex2d(1.5 * radius * cos(AZ_DEG2RAD(i)),
+                          radius * sin(AZ_DEG2RAD(i)));
       }
-    } glEnd();
-  } glPopMatrix();
+    } az_batch_end();
+  } az_batch_pop_transform();
 }
 
 static void draw_green_bubble(double center_x, double center_y, double radius,
@@ -415,28 +435,28 @@ static void draw_purple_column(float center_x, double top, float semi_width,
   const az_color_t inner = {24, 16, 32, 255};
   if (cap) {
     const float cap_height = 5;
-    glBegin(GL_TRIANGLE_FAN); {
-      az_gl_color(inner);
-      glVertex2f(center_x, top - cap_height);
-      az_gl_color(outer);
-      glVertex2f(center_x - semi_width, top - cap_height);
-      glVertex2f(center_x, top);
-      glVertex2f(center_x + semi_width, top - cap_height);
-    } glEnd();
+    az_batch_begin(GL_TRIANGLE_FAN); {
+      az_batch_color(inner);
+      az_batch_vertex2d(center_x, top - cap_height);
+      az_batch_color(outer);
+      az_batch_vertex2d(center_x - semi_width, top - cap_height);
+      az_batch_vertex2d(center_x, top);
+      az_batch_vertex2d(center_x + semi_width, top - cap_height);
+    } az_batch_end();
     top -= cap_height;
     height -= cap_height;
   }
-  glBegin(GL_TRIANGLE_STRIP); {
-    az_gl_color(outer);
-    glVertex2f(center_x - semi_width, top);
-    glVertex2f(center_x - semi_width, top - height);
-    az_gl_color(inner);
-    glVertex2f(center_x, top);
-    glVertex2f(center_x, top - height);
-    az_gl_color(outer);
-    glVertex2f(center_x + semi_width, top);
-    glVertex2f(center_x + semi_width, top - height);
-  } glEnd();
+  az_batch_begin(GL_TRIANGLE_STRIP); {
+    az_batch_color(outer);
+    az_batch_vertex2d(center_x - semi_width, top);
+    az_batch_vertex2d(center_x - semi_width, top - height);
+    az_batch_color(inner);
+    az_batch_vertex2d(center_x, top);
+    az_batch_vertex2d(center_x, top - height);
+    az_batch_color(outer);
+    az_batch_vertex2d(center_x + semi_width, top);
+    az_batch_vertex2d(center_x + semi_width, top - height);
+  } az_batch_end();
 }
 
 static void draw_half_shale_rock(float x_0, float y_0, float x_1, float y_1,
@@ -445,24 +465,26 @@ static void draw_half_shale_rock(float x_0, float y_0, float x_1, float y_1,
   const az_color_t color1 = {50, 50, 51, 255};
   const az_color_t color2 = {23, 24, 25, 255};
   const az_color_t color3 = {42, 42, 43, 255};
-  glBegin(GL_TRIANGLE_FAN); {
-    az_gl_color(color3); glVertex2f(0.5f * (x_0 + x_1), 0.5f * (y_0 + y_1));
-    az_gl_color(color1); glVertex2f(x_0, y_0);
-    az_gl_color(color2); glVertex2f(x_2, y_2); glVertex2f(x_1, y_1);
-  } glEnd();
-  glBegin(GL_TRIANGLE_FAN); {
-    az_gl_color(color3); glVertex2f(0.25f * (x_0 + x_2 + x_3 + x_4),
-                                    0.25f * (y_0 + y_2 + y_3 + y_4));
-    az_gl_color(color1); glVertex2f(x_0, y_0);
-    az_gl_color(color2);
-    glVertex2f(x_2, y_2); glVertex2f(x_3, y_3); glVertex2f(x_4, y_4);
-    az_gl_color(color1); glVertex2f(x_0, y_0);
-  } glEnd();
-  glBegin(GL_TRIANGLE_FAN); {
-    az_gl_color(color3); glVertex2f(0.5f * (x_0 + x_5), 0.5f * (y_0 + y_5));
-    az_gl_color(color1); glVertex2f(x_0, y_0);
-    az_gl_color(color2); glVertex2f(x_4, y_4); glVertex2f(x_5, y_5);
-  } glEnd();
+  az_batch_begin(GL_TRIANGLE_FAN); {
+    az_batch_color(color3);
+    az_batch_vertex2d(0.5f * (x_0 + x_1), 0.5f * (y_0 + y_1));
+    az_batch_color(color1); az_batch_vertex2d(x_0, y_0); az_batch_color(color2);
+    az_batch_vertex2d(x_2, y_2); az_batch_vertex2d(x_1, y_1);
+  } az_batch_end();
+  az_batch_begin(GL_TRIANGLE_FAN); {
+    az_batch_color(color3); az_batch_vertex2d(0.25f * (x_0 + x_2 + x_3 + x_4),
+                                           0.25f * (y_0 + y_2 + y_3 + y_4));
+    az_batch_color(color1); az_batch_vertex2d(x_0, y_0); az_batch_color(color2);
+    az_batch_vertex2d(x_2, y_2); az_batch_vertex2d(x_3, y_3);
+    az_batch_vertex2d(x_4, y_4); az_batch_color(color1);
+    az_batch_vertex2d(x_0, y_0);
+  } az_batch_end();
+  az_batch_begin(GL_TRIANGLE_FAN); {
+    az_batch_color(color3);
+    az_batch_vertex2d(0.5f * (x_0 + x_5), 0.5f * (y_0 + y_5));
+    az_batch_color(color1); az_batch_vertex2d(x_0, y_0); az_batch_color(color2);
+    az_batch_vertex2d(x_4, y_4); az_batch_vertex2d(x_5, y_5);
+  } az_batch_end();
 }
 
 static void draw_crystal_cell(float x_0, float y_0, float x_1, float y_1,
@@ -470,42 +492,42 @@ static void draw_crystal_cell(float x_0, float y_0, float x_1, float y_1,
   const az_color_t color1 = {64, 48, 40, 255};
   const az_color_t color2 = {24, 6, 16, 128};
   const az_color_t color3 = {42, 34, 48, 255};
-  glBegin(GL_TRIANGLE_FAN); {
-    az_gl_color(color3); glVertex2f(0.33333333f * (x_0 + x_1 + x_2),
-                                    0.33333333f * (y_0 + y_1 + y_2));
-    az_gl_color(color1); glVertex2f(x_0, y_0);
-    az_gl_color(color2); glVertex2f(x_1, y_1); glVertex2f(x_2, y_2);
-    az_gl_color(color1); glVertex2f(x_0, y_0);
-  } glEnd();
+  az_batch_begin(GL_TRIANGLE_FAN); {
+    az_batch_color(color3); az_batch_vertex2d(0.33333333f * (x_0 + x_1 + x_2),
+                                           0.33333333f * (y_0 + y_1 + y_2));
+    az_batch_color(color1); az_batch_vertex2d(x_0, y_0); az_batch_color(color2);
+    az_batch_vertex2d(x_1, y_1); az_batch_vertex2d(x_2, y_2);
+    az_batch_color(color1); az_batch_vertex2d(x_0, y_0);
+  } az_batch_end();
 }
 
 static void draw_ice_cell(float x_0, float y_0, float x_1, float y_1,
                           float x_2, float y_2) {
   const az_color_t color1 = {32, 72, 72, 255};
   const az_color_t color2 = {16, 48, 32, 255};
-  glBegin(GL_TRIANGLE_FAN); {
-    az_gl_color(color1); glVertex2f(x_0, y_0);
-    az_gl_color(color2); glVertex2f(x_1, y_1); glVertex2f(x_2, y_2);
-  } glEnd();
+  az_batch_begin(GL_TRIANGLE_FAN); {
+    az_batch_color(color1); az_batch_vertex2d(x_0, y_0); az_batch_color(color2);
+    az_batch_vertex2d(x_1, y_1); az_batch_vertex2d(x_2, y_2);
+  } az_batch_end();
 }
 
 static void draw_green_diamond_quarter(float left, float top, float width,
                                        float height, float hbez, float vbez) {
   const az_color_t color1 = {39, 42, 39, 255};
   const az_color_t color2 = {13, 17, 13, 255};
-  glBegin(GL_TRIANGLE_STRIP); {
-    az_gl_color(color1);
-    glVertex2f(left, top);
-    glVertex2f(left, top - height + vbez);
-    glVertex2f(left + width - hbez, top);
-    az_gl_color(color2);
-    glVertex2f(left, top - height);
-    glVertex2f(left + width, top);
-    az_gl_color(color1);
-    glVertex2f(left + hbez, top - height);
-    glVertex2f(left + width, top - vbez);
-    glVertex2f(left + width, top - height);
-  } glEnd();
+  az_batch_begin(GL_TRIANGLE_STRIP); {
+    az_batch_color(color1);
+    az_batch_vertex2d(left, top);
+    az_batch_vertex2d(left, top - height + vbez);
+    az_batch_vertex2d(left + width - hbez, top);
+    az_batch_color(color2);
+    az_batch_vertex2d(left, top - height);
+    az_batch_vertex2d(left + width, top);
+    az_batch_color(color1);
+    az_batch_vertex2d(left + hbez, top - height);
+    az_batch_vertex2d(left + width, top - vbez);
+    az_batch_vertex2d(left + width, top - height);
+  } az_batch_end();
 }
 
 static void draw_tree_branch(
@@ -513,26 +535,27 @@ static void draw_tree_branch(
     GLfloat x_2, GLfloat y_2, GLfloat x_3, GLfloat y_3) {
   const az_color_t color1 = {48, 45, 42, 255};
   const az_color_t color2 = {24, 18, 12, 255};
-  glBegin(GL_TRIANGLE_FAN); {
-    az_gl_color(color1); glVertex2f(x_0, y_0); az_gl_color(color2);
-    glVertex2f(x_1, y_1); glVertex2f(x_2, y_2); glVertex2f(x_3, y_3);
-  } glEnd();
+  az_batch_begin(GL_TRIANGLE_FAN); {
+    az_batch_color(color1); az_batch_vertex2d(x_0, y_0); az_batch_color(color2);
+    az_batch_vertex2d(x_1, y_1); az_batch_vertex2d(x_2, y_2);
+    az_batch_vertex2d(x_3, y_3);
+  } az_batch_end();
 }
 
 static void draw_blinkenlight(GLfloat center_x, GLfloat center_y, bool lit) {
-  glPushMatrix(); {
-    glTranslatef(center_x, center_y, 0);
-    glBegin(GL_TRIANGLE_FAN); {
-      if (lit) glColor4f(0.30, 0.30, 0.15, 0.9);
-      else glColor4f(0.15, 0.15, 0.15, 0.9);
-      glVertex2f(0, 0);
-      if (lit) glColor4f(0.30, 0.30, 0.15, 0);
-      else glColor4f(0.15, 0.15, 0.15, 0);
+  az_batch_push_transform(); {
+    az_batch_translate((az_vector_t){center_x, center_y});
+    az_batch_begin(GL_TRIANGLE_FAN); {
+      if (lit) az_batch_color4f(0.30, 0.30, 0.15, 0.9);
+      else az_batch_color4f(0.15, 0.15, 0.15, 0.9);
+      az_batch_vertex2d(0, 0);
+      if (lit) az_batch_color4f(0.30, 0.30, 0.15, 0);
+      else az_batch_color4f(0.15, 0.15, 0.15, 0);
       for (int i = 0; i <= 360; i += 45) {
-        glVertex2d(4 * cos(AZ_DEG2RAD(i)), 4 * sin(AZ_DEG2RAD(i)));
+        az_batch_vertex2d(4 * cos(AZ_DEG2RAD(i)), 4 * sin(AZ_DEG2RAD(i)));
       }
-    } glEnd();
-  } glPopMatrix();
+    } az_batch_end();
+  } az_batch_pop_transform();
 }
 
 // Draw one patch of the background pattern.  It should cover the rect from
@@ -546,9 +569,9 @@ static void draw_bg_patch(az_background_pattern_t pattern, az_clock_t clock) {
       draw_rock_wall(color1, color2, 200, 200);
     } break;
     case AZ_BG_GREEN_HEX_TRELLIS: {
-      glPushMatrix(); {
-        glScalef(140.0f / 300.0f, 180.0f / 300.0f, 1.0f);
-        glScalef(2, 2, 1);
+      az_batch_push_transform(); {
+        az_batch_scale(140.0f / 300.0f, 180.0f / 300.0f);
+        az_batch_scale(2, 2);
         draw_brown_bubble(0, -160, 35, 4, clock + 5);
         draw_brown_bubble(0, -90, 50, 6, clock);
         draw_brown_bubble(-40, -25, 40, 5, clock);
@@ -556,12 +579,12 @@ static void draw_bg_patch(az_background_pattern_t pattern, az_clock_t clock) {
         draw_brown_bubble(-55, -120, 32, 3, clock);
         draw_brown_bubble(40, -130, 30, 2, clock);
         draw_brown_bubble(63, -75, 27, 3, clock + 5);
-      } glPopMatrix();
-      glPushMatrix(); {
+      } az_batch_pop_transform();
+      az_batch_push_transform(); {
         draw_hex_trellis();
-        glTranslatef(0.0f, -104.0f, 0.0f);
+        az_batch_translate((az_vector_t){0.0f, -104.0f});
         draw_hex_trellis();
-      } glPopMatrix();
+      } az_batch_pop_transform();
     } break;
     case AZ_BG_YELLOW_PANELLING: {
       const int bottom = -background_datas[pattern].repeat_vert;
@@ -579,16 +602,16 @@ static void draw_bg_patch(az_background_pattern_t pattern, az_clock_t clock) {
       draw_panel(color2, color1, -3 * horz, -8 * vert,  5 * horz, -6 * vert);
       for (int sign = -1; sign <= 1; sign += 2) {
         for (int y = bottom + 20; y <= 0; y += 20) {
-          glBegin(GL_TRIANGLE_STRIP); {
-            az_gl_color(color2);
-            glVertex2f(sign * (5 * horz + 2), y);
-            glVertex2f(sign * (5 * horz + 2), y - 19);
-            az_gl_color(color3);
-            glVertex2f(sign * 170, y);
-            glVertex2f(sign * 170, y - 19);
-            glVertex2f(sign * 180, y);
-            glVertex2f(sign * 180, y - 19);
-          } glEnd();
+          az_batch_begin(GL_TRIANGLE_STRIP); {
+            az_batch_color(color2);
+            az_batch_vertex2d(sign * (5 * horz + 2), y);
+            az_batch_vertex2d(sign * (5 * horz + 2), y - 19);
+            az_batch_color(color3);
+            az_batch_vertex2d(sign * 170, y);
+            az_batch_vertex2d(sign * 170, y - 19);
+            az_batch_vertex2d(sign * 180, y);
+            az_batch_vertex2d(sign * 180, y - 19);
+          } az_batch_end();
         }
       }
     } break;
@@ -623,32 +646,32 @@ static void draw_bg_patch(az_background_pattern_t pattern, az_clock_t clock) {
       const float half_width = 65;
       const float height = 65;
       const float radius = 8;
-      glPushMatrix(); {
-        glTranslatef(-0.5f * half_width, 0, 0);
+      az_batch_push_transform(); {
+        az_batch_translate((az_vector_t){-0.5f * half_width, 0});
         draw_half_stone_brick(1.5f * half_width, height, radius);
-        glTranslatef(half_width, -height, 0);
+        az_batch_translate((az_vector_t){half_width, -height});
         draw_half_stone_brick(0.5f * half_width, height, radius);
-        glTranslatef(-half_width, height, 0);
-        glScalef(-1, 1, 1);
+        az_batch_translate((az_vector_t){-half_width, height});
+        az_batch_scale(-1, 1);
         draw_half_stone_brick(0.5f * half_width, height, radius);
-        glTranslatef(-half_width, -height, 0);
+        az_batch_translate((az_vector_t){-half_width, -height});
         draw_half_stone_brick(1.5f * half_width, height, radius);
-      } glPopMatrix();
+      } az_batch_pop_transform();
     } break;
     case AZ_BG_RED_GRAY_CINDERBLOCKS: {
       const float half_width = 45;
       const float height = 59.4;
-      glPushMatrix(); {
-        glTranslatef(-0.5f * half_width, 0, 0);
+      az_batch_push_transform(); {
+        az_batch_translate((az_vector_t){-0.5f * half_width, 0});
         draw_half_cinderblock(1.5f * half_width, height);
-        glTranslatef(half_width, -height, 0);
+        az_batch_translate((az_vector_t){half_width, -height});
         draw_half_cinderblock(0.5f * half_width, height);
-        glTranslatef(-half_width, height, 0);
-        glScalef(-1, 1, 1);
+        az_batch_translate((az_vector_t){-half_width, height});
+        az_batch_scale(-1, 1);
         draw_half_cinderblock(0.5f * half_width, height);
-        glTranslatef(-half_width, -height, 0);
+        az_batch_translate((az_vector_t){-half_width, -height});
         draw_half_cinderblock(1.5f * half_width, height);
-      } glPopMatrix();
+      } az_batch_pop_transform();
     } break;
     case AZ_BG_GREEN_BUBBLES: {
       draw_green_bubble(0, -90, 50, 12, clock);
@@ -691,12 +714,12 @@ static void draw_bg_patch(az_background_pattern_t pattern, az_clock_t clock) {
                            100, -143, 100, -180, 0, -180);
     } break;
     case AZ_BG_CRYSTAL_CAVE: {
-      glBegin(GL_TRIANGLE_STRIP); {
+      az_batch_begin(GL_TRIANGLE_STRIP); {
         const float gray = 0.003f * az_clock_zigzag(100, 1, clock);
-        glColor3f(gray, gray, gray);
-        glVertex2f(-60,    0); glVertex2f(60,    0);
-        glVertex2f(-60, -100); glVertex2f(60, -100);
-      } glEnd();
+        az_batch_color3f(gray, gray, gray);
+        az_batch_vertex2d(-60,    0); az_batch_vertex2d(60,    0);
+        az_batch_vertex2d(-60, -100); az_batch_vertex2d(60, -100);
+      } az_batch_end();
       draw_crystal_cell(-10, -58, -20, 0, -60, -58);
       draw_crystal_cell(-60, 0, -20, 0, -60, -58);
       draw_crystal_cell(-10, -58, -20, 0, 60, -58);
@@ -717,15 +740,15 @@ static void draw_bg_patch(az_background_pattern_t pattern, az_clock_t clock) {
       draw_ice_cell(48, -160, -16, -160, 48, -93);
     } break;
     case AZ_BG_PURPLE_BUBBLES: {
-      glPushMatrix(); {
-        glScalef(2, 2, 1);
+      az_batch_push_transform(); {
+        az_batch_scale(2, 2);
         draw_purple_bubble(0, -90, 50, 6, clock);
         draw_purple_bubble(-40, -25, 40, 5, clock);
         draw_purple_bubble(30, -40, 35, 4, clock);
         draw_purple_bubble(-55, -120, 32, 3, clock);
         draw_purple_bubble(40, -130, 30, 2, clock);
         draw_purple_bubble(63, -75, 27, 3, clock + 5);
-      } glPopMatrix();
+      } az_batch_pop_transform();
     } break;
     case AZ_BG_GREEN_DIAMONDS: {
       draw_green_diamond_quarter(0, 0, 60, 60, 10, 10);
@@ -753,13 +776,14 @@ static void draw_bg_patch(az_background_pattern_t pattern, az_clock_t clock) {
             (indent ? 0.5 * xstep : 0);
           const double cy = y + 0.3 * ystep * az_rand_sdouble(&seed);
           const double theta = AZ_TWO_PI * az_rand_udouble(&seed);
-          glBegin(GL_TRIANGLE_FAN); {
-            az_gl_color(color4); glVertex2f(cx, cy); az_gl_color(color3);
+          az_batch_begin(GL_TRIANGLE_FAN); {
+            az_batch_color(color4); az_batch_vertex2d(cx, cy);
+            az_batch_color(color3);
             for (int i = 0; i <= 360; i += 45) {
-              glVertex2d(cx + rx * cos(AZ_DEG2RAD(i) + theta),
-                         cy + ry * sin(AZ_DEG2RAD(i) + theta));
+              az_batch_vertex2d(cx + rx * cos(AZ_DEG2RAD(i) + theta),
+                                cy + ry * sin(AZ_DEG2RAD(i) + theta));
             }
-          } glEnd();
+          } az_batch_end();
         }
         indent = !indent;
       }
@@ -768,36 +792,48 @@ static void draw_bg_patch(az_background_pattern_t pattern, az_clock_t clock) {
       const az_color_t color1 = {48, 45, 42, 255};
       const az_color_t color2 = {24, 18, 12, 255};
       // Trunks:
-      glBegin(GL_TRIANGLE_STRIP); {
-        az_gl_color(color1); glVertex2f(-100,    0); glVertex2f(-100, -115);
-        az_gl_color(color2); glVertex2f( -50,    0); glVertex2f( -50,  -45);
-        az_gl_color(color1); glVertex2f(   0,    0); glVertex2f(   0, -115);
-      } glEnd();
-      glBegin(GL_TRIANGLE_STRIP); {
-        az_gl_color(color1); glVertex2f(   0,    0); glVertex2f(   0, -180);
-        az_gl_color(color2); glVertex2f(  50,    0); glVertex2f(  50, -110);
-        az_gl_color(color1); glVertex2f( 100,    0); glVertex2f( 100, -180);
-      } glEnd();
-      glBegin(GL_TRIANGLE_STRIP); {
-        az_gl_color(color2); glVertex2f(-100, -115); glVertex2f(-100, -290);
-        az_gl_color(color1); glVertex2f( -50,  -45); glVertex2f( -50, -315);
-        az_gl_color(color2); glVertex2f(   0, -115); glVertex2f(   0, -245);
-      } glEnd();
-      glBegin(GL_TRIANGLE_STRIP); {
-        az_gl_color(color2); glVertex2f(   0, -180); glVertex2f(   0, -310);
-        az_gl_color(color1); glVertex2f(  50, -110); glVertex2f(  50, -380);
-        az_gl_color(color2); glVertex2f( 100, -180); glVertex2f( 100, -310);
-      } glEnd();
-      glBegin(GL_TRIANGLE_STRIP); {
-        az_gl_color(color1); glVertex2f(-100, -290); glVertex2f(-100, -400);
-        az_gl_color(color2); glVertex2f( -50, -315); glVertex2f( -50, -400);
-        az_gl_color(color1); glVertex2f(   0, -245); glVertex2f(   0, -400);
-      } glEnd();
-      glBegin(GL_TRIANGLE_STRIP); {
-        az_gl_color(color1); glVertex2f(   0, -310); glVertex2f(   0, -400);
-        az_gl_color(color2); glVertex2f(  50, -380); glVertex2f(  50, -400);
-        az_gl_color(color1); glVertex2f( 100, -310); glVertex2f( 100, -400);
-      } glEnd();
+      az_batch_begin(GL_TRIANGLE_STRIP); {
+        az_batch_color(color1); az_batch_vertex2d(-100,    0);
+        az_batch_vertex2d(-100, -115); az_batch_color(color2);
+        az_batch_vertex2d( -50,    0); az_batch_vertex2d( -50,  -45);
+        az_batch_color(color1); az_batch_vertex2d(   0,    0);
+        az_batch_vertex2d(   0, -115);
+      } az_batch_end();
+      az_batch_begin(GL_TRIANGLE_STRIP); {
+        az_batch_color(color1); az_batch_vertex2d(   0,    0);
+        az_batch_vertex2d(   0, -180); az_batch_color(color2);
+        az_batch_vertex2d(  50,    0); az_batch_vertex2d(  50, -110);
+        az_batch_color(color1); az_batch_vertex2d( 100,    0);
+        az_batch_vertex2d( 100, -180);
+      } az_batch_end();
+      az_batch_begin(GL_TRIANGLE_STRIP); {
+        az_batch_color(color2); az_batch_vertex2d(-100, -115);
+        az_batch_vertex2d(-100, -290); az_batch_color(color1);
+        az_batch_vertex2d( -50,  -45); az_batch_vertex2d( -50, -315);
+        az_batch_color(color2); az_batch_vertex2d(   0, -115);
+        az_batch_vertex2d(   0, -245);
+      } az_batch_end();
+      az_batch_begin(GL_TRIANGLE_STRIP); {
+        az_batch_color(color2); az_batch_vertex2d(   0, -180);
+        az_batch_vertex2d(   0, -310); az_batch_color(color1);
+        az_batch_vertex2d(  50, -110); az_batch_vertex2d(  50, -380);
+        az_batch_color(color2); az_batch_vertex2d( 100, -180);
+        az_batch_vertex2d( 100, -310);
+      } az_batch_end();
+      az_batch_begin(GL_TRIANGLE_STRIP); {
+        az_batch_color(color1); az_batch_vertex2d(-100, -290);
+        az_batch_vertex2d(-100, -400); az_batch_color(color2);
+        az_batch_vertex2d( -50, -315); az_batch_vertex2d( -50, -400);
+        az_batch_color(color1); az_batch_vertex2d(   0, -245);
+        az_batch_vertex2d(   0, -400);
+      } az_batch_end();
+      az_batch_begin(GL_TRIANGLE_STRIP); {
+        az_batch_color(color1); az_batch_vertex2d(   0, -310);
+        az_batch_vertex2d(   0, -400); az_batch_color(color2);
+        az_batch_vertex2d(  50, -380); az_batch_vertex2d(  50, -400);
+        az_batch_color(color1); az_batch_vertex2d( 100, -310);
+        az_batch_vertex2d( 100, -400);
+      } az_batch_end();
       // Top-left trunk branches:
       draw_tree_branch( -50, -105,  -50,  -45, -10,   -5,  -15,  -95);
       draw_tree_branch( -50, -105,  -50,  -45, -90,    0,  -75,  -95);
@@ -821,15 +857,15 @@ static void draw_bg_patch(az_background_pattern_t pattern, az_clock_t clock) {
       draw_tree_branch(   0, -350,  -20, -320, -90, -320,  -45, -370);
     } break;
     case AZ_BG_BLUE_BUBBLES: {
-      glPushMatrix(); {
-        glScalef(1.5, 2, 1);
+      az_batch_push_transform(); {
+        az_batch_scale(1.5, 2);
         draw_blue_bubble(0, -90, 50, 6, clock);
         draw_blue_bubble(-40, -25, 40, 5, clock);
         draw_blue_bubble(30, -40, 35, 4, clock);
         draw_blue_bubble(-55, -120, 32, 3, clock);
         draw_blue_bubble(40, -130, 30, 2, clock);
         draw_blue_bubble(63, -75, 27, 3, clock + 5);
-      } glPopMatrix();
+      } az_batch_pop_transform();
     } break;
     case AZ_BG_GREEN_PANELLING: {
       const az_color_t color1 = {30, 60, 45, 255};
@@ -848,58 +884,58 @@ static void draw_bg_patch(az_background_pattern_t pattern, az_clock_t clock) {
       const az_color_t color1 = {20, 30, 40, 255};
       const az_color_t color2 = {10, 15, 20, 255};
       const int phase = az_clock_mod(4, 20, clock);
-      glBegin(GL_TRIANGLE_STRIP); {
-        az_gl_color(color1); glVertex2f(-75,    0);
-        az_gl_color(color2); glVertex2f(-63,   -7);
-        az_gl_color(color1); glVertex2f( 75,    0);
-        az_gl_color(color2); glVertex2f( 63,   -7);
-        az_gl_color(color1); glVertex2f(  0, -130);
-        az_gl_color(color2); glVertex2f(  0, -116);
-        az_gl_color(color1); glVertex2f(-75,    0);
-        az_gl_color(color2); glVertex2f(-63,   -7);
-      } glEnd();
-      glBegin(GL_TRIANGLE_STRIP); {
-        az_gl_color(color1); glVertex2f(-75, -260);
-        az_gl_color(color2); glVertex2f(-63, -253);
-        az_gl_color(color1); glVertex2f( 75, -260);
-        az_gl_color(color2); glVertex2f( 63, -253);
-        az_gl_color(color1); glVertex2f(  0, -130);
-        az_gl_color(color2); glVertex2f(  0, -144);
-        az_gl_color(color1); glVertex2f(-75, -260);
-        az_gl_color(color2); glVertex2f(-63, -253);
-      } glEnd();
-      glBegin(GL_TRIANGLE_STRIP); {
-        az_gl_color(color1); glVertex2f(-75, -130);
-        az_gl_color(color2); glVertex2f(-75, -123);
-        az_gl_color(color1); glVertex2f(  0, -130);
-        az_gl_color(color2); glVertex2f(-12, -123);
-        az_gl_color(color1); glVertex2f(-75,    0);
-        az_gl_color(color2); glVertex2f(-75,  -14);
-      } glEnd();
-      glBegin(GL_TRIANGLE_STRIP); {
-        az_gl_color(color1); glVertex2f( 75, -130);
-        az_gl_color(color2); glVertex2f( 75, -123);
-        az_gl_color(color1); glVertex2f(  0, -130);
-        az_gl_color(color2); glVertex2f( 12, -123);
-        az_gl_color(color1); glVertex2f( 75,    0);
-        az_gl_color(color2); glVertex2f( 75,  -14);
-      } glEnd();
-      glBegin(GL_TRIANGLE_STRIP); {
-        az_gl_color(color1); glVertex2f(-75, -130);
-        az_gl_color(color2); glVertex2f(-75, -137);
-        az_gl_color(color1); glVertex2f(  0, -130);
-        az_gl_color(color2); glVertex2f(-12, -137);
-        az_gl_color(color1); glVertex2f(-75, -260);
-        az_gl_color(color2); glVertex2f(-75, -246);
-      } glEnd();
-      glBegin(GL_TRIANGLE_STRIP); {
-        az_gl_color(color1); glVertex2f( 75, -130);
-        az_gl_color(color2); glVertex2f( 75, -137);
-        az_gl_color(color1); glVertex2f(  0, -130);
-        az_gl_color(color2); glVertex2f( 12, -137);
-        az_gl_color(color1); glVertex2f( 75, -260);
-        az_gl_color(color2); glVertex2f( 75, -246);
-      } glEnd();
+      az_batch_begin(GL_TRIANGLE_STRIP); {
+        az_batch_color(color1); az_batch_vertex2d(-75,    0);
+        az_batch_color(color2); az_batch_vertex2d(-63,   -7);
+        az_batch_color(color1); az_batch_vertex2d( 75,    0);
+        az_batch_color(color2); az_batch_vertex2d( 63,   -7);
+        az_batch_color(color1); az_batch_vertex2d(  0, -130);
+        az_batch_color(color2); az_batch_vertex2d(  0, -116);
+        az_batch_color(color1); az_batch_vertex2d(-75,    0);
+        az_batch_color(color2); az_batch_vertex2d(-63,   -7);
+      } az_batch_end();
+      az_batch_begin(GL_TRIANGLE_STRIP); {
+        az_batch_color(color1); az_batch_vertex2d(-75, -260);
+        az_batch_color(color2); az_batch_vertex2d(-63, -253);
+        az_batch_color(color1); az_batch_vertex2d( 75, -260);
+        az_batch_color(color2); az_batch_vertex2d( 63, -253);
+        az_batch_color(color1); az_batch_vertex2d(  0, -130);
+        az_batch_color(color2); az_batch_vertex2d(  0, -144);
+        az_batch_color(color1); az_batch_vertex2d(-75, -260);
+        az_batch_color(color2); az_batch_vertex2d(-63, -253);
+      } az_batch_end();
+      az_batch_begin(GL_TRIANGLE_STRIP); {
+        az_batch_color(color1); az_batch_vertex2d(-75, -130);
+        az_batch_color(color2); az_batch_vertex2d(-75, -123);
+        az_batch_color(color1); az_batch_vertex2d(  0, -130);
+        az_batch_color(color2); az_batch_vertex2d(-12, -123);
+        az_batch_color(color1); az_batch_vertex2d(-75,    0);
+        az_batch_color(color2); az_batch_vertex2d(-75,  -14);
+      } az_batch_end();
+      az_batch_begin(GL_TRIANGLE_STRIP); {
+        az_batch_color(color1); az_batch_vertex2d( 75, -130);
+        az_batch_color(color2); az_batch_vertex2d( 75, -123);
+        az_batch_color(color1); az_batch_vertex2d(  0, -130);
+        az_batch_color(color2); az_batch_vertex2d( 12, -123);
+        az_batch_color(color1); az_batch_vertex2d( 75,    0);
+        az_batch_color(color2); az_batch_vertex2d( 75,  -14);
+      } az_batch_end();
+      az_batch_begin(GL_TRIANGLE_STRIP); {
+        az_batch_color(color1); az_batch_vertex2d(-75, -130);
+        az_batch_color(color2); az_batch_vertex2d(-75, -137);
+        az_batch_color(color1); az_batch_vertex2d(  0, -130);
+        az_batch_color(color2); az_batch_vertex2d(-12, -137);
+        az_batch_color(color1); az_batch_vertex2d(-75, -260);
+        az_batch_color(color2); az_batch_vertex2d(-75, -246);
+      } az_batch_end();
+      az_batch_begin(GL_TRIANGLE_STRIP); {
+        az_batch_color(color1); az_batch_vertex2d( 75, -130);
+        az_batch_color(color2); az_batch_vertex2d( 75, -137);
+        az_batch_color(color1); az_batch_vertex2d(  0, -130);
+        az_batch_color(color2); az_batch_vertex2d( 12, -137);
+        az_batch_color(color1); az_batch_vertex2d( 75, -260);
+        az_batch_color(color2); az_batch_vertex2d( 75, -246);
+      } az_batch_end();
 
       draw_blinkenlight(-55.5,   -4, phase == 0);
       draw_blinkenlight(-55.5, -256, phase == 0);
@@ -965,16 +1001,16 @@ static void draw_bg_patch(az_background_pattern_t pattern, az_clock_t clock) {
           const double size = 2 + 4 * az_rand_udouble(&seed);
           const double cx = xoff + star_spacing * az_rand_udouble(&seed);
           const double cy = yoff + star_spacing * az_rand_udouble(&seed);
-          glBegin(GL_TRIANGLE_FAN); {
-            glColor3f(0.5, 0.5, 0.5);
-            glVertex2d(cx, cy);
-            glColor3f(0.1, 0.1, 0.1);
+          az_batch_begin(GL_TRIANGLE_FAN); {
+            az_batch_color3f(0.5, 0.5, 0.5);
+            az_batch_vertex2d(cx, cy);
+            az_batch_color3f(0.1, 0.1, 0.1);
             for (int i = 0; i <= 360; i += 45) {
               const double rho = size * (i % 2 == 0 ? twinkle : 0.3);
-              glVertex2d(cx + rho * cos(AZ_DEG2RAD(i)),
-                         cy + rho * sin(AZ_DEG2RAD(i)));
+              az_batch_vertex2d(cx + rho * cos(AZ_DEG2RAD(i)),
+                                cy + rho * sin(AZ_DEG2RAD(i)));
             }
-          } glEnd();
+          } az_batch_end();
           clock_offset += 17;
         }
       }
@@ -1040,11 +1076,11 @@ void az_draw_background_pattern(
         for (int j = 0; j < num_theta_steps; ++j) {
           const az_vector_t position =
             az_vpolar(r_start + i * r_step, theta_start + j * theta_step);
-          glPushMatrix(); {
-            az_gl_translated(position);
-            az_gl_rotated(az_vtheta(position) - AZ_HALF_PI);
+          az_batch_push_transform(); {
+            az_batch_translate(position);
+            az_batch_rotate(az_vtheta(position) - AZ_HALF_PI);
             draw_bg_patch(pattern, clock);
-          } glPopMatrix();
+          } az_batch_pop_transform();
         }
       }
     } break;
@@ -1072,10 +1108,11 @@ void az_draw_background_pattern(
       const int num_y_steps = ceil((max_y - min_y) / y_step);
       for (int i = 0; i < num_x_steps; ++i) {
         for (int j = 0; j < num_y_steps; ++j) {
-          glPushMatrix(); {
-            glTranslated(x_start + i * x_step, y_start + j * y_step, 0);
+          az_batch_push_transform(); {
+            az_batch_translate((az_vector_t){x_start + i * x_step,
+                                             y_start + j * y_step});
             draw_bg_patch(pattern, clock);
-          } glPopMatrix();
+          } az_batch_pop_transform();
         }
       }
     } break;
@@ -1116,21 +1153,23 @@ void az_draw_background_pattern(
       const double j_start = j_step * ceil(min_j / j_step);
       const int num_i_steps = ceil((max_i - min_i) / i_step);
       const int num_j_steps = ceil((max_j - min_j) / j_step);
-      glPushMatrix(); {
-        az_gl_translated(shifted_origin);
+      az_batch_push_transform(); {
+        az_batch_translate(shifted_origin);
         for (int i = 0; i < num_i_steps; ++i) {
           for (int j = 0; j < num_j_steps; ++j) {
-            glPushMatrix(); {
-              az_gl_translated(az_vadd(az_vmul(unit_i, i_start + i * i_step),
-                                       az_vmul(unit_j, j_start + j * j_step)));
-              az_gl_rotated(base_origin_theta - AZ_HALF_PI);
+            az_batch_push_transform(); {
+              az_batch_translate(
+                  az_vadd(az_vmul(unit_i, i_start + i * i_step),
+                          az_vmul(unit_j, j_start + j * j_step)));
+              az_batch_rotate(base_origin_theta - AZ_HALF_PI);
               draw_bg_patch(pattern, clock);
-            } glPopMatrix();
+            } az_batch_pop_transform();
           }
         }
-      } glPopMatrix();
+      } az_batch_pop_transform();
     } break;
   }
+  az_flush_batch();
 }
 
 /*===========================================================================*/
@@ -34,6 +34,7 @@
 #include "azimuth/util/clock.h"
 #include "azimuth/util/color.h"
 #include "azimuth/util/misc.h"
+#include "azimuth/util/profile.h"
 #include "azimuth/util/vector.h"
 #include "azimuth/view/dialog.h"
 #include "azimuth/view/minimap.h"
@@ -814,3 +815,91 @@ void az_draw_skip_message(const az_space_state_t *state) {
 }
 
 /*===========================================================================*/
+
+#if AZ_PROFILING
+
+#define PROFILE_LEFT 360
+#define PROFILE_TOP 40
+#define PROFILE_WIDTH 272
+#define PROFILE_ROW_HEIGHT 8
+#define PROFILE_MAX_ROWS 40
+#define PROFILE_GRAPH_HEIGHT 40
+#define PROFILE_LABEL_WIDTH 172
+// Bars and the graph are scaled so that this many milliseconds (one frame at
+// 60 fps) fills the available width/height:
+#define PROFILE_FULL_SCALE_MS (1000.0 / 60.0)
+
+static double average_history_ms(const az_profile_counter_t *counter) {
+  const int size = az_profile_history_size();
+  if (size == 0) return 0.0;
+  uint64_t total_ns = 0;
+  for (int i = 0; i < size; ++i) total_ns += az_profile_history_ns(counter, i);
+  return 1e-6 * (double)total_ns / size;
+}
+
+void az_draw_profile_overlay(void) {
+  // Only list counters that have taken a measurable amount of time recently.
+  const az_profile_counter_t *rows[PROFILE_MAX_ROWS];
+  double row_ms[PROFILE_MAX_ROWS];
+  int num_rows = 0;
+  for (const az_profile_counter_t *counter = az_first_profile_counter();
+       counter != NULL && num_rows < PROFILE_MAX_ROWS;
+       counter = counter->next) {
+    const double ms = average_history_ms(counter);
+    if (ms < 0.005) continue;
+    rows[num_rows] = counter;
+    row_ms[num_rows] = ms;
+    ++num_rows;
+  }
+  const double height =
+    PROFILE_GRAPH_HEIGHT + 16 + num_rows * PROFILE_ROW_HEIGHT;
+  draw_mbox(PROFILE_LEFT - 4, PROFILE_TOP - 4, PROFILE_WIDTH + 8, height + 8);
+  // Draw a graph of recent frame times, newest frame on the right, with a
+  // line marking the 60 fps budget.
+  const int size = az_profile_history_size();
+  const double graph_bottom = PROFILE_TOP + PROFILE_GRAPH_HEIGHT;
+  const double column_width = (double)PROFILE_WIDTH / AZ_PROFILE_HISTORY;
+  glBegin(GL_QUADS); {
+    for (int i = 0; i < size; ++i) {
+      const double ms = 1e-6 * az_profile_history_ns(NULL, i);
+      const double bar = fmin(1.0, ms / PROFILE_FULL_SCALE_MS) *
+        PROFILE_GRAPH_HEIGHT;
+      if (ms <= PROFILE_FULL_SCALE_MS) glColor3f(0, 0.75, 0);
+      else glColor3f(0.75, 0, 0);
+      const double right = PROFILE_LEFT + PROFILE_WIDTH - i * column_width;
+      glVertex2d(right, graph_bottom);
+      glVertex2d(right, graph_bottom - bar);
+      glVertex2d(right - column_width, graph_bottom - bar);
+      glVertex2d(right - column_width, graph_bottom);
+    }
+  } glEnd();
+  glColor3f(1, 1, 0);
+  glBegin(GL_LINES); {
+    glVertex2d(PROFILE_LEFT, PROFILE_TOP + 0.5);
+    glVertex2d(PROFILE_LEFT + PROFILE_WIDTH, PROFILE_TOP + 0.5);
+  } glEnd();
+  glColor3f(1, 1, 1);
+  az_draw_printf(8, AZ_ALIGN_LEFT, PROFILE_LEFT, graph_bottom + 4,
+                 "frame %5.2f ms", average_history_ms(NULL));
+  // Draw one bar per counter, showing its average time per frame.
+  const double bar_left = PROFILE_LEFT + PROFILE_LABEL_WIDTH;
+  const double bar_max = PROFILE_WIDTH - PROFILE_LABEL_WIDTH;
+  for (int i = 0; i < num_rows; ++i) {
+    const double top = graph_bottom + 16 + i * PROFILE_ROW_HEIGHT;
+    const double bar = fmin(1.0, row_ms[i] / PROFILE_FULL_SCALE_MS) * bar_max;
+    glColor3f(0, 0.5, 0.75);
+    glBegin(GL_QUADS); {
+      glVertex2d(bar_left, top);
+      glVertex2d(bar_left + bar, top);
+      glVertex2d(bar_left + bar, top + PROFILE_ROW_HEIGHT - 2);
+      glVertex2d(bar_left, top + PROFILE_ROW_HEIGHT - 2);
+    } glEnd();
+    glColor3f(1, 1, 1);
+    az_draw_printf(6, AZ_ALIGN_LEFT, PROFILE_LEFT, top, "%-22.22s%5.2f",
+                   rows[i]->name, row_ms[i]);
+  }
+}
+
+#endif // AZ_PROFILING
+
+/*===========================================================================*/
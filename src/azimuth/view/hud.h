@@ -26,6 +26,7 @@
 #include "azimuth/state/planet.h"
 #include "azimuth/state/room.h"
 #include "azimuth/state/space.h"
+#include "azimuth/util/profile.h"
 
 /*===========================================================================*/
 
@@ -37,6 +38,12 @@ void az_draw_hud(az_space_state_t *state);
 
 void az_draw_skip_message(const az_space_state_t *state);
 
+#if AZ_PROFILING
+// Draw a graph of recent frame times, and a bar for each profile counter
+// showing its average time per frame (see azimuth/util/profile.h).
+void az_draw_profile_overlay(void);
+#endif
+
 /*===========================================================================*/
 
 #endif // AZIMUTH_VIEW_HUD_H_
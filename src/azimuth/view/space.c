@@ -28,6 +28,7 @@
 #include "azimuth/state/player.h"
 #include "azimuth/state/space.h"
 #include "azimuth/util/misc.h" // for AZ_ASSERT_UNREACHABLE
+#include "azimuth/util/profile.h"
 #include "azimuth/util/vector.h"
 #include "azimuth/view/background.h"
 #include "azimuth/view/baddie.h"
@@ -206,21 +207,22 @@ static void draw_nuke(const az_space_state_t *state) {
 static void draw_camera_view(az_space_state_t *state) {
   const az_room_t *room =
     &state->planet->rooms[state->ship.player.current_room];
-  az_draw_background_pattern(
+  AZ_PROFILE("az_draw_background_pattern", az_draw_background_pattern(
       room->background_pattern, &room->camera_bounds, state->camera.center,
-      state->clock);
-  az_draw_background_nodes(state);
+      state->clock));
+  AZ_PROFILE("az_draw_background_nodes", az_draw_background_nodes(state));
   glPushMatrix(); {
     glLoadIdentity();
     tint_screen(0, 0.6);
   } glPopMatrix();
-  az_draw_gravfields(state);
-  az_draw_console_and_upgrade_nodes(state);
-  az_draw_background_baddies(state);
-  az_draw_walls(state);
-  az_draw_tractor_nodes(state);
-  az_draw_pickups(state);
-  az_draw_projectiles(state);
+  AZ_PROFILE("az_draw_gravfields", az_draw_gravfields(state));
+  AZ_PROFILE("az_draw_console_and_upgrade_nodes",
+             az_draw_console_and_upgrade_nodes(state));
+  AZ_PROFILE("az_draw_background_baddies", az_draw_background_baddies(state));
+  AZ_PROFILE("az_draw_walls", az_draw_walls(state));
+  AZ_PROFILE("az_draw_tractor_nodes", az_draw_tractor_nodes(state));
+  AZ_PROFILE("az_draw_pickups", az_draw_pickups(state));
+  AZ_PROFILE("az_draw_projectiles", az_draw_projectiles(state));
   draw_nuke(state);
   if (state->mode == AZ_MODE_BOSS_DEATH) {
     if (state->boss_death_mode.boss.kind != AZ_BAD_NOTHING) {
@@ -230,13 +232,13 @@ static void draw_camera_view(az_space_state_t *state) {
       if (baddie->kind != AZ_BAD_NOTHING) az_draw_baddie(baddie, state->clock);
     }
   }
-  az_draw_foreground_baddies(state);
-  az_draw_ship(state);
-  az_draw_particles(state);
-  az_draw_doors(state);
-  az_draw_specks(state);
-  az_draw_liquid(state);
-  az_draw_foreground_nodes(state);
+  AZ_PROFILE("az_draw_foreground_baddies", az_draw_foreground_baddies(state));
+  AZ_PROFILE("az_draw_ship", az_draw_ship(state));
+  AZ_PROFILE("az_draw_particles", az_draw_particles(state));
+  AZ_PROFILE("az_draw_doors", az_draw_doors(state));
+  AZ_PROFILE("az_draw_specks", az_draw_specks(state));
+  AZ_PROFILE("az_draw_liquid", az_draw_liquid(state));
+  AZ_PROFILE("az_draw_foreground_nodes", az_draw_foreground_nodes(state));
 }
 
 static void draw_doorway_transition(az_space_state_t *state) {
@@ -273,11 +275,11 @@ static void draw_global_fade(const az_space_state_t *state) {
 void az_space_draw_screen(az_space_state_t *state) {
   // If we're watching a cutscene, draw that instead of our normal camera view.
   if (state->cutscene.scene != AZ_SCENE_NOTHING) {
-    az_draw_cutscene(state);
-    az_draw_dialogue(state);
-    az_draw_monologue(state);
+    AZ_PROFILE("az_draw_cutscene", az_draw_cutscene(state));
+    AZ_PROFILE("az_draw_dialogue", az_draw_dialogue(state));
+    AZ_PROFILE("az_draw_monologue", az_draw_monologue(state));
     draw_global_fade(state);
-    az_draw_skip_message(state);
+    AZ_PROFILE("az_draw_skip_message", az_draw_skip_message(state));
     return;
   }
 
@@ -366,9 +368,9 @@ void az_space_draw_screen(az_space_state_t *state) {
     } glPopMatrix();
   }
 
-  az_draw_hud(state);
+  AZ_PROFILE("az_draw_hud", az_draw_hud(state));
   draw_global_fade(state);
-  az_draw_skip_message(state);
+  AZ_PROFILE("az_draw_skip_message", az_draw_skip_message(state));
 }
 
 /*===========================================================================*/
@@ -25,6 +25,7 @@
 
 #include "azimuth/state/particle.h"
 #include "azimuth/state/space.h"
+#include "azimuth/state/speck.h"
 #include "azimuth/util/misc.h"
 #include "azimuth/util/vector.h"
 #include "azimuth/view/util.h"
@@ -32,17 +33,19 @@
 /*===========================================================================*/
 
 void az_draw_specks(const az_space_state_t *state) {
-  glBegin(GL_LINES); {
-    AZ_ARRAY_LOOP(speck, state->specks) {
-      if (speck->kind == AZ_SPECK_NOTHING) continue;
-      assert(speck->age >= 0.0);
-      assert(speck->age <= speck->lifetime);
-      glColor4ub(speck->color.r, speck->color.g, speck->color.b,
-                 speck->color.a * (1.0 - speck->age / speck->lifetime));
-      az_gl_vertex(speck->position);
-      az_gl_vertex(az_vsub(speck->position, az_vunit(speck->velocity)));
+  const az_speck_array_t *specks = &state->specks;
+  az_batch_begin(GL_LINES); {
+    for (int i = 0; i < specks->count; ++i) {
+      assert(specks->age[i] >= 0.0);
+      assert(specks->age[i] <= specks->lifetime[i]);
+      az_color_t color = specks->color[i];
+      color.a *= 1.0 - specks->age[i] / specks->lifetime[i];
+      az_push_vertex(specks->position[i], color);
+      az_push_vertex(az_vsub(specks->position[i],
+                             az_vunit(specks->velocity[i])), color);
     }
-  } glEnd();
+  } az_batch_end();
+  az_flush_batch();
 }
 
 /*===========================================================================*/
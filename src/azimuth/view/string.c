@@ -28,10 +28,13 @@
 #include <SDL_opengl.h>
 
 #include "azimuth/state/dialog.h"
+#include "azimuth/util/color.h"
 #include "azimuth/util/key.h"
 #include "azimuth/util/misc.h"
 #include "azimuth/util/prefs.h"
+#include "azimuth/util/vector.h"
 #include "azimuth/util/warning.h"
+#include "azimuth/view/util.h"
 
 /*===========================================================================*/
 
@@ -164,54 +167,59 @@ static struct {
   ['~'] = {GL_LINE_STRIP, 4, {{0,4}, {2,2}, {4,4}, {6,2}}}
 };
 
-static void draw_char(int c) {
+static void draw_char(int c, double left, bool italic, az_color_t color) {
   if (c >= 0 && c < AZ_ARRAY_SIZE(char_specs) &&
       char_specs[c].num_points > 0) {
-    glBegin(char_specs[c].mode); {
+    az_batch_begin(char_specs[c].mode); {
       for (int i = 0; i < char_specs[c].num_points; ++i) {
-        glVertex2f(char_specs[c].points[i].x, char_specs[c].points[i].y);
+        const double y = char_specs[c].points[i].y;
+        double x = left + char_specs[c].points[i].x;
+        // Italic text is slanted to the right, pivoting about y=4.
+        if (italic) x += 2.0 - 0.5 * y;
+        az_push_vertex((az_vector_t){x, y}, color);
       }
-    } glEnd();
+    } az_batch_end();
   }
 }
 
 static void draw_chars_internal(
     double height, az_alignment_t align, double x, double top, bool italic,
-    const char *chars, size_t len) {
+    az_color_t color, const char *chars, size_t len) {
   double left = x;
   switch (align) {
     case AZ_ALIGN_LEFT: break;
     case AZ_ALIGN_CENTER: left -= 0.5 * (len * height - 0.25 * height); break;
     case AZ_ALIGN_RIGHT: left -= len * height; break;
   }
-  glPushMatrix(); {
-    glTranslated(left + 0.5, top + 0.5, 0);
-    glScaled(height / FONT_SIZE, height / FONT_SIZE, 1);
-    if (italic) {
-      static const GLfloat italic_matrix[16] = {
-        1,    0, 0, 0,
-        -0.5, 1, 0, 0,
-        0,    0, 1, 0,
-        2,    0, 0, 1};
-      glMultMatrixf(italic_matrix);
-    }
+  az_batch_push_transform(); {
+    az_batch_translate((az_vector_t){left + 0.5, top + 0.5});
+    az_batch_scale(height / FONT_SIZE, height / FONT_SIZE);
     for (size_t i = 0; i < len; ++i) {
-      draw_char(chars[i]);
-      glTranslated(FONT_SIZE, 0, 0);
+      draw_char(chars[i], (double)i * FONT_SIZE, italic, color);
     }
-  } glPopMatrix();
+  } az_batch_pop_transform();
+}
+
+// Draw plain text in whatever color the caller last set with glColor.  The
+// text is batched in a placeholder color and then flushed without per-vertex
+// colors, so the current GL color never needs to be read back.
+static void draw_plain_chars(double height, az_alignment_t align, double x,
+                             double top, const char *chars, size_t len) {
+  az_flush_batch();
+  draw_chars_internal(height, align, x, top, false, AZ_WHITE, chars, len);
+  az_flush_batch_in_gl_color();
 }
 
 /*===========================================================================*/
 
 void az_draw_string(double height, az_alignment_t align, double x, double top,
                     const char *string) {
-  draw_chars_internal(height, align, x, top, false, string, strlen(string));
+  draw_plain_chars(height, align, x, top, string, strlen(string));
 }
 
 void az_draw_chars(double height, az_alignment_t align, double x, double top,
                    const char *chars, size_t len) {
-  draw_chars_internal(height, align, x, top, false, chars, len);
+  draw_plain_chars(height, align, x, top, chars, len);
 }
 
 void az_draw_printf(double height, az_alignment_t align, double x, double top,
@@ -224,7 +232,7 @@ void az_draw_printf(double height, az_alignment_t align, double x, double top,
   va_start(args, format);
   vsnprintf(buffer, size + 1, format, args);
   va_end(args);
-  draw_chars_internal(height, align, x, top, false, buffer, size);
+  draw_plain_chars(height, align, x, top, buffer, size);
 }
 
 /*===========================================================================*/
@@ -255,13 +263,13 @@ static bool hex_parse(char c1, char c2, uint8_t *out) {
   return true;
 }
 
-void az_draw_paragraph(
+static void draw_paragraph(
     double height, az_alignment_t align, double x, double top, double spacing,
     int max_chars, const az_preferences_t *prefs, const char *paragraph) {
   assert(prefs != NULL);
   assert(paragraph != NULL);
   // Start out with white, non-italic text.
-  glColor3f(1, 1, 1);
+  az_color_t color = AZ_WHITE;
   bool italic = false;
   // Draw each line of text, one per outer loop iteration.  We will return from
   // this function when we reach the end (NUL character) of the paragraph, or
@@ -306,7 +314,7 @@ void az_draw_paragraph(
       // Draw the fragment (if it's non-empty).
       if (fragment_end > fragment_start) {
         draw_chars_internal(height, AZ_ALIGN_LEFT, fragment_left, line_top,
-                            italic, paragraph + fragment_start,
+                            italic, color, paragraph + fragment_start,
                             fragment_end - fragment_start);
       }
       // If we've printed max_chars characters, or we're at the end of the
@@ -364,15 +372,15 @@ void az_draw_paragraph(
         case '/': italic = true; break;
         case '|': italic = false; break;
         // Handle color escapes:
-        case 'A': glColor3f(0.5, 0.5, 0.5); break; // grAy
-        case 'B': glColor3f(0, 0, 1); break; // Blue
-        case 'C': glColor3f(0, 1, 1); break; // Cyan
-        case 'G': glColor3f(0, 1, 0); break; // Green
-        case 'M': glColor3f(1, 0, 1); break; // Magenta
-        case 'O': glColor3f(1, 0.5, 0); break; // Orange
-        case 'R': glColor3f(1, 0, 0); break; // Red
-        case 'W': glColor3f(1, 1, 1); break; // White
-        case 'Y': glColor3f(1, 1, 0); break; // Yellow
+        case 'A': color = az_color3f(0.5, 0.5, 0.5); break; // grAy
+        case 'B': color = az_color3f(0, 0, 1); break; // Blue
+        case 'C': color = az_color3f(0, 1, 1); break; // Cyan
+        case 'G': color = az_color3f(0, 1, 0); break; // Green
+        case 'M': color = az_color3f(1, 0, 1); break; // Magenta
+        case 'O': color = az_color3f(1, 0.5, 0); break; // Orange
+        case 'R': color = az_color3f(1, 0, 0); break; // Red
+        case 'W': color = az_color3f(1, 1, 1); break; // White
+        case 'Y': color = az_color3f(1, 1, 0); break; // Yellow
         case 'X': // heX
           // First, make sure that we won't hit the end of the string trying to
           // read the next six characters after the "$X".  If we will, print a
@@ -395,7 +403,7 @@ void az_draw_paragraph(
                           paragraph[fragment_start + 3], &green) &&
                 hex_parse(paragraph[fragment_start + 4],
                           paragraph[fragment_start + 5], &blue)) {
-              glColor3ub(red, green, blue);
+              color = (az_color_t){red, green, blue, 255};
             } else {
               AZ_WARNING_ONCE("Malformed $X escape: $X%.6s\n",
                               paragraph + fragment_start);
@@ -442,7 +450,7 @@ void az_draw_paragraph(
         draw_chars_internal(
             height, AZ_ALIGN_LEFT,
             line_left + height * (chars_printed - chars_before_line),
-            line_top, italic, key_name, len);
+            line_top, italic, color, key_name, len);
         chars_printed += len;
       }
     }
@@ -454,4 +462,11 @@ void az_draw_paragraph(
   }
 }
 
+void az_draw_paragraph(
+    double height, az_alignment_t align, double x, double top, double spacing,
+    int max_chars, const az_preferences_t *prefs, const char *paragraph) {
+  draw_paragraph(height, align, x, top, spacing, max_chars, prefs, paragraph);
+  az_flush_batch();
+}
+
 /*===========================================================================*/
@@ -19,11 +19,14 @@
 
 #include "azimuth/view/util.h"
 
+#include <assert.h>
 #include <math.h>
+#include <stdbool.h>
 
 #include <SDL_opengl.h>
 
 #include "azimuth/util/color.h"
+#include "azimuth/util/misc.h"
 #include "azimuth/util/vector.h"
 
 /*===========================================================================*/
@@ -44,6 +47,235 @@ void az_gl_vertex(az_vector_t v) {
   glVertex2d(v.x, v.y);
 }
 
+/*===========================================================================*/
+
+typedef struct {
+  GLfloat x, y;
+  az_color_t color;
+} az_batch_vertex_t;
+
+// The batch holds whole points, lines, or triangles, so its size should be a
+// multiple of both 2 and 3.
+#define BATCH_SIZE 6144
+
+// How deeply az_batch_push_transform calls may nest:
+#define MAX_TRANSFORM_DEPTH 8
+
+// A 2D affine transform, mapping (x, y) to (a*x + c*y + tx, b*x + d*y + ty)
+// (the same layout as the corresponding entries of a GL matrix).
+typedef struct {
+  double a, b, c, d, tx, ty;
+} az_batch_transform_t;
+
+static struct {
+  // The kind of independent primitive (GL_POINTS, GL_LINES, or GL_TRIANGLES)
+  // stored in the vertex array, and how many vertices are stored there.
+  GLenum batch_mode;
+  int num_vertices;
+  az_batch_vertex_t vertices[BATCH_SIZE];
+  // The primitive currently being specified:
+  bool in_primitive;
+  GLenum mode;
+  // The transform stack; transforms[depth] is the current transform.
+  int depth;
+  az_batch_transform_t transforms[MAX_TRANSFORM_DEPTH];
+  az_color_t color;
+  // The color of the last vertex pushed (or last batch color set), which is
+  // what the current GL color would be had the batch been drawn with
+  // glColor/glVertex; az_flush_batch leaves the GL color set to this.
+  az_color_t gl_color;
+  int count; // number of vertices specified so far
+  az_batch_vertex_t first, prev, prev2;
+} batch = { .transforms = {{ .a = 1, .d = 1 }} }; // identity transform
+
+static GLenum independent_mode(GLenum mode) {
+  switch (mode) {
+    case GL_POINTS:
+      return GL_POINTS;
+    case GL_LINES: case GL_LINE_STRIP: case GL_LINE_LOOP:
+      return GL_LINES;
+    case GL_TRIANGLES: case GL_TRIANGLE_STRIP: case GL_TRIANGLE_FAN:
+    case GL_QUADS: case GL_QUAD_STRIP: case GL_POLYGON:
+      return GL_TRIANGLES;
+  }
+  AZ_ASSERT_UNREACHABLE();
+}
+
+// Draw and clear the vertex array, using the per-vertex colors if
+// use_colors is true, or else the current GL color.
+static void draw_vertices(bool use_colors) {
+  if (batch.num_vertices == 0) return;
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glVertexPointer(2, GL_FLOAT, sizeof(az_batch_vertex_t),
+                  &batch.vertices[0].x);
+  if (use_colors) {
+    glEnableClientState(GL_COLOR_ARRAY);
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(az_batch_vertex_t),
+                   &batch.vertices[0].color);
+  }
+  glDrawArrays(batch.batch_mode, 0, batch.num_vertices);
+  if (use_colors) {
+    glDisableClientState(GL_COLOR_ARRAY);
+    // Drawing from a color array leaves the current GL color undefined, so
+    // set it to what it would have been without the batch.
+    az_gl_color(batch.gl_color);
+  }
+  glDisableClientState(GL_VERTEX_ARRAY);
+  batch.num_vertices = 0;
+}
+
+// Append one independent primitive (of batch.batch_mode) to the vertex array.
+static void emit(int num, az_batch_vertex_t v0, az_batch_vertex_t v1,
+                 az_batch_vertex_t v2) {
+  if (batch.num_vertices + num > BATCH_SIZE) draw_vertices(true);
+  az_batch_vertex_t *out = &batch.vertices[batch.num_vertices];
+  out[0] = v0;
+  if (num > 1) out[1] = v1;
+  if (num > 2) out[2] = v2;
+  batch.num_vertices += num;
+}
+
+void az_batch_begin(GLenum mode) {
+  assert(!batch.in_primitive);
+  const GLenum bmode = independent_mode(mode);
+  if (batch.batch_mode != bmode) draw_vertices(true);
+  batch.batch_mode = bmode;
+  batch.in_primitive = true;
+  batch.mode = mode;
+  batch.count = 0;
+}
+
+void az_batch_end(void) {
+  assert(batch.in_primitive);
+  if (batch.mode == GL_LINE_LOOP && batch.count >= 2) {
+    emit(2, batch.prev, batch.first, batch.first);
+  }
+  batch.in_primitive = false;
+}
+
+void az_batch_push_transform(void) {
+  assert(batch.depth + 1 < MAX_TRANSFORM_DEPTH);
+  batch.transforms[batch.depth + 1] = batch.transforms[batch.depth];
+  ++batch.depth;
+}
+
+void az_batch_pop_transform(void) {
+  assert(batch.depth > 0);
+  --batch.depth;
+}
+
+void az_batch_translate(az_vector_t v) {
+  az_batch_transform_t *m = &batch.transforms[batch.depth];
+  m->tx += m->a * v.x + m->c * v.y;
+  m->ty += m->b * v.x + m->d * v.y;
+}
+
+void az_batch_rotate(double radians) {
+  az_batch_transform_t *m = &batch.transforms[batch.depth];
+  const double cos_r = cos(radians), sin_r = sin(radians);
+  const az_batch_transform_t old = *m;
+  m->a = old.a * cos_r + old.c * sin_r;
+  m->b = old.b * cos_r + old.d * sin_r;
+  m->c = old.c * cos_r - old.a * sin_r;
+  m->d = old.d * cos_r - old.b * sin_r;
+}
+
+void az_batch_scale(double sx, double sy) {
+  az_batch_transform_t *m = &batch.transforms[batch.depth];
+  m->a *= sx;
+  m->b *= sx;
+  m->c *= sy;
+  m->d *= sy;
+}
+
+void az_gl_batch_transform(void) {
+  const az_batch_transform_t *m = &batch.transforms[batch.depth];
+  const GLdouble matrix[16] = {
+    m->a,  m->b,  0, 0,
+    m->c,  m->d,  0, 0,
+    0,     0,     1, 0,
+    m->tx, m->ty, 0, 1
+  };
+  glMultMatrixd(matrix);
+}
+
+void az_batch_color(az_color_t color) {
+  batch.color = batch.gl_color = color;
+}
+
+static uint8_t color_component(GLfloat value) {
+  return (uint8_t)(fmin(fmax(value, 0.0), 1.0) * 255.0 + 0.5);
+}
+
+void az_batch_color3f(GLfloat r, GLfloat g, GLfloat b) {
+  az_batch_color4f(r, g, b, 1.0f);
+}
+
+void az_batch_color4f(GLfloat r, GLfloat g, GLfloat b, GLfloat a) {
+  batch.color = batch.gl_color =
+    (az_color_t){color_component(r), color_component(g),
+                 color_component(b), color_component(a)};
+}
+
+void az_push_vertex(az_vector_t position, az_color_t color) {
+  assert(batch.in_primitive);
+  const az_batch_transform_t *m = &batch.transforms[batch.depth];
+  const az_batch_vertex_t vertex = {
+    .x = m->a * position.x + m->c * position.y + m->tx,
+    .y = m->b * position.x + m->d * position.y + m->ty,
+    .color = color
+  };
+  batch.gl_color = color;
+  const int index = batch.count++;
+  switch (batch.mode) {
+    case GL_POINTS:
+      emit(1, vertex, vertex, vertex);
+      break;
+    case GL_LINES:
+      if (index % 2 == 1) emit(2, batch.prev, vertex, vertex);
+      break;
+    case GL_LINE_STRIP: case GL_LINE_LOOP:
+      if (index >= 1) emit(2, batch.prev, vertex, vertex);
+      break;
+    case GL_TRIANGLES:
+      if (index % 3 == 2) emit(3, batch.prev2, batch.prev, vertex);
+      break;
+    case GL_TRIANGLE_STRIP: case GL_QUAD_STRIP:
+      if (index >= 2) emit(3, batch.prev2, batch.prev, vertex);
+      break;
+    case GL_TRIANGLE_FAN: case GL_POLYGON:
+      if (index >= 2) emit(3, batch.first, batch.prev, vertex);
+      break;
+    case GL_QUADS:
+      if (index % 4 >= 2) emit(3, batch.first, batch.prev, vertex);
+      break;
+    default: AZ_ASSERT_UNREACHABLE();
+  }
+  if (index == 0 || (batch.mode == GL_QUADS && index % 4 == 0)) {
+    batch.first = vertex;
+  }
+  batch.prev2 = batch.prev;
+  batch.prev = vertex;
+}
+
+void az_batch_vertex(az_vector_t position) {
+  az_push_vertex(position, batch.color);
+}
+
+void az_batch_vertex2d(double x, double y) {
+  az_push_vertex((az_vector_t){x, y}, batch.color);
+}
+
+void az_flush_batch(void) {
+  draw_vertices(true);
+}
+
+void az_flush_batch_in_gl_color(void) {
+  draw_vertices(false);
+}
+
+/*===========================================================================*/
+
 void az_draw_cracks(az_vector_t origin, double angle, double length) {
   az_draw_cracks_with_color(origin, angle, length, (az_color_t){0, 0, 0, 64});
 }
@@ -21,6 +21,8 @@
 #ifndef AZIMUTH_VIEW_UTIL_H_
 #define AZIMUTH_VIEW_UTIL_H_
 
+#include <SDL_opengl.h>
+
 #include "azimuth/util/color.h"
 #include "azimuth/util/random.h"
 #include "azimuth/util/vector.h"
@@ -39,6 +41,79 @@ void az_gl_translated(az_vector_t v);
 // Place a GL vertex at the given position.
 void az_gl_vertex(az_vector_t v);
 
+/*===========================================================================*/
+
+// The batch functions below stand in for glBegin/glColor/glVertex/glEnd.
+// Rather than sending each vertex to the driver, they transform it by the
+// batch's own transform (see below), break the primitive down into
+// independent points, lines, or triangles, and collect those in a client-side
+// vertex array.  The whole batch is then drawn with a single glDrawArrays call
+// when it is flushed, which happens automatically whenever a primitive of a
+// different type (points/lines/triangles) is begun, or when the vertex array
+// fills up.
+//
+// Since batched geometry is drawn later than it is specified, code that uses
+// the batch must call az_flush_batch before drawing anything without the
+// batch, or before changing any GL state (such as the modelview matrix, the
+// blend function, or line width).  Drawing functions that use the batch
+// should flush it before returning to their callers.  The batch must not be
+// used while compiling a display list.
+//
+// Batched geometry is drawn through whatever GL modelview matrix is current
+// when the batch is flushed.  To move, rotate, or scale individual objects
+// within a batch, use the batch transform functions below instead of the GL
+// matrix functions; they work just like their GL counterparts, but are
+// applied on the CPU as vertices are added, so the batch never has to read
+// any GL state back.
+
+// Begin a new primitive; the mode may be any mode accepted by glBegin.
+void az_batch_begin(GLenum mode);
+
+// Finish the current primitive.
+void az_batch_end(void);
+
+// Save/restore the batch transform, like glPushMatrix/glPopMatrix.  The
+// transform starts out as the identity, and pushes and pops must balance.
+void az_batch_push_transform(void);
+void az_batch_pop_transform(void);
+
+// Apply a transformation to the batch transform, like glTranslated,
+// glRotated (but in radians), and glScaled.
+void az_batch_translate(az_vector_t v);
+void az_batch_rotate(double radians);
+void az_batch_scale(double sx, double sy);
+
+// Multiply the GL modelview matrix by the current batch transform, so that
+// geometry drawn without the batch lines up with batched geometry.  The batch
+// should be flushed first, and the GL matrix saved and restored around this.
+void az_gl_batch_transform(void);
+
+// Set the color to be used for subsequent batched vertices.  This is
+// independent of the current GL color.
+void az_batch_color(az_color_t color);
+void az_batch_color3f(GLfloat r, GLfloat g, GLfloat b);
+void az_batch_color4f(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+
+// Add a vertex to the current primitive with the given color.
+void az_push_vertex(az_vector_t position, az_color_t color);
+
+// Add a vertex to the current primitive with the current batch color.
+void az_batch_vertex(az_vector_t position);
+void az_batch_vertex2d(double x, double y);
+
+// Draw and clear any batched geometry.  The current GL color is left as the
+// color of the last batched vertex (or the last batch color set, if that was
+// later), just as if the geometry had been drawn with glColor and glVertex.
+void az_flush_batch(void);
+
+// Like az_flush_batch, but draw all the batched geometry in the current GL
+// color, ignoring the batch colors, and leave the GL color unchanged.  This
+// lets code that draws in whatever color its caller set with glColor use the
+// batch without reading that color back from GL.
+void az_flush_batch_in_gl_color(void);
+
+/*===========================================================================*/
+
 void az_draw_cracks(az_vector_t origin, double angle, double length);
 void az_draw_cracks_with_color(az_vector_t origin, double angle, double length,
                                az_color_t color);
@@ -21,13 +21,18 @@
 
 #include <assert.h>
 #include <math.h>
+#include <stdarg.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "azimuth/state/planet.h"
 #include "azimuth/state/script.h"
 #include "azimuth/state/upgrade.h"
 #include "azimuth/util/misc.h"
+#include "azimuth/util/string.h"
+#include "azimuth/util/thread.h"
+#include "editor/list.h"
 
 /*===========================================================================*/
 
@@ -43,17 +48,6 @@ static int count_consoles(const az_room_t *room, az_console_kind_t *kind_out) {
   return num_consoles;
 }
 
-static int room_contains_upgrade(const az_room_t *room, az_upgrade_t upgrade) {
-  for (int i = 0; i < room->num_nodes; ++i) {
-    const az_node_spec_t *node = &room->nodes[i];
-    if (node->kind == AZ_NODE_UPGRADE &&
-        node->subkind.upgrade == upgrade) {
-      return true;
-    }
-  }
-  return false;
-}
-
 static bool room_has_door_to(const az_room_t *room, int dest_index) {
   for (int i = 0; i < room->num_doors; ++i) {
     const az_door_spec_t *door = &room->doors[i];
@@ -93,16 +87,43 @@ static bool script_contains_instruction(const az_script_t *script,
     ok = false; \
   } while (0)
 
-#define ROOM_ERROR(...) do { \
+// Print a problem with a room that was found by the cross-room checks.
+#define ROOM_LINK_ERROR(...) do { \
     printf("\x1b[31mRoom %d: ", room_index); \
     printf(__VA_ARGS__); \
     printf("\x1b[m\n"); \
     ok = false; \
   } while (0)
 
-static bool audit_script(int room_index, const az_script_t *script) {
-  if (script == NULL) return true;
-  bool ok = true;
+// Record a problem with the room being audited.  Rooms may be audited on
+// worker threads, so problems are saved up and printed afterwards, rather
+// than being printed immediately.
+#define ROOM_ERROR(...) add_room_error(audit, __VA_ARGS__)
+
+static void add_room_error(az_room_audit_t *audit, const char *format, ...) {
+  char buffer[256];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  *AZ_LIST_ADD(audit->errors) = az_strdup(buffer);
+}
+
+static void clear_room_audit(az_room_audit_t *audit) {
+  AZ_LIST_LOOP(error, audit->errors) free(*error);
+  AZ_LIST_DESTROY(audit->errors);
+  audit->valid = false;
+}
+
+static void print_room_audit(int room_index, const az_room_audit_t *audit) {
+  for (int i = 0; i < AZ_LIST_SIZE(audit->errors); ++i) {
+    printf("\x1b[31mRoom %d: %s\x1b[m\n", room_index,
+           *AZ_LIST_GET(audit->errors, i));
+  }
+}
+
+static void audit_script(az_room_audit_t *audit, const az_script_t *script) {
+  if (script == NULL) return;
   const bool has_dlog = script_contains_opcode(script, AZ_OP_DLOG);
   const bool has_mlog = script_contains_opcode(script, AZ_OP_MLOG);
   const bool has_skip1 = script_contains_instruction(script, AZ_OP_SKIP, 1);
@@ -124,193 +145,273 @@ static bool audit_script(int room_index, const az_script_t *script) {
   if (has_skip1 && !script_contains_instruction(script, AZ_OP_SKIP, 0)) {
     ROOM_ERROR("Script has skip1 instruction, but no skip0");
   }
-  return ok;
 }
 
-#define CHECK_SCRIPT(script) do { \
-    if (!audit_script(room_index, (script))) ok = false; \
-  } while (0)
-
-bool az_audit_scenario(const az_planet_t *planet) {
-  bool ok = audit_script(-1, planet->on_start);
-  bool upgrade_exists[AZ_NUM_UPGRADES] = {false};
-  for (int room_index = 0; room_index < planet->num_rooms; ++room_index) {
-    const az_room_t *room = &planet->rooms[room_index];
-    // Check background pattern.
-    if (room->background_pattern == AZ_BG_SOLID_BLACK) {
-      ROOM_ERROR("No background pattern");
-    }
-    // Check on_start script.
-    CHECK_SCRIPT(room->on_start);
-    // Check consoles.
-    az_console_kind_t console_kind = AZ_CONS_SAVE;
-    const int num_consoles = count_consoles(room, &console_kind);
-    if (num_consoles > 1) ROOM_ERROR("Multiple consoles");
-    if (num_consoles > 0) {
-      if (console_kind == AZ_CONS_SAVE) {
-        if (!script_contains_instruction(room->on_start, AZ_OP_MSG, 0)) {
-          ROOM_ERROR("Save point without msg0");
-        }
-        if (!script_contains_opcode(room->on_start, AZ_OP_MUS)) {
-          ROOM_ERROR("Save point without music");
-        }
-      } else if (console_kind == AZ_CONS_REFILL) {
-        if (!script_contains_instruction(room->on_start, AZ_OP_MSG, 1)) {
-          ROOM_ERROR("Repair bay without msg1");
-        }
+// Run all the checks that depend only on the room itself (and its index),
+// recording any problems in the (previously cleared) audit.
+static void audit_room(const az_room_t *room, int room_index,
+                       az_room_audit_t *audit) {
+  // Check background pattern.
+  if (room->background_pattern == AZ_BG_SOLID_BLACK) {
+    ROOM_ERROR("No background pattern");
+  }
+  // Check on_start script.
+  audit_script(audit, room->on_start);
+  // Check consoles.
+  az_console_kind_t console_kind = AZ_CONS_SAVE;
+  const int num_consoles = count_consoles(room, &console_kind);
+  if (num_consoles > 1) ROOM_ERROR("Multiple consoles");
+  if (num_consoles > 0) {
+    if (console_kind == AZ_CONS_SAVE) {
+      if (!script_contains_instruction(room->on_start, AZ_OP_MSG, 0)) {
+        ROOM_ERROR("Save point without msg0");
       }
+      if (!script_contains_opcode(room->on_start, AZ_OP_MUS)) {
+        ROOM_ERROR("Save point without music");
+      }
+    } else if (console_kind == AZ_CONS_REFILL) {
+      if (!script_contains_instruction(room->on_start, AZ_OP_MSG, 1)) {
+        ROOM_ERROR("Repair bay without msg1");
+      }
+    }
+  }
+  // Check walls.
+  for (int i = 0; i < room->num_walls; ++i) {
+    const az_wall_spec_t *wall = &room->walls[i];
+    // Icicles should always be charge-destructible.
+    const int wall_data_index = az_wall_data_index(wall->data);
+    if ((wall_data_index == 18 || wall_data_index == 19) &&
+        wall->kind != AZ_WALL_DESTRUCTIBLE_CHARGED) {
+      ROOM_ERROR("Non-charge-destructible icicle at (%.02f, %.02f)",
+                 wall->position.x, wall->position.y);
     }
-    // Check walls.
-    for (int i = 0; i < room->num_walls; ++i) {
-      const az_wall_spec_t *wall = &room->walls[i];
-      // Icicles should always be charge-destructible.
-      const int wall_data_index = az_wall_data_index(wall->data);
-      if ((wall_data_index == 18 || wall_data_index == 19) &&
-          wall->kind != AZ_WALL_DESTRUCTIBLE_CHARGED) {
-        ROOM_ERROR("Non-charge-destructible icicle at (%.02f, %.02f)",
+    // Check for duplicate walls.
+    for (int j = i + 1; j < room->num_walls; ++j) {
+      const az_wall_spec_t *other_wall = &room->walls[j];
+      if (other_wall->data == wall->data &&
+          az_vwithin(other_wall->position, wall->position, 10.0) &&
+          fabs(az_mod2pi(other_wall->angle - wall->angle)) < AZ_DEG2RAD(1)) {
+        ROOM_ERROR("Duplicate wall at (%.02f, %.02f)",
                    wall->position.x, wall->position.y);
       }
-      // Check for duplicate walls.
-      for (int j = i + 1; j < room->num_walls; ++j) {
-        const az_wall_spec_t *other_wall = &room->walls[j];
-        if (other_wall->data == wall->data &&
-            az_vwithin(other_wall->position, wall->position, 10.0) &&
-            fabs(az_mod2pi(other_wall->angle - wall->angle)) < AZ_DEG2RAD(1)) {
-          ROOM_ERROR("Duplicate wall at (%.02f, %.02f)",
-                     wall->position.x, wall->position.y);
-        }
+    }
+  }
+  // Check for duplicate fake-wall nodes.
+  for (int i = 0; i < room->num_nodes; ++i) {
+    const az_node_spec_t *node = &room->nodes[i];
+    if (node->kind != AZ_NODE_FAKE_WALL_FG &&
+        node->kind != AZ_NODE_FAKE_WALL_BG) continue;
+    for (int j = i + 1; j < room->num_nodes; ++j) {
+      const az_node_spec_t *other_node = &room->nodes[j];
+      if (other_node->kind == node->kind &&
+          other_node->subkind.fake_wall == node->subkind.fake_wall &&
+          az_vwithin(other_node->position, node->position, 10.0) &&
+          fabs(az_mod2pi(other_node->angle - node->angle)) < AZ_DEG2RAD(1)) {
+        ROOM_ERROR("Duplicate node at (%.02f, %.02f)",
+                   node->position.x, node->position.y);
       }
     }
-    // Check for duplicate fake-wall nodes.
-    for (int i = 0; i < room->num_nodes; ++i) {
-      const az_node_spec_t *node = &room->nodes[i];
-      if (node->kind != AZ_NODE_FAKE_WALL_FG &&
-          node->kind != AZ_NODE_FAKE_WALL_BG) continue;
-      for (int j = i + 1; j < room->num_nodes; ++j) {
-        const az_node_spec_t *other_node = &room->nodes[j];
-        if (other_node->kind == node->kind &&
-            other_node->subkind.fake_wall == node->subkind.fake_wall &&
-            az_vwithin(other_node->position, node->position, 10.0) &&
-            fabs(az_mod2pi(other_node->angle - node->angle)) < AZ_DEG2RAD(1)) {
-          ROOM_ERROR("Duplicate node at (%.02f, %.02f)",
-                     node->position.x, node->position.y);
-        }
+  }
+  // Check baddies.
+  for (int i = 0; i < room->num_baddies; ++i) {
+    const az_baddie_spec_t *baddie = &room->baddies[i];
+    // Check on_kill script.
+    audit_script(audit, baddie->on_kill);
+  }
+  // Check doors.
+  for (int i = 0; i < room->num_doors; ++i) {
+    const az_door_spec_t *door = &room->doors[i];
+    // Check that forcefield doors don't have scripts.
+    if (door->kind == AZ_DOOR_FORCEFIELD) {
+      if (door->on_open != NULL) {
+        ROOM_ERROR("Forcefield door with an on_open script");
       }
+      continue;
     }
-    // Check baddies.
-    for (int i = 0; i < room->num_baddies; ++i) {
-      const az_baddie_spec_t *baddie = &room->baddies[i];
-      // Check on_kill script.
-      CHECK_SCRIPT(baddie->on_kill);
+    // Check on_open script.
+    audit_script(audit, door->on_open);
+    // Check that door destination is legitimate.
+    if (door->destination == room_index) {
+      ROOM_ERROR("Door at (%.02f, %.02f) leads to itself",
+                 door->position.x, door->position.y);
+      continue;
     }
-    // Check doors.
-    for (int i = 0; i < room->num_doors; ++i) {
-      const az_door_spec_t *door = &room->doors[i];
-      // Check that forcefield doors don't have scripts.
-      if (door->kind == AZ_DOOR_FORCEFIELD) {
-        if (door->on_open != NULL) {
-          ROOM_ERROR("Forcefield door with an on_open script");
-        }
-        continue;
-      }
-      // Check on_open script.
-      CHECK_SCRIPT(door->on_open);
-      // Check that door destination is legitimate.
-      if (door->destination == room_index) {
-        ROOM_ERROR("Door at (%.02f, %.02f) leads to itself",
+    if (door->kind == AZ_DOOR_ROCKET || door->kind == AZ_DOOR_HYPER_ROCKET ||
+        door->kind == AZ_DOOR_BOMB || door->kind == AZ_DOOR_MEGA_BOMB) {
+      // Check that each ordnance door has a UUID.
+      if (door->uuid_slot == 0) {
+        ROOM_ERROR("Door at (%.02f, %.02f) doesn't have a UUID",
                    door->position.x, door->position.y);
-        continue;
-      }
-      // Check that destination room has a door leading back here.
-      const int dest_index = door->destination;
-      assert(dest_index >= 0);
-      assert(dest_index < planet->num_rooms);
-      const az_room_t *dest_room = &planet->rooms[door->destination];
-      if (!room_has_door_to(dest_room, room_index)) {
-        ROOM_ERROR("Door to room %d doesn't have an exit", dest_index);
-      }
-      // Check that if this room is next to another zone, it sets the music.
-      if (dest_room->zone_key != room->zone_key &&
-          !script_contains_opcode(room->on_start, AZ_OP_MUS)) {
-        ROOM_ERROR("Next to another zone, but doesn't set music");
-      }
-      if (door->kind == AZ_DOOR_ROCKET || door->kind == AZ_DOOR_HYPER_ROCKET ||
-          door->kind == AZ_DOOR_BOMB || door->kind == AZ_DOOR_MEGA_BOMB) {
-        // Check that each ordnance door has a UUID.
-        if (door->uuid_slot == 0) {
-          ROOM_ERROR("Door at (%.02f, %.02f) doesn't have a UUID",
-                     door->position.x, door->position.y);
-        } else {
-          // Check that opening an ordnance door sets a flag.
-          if (!script_contains_opcode(door->on_open, AZ_OP_SET)) {
-            ROOM_ERROR("Door with UUID %d doesn't set a flag when opened",
-                       door->uuid_slot);
-          }
-          // Check that on_start script can unlock the door.
-          if (!script_contains_instruction(room->on_start, AZ_OP_UNLOCK,
-                                           door->uuid_slot)) {
-            ROOM_ERROR("Door with UUID %d doesn't get unlocked by on_start",
-                       door->uuid_slot);
-          }
+      } else {
+        // Check that opening an ordnance door sets a flag.
+        if (!script_contains_opcode(door->on_open, AZ_OP_SET)) {
+          ROOM_ERROR("Door with UUID %d doesn't set a flag when opened",
+                     door->uuid_slot);
+        }
+        // Check that on_start script can unlock the door.
+        if (!script_contains_instruction(room->on_start, AZ_OP_UNLOCK,
+                                         door->uuid_slot)) {
+          ROOM_ERROR("Door with UUID %d doesn't get unlocked by on_start",
+                     door->uuid_slot);
         }
       }
     }
-    // Check gravfields.
-    for (int i = 0; i < room->num_gravfields; ++i) {
-      const az_gravfield_spec_t *gravfield = &room->gravfields[i];
-      // Check on_enter script.
-      CHECK_SCRIPT(gravfield->on_enter);
-      // Check that liquids are vertical.
-      if (az_is_liquid(gravfield->kind)) {
-        const double expected_angle =
-          (az_vdot(az_vpolar(1, gravfield->angle), gravfield->position) >= 0 ?
-           az_vtheta(gravfield->position) :
-           az_vtheta(az_vneg(gravfield->position)));
-        if (fabs(az_mod2pi(gravfield->angle - expected_angle)) > 0.00001) {
-          ROOM_ERROR("Liquid at (%.02f, %.02f) not vertical",
-                     gravfield->position.x, gravfield->position.y);
-        }
+  }
+  // Check gravfields.
+  for (int i = 0; i < room->num_gravfields; ++i) {
+    const az_gravfield_spec_t *gravfield = &room->gravfields[i];
+    // Check on_enter script.
+    audit_script(audit, gravfield->on_enter);
+    // Check that liquids are vertical.
+    if (az_is_liquid(gravfield->kind)) {
+      const double expected_angle =
+        (az_vdot(az_vpolar(1, gravfield->angle), gravfield->position) >= 0 ?
+         az_vtheta(gravfield->position) :
+         az_vtheta(az_vneg(gravfield->position)));
+      if (fabs(az_mod2pi(gravfield->angle - expected_angle)) > 0.00001) {
+        ROOM_ERROR("Liquid at (%.02f, %.02f) not vertical",
+                   gravfield->position.x, gravfield->position.y);
       }
     }
-    // Check nodes.
+  }
+  // Check nodes.
+  for (int i = 0; i < room->num_nodes; ++i) {
+    const az_node_spec_t *node = &room->nodes[i];
+    // Check the node's on_use script.
+    if (node->kind == AZ_NODE_CONSOLE || node->kind == AZ_NODE_UPGRADE) {
+      audit_script(audit, node->on_use);
+    } else if (node->on_use != NULL) {
+      ROOM_ERROR("Node kind %d with an on_use script", (int)node->kind);
+    }
+    // Check that comm consoles have dialogue.
+    if (node->kind == AZ_NODE_CONSOLE &&
+        node->subkind.console == AZ_CONS_COMM &&
+        !script_contains_opcode(node->on_use, AZ_OP_DLOG)) {
+      ROOM_ERROR("Comm console without dialogue");
+    }
+    // Check that getting an upgrade plays mus14 or snd5.
+    if (node->kind == AZ_NODE_UPGRADE &&
+        !script_contains_instruction(node->on_use, AZ_OP_MUS, 14) &&
+        !script_contains_instruction(node->on_use, AZ_OP_SND, 5)) {
+      const az_upgrade_t upgrade = node->subkind.upgrade;
+      ROOM_ERROR("Upgrade #%d (%s) doesn't play mus14 or snd5",
+                 (int)upgrade, az_upgrade_name(upgrade));
+    }
+  }
+  audit->valid = true;
+}
+
+typedef struct {
+  const az_planet_t *planet;
+  az_audit_cache_t *cache;
+  const int *room_indices; // which rooms to audit
+} audit_job_t;
+
+static void audit_room_job(void *arg, int index) {
+  const audit_job_t *job = arg;
+  const int room_index = job->room_indices[index];
+  audit_room(&job->planet->rooms[room_index], room_index,
+             AZ_LIST_GET(job->cache->rooms, room_index));
+}
+
+/*===========================================================================*/
+
+// Run the checks on the given room that depend on other rooms.
+static bool audit_room_links(const az_planet_t *planet, int room_index,
+                             const int *next_room_with_upgrade) {
+  bool ok = true;
+  const az_room_t *room = &planet->rooms[room_index];
+  // Check that each door's destination has a door leading back here, and
+  // that if this room is next to another zone, it sets the music.
+  for (int i = 0; i < room->num_doors; ++i) {
+    const az_door_spec_t *door = &room->doors[i];
+    if (door->kind == AZ_DOOR_FORCEFIELD) continue;
+    if (door->destination == room_index) continue;
+    const int dest_index = door->destination;
+    assert(dest_index >= 0);
+    assert(dest_index < planet->num_rooms);
+    const az_room_t *dest_room = &planet->rooms[dest_index];
+    if (!room_has_door_to(dest_room, room_index)) {
+      ROOM_LINK_ERROR("Door to room %d doesn't have an exit", dest_index);
+    }
+    if (dest_room->zone_key != room->zone_key &&
+        !script_contains_opcode(room->on_start, AZ_OP_MUS)) {
+      ROOM_LINK_ERROR("Next to another zone, but doesn't set music");
+    }
+  }
+  // Check for duplicate upgrades.
+  for (int i = 0; i < room->num_nodes; ++i) {
+    const az_node_spec_t *node = &room->nodes[i];
+    if (node->kind != AZ_NODE_UPGRADE) continue;
+    const az_upgrade_t upgrade = node->subkind.upgrade;
+    for (int other_room_index = next_room_with_upgrade[
+             room_index * AZ_NUM_UPGRADES + upgrade];
+         other_room_index >= 0;
+         other_room_index = next_room_with_upgrade[
+             other_room_index * AZ_NUM_UPGRADES + upgrade]) {
+      ROOM_LINK_ERROR("Upgrade #%d (%s) also appears in room %d",
+                      (int)upgrade, az_upgrade_name(upgrade),
+                      other_room_index);
+    }
+  }
+  return ok;
+}
+
+bool az_audit_scenario(const az_planet_t *planet, az_audit_cache_t *cache) {
+  bool ok = true;
+  // Check the planet's on_start script.
+  az_room_audit_t planet_audit = {.valid = false};
+  audit_script(&planet_audit, planet->on_start);
+  if (AZ_LIST_SIZE(planet_audit.errors) > 0) ok = false;
+  print_room_audit(-1, &planet_audit);
+  clear_room_audit(&planet_audit);
+  // Re-audit rooms whose cached results are out of date, in parallel.
+  const int num_rooms = planet->num_rooms;
+  while (AZ_LIST_SIZE(cache->rooms) < num_rooms) AZ_LIST_ADD(cache->rooms);
+  int *room_indices = AZ_ALLOC(num_rooms, int);
+  int num_to_audit = 0;
+  for (int room_index = 0; room_index < num_rooms; ++room_index) {
+    if (!AZ_LIST_GET(cache->rooms, room_index)->valid) {
+      room_indices[num_to_audit++] = room_index;
+    }
+  }
+  const audit_job_t job = {
+    .planet = planet, .cache = cache, .room_indices = room_indices
+  };
+  az_parallel_for(num_to_audit, audit_room_job, (void *)&job);
+  free(room_indices);
+  // For each room and upgrade, find the next room (if any) that also
+  // contains that upgrade, so that the cross-room checks can find duplicate
+  // upgrades without searching every other room.
+  bool upgrade_exists[AZ_NUM_UPGRADES] = {false};
+  int next_room[AZ_NUM_UPGRADES];
+  for (int i = 0; i < AZ_NUM_UPGRADES; ++i) next_room[i] = -1;
+  int *next_room_with_upgrade = AZ_ALLOC(num_rooms * AZ_NUM_UPGRADES, int);
+  for (int room_index = num_rooms - 1; room_index >= 0; --room_index) {
+    for (int i = 0; i < AZ_NUM_UPGRADES; ++i) {
+      next_room_with_upgrade[room_index * AZ_NUM_UPGRADES + i] = next_room[i];
+    }
+    const az_room_t *room = &planet->rooms[room_index];
     for (int i = 0; i < room->num_nodes; ++i) {
       const az_node_spec_t *node = &room->nodes[i];
-      // Check the node's on_use script.
-      if (node->kind == AZ_NODE_CONSOLE || node->kind == AZ_NODE_UPGRADE) {
-        CHECK_SCRIPT(node->on_use);
-      } else if (node->on_use != NULL) {
-        ROOM_ERROR("Node kind %d with an on_use script", (int)node->kind);
-      }
-      // Check that comm consoles have dialogue.
-      if (node->kind == AZ_NODE_CONSOLE &&
-          node->subkind.console == AZ_CONS_COMM &&
-          !script_contains_opcode(node->on_use, AZ_OP_DLOG)) {
-        ROOM_ERROR("Comm console without dialogue");
-      }
-      // Check upgrades.
-      if (node->kind == AZ_NODE_UPGRADE) {
-        const az_upgrade_t upgrade = node->subkind.upgrade;
-        assert((int)upgrade >= 0 && upgrade < AZ_ARRAY_SIZE(upgrade_exists));
-        upgrade_exists[upgrade] = true;
-        // Check that getting the upgrade plays mus14 or snd5.
-        if (!script_contains_instruction(node->on_use, AZ_OP_MUS, 14) &&
-            !script_contains_instruction(node->on_use, AZ_OP_SND, 5)) {
-          ROOM_ERROR("Upgrade #%d (%s) doesn't play mus14 or snd5",
-                     (int)upgrade, az_upgrade_name(upgrade));
-        }
-        // Check for duplicate upgrades.
-        for (int other_room_index = room_index + 1;
-             other_room_index < planet->num_rooms; ++other_room_index) {
-          const az_room_t *other_room = &planet->rooms[other_room_index];
-          if (room_contains_upgrade(other_room, upgrade)) {
-            ROOM_ERROR("Upgrade #%d (%s) also appears in room %d",
-                       (int)upgrade, az_upgrade_name(upgrade),
-                       other_room_index);
-          }
-        }
-      }
+      if (node->kind != AZ_NODE_UPGRADE) continue;
+      const az_upgrade_t upgrade = node->subkind.upgrade;
+      assert((int)upgrade >= 0 && upgrade < AZ_ARRAY_SIZE(upgrade_exists));
+      upgrade_exists[upgrade] = true;
+      next_room[upgrade] = room_index;
     }
   }
+  // Report each room's problems, along with the cross-room checks.
+  for (int room_index = 0; room_index < num_rooms; ++room_index) {
+    const az_room_audit_t *audit = AZ_LIST_GET(cache->rooms, room_index);
+    assert(audit->valid);
+    if (AZ_LIST_SIZE(audit->errors) > 0) ok = false;
+    print_room_audit(room_index, audit);
+    if (!audit_room_links(planet, room_index, next_room_with_upgrade)) {
+      ok = false;
+    }
+  }
+  free(next_room_with_upgrade);
   // Check that all upgrades exist.
   for (int i = 0; i < AZ_ARRAY_SIZE(upgrade_exists); ++i) {
     if (!upgrade_exists[i]) {
@@ -321,4 +422,15 @@ bool az_audit_scenario(const az_planet_t *planet) {
   return ok;
 }
 
+void az_invalidate_room_audit(az_audit_cache_t *cache, int room_index) {
+  assert(room_index >= 0);
+  if (room_index >= AZ_LIST_SIZE(cache->rooms)) return;
+  clear_room_audit(AZ_LIST_GET(cache->rooms, room_index));
+}
+
+void az_destroy_audit_cache(az_audit_cache_t *cache) {
+  AZ_LIST_LOOP(audit, cache->rooms) clear_room_audit(audit);
+  AZ_LIST_DESTROY(cache->rooms);
+}
+
 /*===========================================================================*/
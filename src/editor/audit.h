@@ -24,11 +24,36 @@
 #include <stdbool.h>
 
 #include "azimuth/state/planet.h"
+#include "editor/list.h"
 
 /*===========================================================================*/
 
-// Returns true if there are no problems.
-bool az_audit_scenario(const az_planet_t *planet);
+// The results of the checks that depend on only a single room.
+typedef struct {
+  bool valid; // false if the room needs to be audited (again)
+  AZ_LIST_DECLARE(char*, errors);
+} az_room_audit_t;
+
+// Audit results for each room, saved between audits so that only rooms that
+// have changed need to be re-audited.  A zeroed cache is empty, and is ready
+// to use.
+typedef struct {
+  AZ_LIST_DECLARE(az_room_audit_t, rooms);
+} az_audit_cache_t;
+
+// Check the scenario for problems, printing any that are found.  Rooms whose
+// results aren't in the cache are audited in parallel (and their results
+// cached), while checks that span several rooms (such as door reciprocity and
+// upgrade uniqueness) are always redone.  Returns true if there are no
+// problems.
+bool az_audit_scenario(const az_planet_t *planet, az_audit_cache_t *cache);
+
+// Mark the given room's cached audit results as out of date.  This must be
+// called whenever the room changes.
+void az_invalidate_room_audit(az_audit_cache_t *cache, int room_index);
+
+// Free all cached audit results, leaving the cache empty.
+void az_destroy_audit_cache(az_audit_cache_t *cache);
 
 /*===========================================================================*/
 
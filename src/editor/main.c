@@ -52,7 +52,9 @@ static az_editor_room_t *get_current_room(void) {
 
 static void set_room_unsaved(az_editor_room_t *room) {
   room->unsaved = true;
+  room->drawing_stale = true;
   state.unsaved = true;
+  state.room_index_stale = true;
   az_relabel_editor_room(room);
 }
 
@@ -1802,6 +1804,7 @@ int main(int argc, char **argv) {
   az_init_gui(false, false);
 
   event_loop();
+  az_editor_destroy_view(&state);
   az_destroy_editor_state(&state);
 
   az_deinit_gui();
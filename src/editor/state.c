@@ -31,6 +31,7 @@
 #include "azimuth/util/misc.h"
 #include "azimuth/util/rw.h"
 #include "azimuth/util/string.h"
+#include "azimuth/util/thread.h"
 #include "azimuth/util/vector.h"
 #include "editor/audit.h"
 #include "editor/list.h"
@@ -339,8 +340,13 @@ void az_relabel_editor_room(az_editor_room_t *room) {
   }
 }
 
+// Return the path of the given resource (which the caller must free).
+static char *resource_path(const char *name) {
+  return az_strprintf("data/%s", name);
+}
+
 static bool resource_reader(const char *name, az_reader_t *reader) {
-  char *path = az_strprintf("data/%s", name);
+  char *path = resource_path(name);
   const bool success = az_file_reader(path, reader);
   free(path);
   return success;
@@ -387,8 +393,9 @@ bool az_load_editor_state(az_editor_state_t *state) {
   }
   // Convert rooms:
   AZ_LIST_INIT(state->planet.rooms, planet.num_rooms);
+  state->room_index_stale = true;
   for (az_room_key_t key = 0; key < planet.num_rooms; ++key) {
-    const az_room_t *room = &planet.rooms[key];
+    const az_room_t *room = az_get_room(&planet, key);
     az_editor_room_t *eroom = AZ_LIST_ADD(state->planet.rooms);
     eroom->zone_key = room->zone_key;
     eroom->properties = room->properties;
@@ -440,9 +447,10 @@ bool az_load_editor_state(az_editor_state_t *state) {
   return true;
 }
 
-static void summarize_scenario(const az_planet_t *planet) {
+static void summarize_scenario(const az_planet_t *planet,
+                               az_audit_cache_t *audit_cache) {
   printf("\n");
-  if (!az_audit_scenario(planet)) {
+  if (!az_audit_scenario(planet, audit_cache)) {
     printf("\n");
   }
   // Print number of rooms in each zone (both total rooms in that zone, and
@@ -488,13 +496,138 @@ static void summarize_scenario(const az_planet_t *planet) {
          (int)(100.0 * (double)total_pop_rooms / (double)planet->num_rooms));
 }
 
-static bool resource_writer(const char *name, az_writer_t *writer) {
-  char *path = az_strprintf("data/%s", name);
-  const bool success = az_file_writer(path, writer);
-  free(path);
+// One file to be written by az_save_editor_state.
+typedef struct {
+  const az_planet_t *planet;
+  const az_room_t *room; // the room to write, or NULL for the planet basis
+  char *path;
+  char *temp_path;
+  char *text; // the formatted contents, or NULL if formatting failed
+  size_t length;
+} save_file_t;
+
+// Room files are formatted into a buffer of this size, which is doubled
+// (up to the maximum) until the file fits.
+#define SAVE_BUFFER_INITIAL_SIZE ((size_t)1 << 16)
+#define SAVE_BUFFER_MAX_SIZE ((size_t)1 << 26)
+
+static void format_save_file(void *arg, int index) {
+  save_file_t *file = &((save_file_t *)arg)[index];
+  for (size_t size = SAVE_BUFFER_INITIAL_SIZE; size <= SAVE_BUFFER_MAX_SIZE;
+       size *= 2) {
+    char *buffer = AZ_ALLOC(size, char);
+    az_writer_t writer;
+    az_charbuf_writer(buffer, size, &writer);
+    const bool success = (file->room == NULL ?
+                          az_write_planet_basis(file->planet, &writer) :
+                          az_write_room(file->room, &writer));
+    if (success) {
+      file->text = buffer;
+      file->length = az_charbuf_writer_length(&writer);
+      az_wclose(&writer);
+      return;
+    }
+    az_wclose(&writer);
+    free(buffer);
+  }
+}
+
+static bool write_temp_file(const save_file_t *file) {
+  if (file->text == NULL) return false;
+  FILE *stream = fopen(file->temp_path, "w");
+  if (stream == NULL) return false;
+  bool success = (fwrite(file->text, 1, file->length, stream) == file->length);
+  if (fclose(stream) != 0) success = false;
+  if (!success) remove(file->temp_path);
   return success;
 }
 
+// Move the file's temp file into place, replacing the old file.  On POSIX
+// systems rename does this atomically, so if it fails, we just remove the temp
+// file and leave the old file alone.  On Windows rename fails if the old file
+// exists, so there we remove the old file and try again; that isn't atomic,
+// and if the second rename fails, the old file is gone and the new contents
+// are left in the temp file.
+static bool replace_with_temp_file(const save_file_t *file) {
+  if (rename(file->temp_path, file->path) == 0) return true;
+#if defined(_WIN32)
+  if (remove(file->path) == 0) {
+    return (rename(file->temp_path, file->path) == 0);
+  }
+#endif
+  remove(file->temp_path);
+  return false;
+}
+
+// Write all the files to temp files, and then (only if that all succeeded)
+// move them into place one at a time.  A failure while writing leaves the old
+// files untouched.  Each file is replaced atomically on POSIX systems, but the
+// set of files is not: if a rename fails partway, the files before it have
+// been replaced and the rest haven't (and their temp files are removed).
+// Since the planet basis comes last, it is only replaced if every room was.
+static bool commit_save_files(const save_file_t *files, int num_files) {
+  int num_written = 0;
+  while (num_written < num_files && write_temp_file(&files[num_written])) {
+    ++num_written;
+  }
+  if (num_written < num_files) {
+    for (int i = 0; i < num_written; ++i) remove(files[i].temp_path);
+    return false;
+  }
+  for (int i = 0; i < num_files; ++i) {
+    if (!replace_with_temp_file(&files[i])) {
+      for (int j = i + 1; j < num_files; ++j) remove(files[j].temp_path);
+      return false;
+    }
+  }
+  return true;
+}
+
+// Fill in the room's spec arrays from the editor room.  The room borrows the
+// editor room's scripts rather than cloning them, so it must be freed with
+// free_borrowed_room rather than az_destroy_room.
+static void borrow_room_contents(const az_editor_room_t *eroom,
+                                 az_room_t *room) {
+  // Convert baddies:
+  room->num_baddies = AZ_LIST_SIZE(eroom->baddies);
+  room->baddies = AZ_ALLOC(room->num_baddies, az_baddie_spec_t);
+  for (int i = 0; i < room->num_baddies; ++i) {
+    room->baddies[i] = AZ_LIST_GET(eroom->baddies, i)->spec;
+  }
+  // Convert doors:
+  room->num_doors = AZ_LIST_SIZE(eroom->doors);
+  room->doors = AZ_ALLOC(room->num_doors, az_door_spec_t);
+  for (int i = 0; i < room->num_doors; ++i) {
+    room->doors[i] = AZ_LIST_GET(eroom->doors, i)->spec;
+  }
+  // Convert gravfields:
+  room->num_gravfields = AZ_LIST_SIZE(eroom->gravfields);
+  room->gravfields = AZ_ALLOC(room->num_gravfields, az_gravfield_spec_t);
+  for (int i = 0; i < room->num_gravfields; ++i) {
+    room->gravfields[i] = AZ_LIST_GET(eroom->gravfields, i)->spec;
+  }
+  // Convert nodes:
+  room->num_nodes = AZ_LIST_SIZE(eroom->nodes);
+  room->nodes = AZ_ALLOC(room->num_nodes, az_node_spec_t);
+  for (int i = 0; i < room->num_nodes; ++i) {
+    room->nodes[i] = AZ_LIST_GET(eroom->nodes, i)->spec;
+  }
+  // Convert walls:
+  room->num_walls = AZ_LIST_SIZE(eroom->walls);
+  room->walls = AZ_ALLOC(room->num_walls, az_wall_spec_t);
+  for (int i = 0; i < room->num_walls; ++i) {
+    room->walls[i] = AZ_LIST_GET(eroom->walls, i)->spec;
+  }
+}
+
+static void free_borrowed_room(az_room_t *room) {
+  free(room->baddies);
+  free(room->doors);
+  free(room->gravfields);
+  free(room->nodes);
+  free(room->walls);
+}
+
 bool az_save_editor_state(az_editor_state_t *state, bool summarize) {
   assert(state != NULL);
   // Count unsaved rooms:
@@ -502,47 +635,31 @@ bool az_save_editor_state(az_editor_state_t *state, bool summarize) {
   AZ_LIST_LOOP(room, state->planet.rooms) {
     if (SAVE_ALL_ROOMS || room->unsaved) ++num_rooms_to_save;
   }
-  // Convert planet:
-  const int num_hints = AZ_LIST_SIZE(state->planet.hints);
-  const int num_paragraphs = AZ_LIST_SIZE(state->planet.paragraphs);
-  const int num_zones = AZ_LIST_SIZE(state->planet.zones);
+  // Make a planet that borrows the editor's data (scripts, zones, and so on)
+  // rather than cloning it.  Only the rooms that we're going to save (or, if
+  // we're summarizing, all rooms) need their contents filled in.
   const int num_rooms = AZ_LIST_SIZE(state->planet.rooms);
   assert(num_rooms >= 0);
   az_planet_t planet = {
     .start_room = state->planet.start_room,
-    .on_start = az_clone_script(state->planet.on_start),
-    .num_hints = num_hints,
-    .hints = AZ_ALLOC(num_hints, az_hint_t),
-    .num_paragraphs = num_paragraphs,
-    .paragraphs = AZ_ALLOC(num_paragraphs, char*),
-    .num_zones = num_zones,
-    .zones = AZ_ALLOC(num_zones, az_zone_t),
+    .on_start = state->planet.on_start,
+    .num_hints = AZ_LIST_SIZE(state->planet.hints),
+    .hints = state->planet.hints.items,
+    .num_paragraphs = AZ_LIST_SIZE(state->planet.paragraphs),
+    .paragraphs = state->planet.paragraphs.items,
+    .num_zones = AZ_LIST_SIZE(state->planet.zones),
+    .zones = state->planet.zones.items,
     .num_rooms = num_rooms,
     .rooms = AZ_ALLOC(num_rooms, az_room_t)
   };
-  // Convert hints:
-  for (int i = 0; i < num_hints; ++i) {
-    planet.hints[i] = *AZ_LIST_GET(state->planet.hints, i);
-  }
-  // Convert paragraphs:
-  for (int i = 0; i < num_paragraphs; ++i) {
-    planet.paragraphs[i] =
-      az_strdup(*AZ_LIST_GET(state->planet.paragraphs, i));
-  }
-  // Convert zones:
-  for (int i = 0; i < num_zones; ++i) {
-    az_clone_zone(AZ_LIST_GET(state->planet.zones, i), &planet.zones[i]);
-  }
-  // Convert rooms:
-  az_room_key_t *rooms_to_save = AZ_ALLOC(num_rooms_to_save, az_room_key_t);
-  int num_rooms_to_save_so_far = 0;
+  // The rooms to save come first, followed by the planet basis, which is
+  // written last (as az_write_planet does).
+  const int num_files = num_rooms_to_save + 1;
+  save_file_t *files = AZ_ALLOC(num_files, save_file_t);
+  int num_files_so_far = 0;
   for (az_room_key_t key = 0; key < num_rooms; ++key) {
     az_editor_room_t *eroom = AZ_LIST_GET(state->planet.rooms, key);
-    if (SAVE_ALL_ROOMS || eroom->unsaved) {
-      assert(num_rooms_to_save_so_far < num_rooms_to_save);
-      rooms_to_save[num_rooms_to_save_so_far] = key;
-      ++num_rooms_to_save_so_far;
-    }
+    if (eroom->unsaved) az_invalidate_room_audit(&state->audit_cache, key);
     az_room_t *room = &planet.rooms[key];
     room->zone_key = eroom->zone_key;
     room->properties = eroom->properties &
@@ -550,53 +667,40 @@ bool az_save_editor_state(az_editor_state_t *state, bool summarize) {
        AZ_ROOMF_UNMAPPED);
     room->marker_flag = eroom->marker_flag;
     room->camera_bounds = eroom->camera_bounds;
-    room->on_start = az_clone_script(eroom->on_start);
+    room->on_start = eroom->on_start;
     room->background_pattern = eroom->background_pattern;
-    // Convert baddies:
-    room->num_baddies = AZ_LIST_SIZE(eroom->baddies);
-    room->baddies = AZ_ALLOC(room->num_baddies, az_baddie_spec_t);
-    for (int i = 0; i < room->num_baddies; ++i) {
-      room->baddies[i] = AZ_LIST_GET(eroom->baddies, i)->spec;
-      room->baddies[i].on_kill = az_clone_script(room->baddies[i].on_kill);
-    }
-    // Convert doors:
-    room->num_doors = AZ_LIST_SIZE(eroom->doors);
-    room->doors = AZ_ALLOC(room->num_doors, az_door_spec_t);
-    for (int i = 0; i < room->num_doors; ++i) {
-      room->doors[i] = AZ_LIST_GET(eroom->doors, i)->spec;
-      room->doors[i].on_open = az_clone_script(room->doors[i].on_open);
-    }
-    // Convert gravfields:
-    room->num_gravfields = AZ_LIST_SIZE(eroom->gravfields);
-    room->gravfields = AZ_ALLOC(room->num_gravfields, az_gravfield_spec_t);
-    for (int i = 0; i < room->num_gravfields; ++i) {
-      room->gravfields[i] = AZ_LIST_GET(eroom->gravfields, i)->spec;
-      room->gravfields[i].on_enter =
-        az_clone_script(room->gravfields[i].on_enter);
-    }
-    // Convert nodes:
-    room->num_nodes = AZ_LIST_SIZE(eroom->nodes);
-    room->nodes = AZ_ALLOC(room->num_nodes, az_node_spec_t);
-    for (int i = 0; i < room->num_nodes; ++i) {
-      room->nodes[i] = AZ_LIST_GET(eroom->nodes, i)->spec;
-      room->nodes[i].on_use = az_clone_script(room->nodes[i].on_use);
-    }
-    // Convert walls:
-    room->num_walls = AZ_LIST_SIZE(eroom->walls);
-    room->walls = AZ_ALLOC(room->num_walls, az_wall_spec_t);
-    for (int i = 0; i < room->num_walls; ++i) {
-      room->walls[i] = AZ_LIST_GET(eroom->walls, i)->spec;
+    const bool save_room = SAVE_ALL_ROOMS || eroom->unsaved;
+    if (save_room || summarize) borrow_room_contents(eroom, room);
+    if (save_room) {
+      assert(num_files_so_far < num_rooms_to_save);
+      save_file_t *file = &files[num_files_so_far++];
+      file->room = room;
+      char *name = az_room_resource_name(key);
+      file->path = resource_path(name);
+      free(name);
     }
   }
-  assert(num_rooms_to_save_so_far == num_rooms_to_save);
+  assert(num_files_so_far == num_rooms_to_save);
+  files[num_files_so_far++].path =
+    resource_path(AZ_PLANET_BASIS_RESOURCE_NAME);
+  for (int i = 0; i < num_files; ++i) {
+    files[i].planet = &planet;
+    files[i].temp_path = az_strprintf("%s.tmp", files[i].path);
+  }
   // Summarize:
-  if (summarize) summarize_scenario(&planet);
-  // Write to disk:
-  const bool success = az_write_planet(&planet, &resource_writer,
-                                       rooms_to_save, num_rooms_to_save);
+  if (summarize) summarize_scenario(&planet, &state->audit_cache);
+  // Format the files in parallel, then write them to disk:
+  az_parallel_for(num_files, format_save_file, files);
+  const bool success = commit_save_files(files, num_files);
   // Clean up:
-  free(rooms_to_save);
-  az_destroy_planet(&planet);
+  for (int i = 0; i < num_files; ++i) {
+    free(files[i].path);
+    free(files[i].temp_path);
+    free(files[i].text);
+  }
+  free(files);
+  for (int i = 0; i < num_rooms; ++i) free_borrowed_room(&planet.rooms[i]);
+  free(planet.rooms);
   if (success) {
     state->unsaved = false;
     AZ_LIST_LOOP(room, state->planet.rooms) room->unsaved = false;
@@ -714,6 +818,7 @@ void az_destroy_editor_state(az_editor_state_t *state) {
     AZ_LIST_DESTROY(room->walls);
   }
   AZ_LIST_DESTROY(state->planet.rooms);
+  az_destroy_audit_cache(&state->audit_cache);
 }
 
 /*===========================================================================*/
@@ -29,6 +29,7 @@
 #include "azimuth/state/wall.h"
 #include "azimuth/util/clock.h"
 #include "azimuth/util/vector.h"
+#include "editor/audit.h"
 #include "editor/list.h"
 
 /*===========================================================================*/
@@ -126,6 +127,12 @@ typedef struct {
   AZ_LIST_DECLARE(az_editor_gravfield_t, gravfields);
   AZ_LIST_DECLARE(az_editor_node_t, nodes);
   AZ_LIST_DECLARE(az_editor_wall_t, walls);
+  // The first of a block of display lists caching how this room is drawn
+  // when it isn't the current room (see editor/view.c), or zero if they
+  // haven't been compiled yet.  Set drawing_stale whenever the room is edited
+  // so that they get recompiled.
+  unsigned int drawing_lists;
+  bool drawing_stale;
 } az_editor_room_t;
 
 typedef struct {
@@ -176,6 +183,11 @@ typedef struct {
     AZ_LIST_DECLARE(az_zone_t, zones);
     AZ_LIST_DECLARE(az_editor_room_t, rooms);
   } planet;
+  // Per-room results from the last audit (see az_audit_scenario):
+  az_audit_cache_t audit_cache;
+  // Set whenever a room is added or edited, so that editor/view.c will
+  // rebuild its index of where each room is:
+  bool room_index_stale;
 } az_editor_state_t;
 
 /*===========================================================================*/
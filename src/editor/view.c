@@ -21,6 +21,7 @@
 
 #include <assert.h>
 #include <math.h>
+#include <stdlib.h>
 
 #include <SDL_opengl.h>
 
@@ -49,6 +50,26 @@
 #define EDITOR_TEXT_BOX_FONT_SIZE 16
 #define EDITOR_TEXT_BOX_ROW_HEIGHT 22
 
+// When zoomed out at least this far (but not as far as minimap mode), rooms
+// other than the current room are drawn with less detail, using only their
+// cached wall outlines and door markers:
+#define LOD_ZOOM_LEVEL 2.5
+// When outlining walls for the low-detail view, skip vertices that are closer
+// than this to the last vertex drawn:
+#define LOD_MIN_VERTEX_SPACING 5.0
+
+// Each room's cached drawing (see compile_room_drawing) is a block of display
+// lists, in this order:
+#define ROOM_LIST_ZONE_SWATCH 0
+#define ROOM_LIST_DOOR_MARKERS 1
+#define ROOM_LIST_EDGE_BOUNDS 2 // sets no color, so the caller can pick one
+#define ROOM_LIST_WALL_OUTLINES 3
+#define NUM_ROOM_LISTS 4
+
+// The size of the polar grid used by the room index (see build_room_index):
+#define ROOM_INDEX_R_CELLS 16
+#define ROOM_INDEX_THETA_CELLS 64
+
 /*===========================================================================*/
 
 static void arc_vertices(double r, double start_theta, double end_theta) {
@@ -161,12 +182,14 @@ static void draw_zone_swatch(az_editor_state_t *state,
   }
 }
 
-// Draw the (approximate) bounds of what the camera can actually see within the
-// given room.
-static void draw_camera_edge_bounds(const az_editor_room_t *room) {
+static void camera_edge_bounds_color(const az_editor_room_t *room) {
   if (room->selected) glColor3f(0, 1, 0); // green
   else glColor3f(0.75, 0.75, 0.75); // white
-  const az_camera_bounds_t *bounds = &room->camera_bounds;
+}
+
+// Draw the (approximate) bounds of what the camera can actually see within a
+// room with the given camera bounds, using the current color.
+static void camera_edge_bounds_lines(const az_camera_bounds_t *bounds) {
   if (bounds->theta_span >= 6.28) {
     glBegin(GL_LINE_LOOP); {
       circle_vertices(hypot(AZ_SCREEN_WIDTH/2,
@@ -218,6 +241,13 @@ static void draw_camera_edge_bounds(const az_editor_room_t *room) {
   } glEnd();
 }
 
+// Draw the (approximate) bounds of what the camera can actually see within the
+// given room.
+static void draw_camera_edge_bounds(const az_editor_room_t *room) {
+  camera_edge_bounds_color(room);
+  camera_edge_bounds_lines(&room->camera_bounds);
+}
+
 static void camera_to_screen_orient(const az_editor_state_t *state,
                                     az_vector_t position) {
   az_gl_translated(position);
@@ -479,38 +509,107 @@ static void draw_room(az_editor_state_t *state, az_editor_room_t *room) {
   draw_camera_edge_bounds(room);
 }
 
-static void draw_room_minimap(az_editor_state_t *state,
-                              az_editor_room_t *room, az_room_key_t key) {
-  if (state->zoom_level >= 32.0) draw_zone_swatch(state, room);
-
-  // Draw doors (schematically):
-  if (state->zoom_level < 64.0) {
-    AZ_LIST_LOOP(editor_door, room->doors) {
-      switch (editor_door->spec.kind) {
-        case AZ_DOOR_NOTHING: AZ_ASSERT_UNREACHABLE();
-        case AZ_DOOR_NORMAL: glColor3f(1, 1, 1); break;
-        case AZ_DOOR_LOCKED: glColor3f(0.5, 0.5, 0.5); break;
-        case AZ_DOOR_ROCKET: glColor3f(1, 0, 0); break;
-        case AZ_DOOR_HYPER_ROCKET: glColor3f(1, 0, 1); break;
-        case AZ_DOOR_BOMB: glColor3f(0, 0, 1); break;
-        case AZ_DOOR_MEGA_BOMB: glColor3f(0, 1, 1); break;
-        case AZ_DOOR_PASSAGE: glColor3f(0, 1, 0); break;
-        case AZ_DOOR_FORCEFIELD: continue; // don't draw
-        case AZ_DOOR_UNLOCKED: glColor3f(1, 1, 0); break;
-        case AZ_DOOR_ALWAYS_OPEN: glColor3f(0.8, 0.8, 0.8); break;
-        case AZ_DOOR_BOSS: glColor3f(0.5, 0.5, 0.5); break;
-      }
-      glPushMatrix(); {
-        glTranslated(editor_door->spec.position.x,
-                     editor_door->spec.position.y, 0);
-        glBegin(GL_POLYGON); {
-          circle_vertices(AZ_DOOR_BOUNDING_RADIUS);
-        } glEnd();
-      } glPopMatrix();
+// Draw the room's doors schematically, as dots colored by door kind.
+static void draw_door_markers(az_editor_room_t *room) {
+  AZ_LIST_LOOP(editor_door, room->doors) {
+    switch (editor_door->spec.kind) {
+      case AZ_DOOR_NOTHING: AZ_ASSERT_UNREACHABLE();
+      case AZ_DOOR_NORMAL: glColor3f(1, 1, 1); break;
+      case AZ_DOOR_LOCKED: glColor3f(0.5, 0.5, 0.5); break;
+      case AZ_DOOR_ROCKET: glColor3f(1, 0, 0); break;
+      case AZ_DOOR_HYPER_ROCKET: glColor3f(1, 0, 1); break;
+      case AZ_DOOR_BOMB: glColor3f(0, 0, 1); break;
+      case AZ_DOOR_MEGA_BOMB: glColor3f(0, 1, 1); break;
+      case AZ_DOOR_PASSAGE: glColor3f(0, 1, 0); break;
+      case AZ_DOOR_FORCEFIELD: continue; // don't draw
+      case AZ_DOOR_UNLOCKED: glColor3f(1, 1, 0); break;
+      case AZ_DOOR_ALWAYS_OPEN: glColor3f(0.8, 0.8, 0.8); break;
+      case AZ_DOOR_BOSS: glColor3f(0.5, 0.5, 0.5); break;
     }
+    glPushMatrix(); {
+      glTranslated(editor_door->spec.position.x,
+                   editor_door->spec.position.y, 0);
+      glBegin(GL_POLYGON); {
+        circle_vertices(AZ_DOOR_BOUNDING_RADIUS);
+      } glEnd();
+    } glPopMatrix();
   }
+}
 
-  draw_camera_edge_bounds(room);
+// Draw a simplified outline of each wall in the room, in the wall's main
+// color.
+static void draw_wall_outlines(az_editor_room_t *room) {
+  AZ_LIST_LOOP(editor_wall, room->walls) {
+    const az_wall_data_t *data = editor_wall->spec.data;
+    const az_polygon_t polygon = data->polygon;
+    glPushMatrix(); {
+      az_gl_translated(editor_wall->spec.position);
+      az_gl_rotated(editor_wall->spec.angle);
+      az_gl_color(data->color1);
+      glBegin(GL_LINE_LOOP); {
+        az_vector_t last = polygon.vertices[polygon.num_vertices - 1];
+        for (int i = 0; i < polygon.num_vertices; ++i) {
+          const az_vector_t vertex = polygon.vertices[i];
+          if (az_vwithin(vertex, last, LOD_MIN_VERTEX_SPACING)) continue;
+          az_gl_vertex(vertex);
+          last = vertex;
+        }
+      } glEnd();
+    } glPopMatrix();
+  }
+}
+
+// Make sure that the room's cached drawing is up to date, (re)compiling its
+// display lists if the room has been edited since they were last compiled.
+static void compile_room_drawing(az_editor_state_t *state,
+                                 az_editor_room_t *room) {
+  if (room->drawing_lists != 0 && !room->drawing_stale) return;
+  if (room->drawing_lists == 0) {
+    room->drawing_lists = glGenLists(NUM_ROOM_LISTS);
+    if (room->drawing_lists == 0u) {
+      AZ_FATAL("glGenLists failed.\n");
+    }
+  }
+  room->drawing_stale = false;
+  glNewList(room->drawing_lists + ROOM_LIST_ZONE_SWATCH, GL_COMPILE); {
+    draw_zone_swatch(state, room);
+  } glEndList();
+  glNewList(room->drawing_lists + ROOM_LIST_DOOR_MARKERS, GL_COMPILE); {
+    draw_door_markers(room);
+  } glEndList();
+  glNewList(room->drawing_lists + ROOM_LIST_EDGE_BOUNDS, GL_COMPILE); {
+    camera_edge_bounds_lines(&room->camera_bounds);
+  } glEndList();
+  glNewList(room->drawing_lists + ROOM_LIST_WALL_OUTLINES, GL_COMPILE); {
+    draw_wall_outlines(room);
+  } glEndList();
+}
+
+static void call_room_list(const az_editor_room_t *room, int index) {
+  assert(room->drawing_lists != 0);
+  assert(!room->drawing_stale);
+  assert(index >= 0 && index < NUM_ROOM_LISTS);
+  glCallList(room->drawing_lists + index);
+}
+
+// Draw a room other than the current room, when zoomed out too far for its
+// finer details to be worth drawing.
+static void draw_room_low_detail(az_editor_state_t *state,
+                                 az_editor_room_t *room) {
+  compile_room_drawing(state, room);
+  call_room_list(room, ROOM_LIST_WALL_OUTLINES);
+  call_room_list(room, ROOM_LIST_DOOR_MARKERS);
+  camera_edge_bounds_color(room);
+  call_room_list(room, ROOM_LIST_EDGE_BOUNDS);
+}
+
+static void draw_room_minimap(az_editor_state_t *state,
+                              az_editor_room_t *room, az_room_key_t key) {
+  compile_room_drawing(state, room);
+  if (state->zoom_level >= 32.0) call_room_list(room, ROOM_LIST_ZONE_SWATCH);
+  if (state->zoom_level < 64.0) call_room_list(room, ROOM_LIST_DOOR_MARKERS);
+  camera_edge_bounds_color(room);
+  call_room_list(room, ROOM_LIST_EDGE_BOUNDS);
 
   // Draw room number:
   if (state->zoom_level < 32.0) {
@@ -563,6 +662,145 @@ static void draw_selection_circle(az_vector_t position, double angle,
   } glPopMatrix();
 }
 
+// To avoid testing every room in the planet each frame to see whether it's in
+// view, we keep an index of the rooms on a polar grid.  Each cell lists the
+// rooms that could be in view when the camera can see any part of that cell.
+typedef AZ_LIST_DECLARE(az_room_key_t, room_key_list_t);
+
+static struct {
+  bool built;
+  double r_cell_size;
+  room_key_list_t cells[ROOM_INDEX_R_CELLS][ROOM_INDEX_THETA_CELLS];
+  // The last query that found each room, so that each query finds each room
+  // only once, even if it's listed in several cells:
+  unsigned int query_stamps[AZ_MAX_NUM_ROOMS];
+  unsigned int last_query;
+} room_index;
+
+// The range of index cells overlapping some area of the plane.
+typedef struct {
+  int min_r_cell, max_r_cell;
+  int min_theta_cell, num_theta_cells; // theta cells wrap around
+} cell_range_t;
+
+static int r_cell_index(double r) {
+  return az_imax(0, az_imin(ROOM_INDEX_R_CELLS - 1,
+                            (int)(r / room_index.r_cell_size)));
+}
+
+// Get the range of cells overlapping the given polar rectangle.
+static cell_range_t index_cells(double min_r, double max_r,
+                                double min_theta, double theta_span) {
+  cell_range_t range = {
+    .min_r_cell = r_cell_index(min_r),
+    .max_r_cell = r_cell_index(max_r),
+    .min_theta_cell = 0,
+    .num_theta_cells = ROOM_INDEX_THETA_CELLS
+  };
+  if (theta_span < AZ_TWO_PI) {
+    const double cells_per_radian = ROOM_INDEX_THETA_CELLS / AZ_TWO_PI;
+    const double start = az_mod2pi_nonneg(min_theta) * cells_per_radian;
+    const double end = start + theta_span * cells_per_radian;
+    range.min_theta_cell = az_imin(ROOM_INDEX_THETA_CELLS - 1, (int)start);
+    range.num_theta_cells =
+      az_imin(ROOM_INDEX_THETA_CELLS, (int)end - (int)start + 1);
+  }
+  return range;
+}
+
+// Get the range of cells overlapping the area in which the camera might be
+// able to see some part of the room (see draw_camera_view).
+static cell_range_t room_index_cells(const az_editor_room_t *room) {
+  const az_camera_bounds_t *bounds = &room->camera_bounds;
+  const double extra_theta_span =
+    (bounds->min_r <= AZ_SCREEN_RADIUS ? AZ_TWO_PI :
+     2.0 * asin(AZ_SCREEN_RADIUS / bounds->min_r));
+  return index_cells(bounds->min_r - AZ_SCREEN_RADIUS,
+                     bounds->min_r + bounds->r_span + AZ_SCREEN_RADIUS,
+                     bounds->min_theta - 0.5 * extra_theta_span,
+                     bounds->theta_span + extra_theta_span);
+}
+
+static void destroy_room_index(void) {
+  for (int r = 0; r < ROOM_INDEX_R_CELLS; ++r) {
+    for (int t = 0; t < ROOM_INDEX_THETA_CELLS; ++t) {
+      AZ_LIST_DESTROY(room_index.cells[r][t]);
+    }
+  }
+  room_index.built = false;
+}
+
+static void build_room_index(az_editor_state_t *state) {
+  destroy_room_index();
+  // Size the grid so that it just covers all the rooms.
+  double max_r = AZ_SCREEN_RADIUS;
+  AZ_LIST_LOOP(room, state->planet.rooms) {
+    const az_camera_bounds_t *bounds = &room->camera_bounds;
+    max_r = fmax(max_r, bounds->min_r + bounds->r_span + AZ_SCREEN_RADIUS);
+  }
+  room_index.r_cell_size = max_r / ROOM_INDEX_R_CELLS;
+  for (int key = 0; key < AZ_LIST_SIZE(state->planet.rooms); ++key) {
+    const cell_range_t range =
+      room_index_cells(AZ_LIST_GET(state->planet.rooms, key));
+    for (int r = range.min_r_cell; r <= range.max_r_cell; ++r) {
+      for (int i = 0; i < range.num_theta_cells; ++i) {
+        const int t = (range.min_theta_cell + i) % ROOM_INDEX_THETA_CELLS;
+        *AZ_LIST_ADD(room_index.cells[r][t]) = key;
+      }
+    }
+  }
+  room_index.built = true;
+  state->room_index_stale = false;
+}
+
+static int compare_room_keys(const void *v1, const void *v2) {
+  return *(const az_room_key_t *)v1 - *(const az_room_key_t *)v2;
+}
+
+// Find the rooms (other than the current room) that might be in view, given
+// the polar bounds of the camera view, storing their keys (in order) into the
+// given array and returning the number found.  We use the room index to find
+// candidates, and then check each one more carefully.
+static int find_rooms_in_view(
+    az_editor_state_t *state, double camera_min_r, double camera_max_r,
+    double camera_theta, double camera_theta_span,
+    az_room_key_t keys_out[AZ_MAX_NUM_ROOMS]) {
+  if (!room_index.built || state->room_index_stale) build_room_index(state);
+  const unsigned int query = ++room_index.last_query;
+  const cell_range_t range =
+    index_cells(camera_min_r, camera_max_r,
+                camera_theta - 0.5 * camera_theta_span, camera_theta_span);
+  int num_keys = 0;
+  for (int r = range.min_r_cell; r <= range.max_r_cell; ++r) {
+    for (int i = 0; i < range.num_theta_cells; ++i) {
+      const int t = (range.min_theta_cell + i) % ROOM_INDEX_THETA_CELLS;
+      AZ_LIST_LOOP(key, room_index.cells[r][t]) {
+        if (*key == state->current_room) continue;
+        if (room_index.query_stamps[*key] == query) continue;
+        room_index.query_stamps[*key] = query;
+        const az_editor_room_t *room =
+          AZ_LIST_GET(state->planet.rooms, *key);
+        const az_camera_bounds_t *bounds = &room->camera_bounds;
+        if (bounds->min_r + bounds->r_span + AZ_SCREEN_RADIUS <
+            camera_min_r ||
+            bounds->min_r - AZ_SCREEN_RADIUS > camera_max_r) continue;
+        const double extra_theta_span = camera_theta_span +
+          (bounds->min_r <= AZ_SCREEN_RADIUS ? AZ_TWO_PI :
+           2.0 * asin(AZ_SCREEN_RADIUS / bounds->min_r));
+        if (az_mod2pi_nonneg(camera_theta -
+                             (bounds->min_theta - 0.5 * extra_theta_span)) >
+            bounds->theta_span + extra_theta_span) continue;
+        assert(num_keys < AZ_MAX_NUM_ROOMS);
+        keys_out[num_keys++] = *key;
+      }
+    }
+  }
+  // Draw rooms in order, as we would without the index, so that the overlaps
+  // between them don't depend on the grid.
+  qsort(keys_out, num_keys, sizeof(az_room_key_t), compare_room_keys);
+  return num_keys;
+}
+
 static void draw_camera_view(az_editor_state_t *state) {
   glColor3f(1, 1, 0); // yellow
   glBegin(GL_LINE_LOOP); {
@@ -578,26 +816,21 @@ static void draw_camera_view(az_editor_state_t *state) {
   const double camera_theta_span = (camera_mid_r <= camera_radius ? AZ_TWO_PI :
                                     2.0 * asin(camera_radius / camera_mid_r));
 
-  // Draw other rooms:
-  for (int i = 0; i < AZ_LIST_SIZE(state->planet.rooms); ++i) {
-    if (i == state->current_room) continue;
-    az_editor_room_t *room = AZ_LIST_GET(state->planet.rooms, i);
-    // Determine whether the room is (possibly) in view.  If not, don't bother
-    // drawing it.
-    const az_camera_bounds_t *bounds = &room->camera_bounds;
-    if (bounds->min_r + bounds->r_span + AZ_SCREEN_RADIUS < camera_min_r ||
-        bounds->min_r - AZ_SCREEN_RADIUS > camera_max_r) continue;
-    const double extra_theta_span = camera_theta_span +
-      (bounds->min_r <= AZ_SCREEN_RADIUS ? AZ_TWO_PI :
-       2.0 * asin(AZ_SCREEN_RADIUS / bounds->min_r));
-    if (az_mod2pi_nonneg(camera_theta -
-                         (bounds->min_theta - 0.5 * extra_theta_span)) >
-        bounds->theta_span + extra_theta_span) continue;
-    // Draw the room.
-    if (!az_editor_is_in_minimap_mode(state)) {
+  // Draw other rooms (those that are possibly in view, that is):
+  az_room_key_t keys[AZ_MAX_NUM_ROOMS];
+  const int num_keys = find_rooms_in_view(
+      state, camera_min_r, camera_max_r, camera_theta, camera_theta_span,
+      keys);
+  for (int i = 0; i < num_keys; ++i) {
+    az_editor_room_t *room = AZ_LIST_GET(state->planet.rooms, keys[i]);
+    if (az_editor_is_in_minimap_mode(state)) {
+      draw_room_minimap(state, room, keys[i]);
+    } else if (state->zoom_level >= LOD_ZOOM_LEVEL) {
+      draw_room_low_detail(state, room);
+    } else {
       draw_room(state, room);
       if (room->selected) draw_camera_edge_bounds(room);
-    } else draw_room_minimap(state, room, i);
+    }
   }
 
   // Fade out other rooms:
@@ -909,4 +1142,14 @@ int az_pixel_to_text_box_index(int x, int y) {
           az_imin(az_imax(0, col), EDITOR_TEXT_BOX_CHARS_PER_ROW));
 }
 
+void az_editor_destroy_view(az_editor_state_t *state) {
+  AZ_LIST_LOOP(room, state->planet.rooms) {
+    if (room->drawing_lists == 0) continue;
+    glDeleteLists(room->drawing_lists, NUM_ROOM_LISTS);
+    room->drawing_lists = 0;
+  }
+  destroy_room_index();
+  state->room_index_stale = true;
+}
+
 /*===========================================================================*/
@@ -29,6 +29,11 @@
 
 void az_editor_draw_screen(az_editor_state_t *state);
 
+// Free the display lists and room index that az_editor_draw_screen caches for
+// the editor state.  This must be called (while the GL context still exists)
+// before the editor state is destroyed.
+void az_editor_destroy_view(az_editor_state_t *state);
+
 az_vector_t az_pixel_to_position(const az_editor_state_t *state, int x, int y);
 
 int az_pixel_to_text_box_index(int x, int y);
@@ -0,0 +1,198 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#include "muse/batch.h"
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "azimuth/state/music.h"
+#include "azimuth/util/misc.h"
+#include "azimuth/util/music.h"
+#include "azimuth/util/profile.h"
+#include "azimuth/util/rw.h"
+#include "azimuth/util/sound.h"
+#include "azimuth/util/string.h"
+#include "azimuth/util/thread.h"
+#include "azimuth/util/vector.h"
+#include "muse/wave.h"
+
+/*===========================================================================*/
+
+// We synthesize music in chunks of this many samples, which is how the game's
+// audio callback asks for it:
+#define CHUNK_SAMPLES 1024
+
+typedef struct {
+  const char *filename;
+  int flag;
+  char *wav_name;
+  // These are filled in by render_job:
+  const char *error; // NULL on success
+  uint64_t checksum;
+  uint64_t render_ns;
+} batch_job_t;
+
+typedef struct {
+  const char *out_dir;
+  int num_samples;
+  int num_drums;
+  const az_sound_data_t *drums;
+  batch_job_t *jobs;
+} batch_t;
+
+// Compute a 64-bit FNV-1a hash of the samples, taken as little-endian bytes,
+// so that checksums can be compared across platforms.
+static uint64_t checksum_samples(const int16_t *samples, int num_samples) {
+  uint64_t hash = UINT64_C(0xcbf29ce484222325);
+  for (int i = 0; i < num_samples; ++i) {
+    const uint16_t sample = (uint16_t)samples[i];
+    hash = (hash ^ (sample & 0xff)) * UINT64_C(0x100000001b3);
+    hash = (hash ^ (sample >> 8)) * UINT64_C(0x100000001b3);
+  }
+  return hash;
+}
+
+// Name the WAV file for a job after the music file (minus any directory or
+// extension) and flag, e.g. "music01-flag2.wav".
+static char *make_wav_name(const char *filename, int flag) {
+  const char *slash = strrchr(filename, '/');
+  const char *base = (slash == NULL ? filename : slash + 1);
+  const char *dot = strrchr(base, '.');
+  const int length = (dot == NULL ? (int)strlen(base) : (int)(dot - base));
+  return az_strprintf("%.*s-flag%d.wav", length, base, flag);
+}
+
+static void render_job(void *arg, int index) {
+  const batch_t *batch = arg;
+  batch_job_t *job = &batch->jobs[index];
+  // Each job loads its own copy of the music, so that jobs share nothing but
+  // the (read-only) drum kit.
+  az_reader_t reader;
+  if (!az_file_reader(job->filename, &reader)) {
+    job->error = "could not open music file";
+    return;
+  }
+  az_music_t music;
+  const bool parsed =
+    az_read_music(&reader, batch->num_drums, batch->drums, &music);
+  az_rclose(&reader);
+  if (!parsed) {
+    job->error = "failed to parse music";
+    return;
+  }
+  int16_t *samples = AZ_ALLOC(batch->num_samples, int16_t);
+  az_music_synth_t synth;
+  az_reset_music_synth(&synth, &music, job->flag);
+  const uint64_t start_ns = az_profile_now_ns();
+  for (int i = 0; i < batch->num_samples; i += CHUNK_SAMPLES) {
+    az_synthesize_music(&synth, samples + i,
+                        az_imin(CHUNK_SAMPLES, batch->num_samples - i));
+  }
+  job->render_ns = az_profile_now_ns() - start_ns;
+  az_destroy_music(&music);
+  job->checksum = checksum_samples(samples, batch->num_samples);
+  char *path = az_strprintf("%s/%s", batch->out_dir, job->wav_name);
+  FILE *file = fopen(path, "wb");
+  if (file == NULL) {
+    job->error = "could not create WAV file";
+  } else {
+    bool ok = az_write_samples_to_wav_file(file, samples, batch->num_samples);
+    if (fclose(file) != 0) ok = false;
+    if (!ok) job->error = "failed to write WAV file";
+  }
+  free(path);
+  free(samples);
+}
+
+static bool write_checksums(const batch_t *batch, int num_jobs) {
+  char *path = az_strprintf("%s/checksums.txt", batch->out_dir);
+  FILE *file = fopen(path, "w");
+  free(path);
+  if (file == NULL) return false;
+  bool ok = true;
+  for (int i = 0; i < num_jobs && ok; ++i) {
+    const batch_job_t *job = &batch->jobs[i];
+    if (job->error != NULL) continue;
+    ok = (fprintf(file, "%016"PRIx64"  %s\n", job->checksum,
+                  job->wav_name) >= 0);
+  }
+  if (fclose(file) != 0) ok = false;
+  return ok;
+}
+
+bool az_batch_render_music(const char *out_dir, double duration,
+                           int num_flags, const int *flags,
+                           int num_files, char **filenames) {
+  batch_t batch = {
+    .out_dir = out_dir,
+    .num_samples = (int)ceil(AZ_AUDIO_RATE * duration)
+  };
+  // Create the drum kit up front, since it's shared by all the jobs.
+  az_get_drum_kit(&batch.num_drums, &batch.drums);
+  const int num_jobs = num_files * num_flags;
+  batch.jobs = AZ_ALLOC(num_jobs, batch_job_t);
+  for (int i = 0; i < num_jobs; ++i) {
+    batch_job_t *job = &batch.jobs[i];
+    job->filename = filenames[i / num_flags];
+    job->flag = flags[i % num_flags];
+    job->wav_name = make_wav_name(job->filename, job->flag);
+  }
+
+  const uint64_t start_ns = az_profile_now_ns();
+  az_parallel_for(num_jobs, render_job, &batch);
+  const double elapsed_seconds = 1e-9 * (az_profile_now_ns() - start_ns);
+
+  int num_rendered = 0;
+  printf("%-24s %-16s %10s %12s\n", "WAV file", "checksum", "render ms",
+         "samples/sec");
+  for (int i = 0; i < num_jobs; ++i) {
+    const batch_job_t *job = &batch.jobs[i];
+    if (job->error != NULL) {
+      fprintf(stderr, "ERROR: %s (flag %d): %s\n", job->filename, job->flag,
+              job->error);
+      continue;
+    }
+    ++num_rendered;
+    printf("%-24s %016"PRIx64" %10.1f %12.0f\n", job->wav_name,
+           job->checksum, 1e-6 * job->render_ns,
+           batch.num_samples / fmax(1e-9 * job->render_ns, 1e-9));
+  }
+  printf("Rendered %d of %d tracks of %d samples in %.2f s using up to %d"
+         " threads (%.0f samples/sec overall)\n", num_rendered, num_jobs,
+         batch.num_samples, elapsed_seconds, az_imin(az_num_cpus(), num_jobs),
+         (double)num_rendered * batch.num_samples /
+         fmax(elapsed_seconds, 1e-9));
+  bool success = (num_rendered == num_jobs);
+  if (!write_checksums(&batch, num_jobs)) {
+    fprintf(stderr, "ERROR: could not write %s/checksums.txt\n", out_dir);
+    success = false;
+  }
+
+  for (int i = 0; i < num_jobs; ++i) free(batch.jobs[i].wav_name);
+  free(batch.jobs);
+  return success;
+}
+
+/*===========================================================================*/
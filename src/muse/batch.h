@@ -0,0 +1,41 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#pragma once
+#ifndef MUSE_BATCH_H_
+#define MUSE_BATCH_H_
+
+#include <stdbool.h>
+
+/*===========================================================================*/
+
+// Render each of the given music files with each of the given flag values
+// for the given number of seconds, spreading the work across all CPUs.  Each
+// rendering is written to a WAV file in out_dir, and its checksum is recorded
+// in out_dir/checksums.txt, so that the files from two different versions of
+// the synthesizer can be compared.  A summary, including how many samples per
+// second each track was rendered at, is printed to stdout.  Returns true if
+// everything succeeded.
+bool az_batch_render_music(const char *out_dir, double duration,
+                           int num_flags, const int *flags,
+                           int num_files, char **filenames);
+
+/*===========================================================================*/
+
+#endif // MUSE_BATCH_H_
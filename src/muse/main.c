@@ -19,12 +19,15 @@
 
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <SDL.h>
 
 #include "azimuth/state/music.h"
 #include "azimuth/util/music.h"
+#include "azimuth/util/misc.h"
 #include "azimuth/util/sound.h"
+#include "muse/batch.h"
 #include "muse/wave.h"
 
 /*===========================================================================*/
@@ -43,9 +46,54 @@ static void destroy_music(void) {
   az_destroy_music(&music);
 }
 
+static void print_usage(const char *program) {
+  fprintf(stderr, "Usage: %s <filename> [<flag>] [<duration>]\n"
+          "       %s --batch <out dir> <duration> <flag>[,<flag>...]"
+          " <filename>...\n", program, program);
+}
+
+// Batch mode: render every given music file with every given flag to a WAV
+// file in the output directory (see az_batch_render_music).
+static int batch_main(int argc, char **argv) {
+  if (argc < 6) {
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  const char *out_dir = argv[2];
+  double duration = 0.0;
+  if (sscanf(argv[3], "%lf", &duration) < 1 || duration <= 0.0) {
+    fprintf(stderr, "Invalid duration: %s\n", argv[3]);
+    return EXIT_FAILURE;
+  }
+  int num_flags = 1;
+  for (const char *ch = argv[4]; *ch != '\0'; ++ch) {
+    if (*ch == ',') ++num_flags;
+  }
+  int *flags = AZ_ALLOC(num_flags, int);
+  const char *flag_string = argv[4];
+  for (int i = 0; i < num_flags; ++i) {
+    int length = 0;
+    if (sscanf(flag_string, "%d%n", &flags[i], &length) < 1 ||
+        (flag_string[length] != ',' && flag_string[length] != '\0')) {
+      fprintf(stderr, "Invalid flag list: %s\n", argv[4]);
+      free(flags);
+      return EXIT_FAILURE;
+    }
+    flag_string += length + 1;
+  }
+  const bool success =
+    az_batch_render_music(out_dir, duration, num_flags, flags, argc - 5,
+                          argv + 5);
+  free(flags);
+  return (success ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
 int main(int argc, char **argv) {
+  if (argc >= 2 && strcmp(argv[1], "--batch") == 0) {
+    return batch_main(argc, argv);
+  }
   if (argc < 2 || argc > 4) {
-    fprintf(stderr, "Usage: %s <filename> [<flag>] [<duration>]\n", argv[0]);
+    print_usage(argv[0]);
     return EXIT_FAILURE;
   }
   int music_flag = 0;
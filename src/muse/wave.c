@@ -43,15 +43,13 @@ static void write_int32(FILE *file, int32_t value) {
   fputc((value >> 24) & 0xff, file);
 }
 
-void az_write_music_to_wav_file(FILE *file, az_music_synth_t *synth,
-                                double duration) {
-  const int num_samples = ceil(AZ_AUDIO_RATE * duration);
+static void write_wav_header(FILE *file, int num_samples) {
   const int bytes_per_sample = 2;
   const int bits_per_sample = 8 * bytes_per_sample;
   const int data_size = num_samples * bytes_per_sample;
   // Header:
   fputs("RIFF", file);
-  write_int32(file, 36 * data_size);
+  write_int32(file, 36 + data_size);
   fputs("WAVE", file);
   // Format:
   fputs("fmt ", file);
@@ -65,6 +63,12 @@ void az_write_music_to_wav_file(FILE *file, az_music_synth_t *synth,
   // Data:
   fputs("data", file);
   write_int32(file, data_size);
+}
+
+void az_write_music_to_wav_file(FILE *file, az_music_synth_t *synth,
+                                double duration) {
+  const int num_samples = ceil(AZ_AUDIO_RATE * duration);
+  write_wav_header(file, num_samples);
   int16_t buffer[1024];
   int samples_remaining = num_samples;
   while (samples_remaining > 0) {
@@ -77,4 +81,11 @@ void az_write_music_to_wav_file(FILE *file, az_music_synth_t *synth,
   }
 }
 
+bool az_write_samples_to_wav_file(FILE *file, const int16_t *samples,
+                                  int num_samples) {
+  write_wav_header(file, num_samples);
+  for (int i = 0; i < num_samples; ++i) write_int16(file, samples[i]);
+  return !ferror(file);
+}
+
 /*===========================================================================*/
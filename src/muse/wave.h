@@ -22,6 +22,7 @@
 #define MUSE_WAVE_H_
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 
 #include "azimuth/util/music.h"
@@ -31,6 +32,11 @@
 void az_write_music_to_wav_file(FILE *file, az_music_synth_t *synth,
                                 double duration);
 
+// Write already-synthesized mono samples (at AZ_AUDIO_RATE) to a WAV file.
+// Returns false if there was an error writing to the file.
+bool az_write_samples_to_wav_file(FILE *file, const int16_t *samples,
+                                  int num_samples);
+
 /*===========================================================================*/
 
 #endif // MUSE_WAVE_H_
@@ -0,0 +1,110 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+// planetc compiles the text planet data (rooms/planet.txt and the room files)
+// into a single compiled planet image (see azimuth/state/compiled_planet.h),
+// which the build embeds in the game as rooms/planet.bin.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "azimuth/state/compiled_planet.h"
+#include "azimuth/state/planet.h"
+#include "azimuth/state/wall.h" // for az_init_wall_datas
+#include "azimuth/util/rw.h"
+#include "azimuth/util/string.h"
+
+/*===========================================================================*/
+
+static const char *data_dir = "data";
+
+// A resource reader for the text data only; we never want to compile from a
+// stale compiled planet that happens to be sitting in the data directory.
+static bool text_resource_reader(const char *name, az_reader_t *reader) {
+  const size_t length = strlen(name);
+  if (length < 4 || strcmp(name + length - 4, ".txt") != 0) return false;
+  char *path = az_strprintf("%s/%s", data_dir, name);
+  const bool success = az_file_reader(path, reader);
+  free(path);
+  return success;
+}
+
+// Load the image back in and recompile it, and check that we get the same
+// bytes out, so that the build fails rather than embedding a bad image.
+static bool verify_image(const char *image, size_t size) {
+  az_planet_t planet;
+  if (!az_load_compiled_planet(image, size, &planet)) return false;
+  char *image2;
+  size_t size2;
+  az_compile_planet(&planet, &image2, &size2);
+  az_destroy_planet(&planet);
+  const bool same = (size2 == size && memcmp(image, image2, size) == 0);
+  free(image2);
+  return same;
+}
+
+static bool write_image(const char *path, const char *image, size_t size) {
+  FILE *file = fopen(path, "wb");
+  if (file == NULL) return false;
+  const bool success = (fwrite(image, sizeof(char), size, file) == size);
+  return (fclose(file) == 0) && success;
+}
+
+static void print_usage(const char *program) {
+  fprintf(stderr, "Usage: %s [-d <data_dir>] <output_file>\n", program);
+}
+
+int main(int argc, char **argv) {
+  int arg = 1;
+  if (arg + 1 < argc && strcmp(argv[arg], "-d") == 0) {
+    data_dir = argv[arg + 1];
+    arg += 2;
+  }
+  if (arg + 1 != argc) {
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  const char *output_path = argv[arg];
+
+  az_init_wall_datas();
+  az_planet_t planet;
+  if (!az_read_planet(text_resource_reader, &planet)) {
+    fprintf(stderr, "ERROR: failed to load planet from %s\n", data_dir);
+    return EXIT_FAILURE;
+  }
+  char *image;
+  size_t size;
+  az_compile_planet(&planet, &image, &size);
+  az_destroy_planet(&planet);
+
+  bool success = true;
+  if (!verify_image(image, size)) {
+    fprintf(stderr, "ERROR: compiled planet failed to round-trip\n");
+    success = false;
+  } else if (!write_image(output_path, image, size)) {
+    fprintf(stderr, "ERROR: could not write %s\n", output_path);
+    success = false;
+  }
+  free(image);
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*===========================================================================*/
@@ -0,0 +1,373 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+// simbench runs the game simulation (az_tick_space_state) headlessly, with no
+// window, audio, or frame pacing, and reports how long each tick subsystem
+// takes.  Ship controls come either from a built-in script or from a controls
+// file; each line of a controls file has the form "<num_frames> <keys>",
+// where <keys> is "-" or any combination of the letters u, d, l, r (thrust
+// and turning), f, o, and x (fire, ordnance, and utility).  Lines starting
+// with '#' are ignored, and the file is replayed in a loop as needed.  With
+// -s, it also reports how much time each room's scripts took, and how often
+// each script opcode was executed.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "azimuth/constants.h"
+#include "azimuth/state/baddie.h" // for az_init_baddie_datas
+#include "azimuth/state/music.h" // for az_init_music_datas
+#include "azimuth/state/planet.h"
+#include "azimuth/state/player.h"
+#include "azimuth/state/sound.h" // for az_init_sound_datas
+#include "azimuth/state/space.h"
+#include "azimuth/state/wall.h" // for az_init_wall_datas
+#include "azimuth/tick/script.h" // for az_resume_script and script profiles
+#include "azimuth/tick/space.h"
+#include "azimuth/util/misc.h"
+#include "azimuth/util/prefs.h"
+#include "azimuth/util/profile.h"
+#include "azimuth/util/random.h"
+#include "azimuth/util/rw.h"
+#include "azimuth/util/string.h"
+
+/*===========================================================================*/
+
+#define MAX_CONTROL_STEPS 1000
+#define MAX_SUBSYSTEMS 32
+
+typedef struct {
+  int num_frames;
+  az_controls_t controls;
+} control_step_t;
+
+static const char *data_dir = "data";
+static az_planet_t planet;
+static az_preferences_t prefs;
+static az_space_state_t state;
+
+static int num_control_steps = 0;
+static control_step_t control_steps[MAX_CONTROL_STEPS];
+
+// A default control script that flies around, turning and shooting.
+static const char default_controls[] =
+  "30 u\n20 rf\n40 uf\n15 l\n30 uo\n20 df\n25 ulf\n10 x\n30 urf\n20 -\n";
+
+static bool data_dir_resource_reader(const char *name, az_reader_t *reader) {
+  char *path = az_strprintf("%s/%s", data_dir, name);
+  const bool success = az_file_reader(path, reader);
+  free(path);
+  return success;
+}
+
+static void destroy_planet(void) {
+  az_destroy_planet(&planet);
+}
+
+/*===========================================================================*/
+// Controls:
+
+static bool parse_controls(const char *text) {
+  num_control_steps = 0;
+  while (*text != '\0') {
+    const char *line_end = strchr(text, '\n');
+    if (line_end == NULL) line_end = text + strlen(text);
+    if (*text != '#' && line_end > text) {
+      if (num_control_steps >= MAX_CONTROL_STEPS) return false;
+      control_step_t *step = &control_steps[num_control_steps++];
+      AZ_ZERO_OBJECT(step);
+      char keys[16] = "";
+      if (sscanf(text, "%d %15s", &step->num_frames, keys) < 2 ||
+          step->num_frames <= 0) return false;
+      for (const char *key = keys; *key != '\0'; ++key) {
+        switch (*key) {
+          case 'u': step->controls.up_held = true; break;
+          case 'd': step->controls.down_held = true; break;
+          case 'l': step->controls.left_held = true; break;
+          case 'r': step->controls.right_held = true; break;
+          case 'f': step->controls.fire_held = true; break;
+          case 'o': step->controls.ordn_held = true; break;
+          case 'x': step->controls.util_held = true; break;
+          case '-': break;
+          default: return false;
+        }
+      }
+    }
+    text = (*line_end == '\0' ? line_end : line_end + 1);
+  }
+  return num_control_steps > 0;
+}
+
+static bool load_controls_file(const char *path) {
+  FILE *file = fopen(path, "r");
+  if (file == NULL) return false;
+  static char buffer[MAX_CONTROL_STEPS * 32];
+  const size_t length = fread(buffer, 1, sizeof(buffer) - 1, file);
+  fclose(file);
+  buffer[length] = '\0';
+  return parse_controls(buffer);
+}
+
+// Set the ship controls for the given frame number.  A control counts as
+// "pressed" on the first frame that it is held.
+static void set_controls(int frame) {
+  int total_frames = 0;
+  for (int i = 0; i < num_control_steps; ++i) {
+    total_frames += control_steps[i].num_frames;
+  }
+  const az_controls_t *prev = NULL;
+  const az_controls_t *current = NULL;
+  int remaining = frame % total_frames;
+  for (int i = 0; current == NULL; ++i) {
+    if (remaining < control_steps[i].num_frames) {
+      current = &control_steps[i].controls;
+      if (remaining == 0) {
+        prev = &control_steps[(i + num_control_steps - 1) %
+                              num_control_steps].controls;
+      }
+    } else remaining -= control_steps[i].num_frames;
+  }
+  state.ship.controls = *current;
+  if (prev != NULL) {
+    state.ship.controls.up_pressed = current->up_held && !prev->up_held;
+    state.ship.controls.down_pressed = current->down_held && !prev->down_held;
+    state.ship.controls.fire_pressed = current->fire_held && !prev->fire_held;
+    state.ship.controls.util_pressed = current->util_held && !prev->util_held;
+  }
+}
+
+// Do what a player would do to dismiss any text that is waiting on a
+// keypress, so that scripted sequences don't stall the simulation.
+static void dismiss_text(void) {
+  if (state.monologue.step == AZ_MLS_TALK) {
+    state.monologue.step = AZ_MLS_WAIT;
+    state.monologue.progress = 0.0;
+    state.monologue.chars_to_print = state.monologue.paragraph_length;
+  } else if (state.monologue.step == AZ_MLS_WAIT) {
+    az_resume_script(&state, &state.sync_vm);
+  } else if (state.dialogue.step == AZ_DLS_TALK) {
+    state.dialogue.step = AZ_DLS_WAIT;
+    state.dialogue.progress = 0.0;
+    state.dialogue.chars_to_print = state.dialogue.paragraph_length;
+  } else if (state.dialogue.step == AZ_DLS_WAIT) {
+    az_resume_script(&state, &state.sync_vm);
+  } else if (state.mode == AZ_MODE_UPGRADE &&
+             state.upgrade_mode.step == AZ_UGS_MESSAGE) {
+    state.upgrade_mode.step = AZ_UGS_CLOSE;
+    state.upgrade_mode.progress = 0.0;
+  }
+}
+
+/*===========================================================================*/
+// Simulation:
+
+typedef struct {
+  const char *name;
+  uint64_t total_ns;
+} subsystem_time_t;
+
+typedef struct {
+  uint64_t total_ns, max_frame_ns;
+  int num_subsystems;
+  subsystem_time_t subsystems[MAX_SUBSYSTEMS];
+} bench_result_t;
+
+static void enter_room(az_room_key_t room_key, bool all_upgrades) {
+  AZ_ZERO_OBJECT(&state);
+  state.planet = &planet;
+  state.prefs = &prefs;
+  state.mode = AZ_MODE_NORMAL;
+  az_init_player(&state.ship.player);
+  if (all_upgrades) {
+    for (int i = 0; i < AZ_NUM_UPGRADES; ++i) {
+      az_give_upgrade(&state.ship.player, (az_upgrade_t)i);
+    }
+  }
+  state.ship.player.current_room = room_key;
+  const az_room_t *room = az_get_room(&planet, room_key);
+  az_enter_room(&state, room);
+  // Start the ship just inside a door, as though we'd flown in through it.
+  state.ship.position = az_bounds_center(&room->camera_bounds);
+  AZ_ARRAY_LOOP(door, state.doors) {
+    if (door->kind == AZ_DOOR_NOTHING) continue;
+    if (door->kind == AZ_DOOR_FORCEFIELD) continue;
+    state.ship.position = az_vadd(door->position, az_vpolar(60.0, door->angle));
+    state.ship.angle = door->angle;
+    break;
+  }
+  az_after_entering_room(&state);
+}
+
+static void record_subsystem(bench_result_t *result, const char *name,
+                             uint64_t total_ns) {
+  for (int i = 0; i < result->num_subsystems; ++i) {
+    if (strcmp(result->subsystems[i].name, name) == 0) {
+      result->subsystems[i].total_ns += total_ns;
+      return;
+    }
+  }
+  if (result->num_subsystems >= MAX_SUBSYSTEMS) return;
+  result->subsystems[result->num_subsystems++] =
+    (subsystem_time_t){ .name = name, .total_ns = total_ns };
+}
+
+static void run_room(az_room_key_t room_key, int num_frames,
+                     bool all_upgrades, bench_result_t *result) {
+  // Reset the random seed for each room, so that each room's results don't
+  // depend on which other rooms were simulated first.
+  az_set_global_random_seed((az_random_seed_t){1, 1});
+  enter_room(room_key, all_upgrades);
+  az_reset_profile_counters();
+  for (int frame = 0; frame < num_frames; ++frame) {
+    set_controls(frame);
+    const uint64_t start_ns = az_profile_now_ns();
+    az_tick_space_state(&state, AZ_FRAME_TIME_SECONDS);
+    const uint64_t frame_ns = az_profile_now_ns() - start_ns;
+    result->total_ns += frame_ns;
+    if (frame_ns > result->max_frame_ns) result->max_frame_ns = frame_ns;
+    // There's no audio here, so just throw away this frame's sounds.
+    AZ_ZERO_OBJECT(&state.soundboard);
+    AZ_ZERO_OBJECT(&state.ship.controls);
+    dismiss_text();
+  }
+  for (const az_profile_counter_t *counter = az_first_profile_counter();
+       counter != NULL; counter = counter->next) {
+    record_subsystem(result, counter->name, counter->total_ns);
+  }
+}
+
+static void print_result(const char *label, int num_frames,
+                         const bench_result_t *result) {
+  printf("%s: %d frames, %.3f ms total, %.1f us/frame mean, "
+         "%.1f us/frame max\n", label, num_frames, result->total_ns * 1e-6,
+         result->total_ns * 1e-3 / num_frames, result->max_frame_ns * 1e-3);
+  for (int i = 0; i < result->num_subsystems; ++i) {
+    printf("  %-24s %12.0f ns/frame\n", result->subsystems[i].name,
+           (double)result->subsystems[i].total_ns / num_frames);
+  }
+}
+
+/*===========================================================================*/
+
+static void print_usage(const char *program) {
+  fprintf(stderr, "Usage: %s [-d <data_dir>] [-n <num_frames>] "
+          "[-c <controls_file>] [-u] [-s] (<room> ... | all)\n", program);
+}
+
+int main(int argc, char **argv) {
+  int num_frames = 1000;
+  bool all_upgrades = false;
+  bool script_profile = false;
+  const char *controls_path = NULL;
+  int first_room_arg = 1;
+  for (; first_room_arg < argc && argv[first_room_arg][0] == '-';
+       ++first_room_arg) {
+    const char *flag = argv[first_room_arg];
+    if (strcmp(flag, "-u") == 0) {
+      all_upgrades = true;
+      continue;
+    }
+    if (strcmp(flag, "-s") == 0) {
+      script_profile = true;
+      continue;
+    }
+    if (first_room_arg + 1 >= argc) {
+      print_usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+    const char *value = argv[++first_room_arg];
+    if (strcmp(flag, "-d") == 0) data_dir = value;
+    else if (strcmp(flag, "-c") == 0) controls_path = value;
+    else if (strcmp(flag, "-n") == 0) {
+      if (sscanf(value, "%d", &num_frames) < 1 || num_frames <= 0) {
+        fprintf(stderr, "Invalid number of frames: %s\n", value);
+        return EXIT_FAILURE;
+      }
+    } else {
+      print_usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (first_room_arg >= argc) {
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  if (controls_path != NULL) {
+    if (!load_controls_file(controls_path)) {
+      fprintf(stderr, "ERROR: could not read controls from %s\n",
+              controls_path);
+      return EXIT_FAILURE;
+    }
+  } else if (!parse_controls(default_controls)) AZ_ASSERT_UNREACHABLE();
+
+  az_init_sound_datas(NULL);
+  az_init_baddie_datas();
+  az_init_wall_datas();
+  az_reset_prefs_to_defaults(&prefs);
+  if (!az_init_music_datas(data_dir_resource_reader) ||
+      !az_read_planet(data_dir_resource_reader, &planet)) {
+    fprintf(stderr, "ERROR: failed to load scenario from %s\n", data_dir);
+    return EXIT_FAILURE;
+  }
+  atexit(destroy_planet);
+  if (!AZ_PROFILING) {
+    fprintf(stderr, "Note: built without PROFILING=1, so only total frame "
+            "times will be reported.\n");
+  }
+
+  const bool all_rooms = (strcmp(argv[first_room_arg], "all") == 0);
+  const int num_rooms = (all_rooms ? planet.num_rooms : argc - first_room_arg);
+  bench_result_t overall = {.total_ns = 0};
+  for (int i = 0; i < num_rooms; ++i) {
+    int room_key = i;
+    if (!all_rooms && (sscanf(argv[first_room_arg + i], "%d", &room_key) < 1 ||
+                       room_key < 0 || room_key >= planet.num_rooms)) {
+      fprintf(stderr, "Invalid room: %s\n", argv[first_room_arg + i]);
+      return EXIT_FAILURE;
+    }
+    bench_result_t result = {.total_ns = 0};
+    run_room(room_key, num_frames, all_upgrades, &result);
+    char label[32];
+    snprintf(label, sizeof(label), "room %03d", room_key);
+    print_result(label, num_frames, &result);
+    overall.total_ns += result.total_ns;
+    if (result.max_frame_ns > overall.max_frame_ns) {
+      overall.max_frame_ns = result.max_frame_ns;
+    }
+    for (int j = 0; j < result.num_subsystems; ++j) {
+      record_subsystem(&overall, result.subsystems[j].name,
+                       result.subsystems[j].total_ns);
+    }
+  }
+  if (num_rooms > 1) print_result("overall", num_frames * num_rooms, &overall);
+  if (script_profile) {
+    az_writer_t writer;
+    az_stdout_writer(&writer);
+    az_write_script_profile(&writer);
+    az_wclose(&writer);
+  }
+  return EXIT_SUCCESS;
+}
+
+/*===========================================================================*/
@@ -18,11 +18,19 @@
 =============================================================================*/
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "azimuth/util/audio.h"
+#include "azimuth/util/misc.h"
+#include "azimuth/util/mixer.h"
 #include "azimuth/util/music.h"
+#include "azimuth/util/music_stream.h"
+#include "azimuth/util/random.h"
 #include "azimuth/util/rw.h"
 #include "azimuth/util/sound.h"
+#include "azimuth/util/thread.h"
+#include "azimuth/util/vector.h"
 #include "test/test.h"
 
 /*===========================================================================*/
@@ -42,6 +50,287 @@ void test_create_sound_data(void) {
   EXPECT_TRUE(data.samples == NULL);
 }
 
+static const az_sound_spec_t cache_test_specs[] = {
+  { .wave_kind = AZ_SINE_WAVE, .env_decay = 0.125, .start_freq = 0.5 },
+  { .wave_kind = AZ_NOISE_WAVE, .env_sustain = 0.1, .env_decay = 0.2,
+    .start_freq = 0.3, .repeat_speed = 0.4, .phaser_sweep = -0.15 },
+  { .wave_kind = AZ_SQUARE_WAVE, .env_attack = 0.1, .env_decay = 0.15,
+    .start_freq = 0.6, .freq_slide = -0.2, .lpf_cutoff = 0.5 },
+  { .wave_kind = AZ_NOISE_WAVE, .env_decay = 0.1, .start_freq = 0.2 }
+};
+
+#define NUM_CACHE_TEST_SPECS AZ_ARRAY_SIZE(cache_test_specs)
+
+// Check that each of the sounds is the same as what az_create_sound_data
+// gives for its spec.
+static void expect_rendered_sounds(const az_sound_data_t *datas) {
+  for (int i = 0; i < NUM_CACHE_TEST_SPECS; ++i) {
+    az_sound_data_t expected;
+    az_create_sound_data(&cache_test_specs[i], &expected);
+    EXPECT_INT_EQ(expected.num_samples, datas[i].num_samples);
+    EXPECT_TRUE(expected.num_samples == datas[i].num_samples &&
+                memcmp(expected.samples, datas[i].samples,
+                       expected.num_samples * sizeof(int16_t)) == 0);
+    az_destroy_sound_data(&expected);
+  }
+}
+
+static void destroy_sounds(az_sound_data_t *datas) {
+  for (int i = 0; i < NUM_CACHE_TEST_SPECS; ++i) {
+    az_destroy_sound_data(&datas[i]);
+  }
+}
+
+void test_sound_cache(void) {
+  const char *cache_path = "test_sounds.cache.tmp";
+  remove(cache_path);
+  // Rendering sounds in parallel should give the same results as rendering
+  // them one at a time, and should write the cache file.
+  az_sound_data_t datas[NUM_CACHE_TEST_SPECS] = {{0}};
+  az_create_sound_datas(NUM_CACHE_TEST_SPECS, cache_test_specs, datas,
+                        cache_path);
+  expect_rendered_sounds(datas);
+  destroy_sounds(datas);
+  FILE *file = fopen(cache_path, "rb");
+  ASSERT_TRUE(file != NULL);
+  fclose(file);
+  // Loading the sounds back out of the cache (even in a different order, or
+  // with sounds that aren't in the cache) should give the same results.
+  const az_sound_spec_t extra_spec = {
+    .wave_kind = AZ_TRIANGLE_WAVE, .env_decay = 0.1, .start_freq = 0.4
+  };
+  EXPECT_FALSE(az_sound_spec_hash(&extra_spec) ==
+               az_sound_spec_hash(&cache_test_specs[0]));
+  az_sound_spec_t specs[NUM_CACHE_TEST_SPECS + 1];
+  for (int i = 0; i < NUM_CACHE_TEST_SPECS; ++i) {
+    specs[i] = cache_test_specs[NUM_CACHE_TEST_SPECS - 1 - i];
+  }
+  specs[NUM_CACHE_TEST_SPECS] = extra_spec;
+  az_sound_data_t more_datas[NUM_CACHE_TEST_SPECS + 1] = {{0}};
+  az_create_sound_datas(NUM_CACHE_TEST_SPECS + 1, specs, more_datas,
+                        cache_path);
+  for (int i = 0; i < NUM_CACHE_TEST_SPECS; ++i) {
+    datas[i] = more_datas[NUM_CACHE_TEST_SPECS - 1 - i];
+  }
+  expect_rendered_sounds(datas);
+  destroy_sounds(datas);
+  az_destroy_sound_data(&more_datas[NUM_CACHE_TEST_SPECS]);
+  // A corrupted cache should be ignored.
+  file = fopen(cache_path, "wb");
+  ASSERT_TRUE(file != NULL);
+  fputs("garbage", file);
+  fclose(file);
+  az_create_sound_datas(NUM_CACHE_TEST_SPECS, cache_test_specs, datas,
+                        cache_path);
+  expect_rendered_sounds(datas);
+  destroy_sounds(datas);
+  remove(cache_path);
+}
+
+typedef struct {
+  az_audio_queue_t *queue;
+  int num_commands;
+} az_queue_test_t;
+
+// Push volume commands numbered from zero up to num_commands - 1, waiting
+// for the consumer whenever the queue is full.
+static void push_numbered_commands(void *arg) {
+  az_queue_test_t *test = arg;
+  for (int i = 0; i < test->num_commands; ++i) {
+    const az_audio_command_t command = {
+      .kind = AZ_AUDIO_CMD_MUSIC_VOLUME, .flag = i
+    };
+    while (!az_push_audio_command(test->queue, &command)) {}
+  }
+}
+
+void test_audio_queue(void) {
+  static az_audio_queue_t queue;
+  AZ_ZERO_OBJECT(&queue);
+  az_audio_command_t command;
+  EXPECT_FALSE(az_pop_audio_command(&queue, &command));
+  // A soundboard sent through the queue should come out the same.
+  const az_sound_data_t sound1, sound2, sound3;
+  const az_music_t music;
+  az_soundboard_t soundboard;
+  AZ_ZERO_OBJECT(&soundboard);
+  az_change_music_flag(&soundboard, 3);
+  az_change_music_data(&soundboard, &music, 1.5);
+  az_change_music_flag(&soundboard, 4);
+  az_play_sound_data(&soundboard, &sound1, 0.5f);
+  az_loop_sound_data(&soundboard, &sound2, 0.25f);
+  az_reset_sound_data(&soundboard, &sound3);
+  ASSERT_TRUE(az_push_soundboard(&queue, &soundboard));
+  az_soundboard_t received;
+  AZ_ZERO_OBJECT(&received);
+  while (true) {
+    ASSERT_TRUE(az_pop_audio_command(&queue, &command));
+    if (command.kind == AZ_AUDIO_CMD_END_FRAME) break;
+    az_apply_audio_command(&command, &received);
+  }
+  EXPECT_FALSE(az_pop_audio_command(&queue, &command));
+  EXPECT_TRUE(memcmp(&soundboard, &received, sizeof(soundboard)) == 0);
+  // Once the queue is full, pushing a soundboard should push nothing at all.
+  int num_pushed = 0;
+  while (az_push_audio_command(&queue, &(az_audio_command_t){
+        .kind = AZ_AUDIO_CMD_SOUND_VOLUME })) ++num_pushed;
+  EXPECT_INT_EQ(AZ_AUDIO_QUEUE_SIZE, num_pushed);
+  ASSERT_TRUE(az_pop_audio_command(&queue, &command));
+  EXPECT_FALSE(az_push_soundboard(&queue, &soundboard));
+  for (int i = 1; i < AZ_AUDIO_QUEUE_SIZE; ++i) {
+    ASSERT_TRUE(az_pop_audio_command(&queue, &command));
+    EXPECT_INT_EQ(AZ_AUDIO_CMD_SOUND_VOLUME, command.kind);
+  }
+  EXPECT_FALSE(az_pop_audio_command(&queue, &command));
+  // Commands pushed from another thread should arrive intact and in order.
+  az_queue_test_t test = { .queue = &queue, .num_commands = 20000 };
+  az_thread_t *producer = az_start_thread(push_numbered_commands, &test);
+  for (int i = 0; i < test.num_commands; ++i) {
+    while (!az_pop_audio_command(&queue, &command)) {}
+    EXPECT_INT_EQ(AZ_AUDIO_CMD_MUSIC_VOLUME, command.kind);
+    EXPECT_INT_EQ(i, command.flag);
+  }
+  az_join_thread(producer);
+  EXPECT_FALSE(az_pop_audio_command(&queue, &command));
+}
+
+void test_mixer(void) {
+  // Panning should keep centered sounds at full volume.
+  float left, right;
+  az_pan_gains(0.0f, &left, &right);
+  EXPECT_APPROX(1.0, left);
+  EXPECT_APPROX(1.0, right);
+  az_pan_gains(-1.0f, &left, &right);
+  EXPECT_APPROX(1.0, left);
+  EXPECT_WITHIN(0.0, right, 1e-6);
+  az_pan_gains(0.5f, &left, &right);
+  EXPECT_TRUE(left > 0.0f && left < 1.0f);
+  EXPECT_APPROX(1.0, right);
+  // Soft clipping should leave quiet samples alone, and squash loud ones.
+  EXPECT_APPROX(0.5, az_soft_clip(0.5f));
+  EXPECT_APPROX(-0.5, az_soft_clip(-0.5f));
+  EXPECT_TRUE(az_soft_clip(0.9f) < 0.9f);
+  EXPECT_TRUE(az_soft_clip(1.0f) > az_soft_clip(0.9f));
+  EXPECT_TRUE(az_soft_clip(100.0f) < 1.0f);
+  EXPECT_APPROX(-az_soft_clip(2.0f), az_soft_clip(-2.0f));
+  const float loud_mix[4] = {1000.0f, -1000.0f, 1e6f, -1e6f};
+  int16_t clipped[4];
+  az_soft_clip_mix(loud_mix, clipped, 4);
+  EXPECT_INT_EQ(1000, clipped[0]);
+  EXPECT_INT_EQ(-1000, clipped[1]);
+  EXPECT_TRUE(clipped[2] > 32000);
+  EXPECT_TRUE(clipped[3] < -32000);
+
+  // Upsampled to twice the rate, a one-shot sound should play for twice as
+  // many frames, and then free its voice.
+  int16_t constant[10];
+  AZ_ARRAY_LOOP(sample, constant) *sample = 1000;
+  const az_sound_data_t sound = { .num_samples = 10, .samples = constant };
+  az_mixer_t mixer;
+  az_init_mixer(&mixer, 2 * AZ_AUDIO_RATE, 1);
+  az_mixer_voice_t *voice = az_start_mixer_voice(&mixer, &sound, 0);
+  ASSERT_TRUE(voice != NULL);
+  voice->volume = 0.5f;
+  float mix[AZ_MIXER_BLOCK_FRAMES * AZ_MIXER_MAX_CHANNELS] = {0};
+  az_mix_voices(&mixer, 1.0f, mix, 30);
+  for (int i = 0; i < 19; ++i) EXPECT_APPROX(500.0, mix[i]);
+  EXPECT_APPROX(250.0, mix[19]); // halfway from the last sample to silence
+  for (int i = 20; i < 30; ++i) EXPECT_APPROX(0.0, mix[i]);
+  EXPECT_TRUE(voice->data == NULL);
+
+  // In stereo, a looped sound panned hard right should keep going, only in
+  // the right channel.
+  az_init_mixer(&mixer, 48000, 2);
+  voice = az_start_mixer_voice(&mixer, &sound, 0);
+  ASSERT_TRUE(voice != NULL);
+  voice->pan = 1.0f;
+  voice->loop = voice->persisted = true;
+  AZ_ZERO_ARRAY(mix);
+  az_mix_voices(&mixer, 1.0f, mix, AZ_MIXER_BLOCK_FRAMES);
+  for (int i = 0; i < AZ_MIXER_BLOCK_FRAMES; ++i) {
+    EXPECT_WITHIN(0.0, mix[2 * i], 0.01);
+    EXPECT_APPROX(1000.0, mix[2 * i + 1]);
+  }
+  EXPECT_TRUE(voice->data == &sound);
+  EXPECT_FALSE(voice->finished);
+
+  // When all voices are busy, a new sound should take over the oldest voice
+  // with the lowest priority, but never one with a higher priority.
+  az_init_mixer(&mixer, 48000, 2);
+  az_mixer_voice_t *voices[AZ_MIXER_MAX_VOICES];
+  for (int i = 0; i < AZ_MIXER_MAX_VOICES; ++i) {
+    voices[i] = az_start_mixer_voice(&mixer, &sound, 0);
+    ASSERT_TRUE(voices[i] != NULL);
+  }
+  EXPECT_TRUE(az_start_mixer_voice(&mixer, &sound, 0) == voices[0]);
+  EXPECT_TRUE(az_start_mixer_voice(&mixer, &sound, 1) == voices[1]);
+  EXPECT_TRUE(az_start_mixer_voice(&mixer, &sound, 0) == voices[2]);
+  AZ_ARRAY_LOOP(busy, mixer.voices) busy->priority = 1;
+  EXPECT_TRUE(az_start_mixer_voice(&mixer, &sound, 0) == NULL);
+  EXPECT_TRUE(az_start_mixer_voice(&mixer, &sound, 1) == voices[3]);
+
+  // Music should be linearly interpolated, continuing smoothly from one
+  // block to the next, and faded by the given gain ramp.
+  az_init_mixer(&mixer, 2 * AZ_AUDIO_RATE, 1);
+  ASSERT_INT_EQ(4, az_music_samples_needed(&mixer, 8));
+  const int16_t music1[4] = {100, 200, 300, 400};
+  AZ_ZERO_ARRAY(mix);
+  az_mix_music(&mixer, music1, 1.0f, 0.0f, mix, 8);
+  const double expected1[8] = {0, 0, 0, 50, 100, 150, 200, 250};
+  for (int i = 0; i < 8; ++i) EXPECT_APPROX(expected1[i], mix[i]);
+  ASSERT_INT_EQ(2, az_music_samples_needed(&mixer, 4));
+  const int16_t music2[2] = {500, 600};
+  AZ_ZERO_ARRAY(mix);
+  az_mix_music(&mixer, music2, 1.0f, -0.5f, mix, 4);
+  const double expected2[4] = {300, 175, 0, 0};
+  for (int i = 0; i < 4; ++i) EXPECT_APPROX(expected2[i], mix[i]);
+}
+
+// Check that mixing a voice adds exactly what a plain scalar loop would, for
+// every block length (so that both the four-frames-at-a-time SSE2 path and
+// the scalar tail get exercised), in both mono and stereo.
+void test_mixer_accumulate(void) {
+  az_random_seed_t seed = {3, 7};
+  int16_t samples[AZ_MIXER_BLOCK_FRAMES + 2];
+  AZ_ARRAY_LOOP(sample, samples) {
+    *sample = (int16_t)(az_rand_uint32(&seed) & 0xffff);
+  }
+  const az_sound_data_t sound = {
+    .num_samples = AZ_ARRAY_SIZE(samples), .samples = samples
+  };
+  const int stride = AZ_MIXER_MAX_CHANNELS;
+  float initial[AZ_MIXER_BLOCK_FRAMES * AZ_MIXER_MAX_CHANNELS];
+  AZ_ARRAY_LOOP(value, initial) *value = 1000.0f * az_rand_sdouble(&seed);
+  for (int num_channels = 1; num_channels <= stride; ++num_channels) {
+    for (int num_frames = 1; num_frames <= AZ_MIXER_BLOCK_FRAMES;
+         ++num_frames) {
+      // At AZ_AUDIO_RATE, the voice's block is just the sound's samples.
+      az_mixer_t mixer;
+      az_init_mixer(&mixer, AZ_AUDIO_RATE, num_channels);
+      az_mixer_voice_t *voice = az_start_mixer_voice(&mixer, &sound, 0);
+      ASSERT_TRUE(voice != NULL);
+      voice->volume = 0.75f;
+      voice->pan = (num_channels == 1 ? 0.0f : -0.25f);
+      float gains[AZ_MIXER_MAX_CHANNELS] = {1.0f, 1.0f};
+      if (num_channels == 2) az_pan_gains(voice->pan, &gains[0], &gains[1]);
+      const float gain = 0.5f;
+      for (int c = 0; c < num_channels; ++c) gains[c] *= gain * voice->volume;
+      // Offset the mix by one frame, so that it isn't 16-byte aligned.
+      float mix[AZ_MIXER_BLOCK_FRAMES * AZ_MIXER_MAX_CHANNELS + stride];
+      AZ_ZERO_ARRAY(mix);
+      memcpy(mix + num_channels, initial, sizeof(initial));
+      az_mix_voices(&mixer, gain, mix + num_channels, num_frames);
+      EXPECT_TRUE(mix[0] == 0.0f);
+      for (int i = 0; i < AZ_MIXER_BLOCK_FRAMES * num_channels; ++i) {
+        const int frame = i / num_channels;
+        const float expected = (frame >= num_frames ? initial[i] :
+            initial[i] + gains[i % num_channels] * samples[frame]);
+        ASSERT_TRUE(mix[num_channels + i] == expected);
+      }
+    }
+  }
+}
+
 void test_persist_sound(void) {
   az_soundboard_t soundboard = { .num_persists = 0 };
   const az_sound_data_t sound1, sound2, sound3, sound4;
@@ -135,6 +424,78 @@ void test_sound_volume(void) {
     ASSERT_TRUE(success); \
   } while (false)
 
+// Read num_samples samples from the stream into the samples array, waiting
+// for the producer if necessary.  If producer is true, there's no producer
+// thread, so render into the stream directly.
+static void read_stream_fully(az_music_stream_t *stream, bool producer,
+                              int16_t *samples, int num_samples) {
+  int num_read = 0;
+  while (num_read < num_samples) {
+    if (producer) while (az_render_music_stream(stream)) {}
+    const int count = az_read_music_stream(stream, samples + num_read,
+                                           num_samples - num_read);
+    if (producer) ASSERT_INT_EQ(num_samples - num_read, count);
+    else if (count == 0) az_sleep_ns(100000);
+    num_read += count;
+  }
+}
+
+void test_music_stream(void) {
+  const char *music_string =
+    "@M \"a A =1b :a b B :b\"\n"
+    "!Part A\n"
+    "1| c4s e |\n"
+    "!Part B\n"
+    "1| g4s a |\n";
+  az_music_t music;
+  PARSE_MUSIC_FROM_STRING(music_string, &music);
+  // Each part is an eighth note long, so changing the flag partway through
+  // the third part should take effect at the start of the fourth part, even
+  // though the stream has already rendered well past that point.
+  const int part_samples = AZ_AUDIO_RATE / 8;
+  const int flag_at = 2 * part_samples + part_samples / 2;
+  const int total = 6 * part_samples;
+  static int16_t expected[6 * AZ_AUDIO_RATE / 8];
+  static int16_t actual[AZ_ARRAY_SIZE(expected)];
+  az_music_synth_t synth;
+  az_reset_music_synth(&synth, &music, 0);
+  az_synthesize_music(&synth, expected, flag_at);
+  synth.flag = 1;
+  az_synthesize_music(&synth, expected + flag_at, total - flag_at);
+  // Make sure that the flag change actually made a difference:
+  az_reset_music_synth(&synth, &music, 0);
+  az_synthesize_music(&synth, actual, total);
+  EXPECT_FALSE(memcmp(expected, actual, sizeof(actual)) == 0);
+
+  // Try the stream both with a producer thread and without.
+  for (int threaded = 0; threaded <= 1; ++threaded) {
+    static az_music_stream_t stream;
+    az_init_music_stream(&stream);
+    az_thread_t *thread =
+      (threaded ? az_start_thread(az_run_music_stream, &stream) : NULL);
+    az_change_stream_music(&stream, &music, 0);
+    memset(actual, 0, sizeof(actual));
+    for (int start = 0; start < total; start += 1000) {
+      if (start <= flag_at && flag_at < start + 1000) {
+        read_stream_fully(&stream, !threaded, actual + start, flag_at - start);
+        az_set_stream_music_flag(&stream, 1);
+        read_stream_fully(&stream, !threaded, actual + flag_at,
+                          az_imin(start + 1000, total) - flag_at);
+      } else {
+        read_stream_fully(&stream, !threaded, actual + start,
+                          az_imin(1000, total - start));
+      }
+    }
+    EXPECT_TRUE(memcmp(expected, actual, sizeof(actual)) == 0);
+    if (threaded) {
+      az_stop_music_stream(&stream);
+      az_join_thread(thread);
+    }
+    az_destroy_music_stream(&stream);
+  }
+  az_destroy_music(&music);
+}
+
 void test_parse_music(void) {
   const char *music_string =
     "@M \"A|AB\" % foo\n"
@@ -181,4 +542,64 @@ void test_parse_music_instructions(void) {
   az_destroy_music(&music);
 }
 
+void test_synthesize_music(void) {
+  const char *music_string =
+    "@M \"|A\"\n"
+    "!Part A\n"
+    "1 Wp50 L40 E0,5  D+20,50\n"
+    "2 Wt34 L60 E0,25 V2,30\n"
+    "3 Wn   L30 E0,100\n"
+    "4 Ws   L50 E0.01,20 V1,9\n"
+    "5 Wp25 L30 D-50,20\n"
+    "1| c3e d e f g a b c4 |\n"
+    "2| c2s e g c3 e g c4 e g c5 e g c4 g e c |\n"
+    "3| c4q r c4e r |\n"
+    "4| g3h. a4q |\n"
+    "5| e4t f g r e4t f g r c3h |\n";
+  az_music_t music;
+  PARSE_MUSIC_FROM_STRING(music_string, &music);
+  // Synthesizing music should give the same samples no matter how the
+  // output is divided up between calls.
+  static int16_t expected[3 * AZ_AUDIO_RATE], actual[3 * AZ_AUDIO_RATE];
+  az_music_synth_t synth;
+  az_reset_music_synth(&synth, &music, 0);
+  az_synthesize_music(&synth, expected, AZ_ARRAY_SIZE(expected));
+  bool any_nonzero = false;
+  AZ_ARRAY_LOOP(sample, expected) if (*sample != 0) any_nonzero = true;
+  EXPECT_TRUE(any_nonzero);
+  const int chunk_sizes[] = {1, 7, 100, 4096};
+  AZ_ARRAY_LOOP(chunk_size, chunk_sizes) {
+    az_reset_music_synth(&synth, &music, 0);
+    for (int start = 0; start < AZ_ARRAY_SIZE(actual); start += *chunk_size) {
+      az_synthesize_music(&synth, actual + start,
+                          az_imin(*chunk_size,
+                                  AZ_ARRAY_SIZE(actual) - start));
+    }
+    EXPECT_TRUE(memcmp(expected, actual, sizeof(actual)) == 0);
+  }
+  // The output should also match a reference rendering made with the
+  // original one-virtual-sample-at-a-time synthesizer (given per-voice noise
+  // generators), to within one unit of rounding error per sample.
+  static const int16_t reference_samples[] = {
+    -1261, -12139, -9679, -12863, -7905, -2404, -1047, 2592, 4580, -2347,
+    1476, -3867, -4859, -654, -2486, 3589, 154, 3937, 761, 853, 481, -7304,
+    -4191, -3672, -4385, -2214, -8155, -3942, -9097, -7519, -6311, 1686, 8312,
+    2088, 3949, 7653, 3192, -6312, -10250, -10301, -6764, -3010, -6656, -4527,
+    -2979, -1330, 7910, -1850, 3573, -5105, -1694, -841, 475, -6502, 5296,
+    2856, -5812, 5456, -651, -3453, 103, 2689, 446, -7758, -6718, -4889, 2266,
+    -675, -326, -8295, -4749, -158, -3586, -2008, 2883, 3822, -2968, -454,
+    -7479, -2650, -312, -3115, 7088, 1511, -2361, 499, -3633, 2571, 7832,
+    8196, 6376, 604, -1639, -3223, -8167, -8586, -1387, -207, -2143, -494,
+    5553
+  };
+  const int reference_stride = 661;
+  for (int i = 0; i < AZ_ARRAY_SIZE(reference_samples); ++i) {
+    EXPECT_WITHIN(reference_samples[i], expected[i * reference_stride], 1);
+  }
+  double total_amplitude = 0.0;
+  AZ_ARRAY_LOOP(sample, expected) total_amplitude += abs(*sample);
+  EXPECT_WITHIN(229818360.0, total_amplitude, 100.0);
+  az_destroy_music(&music);
+}
+
 /*===========================================================================*/
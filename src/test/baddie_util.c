@@ -0,0 +1,179 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#include <math.h>
+#include <stdbool.h>
+
+#include "azimuth/state/baddie.h"
+#include "azimuth/state/nav_grid.h"
+#include "azimuth/state/space.h"
+#include "azimuth/state/wall.h"
+#include "azimuth/state/wall_grid.h"
+#include "azimuth/tick/baddie_util.h"
+#include "azimuth/util/misc.h"
+#include "azimuth/util/random.h"
+#include "azimuth/util/vector.h"
+#include "test/test.h"
+
+/*===========================================================================*/
+
+static az_space_state_t state;
+
+// Move the position far enough to make any cached line-of-sight result for
+// the moved object stale, even after a small nudge (see below): sometimes by
+// a short hop, and sometimes to a random point.
+static void move_past_tolerance(az_random_seed_t *seed,
+                                az_vector_t *position) {
+  if (az_rand_udouble(seed) < 0.5) {
+    az_vpluseq(position, az_vpolar(3.5 + 6.5 * az_rand_udouble(seed),
+                                   AZ_TWO_PI * az_rand_udouble(seed)));
+    return;
+  }
+  az_vector_t new_position = random_point(seed, 600.0, 400.0);
+  while (az_vwithin(new_position, *position, 5.0)) {
+    new_position = random_point(seed, 600.0, 400.0);
+  }
+  *position = new_position;
+}
+
+// Like az_can_see_ship, but without using the sight cache (a baddie that
+// isn't in the state's baddies array has no cache entry).
+static bool can_see_ship_uncached(const az_baddie_t *baddie) {
+  const az_baddie_t copy = *baddie;
+  return az_can_see_ship(&state, &copy);
+}
+
+void test_sight_cache(void) {
+  az_random_seed_t seed = {1, 1};
+  AZ_ZERO_OBJECT(&state);
+  state.ship.player.shields = 100.0;
+  state.ship.position = random_point(&seed, 600.0, 400.0);
+  for (int i = 0; i < 30; ++i) {
+    randomize_wall(&seed, &state.walls[i], 600.0, 400.0);
+  }
+  az_build_wall_grid(&state.wall_grid, state.walls);
+  az_build_nav_grid(&state.nav_grid, state.walls, &state.wall_grid);
+  az_baddie_t *baddie = &state.baddies[0];
+  az_init_baddie(baddie, AZ_BAD_ZIPPER, random_point(&seed, 600.0, 400.0),
+                 0.0);
+  baddie->uid = 1;
+  const az_sight_cache_entry_t *entry = &state.sight_cache[0];
+
+  int num_seen = 0, num_hidden = 0;
+  for (int step = 0; step < 3000; ++step) {
+    // Move the baddie or the ship past the cache's tolerance, or move a wall.
+    switch (step % 3) {
+      case 0: move_past_tolerance(&seed, &baddie->position); break;
+      case 1: move_past_tolerance(&seed, &state.ship.position); break;
+      case 2: {
+        az_wall_t *wall = &state.walls[az_rand_uint32(&seed) % 30];
+        wall->position = random_point(&seed, 600.0, 400.0);
+        az_reindex_wall(&state, wall);
+      } break;
+    }
+    // Every other time around, refresh the cache before checking, so that we
+    // exercise both the refresh and the check-time recomputation.
+    if ((step / 3) % 2 == 0) az_update_sight_cache(&state);
+    const bool expected = can_see_ship_uncached(baddie);
+    EXPECT_TRUE(expected == az_can_see_ship(&state, baddie));
+    if (expected) ++num_seen;
+    else ++num_hidden;
+    // Nudging the baddie and ship by less than the tolerance should answer
+    // from the cache, without recomputing anything.
+    const az_sight_cache_entry_t before = *entry;
+    az_vpluseq(&baddie->position, az_vpolar(1.0, step));
+    az_vpluseq(&state.ship.position, az_vpolar(1.0, -step));
+    az_update_sight_cache(&state);
+    az_can_see_ship(&state, baddie);
+    EXPECT_VAPPROX(before.baddie_position, entry->baddie_position);
+    EXPECT_VAPPROX(before.ship_position, entry->ship_position);
+    EXPECT_TRUE(before.wall_dist == entry->wall_dist);
+  }
+  // The test should have covered both outcomes.
+  EXPECT_TRUE(num_seen > 0);
+  EXPECT_TRUE(num_hidden > 0);
+}
+
+// Build walls in a 600x600 box (marked out by four walls at the corners),
+// with a barrier of walls across the middle that leaves a gap at one end.
+static void build_barrier(void) {
+  AZ_ZERO_OBJECT(&state);
+  for (int i = 0; i < 4; ++i) {
+    az_wall_t *wall = &state.walls[i];
+    wall->kind = AZ_WALL_INDESTRUCTIBLE;
+    wall->data = az_get_wall_data(3);
+    wall->position = az_vpolar(300.0 * sqrt(2.0), AZ_DEG2RAD(45 + 90 * i));
+  }
+  for (int i = 0; i < 6; ++i) {
+    az_wall_t *wall = &state.walls[4 + i];
+    wall->kind = AZ_WALL_DESTRUCTIBLE_BOMB;
+    wall->data = az_get_wall_data(0);
+    wall->position = (az_vector_t){-260.0 + 80.0 * i, 0.0};
+  }
+  az_build_wall_grid(&state.wall_grid, state.walls);
+  az_build_nav_grid(&state.nav_grid, state.walls, &state.wall_grid);
+}
+
+void test_navigate_towards(void) {
+  build_barrier();
+  const az_vector_t start = {0, -150}, goal = {0, 150};
+  // With nothing in the way, head straight for the goal.
+  EXPECT_VAPPROX(az_vsub(goal, (az_vector_t){-100, 150}),
+                 az_navigate_towards(&state, (az_vector_t){-100, 150}, goal));
+  // With the barrier in the way, head for the gap at its right-hand end (but
+  // still with the same length as the direct route).
+  ASSERT_FALSE(az_nav_grid_line_is_clear(&state.nav_grid, start, goal));
+  az_vector_t heading = az_navigate_towards(&state, start, goal);
+  EXPECT_APPROX(az_vdist(start, goal), az_vnorm(heading));
+  EXPECT_TRUE(heading.x > 0.0);
+  // Following the heading should get us through the gap and to the goal,
+  // without hitting any walls along the way.
+  az_vector_t position = start;
+  double max_x = position.x;
+  for (int step = 0; step < 200 && !az_vwithin(position, goal, 5.0);
+       ++step) {
+    heading = az_navigate_towards(&state, position, goal);
+    const az_vector_t next =
+      az_vadd(position, az_vwithlen(heading, fmin(5.0, az_vnorm(heading))));
+    az_impact_t impact;
+    az_ray_impact(&state, position, az_vsub(next, position),
+                  ~AZ_IMPF_WALL, AZ_NULL_UID, &impact);
+    ASSERT_INT_EQ(AZ_IMP_NOTHING, impact.type);
+    position = next;
+    max_x = fmax(max_x, position.x);
+  }
+  EXPECT_TRUE(az_vwithin(position, goal, 5.0));
+  EXPECT_TRUE(max_x > 190.0);
+  // If we move a wall from the left-hand end of the barrier to the
+  // right-hand end, the flow field should be recomputed, and we should head
+  // for the new gap on the left instead.
+  state.walls[4].position.x = 220.0;
+  az_reindex_wall(&state, &state.walls[4]);
+  heading = az_navigate_towards(&state, start, goal);
+  EXPECT_TRUE(heading.x < 0.0);
+  // And if we knock a hole in the middle of the barrier, head straight for
+  // the goal again.
+  state.walls[7].kind = state.walls[8].kind = AZ_WALL_NOTHING;
+  az_reindex_wall(&state, &state.walls[7]);
+  az_reindex_wall(&state, &state.walls[8]);
+  EXPECT_VAPPROX(az_vsub(goal, start),
+                 az_navigate_towards(&state, start, goal));
+}
+
+/*===========================================================================*/
@@ -23,6 +23,25 @@
 
 /*===========================================================================*/
 
+void test_camera_pan(void) {
+  const az_camera_t camera = { .center = {0, 1000} };
+  // Sounds at the center of the screen, or directly above/below it, shouldn't
+  // be panned at all.
+  EXPECT_APPROX(0.0, az_camera_pan(&camera, (az_vector_t){0, 1000}));
+  EXPECT_APPROX(0.0, az_camera_pan(&camera, (az_vector_t){0, 1200}));
+  // Sounds to the right of the screen center should be panned to the right,
+  // but only partway, even from far offscreen.
+  const float pan = az_camera_pan(&camera, (az_vector_t){100, 1000});
+  EXPECT_TRUE(pan > 0.0f && pan < 1.0f);
+  EXPECT_APPROX(-pan, az_camera_pan(&camera, (az_vector_t){-100, 1000}));
+  const float far_pan = az_camera_pan(&camera, (az_vector_t){5000, 1000});
+  EXPECT_TRUE(far_pan > pan && far_pan < 1.0f);
+  // Panning should follow the camera's rotation: with the camera on the
+  // positive x-axis, screen right is towards negative y.
+  const az_camera_t rotated = { .center = {1000, 0} };
+  EXPECT_APPROX(pan, az_camera_pan(&rotated, (az_vector_t){1000, -100}));
+}
+
 void test_position_visible(void) {
   const az_camera_bounds_t bounds = {
     .min_r = 10000.0, .r_span = 500.0,
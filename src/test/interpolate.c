@@ -0,0 +1,85 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#include "azimuth/state/baddie.h"
+#include "azimuth/state/interpolate.h"
+#include "azimuth/state/space.h"
+#include "azimuth/util/misc.h"
+#include "azimuth/util/vector.h"
+#include "test/test.h"
+
+/*===========================================================================*/
+
+static az_space_state_t state;
+static az_space_positions_t previous, current;
+
+void test_interpolate_positions(void) {
+  AZ_ZERO_OBJECT(&state);
+  state.ship.position = (az_vector_t){0, 0};
+  state.ship.angle = 3.0;
+  state.camera.center = (az_vector_t){100, 100};
+  az_baddie_t *baddie1 = az_add_baddie(&state, AZ_BAD_ZIPPER,
+                                       (az_vector_t){50, 50}, 0.0);
+  az_baddie_t *baddie2 = az_add_baddie(&state, AZ_BAD_ZIPPER,
+                                       (az_vector_t){-50, 50}, 0.0);
+  az_save_space_positions(&state, &previous);
+
+  // Move everything.  The second baddie gets replaced by a new baddie in the
+  // same slot, so it shouldn't be interpolated.
+  state.ship.position = (az_vector_t){10, 0};
+  state.ship.angle = -3.0;
+  state.camera.center = (az_vector_t){100, 120};
+  baddie1->position = (az_vector_t){60, 50};
+  baddie1->angle = 1.0;
+  baddie2->kind = AZ_BAD_NOTHING;
+  ASSERT_TRUE(az_add_baddie(&state, AZ_BAD_ZIPPER, (az_vector_t){-40, 50},
+                            0.0) == baddie2);
+
+  az_interpolate_space_positions(&state, &previous, 0.25, &current);
+  EXPECT_VAPPROX(((az_vector_t){2.5, 0}), state.ship.position);
+  // The ship turns the short way around, through pi.
+  EXPECT_APPROX(3.0 + 0.25 * (AZ_TWO_PI - 6.0), state.ship.angle);
+  EXPECT_VAPPROX(((az_vector_t){100, 105}), state.camera.center);
+  EXPECT_VAPPROX(((az_vector_t){52.5, 50}), baddie1->position);
+  EXPECT_APPROX(0.25, baddie1->angle);
+  EXPECT_VAPPROX(((az_vector_t){-40, 50}), baddie2->position);
+
+  // Restoring should put everything back exactly.
+  az_restore_space_positions(&state, &current);
+  EXPECT_VAPPROX(((az_vector_t){10, 0}), state.ship.position);
+  EXPECT_APPROX(-3.0, state.ship.angle);
+  EXPECT_VAPPROX(((az_vector_t){60, 50}), baddie1->position);
+  EXPECT_APPROX(1.0, baddie1->angle);
+
+  // Objects that jump a long way, or that are in a different room, aren't
+  // interpolated.
+  az_save_space_positions(&state, &previous);
+  state.ship.position = (az_vector_t){500, 0};
+  baddie1->position = (az_vector_t){70, 50};
+  az_interpolate_space_positions(&state, &previous, 0.5, &current);
+  EXPECT_VAPPROX(((az_vector_t){500, 0}), state.ship.position);
+  EXPECT_VAPPROX(((az_vector_t){65, 50}), baddie1->position);
+  az_restore_space_positions(&state, &current);
+  state.ship.player.current_room = 1;
+  az_interpolate_space_positions(&state, &previous, 0.5, &current);
+  EXPECT_VAPPROX(((az_vector_t){70, 50}), baddie1->position);
+  az_restore_space_positions(&state, &current);
+}
+
+/*===========================================================================*/
@@ -17,11 +17,17 @@
 | with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
 =============================================================================*/
 
+#include "azimuth/state/baddie.h"
+#include "azimuth/state/wall.h"
 #include "test/test.h"
 
 /*===========================================================================*/
 
 int main(int argc, char **argv) {
+  // Some tests need baddie and wall data, which can only be initialized once:
+  az_init_baddie_datas();
+  az_init_wall_datas();
+
   RUN_TEST(test_alloc);
   RUN_TEST(test_arc_circle_hits_circle);
   RUN_TEST(test_arc_circle_hits_line);
@@ -35,6 +41,8 @@ int main(int argc, char **argv) {
   RUN_TEST(test_arc_ray_hits_polygon);
   RUN_TEST(test_arc_ray_hits_polygon_trans);
   RUN_TEST(test_array_size);
+  RUN_TEST(test_audio_queue);
+  RUN_TEST(test_camera_pan);
   RUN_TEST(test_circle_hits_arc);
   RUN_TEST(test_circle_hits_circle);
   RUN_TEST(test_circle_hits_line);
@@ -49,18 +57,29 @@ int main(int argc, char **argv) {
   RUN_TEST(test_clock_mod);
   RUN_TEST(test_clock_zigzag);
   RUN_TEST(test_color3f);
+  RUN_TEST(test_compiled_planet);
+  RUN_TEST(test_compiled_polygon);
+  RUN_TEST(test_compiled_polygon_sizes);
   RUN_TEST(test_create_sound_data);
   RUN_TEST(test_cubic_bezier_angle);
   RUN_TEST(test_cubic_bezier_arc_length);
   RUN_TEST(test_cubic_bezier_arc_param);
   RUN_TEST(test_cubic_bezier_point);
+  RUN_TEST(test_find_auto_aim_target);
+  RUN_TEST(test_find_homing_target);
   RUN_TEST(test_find_knee);
   RUN_TEST(test_hint_matches);
   RUN_TEST(test_hsva_color);
+  RUN_TEST(test_interpolate_positions);
   RUN_TEST(test_is_number_key);
   RUN_TEST(test_lead_target);
+  RUN_TEST(test_mixer);
+  RUN_TEST(test_mixer_accumulate);
   RUN_TEST(test_modulo);
   RUN_TEST(test_mod2pi);
+  RUN_TEST(test_music_stream);
+  RUN_TEST(test_nav_grid);
+  RUN_TEST(test_navigate_towards);
   RUN_TEST(test_paragraph_length);
   RUN_TEST(test_paragraph_read);
   RUN_TEST(test_parse_music);
@@ -72,10 +91,12 @@ int main(int argc, char **argv) {
   RUN_TEST(test_player_set_zone_mapped);
   RUN_TEST(test_polygon_contains);
   RUN_TEST(test_polygon_contains_circle);
+  RUN_TEST(test_pool);
   RUN_TEST(test_position_visible);
   RUN_TEST(test_prefs_defaults);
   RUN_TEST(test_prefs_missing_values);
   RUN_TEST(test_prefs_save_load);
+  RUN_TEST(test_profile_history);
   RUN_TEST(test_randint);
   RUN_TEST(test_random);
   RUN_TEST(test_ray_hits_arc);
@@ -84,14 +105,20 @@ int main(int argc, char **argv) {
   RUN_TEST(test_ray_hits_line_segment);
   RUN_TEST(test_ray_hits_polygon);
   RUN_TEST(test_ray_hits_polygon_trans);
+  RUN_TEST(test_room_builder);
   RUN_TEST(test_script_clone);
+  RUN_TEST(test_script_compile);
   RUN_TEST(test_script_print);
+  RUN_TEST(test_script_profile);
   RUN_TEST(test_script_scan);
   RUN_TEST(test_select_gun);
+  RUN_TEST(test_sight_cache);
   RUN_TEST(test_signmod);
+  RUN_TEST(test_sound_cache);
   RUN_TEST(test_sound_volume);
   RUN_TEST(test_strdup);
   RUN_TEST(test_strprintf);
+  RUN_TEST(test_synthesize_music);
   RUN_TEST(test_transition_color);
   RUN_TEST(test_uids);
   RUN_TEST(test_vaddlen);
@@ -102,6 +129,7 @@ int main(int argc, char **argv) {
   RUN_TEST(test_vrotate);
   RUN_TEST(test_vunit);
   RUN_TEST(test_vwithlen);
+  RUN_TEST(test_wall_grid);
   RUN_TEST(test_zero_array);
   RUN_TEST(test_zero_object);
 
@@ -0,0 +1,179 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#include "azimuth/state/nav_grid.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "azimuth/state/room.h"
+#include "azimuth/state/wall.h"
+#include "azimuth/state/wall_grid.h"
+#include "azimuth/util/misc.h"
+#include "azimuth/util/vector.h"
+#include "test/test.h"
+
+/*===========================================================================*/
+
+static az_wall_t walls[AZ_MAX_NUM_WALLS];
+static az_wall_grid_t wall_grid;
+static az_nav_grid_t nav_grid, rebuilt_nav_grid;
+static az_flow_field_t field;
+
+static az_vector_t center_of(int col, int row) {
+  return az_vadd(nav_grid.layout.min_corner,
+                 (az_vector_t){(col + 0.5) * nav_grid.layout.cell_size,
+                               (row + 0.5) * nav_grid.layout.cell_size});
+}
+
+// Lay walls out along a spiral, which makes for plenty of concave pockets
+// for the flow field to find its way out of.  The spiral is framed by four
+// walls at the corners, so that moving the spiral's walls around doesn't
+// change the layout of the grid.
+static void build_spiral(void) {
+  AZ_ZERO_ARRAY(walls);
+  for (int i = 0; i < 4; ++i) {
+    az_wall_t *wall = &walls[AZ_MAX_NUM_WALLS - 1 - i];
+    wall->kind = AZ_WALL_INDESTRUCTIBLE;
+    wall->data = az_get_wall_data(3);
+    wall->position = az_vpolar(400.0, AZ_DEG2RAD(45 + 90 * i));
+  }
+  for (int i = 0; i < 40; ++i) {
+    az_wall_t *wall = &walls[2 * i];
+    wall->kind = AZ_WALL_DESTRUCTIBLE_BOMB;
+    wall->data = az_get_wall_data(3);
+    wall->position = az_vpolar(40.0 + 5.0 * i, 0.4 * i);
+    wall->angle = 0.4 * i + AZ_HALF_PI;
+  }
+  az_build_wall_grid(&wall_grid, walls);
+  az_build_nav_grid(&nav_grid, walls, &wall_grid);
+}
+
+// Update the grids for a wall that has changed, and check that updating the
+// navigation grid in place gives the same result as rebuilding it.
+static void update_wall(az_wall_t *wall) {
+  az_update_wall_grid(&wall_grid, walls, wall - walls);
+  az_update_nav_grid(&nav_grid, walls, &wall_grid, wall - walls);
+  az_build_nav_grid(&rebuilt_nav_grid, walls, &wall_grid);
+  ASSERT_TRUE(memcmp(&rebuilt_nav_grid.layout, &nav_grid.layout,
+                     sizeof(nav_grid.layout)) == 0);
+  ASSERT_TRUE(memcmp(rebuilt_nav_grid.blocked, nav_grid.blocked,
+                     sizeof(nav_grid.blocked)) == 0);
+}
+
+// Check that each cell is blocked exactly when some wall comes within half a
+// cell of its center.
+static void check_blocked_cells(void) {
+  const double radius = 0.5 * nav_grid.layout.cell_size;
+  for (int row = 0; row < nav_grid.layout.num_rows; ++row) {
+    for (int col = 0; col < nav_grid.layout.num_cols; ++col) {
+      bool blocked = false;
+      AZ_ARRAY_LOOP(wall, walls) {
+        if (wall->kind == AZ_WALL_NOTHING) continue;
+        if (az_circle_touches_wall(wall, radius, center_of(col, row))) {
+          blocked = true;
+          break;
+        }
+      }
+      ASSERT_TRUE(blocked == nav_grid.blocked[row][col]);
+    }
+  }
+}
+
+// Check that, from every cell that can reach the goal (or that is blocked,
+// but next to one that can), following the flow field leads to an unblocked
+// neighbor that is closer to the goal.
+static void check_flow_field(void) {
+  for (int row = 0; row < nav_grid.layout.num_rows; ++row) {
+    for (int col = 0; col < nav_grid.layout.num_cols; ++col) {
+      const uint16_t dist = field.dist[row][col];
+      az_vector_t direction = AZ_VZERO;
+      const bool found = az_flow_field_direction(
+          &nav_grid, &field, center_of(col, row), &direction);
+      if (dist == 0 ||
+          (dist == AZ_FLOW_UNREACHABLE && !nav_grid.blocked[row][col])) {
+        ASSERT_FALSE(found);
+        continue;
+      }
+      if (dist == AZ_FLOW_UNREACHABLE && !found) continue;
+      ASSERT_TRUE(found);
+      int next_col, next_row;
+      ASSERT_TRUE(az_nav_grid_cell(
+          &nav_grid, az_vadd(center_of(col, row),
+                             az_vmul(direction, nav_grid.layout.cell_size)),
+          &next_col, &next_row));
+      ASSERT_TRUE(az_imax(abs(next_col - col), abs(next_row - row)) == 1);
+      ASSERT_FALSE(nav_grid.blocked[next_row][next_col] &&
+                   field.dist[next_row][next_col] != 0);
+      ASSERT_TRUE(field.dist[next_row][next_col] < dist);
+    }
+  }
+}
+
+void test_nav_grid(void) {
+  // An empty grid has no cells, and never blocks anything.
+  AZ_ZERO_ARRAY(walls);
+  az_build_wall_grid(&wall_grid, walls);
+  az_build_nav_grid(&nav_grid, walls, &wall_grid);
+  EXPECT_INT_EQ(0, nav_grid.layout.num_cols);
+  EXPECT_TRUE(az_nav_grid_line_is_clear(&nav_grid, (az_vector_t){-100, 0},
+                                        (az_vector_t){100, 0}));
+
+  // Check the grid for a spiral against every wall.  The spiral's center is
+  // walled off from the outside along a straight line, but a flow field from
+  // the center should still find a way out.
+  build_spiral();
+  ASSERT_TRUE(nav_grid.layout.num_cols > 0);
+  check_blocked_cells();
+  RETURN_IF_FAILED();
+  const az_vector_t outside = {300, 0};
+  EXPECT_FALSE(az_nav_grid_line_is_clear(&nav_grid, AZ_VZERO, outside));
+  az_build_flow_field(&nav_grid, AZ_VZERO, &field);
+  check_flow_field();
+  RETURN_IF_FAILED();
+  int outside_col, outside_row;
+  ASSERT_TRUE(az_nav_grid_cell(&nav_grid, outside, &outside_col,
+                               &outside_row));
+  EXPECT_TRUE(field.dist[outside_row][outside_col] < AZ_FLOW_UNREACHABLE);
+
+  // Knock out every third wall of the spiral, as if destroyed, and then turn
+  // the remaining walls a little way around the spiral, checking that
+  // updating the grid one wall at a time matches rebuilding it.
+  for (int i = 0; i < 40; i += 3) {
+    walls[2 * i].kind = AZ_WALL_NOTHING;
+    update_wall(&walls[2 * i]);
+    RETURN_IF_FAILED();
+  }
+  for (int i = 0; i < 40; ++i) {
+    az_wall_t *wall = &walls[2 * i];
+    if (wall->kind == AZ_WALL_NOTHING) continue;
+    wall->position = az_vrotate(wall->position, 0.1);
+    wall->angle += 0.1;
+    update_wall(wall);
+    RETURN_IF_FAILED();
+  }
+  check_blocked_cells();
+  RETURN_IF_FAILED();
+  az_build_flow_field(&nav_grid, outside, &field);
+  check_flow_field();
+}
+
+/*===========================================================================*/
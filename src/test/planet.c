@@ -17,8 +17,18 @@
 | with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
 =============================================================================*/
 
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "azimuth/state/compiled_planet.h"
 #include "azimuth/state/planet.h"
 #include "azimuth/state/player.h"
+#include "azimuth/state/room.h"
+#include "azimuth/state/wall.h"
+#include "azimuth/util/misc.h"
+#include "azimuth/util/rw.h"
+#include "azimuth/util/string.h"
 #include "test/test.h"
 
 /*===========================================================================*/
@@ -101,3 +111,143 @@ void test_hint_matches(void) {
 }
 
 /*===========================================================================*/
+
+static const char test_room_text[] =
+  "@R z1 p4 k1 b1 d1 g2 n2 w1\n"
+  "  c(100.5,50.0,1.25,0.5)\n"
+  "$s:mus2,wait1.5;\n"
+  "!W1 d12 x10.5 y-20.25 a0.5 u3\n"
+  "!D7 x1 y2 a3 r107 u4\n"
+  "$o:set5;\n"
+  "!G4 x1 y2 a0.5 o0.00 f340.00 r340.00 l320.00 u0\n"
+  "!G2 x7 y8 a0.5 s25.00 w100.00 i250.00 t100.00 u0\n"
+  "$e:snd4;\n"
+  "!N9/107 x3 y4 a-0.2 u0\n"
+  "!N1/2 x5 y6 a0 u7\n"
+  "!B21 x1 y2 a1.5 u5:6:7\n"
+  "$k:set9,halt;\n";
+
+void test_compiled_planet(void) {
+  az_planet_t planet = {.start_room = 1};
+  planet.on_start = az_sscan_script("mus17,wait1;", 12);
+  ASSERT_TRUE(planet.on_start != NULL);
+  planet.num_zones = 2;
+  planet.zones = AZ_ALLOC(planet.num_zones, az_zone_t);
+  for (int i = 0; i < planet.num_zones; ++i) {
+    planet.zones[i].name = az_strprintf("Zone %d", i);
+    planet.zones[i].entering_message =
+      az_strprintf("Entering: $X%02x%02x%02x%s", 10 * i, 20, 30,
+                   planet.zones[i].name);
+    planet.zones[i].color = (az_color_t){10 * i, 20, 30, 255};
+  }
+  planet.num_hints = 1;
+  planet.hints = AZ_ALLOC(planet.num_hints, az_hint_t);
+  planet.hints[0] = (az_hint_t){
+    .properties = (AZ_HINTF_OP2_IS_AND | AZ_HINTF_PREREQ2_IS_FLAG),
+    .prereq2 = 4, .result = AZ_UPG_GUN_TRIPLE, .target_room = 1
+  };
+  planet.num_paragraphs = 1;
+  planet.paragraphs = AZ_ALLOC(planet.num_paragraphs, char*);
+  planet.paragraphs[0] = az_strdup("Hello, $Cworld$W!");
+  // Use more rooms than fit in the room cache, so that we exercise eviction.
+  planet.num_rooms = 30;
+  planet.rooms = AZ_ALLOC(planet.num_rooms, az_room_t);
+  for (int i = 0; i < planet.num_rooms; ++i) {
+    az_reader_t reader;
+    az_cstring_reader(test_room_text, &reader);
+    const bool success = az_read_room(&reader, &planet.rooms[i]);
+    az_rclose(&reader);
+    ASSERT_TRUE(success);
+  }
+
+  // Compiling, loading, and recompiling should give the same image back.
+  char *image;
+  size_t size;
+  az_compile_planet(&planet, &image, &size);
+  az_destroy_planet(&planet);
+  ASSERT_TRUE(az_load_compiled_planet(image, size, &planet));
+  char *image2;
+  size_t size2;
+  az_compile_planet(&planet, &image2, &size2);
+  EXPECT_INT_EQ(size, size2);
+  EXPECT_TRUE(size == size2 && memcmp(image, image2, size) == 0);
+  free(image2);
+
+  // Spot-check the loaded planet.
+  EXPECT_INT_EQ(1, planet.start_room);
+  EXPECT_INT_EQ(2, planet.on_start->num_instructions);
+  EXPECT_STRING_EQ("Zone 1", planet.zones[1].name);
+  EXPECT_STRING_EQ("Entering: $X0a141eZone 1",
+                   planet.zones[1].entering_message);
+  EXPECT_INT_EQ(4, planet.hints[0].prereq2);
+  EXPECT_STRING_EQ("Hello, $Cworld$W!", planet.paragraphs[0]);
+  const az_room_t *room = &planet.rooms[1];
+  EXPECT_INT_EQ(1, room->zone_key);
+  EXPECT_APPROX(100.5, room->camera_bounds.min_r);
+  EXPECT_INT_EQ(2, room->on_start->num_instructions);
+  EXPECT_INT_EQ(6, room->baddies[0].cargo_slots[0]);
+  EXPECT_INT_EQ(2, room->baddies[0].on_kill->num_instructions);
+  EXPECT_INT_EQ(107, room->doors[0].destination);
+  EXPECT_APPROX(320.0, room->gravfields[0].size.trapezoid.semilength);
+  EXPECT_APPROX(250.0, room->gravfields[1].size.sector.inner_radius);
+  EXPECT_TRUE(room->gravfields[1].on_enter != NULL);
+  EXPECT_INT_EQ(AZ_CONS_SAVE, room->nodes[1].subkind.console);
+  EXPECT_INT_EQ(12, az_wall_data_index(room->walls[0].data));
+  EXPECT_APPROX(-20.25, room->walls[0].position.y);
+  az_destroy_planet(&planet);
+
+  // Opening the image lazily should give just the room headers up front, and
+  // the rest of each room on demand.
+  az_reader_t reader;
+  az_membuf_reader(image, size, &reader);
+  az_rmapping_t mapping;
+  ASSERT_TRUE(az_rmap(&reader, &mapping));
+  az_rclose(&reader);
+  ASSERT_TRUE(az_open_compiled_planet(&mapping, &planet));
+  ASSERT_TRUE(planet.room_cache != NULL);
+  EXPECT_INT_EQ(30, planet.num_rooms);
+  EXPECT_INT_EQ(1, planet.rooms[1].zone_key);
+  EXPECT_APPROX(100.5, planet.rooms[1].camera_bounds.min_r);
+  EXPECT_INT_EQ(0, planet.rooms[1].num_walls);
+  for (int pass = 0; pass < 2; ++pass) {
+    for (int i = 0; i < planet.num_rooms; ++i) {
+      az_prefetch_neighbor_rooms(&planet, i);
+      room = az_get_room(&planet, i);
+      EXPECT_INT_EQ(1, room->zone_key);
+      EXPECT_INT_EQ(2, room->on_start->num_instructions);
+      EXPECT_INT_EQ(107, room->doors[0].destination);
+      EXPECT_INT_EQ(12, az_wall_data_index(room->walls[0].data));
+    }
+  }
+  // A room's generation stays the same while it stays in the cache, and
+  // changes once it has been evicted and reloaded, even if it is reloaded at
+  // the same address.
+  room = az_get_room(&planet, 0);
+  const uint64_t generation = az_room_generation(&planet, 0);
+  EXPECT_TRUE(generation != 0);
+  EXPECT_TRUE(room == az_peek_room(&planet, 0));
+  EXPECT_TRUE(generation == az_room_generation(&planet, 0));
+  for (int i = 1; i < planet.num_rooms; ++i) az_get_room(&planet, i);
+  EXPECT_TRUE(0 == az_room_generation(&planet, 0));
+  az_get_room(&planet, 0);
+  EXPECT_TRUE(az_room_generation(&planet, 0) != 0);
+  EXPECT_TRUE(az_room_generation(&planet, 0) != generation);
+  az_destroy_planet(&planet);
+
+  // A truncated or corrupted image should fail to load (without leaking).
+  EXPECT_FALSE(az_load_compiled_planet(image, size - 1, &planet));
+  for (size_t cut = 0; cut < size; cut += size / 8 + 1) {
+    // Fix up the image size field, so that the truncation is only noticed
+    // once the loader tries to read past the end.
+    char *truncated = AZ_ALLOC(size, char);
+    memcpy(truncated, image, size);
+    for (int i = 0; i < 4; ++i) truncated[12 + i] = (char)(cut >> (8 * i));
+    EXPECT_FALSE(az_load_compiled_planet(truncated, cut, &planet));
+    free(truncated);
+  }
+  image[8] ^= 0x7f; // version number
+  EXPECT_FALSE(az_load_compiled_planet(image, size, &planet));
+  free(image);
+}
+
+/*===========================================================================*/
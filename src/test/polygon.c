@@ -20,7 +20,9 @@
 #include <math.h>
 #include <stddef.h> // for NULL
 
+#include "azimuth/state/wall.h"
 #include "azimuth/util/polygon.h"
+#include "azimuth/util/random.h"
 #include "azimuth/util/vector.h"
 #include "test/test.h"
 
@@ -1137,6 +1139,126 @@ void test_arc_circle_hits_polygon_trans(void) {
 
 /*===========================================================================*/
 
+// Check that compiling the polygon doesn't change the result of any collision
+// test, for a number of random queries near the polygon.
+static void check_compiled_polygon(az_random_seed_t *seed,
+                                   az_polygon_t polygon) {
+  az_polygon_t compiled = polygon;
+  compiled.compiled = NULL;
+  az_compile_polygon(&compiled);
+  ASSERT_TRUE(compiled.compiled != NULL);
+  polygon.compiled = NULL;
+  double extent = 0.0;
+  for (int i = 0; i < polygon.num_vertices; ++i) {
+    extent = fmax(extent, az_vnorm(polygon.vertices[i]));
+  }
+  extent *= 1.5;
+  for (int trial = 0; trial < 200; ++trial) {
+    const az_vector_t start = random_point(seed, extent, extent);
+    const az_vector_t delta = random_point(seed, extent, extent);
+    const az_vector_t spin_center = random_point(seed, extent, extent);
+    const double spin_angle = AZ_TWO_PI * az_rand_sdouble(seed);
+    const double radius = 0.3 * extent * az_rand_udouble(seed);
+    az_vector_t point1 = nix, normal1 = nix, point2 = nix, normal2 = nix;
+    double angle1 = 99999, angle2 = 99999;
+
+    EXPECT_TRUE(az_circle_touches_polygon(polygon, radius, start) ==
+                az_circle_touches_polygon(compiled, radius, start));
+
+    EXPECT_TRUE(az_ray_hits_polygon(polygon, start, delta, &point1,
+                                    &normal1) ==
+                az_ray_hits_polygon(compiled, start, delta, &point2,
+                                    &normal2));
+    EXPECT_VEQ(point1, point2);
+    EXPECT_VEQ(normal1, normal2);
+
+    point1 = normal1 = point2 = normal2 = nix;
+    EXPECT_TRUE(az_circle_hits_polygon(polygon, radius, start, delta,
+                                       &point1, &normal1) ==
+                az_circle_hits_polygon(compiled, radius, start, delta,
+                                       &point2, &normal2));
+    EXPECT_VEQ(point1, point2);
+    EXPECT_VEQ(normal1, normal2);
+
+    point1 = normal1 = point2 = normal2 = nix;
+    EXPECT_TRUE(az_arc_ray_hits_polygon(polygon, start, spin_center,
+                                        spin_angle, &angle1, &point1,
+                                        &normal1) ==
+                az_arc_ray_hits_polygon(compiled, start, spin_center,
+                                        spin_angle, &angle2, &point2,
+                                        &normal2));
+    EXPECT_TRUE(angle1 == angle2);
+    EXPECT_VEQ(point1, point2);
+    EXPECT_VEQ(normal1, normal2);
+
+    point1 = normal1 = point2 = normal2 = nix;
+    angle1 = angle2 = 99999;
+    EXPECT_TRUE(az_arc_circle_hits_polygon(polygon, radius, start,
+                                           spin_center, spin_angle, &angle1,
+                                           &point1, &normal1) ==
+                az_arc_circle_hits_polygon(compiled, radius, start,
+                                           spin_center, spin_angle, &angle2,
+                                           &point2, &normal2));
+    EXPECT_TRUE(angle1 == angle2);
+    EXPECT_VEQ(point1, point2);
+    EXPECT_VEQ(normal1, normal2);
+  }
+  az_uncompile_polygon(&compiled);
+  EXPECT_TRUE(compiled.compiled == NULL);
+}
+
+void test_compiled_polygon(void) {
+  az_random_seed_t seed = {4, 9};
+  az_polygon_t polygon = null_polygon;
+  az_compile_polygon(&polygon);
+  EXPECT_TRUE(polygon.compiled == NULL);
+
+  check_compiled_polygon(&seed, triangle);
+  check_compiled_polygon(&seed, square);
+  check_compiled_polygon(&seed, concave_hexagon);
+  for (int i = 0; i < AZ_NUM_WALL_DATAS; ++i) {
+    const az_polygon_t wall_polygon = az_get_wall_data(i)->polygon;
+    EXPECT_TRUE(wall_polygon.compiled != NULL);
+    check_compiled_polygon(&seed, wall_polygon);
+  }
+}
+
+// Check every polygon size that can be compiled, so that each edge gets
+// checked in every position within a group of four (the SSE2 filter in
+// polygon.c handles four edges at a time, then finishes off any remainder).
+void test_compiled_polygon_sizes(void) {
+  az_random_seed_t seed = {6, 1};
+  az_vector_t vertices[AZ_MAX_COMPILED_POLYGON_VERTICES];
+  for (int n = 3; n <= AZ_MAX_COMPILED_POLYGON_VERTICES; ++n) {
+    // Make a star-shaped polygon, so that the edges aren't all alike.
+    for (int i = 0; i < n; ++i) {
+      vertices[i] = az_vpolar((i % 2 == 0 ? 10.0 : 7.0), i * AZ_TWO_PI / n);
+    }
+    const az_polygon_t polygon = { .num_vertices = n, .vertices = vertices };
+    check_compiled_polygon(&seed, polygon);
+    // A short ray aimed into the middle of each edge from just outside it
+    // must hit that edge, which it can't if that edge's filter bit is wrong.
+    az_polygon_t compiled = polygon;
+    az_compile_polygon(&compiled);
+    ASSERT_TRUE(compiled.compiled != NULL);
+    for (int i = 0; i < n; ++i) {
+      const az_vector_t p1 = vertices[i], p2 = vertices[(i + 1) % n];
+      const az_vector_t mid = az_vmul(az_vadd(p1, p2), 0.5);
+      const az_vector_t inward = az_vrot90ccw(az_vwithlen(az_vsub(p2, p1),
+                                                          0.01));
+      const az_vector_t start = az_vsub(mid, inward);
+      const az_vector_t delta = az_vmul(inward, 2.0);
+      az_vector_t point = nix;
+      EXPECT_TRUE(az_ray_hits_polygon(compiled, start, delta, &point, NULL));
+      EXPECT_VAPPROX(mid, point);
+      EXPECT_TRUE(az_circle_touches_polygon(compiled, 0.02, mid));
+    }
+    az_uncompile_polygon(&compiled);
+  }
+}
+
+/*===========================================================================*/
+
 void test_find_knee(void) {
   // Leg forms equilateral triangle:
   EXPECT_VAPPROX(((az_vector_t){2, 2 + sqrt(3)}), az_find_knee(
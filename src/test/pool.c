@@ -0,0 +1,94 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#include <stdbool.h>
+
+#include "azimuth/state/pool.h"
+#include "azimuth/util/misc.h"
+#include "test/test.h"
+
+/*===========================================================================*/
+
+static int objects[8];
+static az_pool_t pool;
+
+static bool is_vacant(const void *array, int slot) {
+  return ((const int *)array)[slot] == 0;
+}
+
+static int insert(int value) {
+  const int slot =
+    az_pool_insert(&pool, AZ_ARRAY_SIZE(objects), is_vacant, objects);
+  if (slot >= 0) objects[slot] = value;
+  return slot;
+}
+
+// Return the sum of the objects visited by an AZ_POOL_LOOP, stopping early
+// (via break) upon reaching the given value.
+static int loop_sum(int stop_at) {
+  int sum = 0;
+  AZ_POOL_LOOP(object, objects, &pool) {
+    if (*object == 0) continue;
+    if (*object == stop_at) break;
+    sum += *object;
+  }
+  return sum;
+}
+
+void test_pool(void) {
+  AZ_ZERO_ARRAY(objects);
+  AZ_ZERO_OBJECT(&pool);
+  // Slots are handed out in order while the array fills up.
+  for (int i = 0; i < AZ_ARRAY_SIZE(objects); ++i) {
+    EXPECT_INT_EQ(i, insert(i + 1));
+  }
+  EXPECT_INT_EQ(-1, insert(100));
+  EXPECT_INT_EQ(36, loop_sum(-1));
+  EXPECT_INT_EQ(6, loop_sum(4));
+  // Before collecting, emptied slots can still be reused in place.
+  objects[5] = 0;
+  EXPECT_INT_EQ(5, insert(10));
+  EXPECT_INT_EQ(40, loop_sum(-1));
+  // Collecting removes emptied slots from the live list, keeping the others
+  // in order, and the emptied slots get reused.
+  objects[2] = objects[6] = 0;
+  az_pool_collect(&pool, is_vacant, objects);
+  EXPECT_INT_EQ(6, pool.num_live);
+  EXPECT_INT_EQ(5, pool.live[4]);
+  EXPECT_INT_EQ(7, pool.live[5]);
+  EXPECT_INT_EQ(1 + 2 + 4 + 5, loop_sum(10));
+  const int slot = insert(20);
+  EXPECT_TRUE(slot == 2 || slot == 6);
+  EXPECT_INT_EQ(slot, pool.live[6]);
+  EXPECT_INT_EQ(8 - slot, insert(30));
+  EXPECT_INT_EQ(-1, insert(100));
+  EXPECT_INT_EQ(1 + 2 + 4 + 5 + 10 + 8 + 20 + 30, loop_sum(-1));
+  // Objects inserted during a loop are visited by that loop.
+  objects[0] = 0;
+  az_pool_collect(&pool, is_vacant, objects);
+  int visited = 0;
+  AZ_POOL_LOOP(object, objects, &pool) {
+    if (*object == 0) continue;
+    ++visited;
+    if (*object == 30) insert(40);
+  }
+  EXPECT_INT_EQ(8, visited);
+}
+
+/*===========================================================================*/
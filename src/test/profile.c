@@ -0,0 +1,147 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#include <string.h>
+
+#include "azimuth/state/planet.h"
+#include "azimuth/state/player.h"
+#include "azimuth/state/room.h"
+#include "azimuth/state/script.h"
+#include "azimuth/state/space.h"
+#include "azimuth/tick/script.h"
+#include "azimuth/util/misc.h"
+#include "azimuth/util/profile.h"
+#include "test/test.h"
+
+/*===========================================================================*/
+
+#if AZ_PROFILING
+static const az_profile_counter_t *find_counter(const char *name) {
+  const az_profile_counter_t *found = NULL;
+  for (const az_profile_counter_t *counter = az_first_profile_counter();
+       counter != NULL; counter = counter->next) {
+    if (strcmp(counter->name, name) == 0) {
+      // Counters with the same name should be merged into a single entry.
+      EXPECT_TRUE(found == NULL);
+      found = counter;
+    }
+  }
+  return found;
+}
+
+static void busy_wait_ns(uint64_t duration_ns) {
+  const uint64_t start_ns = az_profile_now_ns();
+  while (az_profile_now_ns() - start_ns < duration_ns) {}
+}
+#endif
+
+void test_profile_history(void) {
+#if AZ_PROFILING
+  AZ_PROFILE_END_FRAME();
+  // Two call sites sharing a name should add up to a single counter.
+  AZ_PROFILE("test_profile_a", busy_wait_ns(100000));
+  AZ_PROFILE("test_profile_a", busy_wait_ns(100000));
+  AZ_PROFILE("test_profile_b", busy_wait_ns(50000));
+  AZ_PROFILE_END_FRAME();
+  const az_profile_counter_t *counter_a = find_counter("test_profile_a");
+  const az_profile_counter_t *counter_b = find_counter("test_profile_b");
+  ASSERT_TRUE(counter_a != NULL);
+  ASSERT_TRUE(counter_b != NULL);
+  EXPECT_INT_EQ(2, counter_a->num_calls);
+  EXPECT_INT_EQ(1, counter_b->num_calls);
+  EXPECT_TRUE(az_profile_history_size() >= 1);
+  EXPECT_TRUE(az_profile_history_ns(counter_a, 0) >= 200000);
+  EXPECT_TRUE(az_profile_history_ns(counter_b, 0) >= 50000);
+  EXPECT_TRUE(az_profile_history_ns(NULL, 0) >=
+              az_profile_history_ns(counter_a, 0) +
+              az_profile_history_ns(counter_b, 0));
+  // A frame in which a section doesn't run should record zero for it, and
+  // once the ring buffer fills up, the history should stop growing.
+  for (int i = 0; i < AZ_PROFILE_HISTORY - 1; ++i) {
+    AZ_PROFILE("test_profile_b", busy_wait_ns(1000));
+    AZ_PROFILE_END_FRAME();
+  }
+  EXPECT_INT_EQ(AZ_PROFILE_HISTORY, az_profile_history_size());
+  EXPECT_INT_EQ(0, az_profile_history_ns(counter_a, 0));
+  EXPECT_TRUE(az_profile_history_ns(counter_b, 0) >= 1000);
+  EXPECT_TRUE(az_profile_history_ns(counter_a, AZ_PROFILE_HISTORY - 1) >=
+              200000);
+  EXPECT_INT_EQ(AZ_PROFILE_HISTORY, counter_b->num_calls);
+#endif
+}
+
+/*===========================================================================*/
+
+#if AZ_PROFILING
+static az_space_state_t state;
+#endif
+
+void test_script_profile(void) {
+#if AZ_PROFILING
+  // The test-and-branch and the push-and-branch are each fused into a single
+  // superinstruction, but should still be counted as their two opcodes.
+  const char *string =
+    "push1,push2,add,pop,test5,beqz/A,nop,A#push0,beqz/B,nop,B#halt;";
+  az_script_t *script = az_sscan_script(string, strlen(string));
+  ASSERT_TRUE(script != NULL);
+  ASSERT_INT_EQ(AZ_SOP_TEST_BEQZ, script->compiled[4].handler);
+  ASSERT_INT_EQ(AZ_SOP_GOTO, script->compiled[7].handler);
+  az_room_t rooms[3] = {{ .on_start = NULL }};
+  rooms[2].on_start = script;
+  az_planet_t planet = { .num_rooms = AZ_ARRAY_SIZE(rooms), .rooms = rooms };
+  AZ_ZERO_OBJECT(&state);
+  state.planet = &planet;
+  state.ship.player.current_room = 2;
+  az_reset_script_profile();
+  // With flag 5 clear, the first branch skips the first nop (9 instructions);
+  // with it set, the first nop runs (10 instructions).
+  az_run_script(&state, script);
+  az_set_flag(&state.ship.player, 5);
+  az_run_script(&state, script);
+  const az_script_profile_t *profile =
+    az_get_script_profile(2, AZ_SCRIPT_ON_START);
+  EXPECT_INT_EQ(2, profile->num_runs);
+  EXPECT_INT_EQ(19, profile->num_instructions);
+  EXPECT_INT_EQ(6, az_get_script_opcode_count(AZ_OP_PUSH));
+  EXPECT_INT_EQ(2, az_get_script_opcode_count(AZ_OP_ADD));
+  EXPECT_INT_EQ(2, az_get_script_opcode_count(AZ_OP_POP));
+  EXPECT_INT_EQ(2, az_get_script_opcode_count(AZ_OP_TEST));
+  EXPECT_INT_EQ(4, az_get_script_opcode_count(AZ_OP_BEQZ));
+  EXPECT_INT_EQ(1, az_get_script_opcode_count(AZ_OP_NOP));
+  EXPECT_INT_EQ(2, az_get_script_opcode_count(AZ_OP_HALT));
+  EXPECT_INT_EQ(0, az_get_script_opcode_count(AZ_OP_BNEZ));
+  // Runs should be charged to the room the ship is in, and to "other" if the
+  // script isn't one of that room's scripts.
+  state.ship.player.current_room = 1;
+  az_run_script(&state, script);
+  EXPECT_INT_EQ(2, az_get_script_profile(2, AZ_SCRIPT_ON_START)->num_runs);
+  EXPECT_INT_EQ(0, az_get_script_profile(1, AZ_SCRIPT_ON_START)->num_runs);
+  EXPECT_INT_EQ(1, az_get_script_profile(1, AZ_SCRIPT_OTHER)->num_runs);
+  EXPECT_INT_EQ(10, az_get_script_profile(1, AZ_SCRIPT_OTHER)->
+                num_instructions);
+  EXPECT_INT_EQ(9, az_get_script_opcode_count(AZ_OP_PUSH));
+  // Resetting should zero everything.
+  az_reset_script_profile();
+  EXPECT_INT_EQ(0, az_get_script_profile(1, AZ_SCRIPT_OTHER)->num_runs);
+  EXPECT_INT_EQ(0, az_get_script_opcode_count(AZ_OP_PUSH));
+  az_free_script(script);
+#endif
+}
+
+/*===========================================================================*/
@@ -0,0 +1,141 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "azimuth/state/node.h"
+#include "azimuth/state/planet.h"
+#include "azimuth/state/player.h"
+#include "azimuth/state/room.h"
+#include "azimuth/state/room_builder.h"
+#include "azimuth/state/space.h"
+#include "azimuth/state/upgrade.h"
+#include "azimuth/util/misc.h"
+#include "azimuth/util/rw.h"
+#include "test/test.h"
+
+/*===========================================================================*/
+
+static const char test_room_text[] =
+  "@R z0 p0 k0 b1 d1 g2 n2 w1\n"
+  "  c(100.5,50.0,1.25,0.5)\n"
+  "!W1 d12 x10.5 y-20.25 a0.5 u3\n"
+  "!D7 x1 y2 a3 r1 u4\n"
+  "$o:set5;\n"
+  "!G4 x1 y2 a0.5 o0.00 f340.00 r340.00 l320.00 u0\n"
+  "!G2 x7 y8 a0.5 s25.00 w100.00 i250.00 t100.00 u0\n"
+  "$e:snd4;\n"
+  "!N9/107 x3 y4 a-0.2 u0\n"
+  "!N3/0 x5 y6 a0 u7\n"
+  "!B21 x1 y2 a1.5 u5:3:7\n"
+  "$k:set9,halt;\n";
+
+static az_space_state_t expected_state, actual_state;
+
+// Check that actual_state has exactly the same room objects as
+// expected_state.
+static void expect_same_room_objects(void) {
+#define EXPECT_SAME(field) \
+  EXPECT_TRUE(memcmp(&expected_state.field, &actual_state.field, \
+                     sizeof(expected_state.field)) == 0)
+  EXPECT_SAME(baddies);
+  EXPECT_SAME(doors);
+  EXPECT_SAME(gravfields);
+  EXPECT_SAME(nodes);
+  EXPECT_SAME(walls);
+  EXPECT_SAME(wall_grid);
+  EXPECT_SAME(nav_grid);
+  EXPECT_SAME(uuids);
+#undef EXPECT_SAME
+}
+
+static int count_nodes(const az_space_state_t *state) {
+  int count = 0;
+  AZ_ARRAY_LOOP(node, state->nodes) {
+    if (node->kind != AZ_NODE_NOTHING) ++count;
+  }
+  return count;
+}
+
+void test_room_builder(void) {
+  az_planet_t planet = {.num_rooms = 2};
+  planet.rooms = AZ_ALLOC(planet.num_rooms, az_room_t);
+  for (int i = 0; i < planet.num_rooms; ++i) {
+    az_reader_t reader;
+    az_cstring_reader(test_room_text, &reader);
+    const bool success = az_read_room(&reader, &planet.rooms[i]);
+    az_rclose(&reader);
+    ASSERT_TRUE(success);
+  }
+  AZ_ZERO_OBJECT(&expected_state);
+  expected_state.planet = &planet;
+  az_init_player(&expected_state.ship.player);
+  az_enter_room(&expected_state, &planet.rooms[0]);
+  EXPECT_INT_EQ(2, count_nodes(&expected_state));
+  // The baddie's cargo should include the wall and the upgrade node.
+  EXPECT_INT_EQ(AZ_UUID_WALL, expected_state.baddies[0].cargo_uuids[0].type);
+  EXPECT_INT_EQ(AZ_UUID_NODE, expected_state.baddies[0].cargo_uuids[1].type);
+
+  // Building room objects and installing them should be the same as entering
+  // the room directly.
+  AZ_ZERO_OBJECT(&actual_state);
+  actual_state.planet = &planet;
+  az_init_player(&actual_state.ship.player);
+  az_room_objects_t *objects = AZ_ALLOC(1, az_room_objects_t);
+  az_build_room_objects(&planet, &actual_state.ship.player, &planet.rooms[0],
+                        objects);
+  az_install_room_objects(&actual_state, objects);
+  free(objects);
+  expect_same_room_objects();
+
+  // Likewise for building them in the background.
+  az_room_builder_t *builder = az_create_room_builder();
+  az_clear_space(&actual_state);
+  az_request_room_build(builder, &planet, &actual_state.ship.player, 0);
+  EXPECT_TRUE(az_take_room_build(builder, &actual_state, 0));
+  expect_same_room_objects();
+  // There's nothing left to take after that.
+  az_clear_space(&actual_state);
+  EXPECT_FALSE(az_take_room_build(builder, &actual_state, 0));
+  EXPECT_INT_EQ(0, count_nodes(&actual_state));
+
+  // Requesting a different room replaces the previous request, and taking a
+  // room that wasn't requested fails.
+  az_request_room_build(builder, &planet, &actual_state.ship.player, 0);
+  az_request_room_build(builder, &planet, &actual_state.ship.player, 1);
+  EXPECT_FALSE(az_take_room_build(builder, &actual_state, 0));
+  az_request_room_build(builder, &planet, &actual_state.ship.player, 1);
+  az_cancel_room_build(builder);
+  EXPECT_FALSE(az_take_room_build(builder, &actual_state, 1));
+
+  // If the player gets an upgrade after the build was requested, the build
+  // is no longer valid (since the upgrade node shouldn't appear anymore).
+  az_request_room_build(builder, &planet, &actual_state.ship.player, 1);
+  az_give_upgrade(&actual_state.ship.player, AZ_UPG_GUN_CHARGE);
+  EXPECT_FALSE(az_take_room_build(builder, &actual_state, 1));
+  az_enter_room(&actual_state, &planet.rooms[1]);
+  EXPECT_INT_EQ(1, count_nodes(&actual_state));
+
+  az_destroy_room_builder(builder);
+  az_destroy_planet(&planet);
+}
+
+/*===========================================================================*/
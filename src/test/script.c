@@ -27,6 +27,49 @@
 
 static const char *script_string = "push-23.5,beqz/@,nop,bnez/A,halt,A#push0;";
 
+void test_script_compile(void) {
+  const char *string =
+    "test5,beqz/A,nix1,nix2,nix3,A#push0,bnez/@,push1,heqz;";
+  az_script_t *script = az_sscan_script(string, strlen(string));
+  ASSERT_TRUE(script != NULL);
+  ASSERT_INT_EQ(9, script->num_instructions);
+  ASSERT_TRUE(script->compiled != NULL);
+  const az_compiled_instruction_t *compiled = script->compiled;
+  // Test-and-branch is fused, but the branch is still there on its own.
+  EXPECT_INT_EQ(AZ_SOP_TEST_BEQZ, compiled[0].handler);
+  EXPECT_INT_EQ(2, compiled[0].length);
+  EXPECT_INT_EQ(5, compiled[0].target);
+  EXPECT_INT_EQ(AZ_OP_BEQZ, compiled[1].handler);
+  EXPECT_INT_EQ(5, compiled[1].target);
+  // A run of nix instructions is fused from each starting point.
+  EXPECT_INT_EQ(AZ_SOP_NIX_RUN, compiled[2].handler);
+  EXPECT_INT_EQ(3, compiled[2].length);
+  EXPECT_INT_EQ(AZ_SOP_NIX_RUN, compiled[3].handler);
+  EXPECT_INT_EQ(2, compiled[3].length);
+  EXPECT_INT_EQ(AZ_OP_NIX, compiled[4].handler);
+  EXPECT_INT_EQ(3, compiled[4].index);
+  // Pushing a constant and branching on it is decided ahead of time.
+  EXPECT_INT_EQ(AZ_SOP_GOTO, compiled[5].handler);
+  EXPECT_INT_EQ(7, compiled[5].target);
+  EXPECT_INT_EQ(9, compiled[6].target);
+  EXPECT_INT_EQ(AZ_OP_PUSH, compiled[7].handler);
+  EXPECT_INT_EQ(AZ_SOP_END, compiled[9].handler);
+  EXPECT_TRUE(script->stack_safe);
+  az_free_script(script);
+
+  // Scripts that can underflow the stack, or reach an instruction with
+  // different stack depths, aren't stack-safe.
+  const char *unsafe_strings[] = {
+    "push1,pop2;", "push1,A#push2,jump/A;", "push1,bnez/A,push2,A#nop;"
+  };
+  AZ_ARRAY_LOOP(unsafe_string, unsafe_strings) {
+    script = az_sscan_script(*unsafe_string, strlen(*unsafe_string));
+    ASSERT_TRUE(script != NULL);
+    EXPECT_FALSE(script->stack_safe);
+    az_free_script(script);
+  }
+}
+
 void test_script_print(void) {
   az_instruction_t instructions[] = {
     { .opcode = AZ_OP_PUSH, .immediate = -23.5 },
@@ -0,0 +1,260 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#include <math.h>
+#include <stdbool.h>
+
+#include "azimuth/state/baddie.h"
+#include "azimuth/state/space.h"
+#include "azimuth/state/uid.h"
+#include "azimuth/util/misc.h"
+#include "azimuth/util/random.h"
+#include "azimuth/util/vector.h"
+#include "test/test.h"
+
+/*===========================================================================*/
+
+static az_space_state_t state;
+
+// Fill the space state with a random layout of baddies around the origin.
+// Some baddies sit exactly at the origin, and some are placed on (or within
+// rounding error of) the auto-aim limit.  After the homing target list is
+// built, some baddies are killed and some gain a NO_HOMING flag, as can
+// happen partway through a tick.
+static void random_layout(az_random_seed_t *seed, double forward,
+                          double limit) {
+  az_clear_space(&state);
+  const int num_baddies = az_rand_uint32(seed) % 40;
+  for (int i = 0; i < num_baddies; ++i) {
+    const az_baddie_kind_t kind =
+      1 + az_rand_uint32(seed) % (AZ_NUM_BADDIE_KINDS - 1);
+    az_vector_t position;
+    const uint32_t placement = az_rand_uint32(seed) % 8;
+    if (placement == 0) position = AZ_VZERO;
+    else if (placement == 1) {
+      position = az_vpolar(500.0 * az_rand_udouble(seed),
+                           forward + (i % 2 == 0 ? limit : -limit));
+    } else position = random_point(seed, 500.0, 500.0);
+    ASSERT_TRUE(az_add_baddie(&state, kind, position, 0.0) != NULL);
+  }
+  az_build_homing_targets(&state);
+  AZ_ARRAY_LOOP(baddie, state.baddies) {
+    if (baddie->kind == AZ_BAD_NOTHING) continue;
+    const uint32_t change = az_rand_uint32(seed) % 10;
+    if (change == 0) baddie->kind = AZ_BAD_NOTHING;
+    else if (change == 1) {
+      baddie->temp_properties |= AZ_BADF_NO_HOMING_PROJ;
+    } else if (change == 2) {
+      baddie->temp_properties |= AZ_BADF_NO_HOMING_BEAM;
+    }
+  }
+}
+
+// Clear the space state, and add a baddie that all homing weapons can target.
+static az_baddie_t *add_target(az_vector_t position) {
+  az_baddie_t *baddie = az_add_baddie(&state, AZ_BAD_ZIPPER, position, 0.0);
+  if (baddie != NULL) {
+    EXPECT_FALSE(az_baddie_has_flag(baddie, AZ_BADF_NO_HOMING_PROJ));
+  }
+  return baddie;
+}
+
+static az_uid_t random_baddie_uid(az_random_seed_t *seed) {
+  const az_baddie_t *baddie =
+    &state.baddies[az_rand_uint32(seed) % AZ_ARRAY_SIZE(state.baddies)];
+  return baddie->uid;
+}
+
+/*===========================================================================*/
+
+// Find the homing target by computing every baddie's score exactly.
+static bool exact_homing_target(az_vector_t position, double angle,
+                                az_uid_t ignore_uid,
+                                az_baddie_flags_t ignore_flag,
+                                az_vector_t *target_position_out) {
+  bool found_target = false;
+  double best_score = INFINITY;
+  AZ_ARRAY_LOOP(baddie, state.baddies) {
+    if (baddie->kind == AZ_BAD_NOTHING) continue;
+    if (baddie->uid == ignore_uid) continue;
+    if (az_baddie_has_flag(baddie, ignore_flag)) continue;
+    const double score = az_vdist(baddie->position, position) +
+      fabs(az_mod2pi(az_vtheta(az_vsub(baddie->position, position)) -
+                     angle)) * 100.0;
+    if (score < best_score) {
+      best_score = score;
+      found_target = true;
+      *target_position_out = baddie->position;
+    }
+  }
+  return found_target;
+}
+
+void test_find_homing_target(void) {
+  // A target sitting right at the query point has no direction, so its
+  // score (zero distance plus the angle of a zero vector) must still be
+  // computed exactly rather than from the dot-product bound.
+  az_clear_space(&state);
+  ASSERT_TRUE(add_target(AZ_VZERO) != NULL);
+  ASSERT_TRUE(add_target((az_vector_t){0, 50}) != NULL);
+  az_build_homing_targets(&state);
+  az_vector_t target = AZ_VZERO;
+  ASSERT_TRUE(az_find_homing_target(&state, AZ_VZERO, 0.0, AZ_NULL_UID,
+                                    AZ_BADF_NO_HOMING_PROJ, &target));
+  EXPECT_VEQ(AZ_VZERO, target);
+  ASSERT_TRUE(az_find_homing_target(&state, AZ_VZERO, AZ_HALF_PI,
+                                    AZ_NULL_UID, AZ_BADF_NO_HOMING_PROJ,
+                                    &target));
+  EXPECT_VEQ(((az_vector_t){0, 50}), target);
+
+  // A target that has gained the flag being ignored since the list was built
+  // must not be returned (though it's fine for other weapons), nor should one
+  // that has been killed since.
+  az_clear_space(&state);
+  az_baddie_t *near = add_target((az_vector_t){10, 0});
+  ASSERT_TRUE(near != NULL);
+  ASSERT_TRUE(add_target((az_vector_t){100, 0}) != NULL);
+  az_build_homing_targets(&state);
+  near->temp_properties |= AZ_BADF_NO_HOMING_PROJ;
+  ASSERT_TRUE(az_find_homing_target(&state, AZ_VZERO, 0.0, AZ_NULL_UID,
+                                    AZ_BADF_NO_HOMING_PROJ, &target));
+  EXPECT_VEQ(((az_vector_t){100, 0}), target);
+  ASSERT_TRUE(az_find_homing_target(&state, AZ_VZERO, 0.0, AZ_NULL_UID,
+                                    AZ_BADF_NO_HOMING_BEAM, &target));
+  EXPECT_VEQ(((az_vector_t){10, 0}), target);
+  near->kind = AZ_BAD_NOTHING;
+  ASSERT_TRUE(az_find_homing_target(&state, AZ_VZERO, 0.0, AZ_NULL_UID,
+                                    AZ_BADF_NO_HOMING_BEAM, &target));
+  EXPECT_VEQ(((az_vector_t){100, 0}), target);
+
+  az_random_seed_t seed = {2, 3};
+  for (int layout = 0; layout < 200; ++layout) {
+    random_layout(&seed, 0.0, 0.0);
+    for (int query = 0; query < 20; ++query) {
+      // Sometimes query from the origin, where some baddies may be sitting.
+      const az_vector_t position =
+        (query == 0 ? AZ_VZERO : random_point(&seed, 600.0, 600.0));
+      const double angle = AZ_PI * az_rand_sdouble(&seed);
+      const az_uid_t ignore_uid = random_baddie_uid(&seed);
+      az_vector_t expected = AZ_VZERO, actual = AZ_VZERO;
+      const bool found = exact_homing_target(
+          position, angle, ignore_uid, AZ_BADF_NO_HOMING_PROJ, &expected);
+      EXPECT_TRUE(found == az_find_homing_target(
+          &state, position, angle, ignore_uid, AZ_BADF_NO_HOMING_PROJ,
+          &actual));
+      EXPECT_VEQ(expected, actual);
+    }
+  }
+}
+
+/*===========================================================================*/
+
+// Find the auto-aim target by computing every baddie's angle exactly.
+static bool exact_auto_aim_target(az_vector_t start, double forward,
+                                  double limit, az_baddie_flags_t ignore_flag,
+                                  az_vector_t *delta_out) {
+  bool found_target = false;
+  double best_dist = INFINITY;
+  AZ_ARRAY_LOOP(baddie, state.baddies) {
+    if (baddie->kind == AZ_BAD_NOTHING) continue;
+    if (az_baddie_has_flag(baddie, ignore_flag)) continue;
+    const az_vector_t delta = az_vsub(baddie->position, start);
+    const double dist = az_vnorm(delta);
+    if (dist >= best_dist) continue;
+    if (fabs(az_mod2pi(az_vtheta(delta) - forward)) <= limit) {
+      best_dist = dist;
+      found_target = true;
+      *delta_out = delta;
+    }
+  }
+  return found_target;
+}
+
+void test_find_auto_aim_target(void) {
+  // A target exactly on the limit is within it, and one just past it isn't,
+  // however close their cosines are.
+  az_clear_space(&state);
+  const az_vector_t edge = {100, 37};
+  ASSERT_TRUE(add_target(edge) != NULL);
+  az_build_homing_targets(&state);
+  const double edge_limit = az_vtheta(edge);
+  az_vector_t delta = AZ_VZERO;
+  ASSERT_TRUE(az_find_auto_aim_target(&state, AZ_VZERO, 0.0, edge_limit,
+                                      AZ_BADF_NO_HOMING_BEAM, &delta));
+  EXPECT_VEQ(edge, delta);
+  EXPECT_FALSE(az_find_auto_aim_target(&state, AZ_VZERO, 0.0,
+                                       nextafter(edge_limit, 0.0),
+                                       AZ_BADF_NO_HOMING_BEAM, &delta));
+  EXPECT_FALSE(az_find_auto_aim_target(&state, AZ_VZERO, 2.0 * edge_limit,
+                                       nextafter(edge_limit, 0.0),
+                                       AZ_BADF_NO_HOMING_BEAM, &delta));
+  ASSERT_TRUE(az_find_auto_aim_target(&state, AZ_VZERO, -AZ_HALF_PI,
+                                      AZ_HALF_PI + edge_limit,
+                                      AZ_BADF_NO_HOMING_BEAM, &delta));
+  EXPECT_VEQ(edge, delta);
+
+  // A target at the query point counts as being at angle zero, and beats any
+  // farther target.  If it's killed after the list was built, or gains the
+  // ignored flag, the next nearest target is returned instead.
+  az_clear_space(&state);
+  az_baddie_t *here = add_target(AZ_VZERO);
+  ASSERT_TRUE(here != NULL);
+  ASSERT_TRUE(add_target((az_vector_t){50, 0}) != NULL);
+  az_build_homing_targets(&state);
+  ASSERT_TRUE(az_find_auto_aim_target(&state, AZ_VZERO, 0.0, 0.5,
+                                      AZ_BADF_NO_HOMING_BEAM, &delta));
+  EXPECT_VEQ(AZ_VZERO, delta);
+  ASSERT_TRUE(az_find_auto_aim_target(&state, AZ_VZERO, AZ_PI, AZ_PI,
+                                      AZ_BADF_NO_HOMING_BEAM, &delta));
+  EXPECT_VEQ(AZ_VZERO, delta);
+  EXPECT_FALSE(az_find_auto_aim_target(&state, AZ_VZERO, AZ_PI, 0.5,
+                                       AZ_BADF_NO_HOMING_BEAM, &delta));
+  here->temp_properties |= AZ_BADF_NO_HOMING_BEAM;
+  ASSERT_TRUE(az_find_auto_aim_target(&state, AZ_VZERO, 0.0, 0.5,
+                                      AZ_BADF_NO_HOMING_BEAM, &delta));
+  EXPECT_VEQ(((az_vector_t){50, 0}), delta);
+  here->temp_properties = 0;
+  here->kind = AZ_BAD_NOTHING;
+  ASSERT_TRUE(az_find_auto_aim_target(&state, AZ_VZERO, 0.0, 0.5,
+                                      AZ_BADF_NO_HOMING_BEAM, &delta));
+  EXPECT_VEQ(((az_vector_t){50, 0}), delta);
+
+  az_random_seed_t seed = {5, 8};
+  for (int layout = 0; layout < 200; ++layout) {
+    const double forward = AZ_PI * az_rand_sdouble(&seed);
+    const double limit = AZ_DEG2RAD(layout % 2 == 0 ? 60 : 120);
+    random_layout(&seed, forward, limit);
+    for (int query = 0; query < 20; ++query) {
+      // Query from the origin, where the borderline baddies were placed, as
+      // well as from random points.
+      const az_vector_t start =
+        (query < 10 ? AZ_VZERO : random_point(&seed, 600.0, 600.0));
+      const az_baddie_flags_t ignore_flag =
+        (query % 2 == 0 ? AZ_BADF_NO_HOMING_BEAM : AZ_BADF_NO_HOMING_PHASE);
+      az_vector_t expected = AZ_VZERO, actual = AZ_VZERO;
+      const bool found = exact_auto_aim_target(start, forward, limit,
+                                               ignore_flag, &expected);
+      EXPECT_TRUE(found == az_find_auto_aim_target(
+          &state, start, forward, limit, ignore_flag, &actual));
+      EXPECT_VEQ(expected, actual);
+    }
+  }
+}
+
+/*===========================================================================*/
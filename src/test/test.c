@@ -25,7 +25,25 @@
 #include <stdlib.h> // for EXIT_FAILURE and EXIT_SUCCESS
 #include <string.h> // for strcmp
 
-#include "azimuth/util/vector.h" // for az_dapprox
+#include "azimuth/state/wall.h"
+#include "azimuth/util/random.h"
+#include "azimuth/util/vector.h"
+
+/*===========================================================================*/
+
+az_vector_t random_point(az_random_seed_t *seed, double semi_width,
+                         double semi_height) {
+  return (az_vector_t){semi_width * az_rand_sdouble(seed),
+                       semi_height * az_rand_sdouble(seed)};
+}
+
+void randomize_wall(az_random_seed_t *seed, az_wall_t *wall,
+                    double semi_width, double semi_height) {
+  wall->kind = AZ_WALL_INDESTRUCTIBLE;
+  wall->data = az_get_wall_data(az_rand_uint32(seed) % AZ_NUM_WALL_DATAS);
+  wall->position = random_point(seed, semi_width, semi_height);
+  wall->angle = AZ_TWO_PI * az_rand_udouble(seed);
+}
 
 /*===========================================================================*/
 
@@ -97,6 +115,15 @@ bool _expect_vapprox(az_vector_t expected, az_vector_t actual,
   return false;
 }
 
+bool _expect_veq(az_vector_t expected, az_vector_t actual,
+                 const char *message) {
+  if (expected.x == actual.x && expected.y == actual.y) return true;
+  test_failure();
+  printf(" \x1b[1;31mFAILED:\x1b[m %s\n  (%.20g, %.20g) vs. (%.20g, %.20g)\n",
+         message, expected.x, expected.y, actual.x, actual.y);
+  return false;
+}
+
 bool _expect_int_eq(int expected, int actual, const char *message) {
   if (expected == actual) return true;
   test_failure();
@@ -23,6 +23,8 @@
 
 #include <stdbool.h>
 
+#include "azimuth/state/wall.h"
+#include "azimuth/util/random.h"
 #include "azimuth/util/vector.h"
 
 /*===========================================================================*/
@@ -47,6 +49,11 @@
 #define EXPECT_VAPPROX(expected, actual) \
   _expect_vapprox(expected, actual, #expected " == " #actual)
 
+// Test that the two vectors are exactly equal (for checking an optimized
+// computation against a straightforward one that should agree bit-for-bit).
+#define EXPECT_VEQ(expected, actual) \
+  _expect_veq(expected, actual, #expected " == " #actual)
+
 // Test that the two ints are exactly equal.
 #define EXPECT_INT_EQ(expected, actual) \
   _expect_int_eq(expected, actual, #expected " == " #actual)
@@ -88,6 +95,22 @@ int final_test_summary(void);
 
 /*===========================================================================*/
 
+// Helpers for randomized tests, which check an optimized query against a
+// brute-force one over many random layouts.  Each test uses its own seed, so
+// that failures are reproducible.
+
+// Return a random point in the rect from <-semi_width, -semi_height> to
+// <semi_width, semi_height>.
+az_vector_t random_point(az_random_seed_t *seed, double semi_width,
+                         double semi_height);
+
+// Turn the wall into an indestructible wall of a random shape, with a random
+// position (as from random_point) and angle.
+void randomize_wall(az_random_seed_t *seed, az_wall_t *wall,
+                    double semi_width, double semi_height);
+
+/*===========================================================================*/
+
 extern bool _current_test_failed;
 
 void _run_test(const char *name, void (*function)(void));
@@ -102,6 +125,9 @@ bool _expect_approx(double expected, double actual, const char *message);
 bool _expect_vapprox(az_vector_t expected, az_vector_t actual,
                      const char *message);
 
+bool _expect_veq(az_vector_t expected, az_vector_t actual,
+                 const char *message);
+
 bool _expect_int_eq(int expected, int actual, const char *message);
 
 bool _expect_string_eq(const char *expected, const char *actual,
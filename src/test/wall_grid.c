@@ -0,0 +1,130 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#include "azimuth/state/room.h"
+#include "azimuth/state/wall.h"
+#include "azimuth/state/wall_grid.h"
+#include "azimuth/util/misc.h"
+#include "azimuth/util/random.h"
+#include "azimuth/util/vector.h"
+#include "test/test.h"
+
+/*===========================================================================*/
+
+static az_wall_t walls[AZ_MAX_NUM_WALLS];
+static az_wall_grid_t grid;
+
+// Find the first wall hit by a circle sweep, either using the grid or
+// checking every wall, and return its index (or -1 for no hit).
+static int sweep_hit(bool use_grid, double radius, az_vector_t start,
+                     az_vector_t delta) {
+  az_wall_set_t candidates;
+  if (use_grid) {
+    az_wall_grid_sweep(&grid, radius, start, delta, &candidates);
+  } else {
+    AZ_ARRAY_LOOP(bits, candidates.bits) *bits = ~UINT64_C(0);
+  }
+  int hit = -1;
+  for (int i = az_wall_set_next(&candidates, 0);
+       i >= 0 && i < AZ_MAX_NUM_WALLS;
+       i = az_wall_set_next(&candidates, i + 1)) {
+    if (walls[i].kind == AZ_WALL_NOTHING) continue;
+    az_vector_t pos;
+    if (radius == 0.0 ?
+        az_ray_hits_wall(&walls[i], start, delta, &pos, NULL) :
+        az_circle_hits_wall(&walls[i], radius, start, delta, &pos, NULL)) {
+      hit = i;
+      delta = az_vsub(pos, start);
+    }
+  }
+  return hit;
+}
+
+static int arc_hit(bool use_grid, double radius, az_vector_t start,
+                   az_vector_t spin_center, double spin_angle) {
+  az_wall_set_t candidates;
+  if (use_grid) {
+    az_wall_grid_arc_sweep(&grid, radius, start, spin_center, spin_angle,
+                           &candidates);
+  } else {
+    AZ_ARRAY_LOOP(bits, candidates.bits) *bits = ~UINT64_C(0);
+  }
+  int hit = -1;
+  for (int i = az_wall_set_next(&candidates, 0);
+       i >= 0 && i < AZ_MAX_NUM_WALLS;
+       i = az_wall_set_next(&candidates, i + 1)) {
+    if (walls[i].kind == AZ_WALL_NOTHING) continue;
+    if (az_arc_circle_hits_wall(&walls[i], radius, start, spin_center,
+                                spin_angle, &spin_angle, NULL, NULL)) {
+      hit = i;
+    }
+  }
+  return hit;
+}
+
+static void check_queries(az_random_seed_t *seed) {
+  for (int n = 0; n < 300; ++n) {
+    const double radius = (n % 3 == 0 ? 0.0 : 20.0 * az_rand_udouble(seed));
+    const az_vector_t start = random_point(seed, 600.0, 400.0);
+    const az_vector_t delta = {150.0 * az_rand_sdouble(seed),
+                               150.0 * az_rand_sdouble(seed)};
+    ASSERT_INT_EQ(sweep_hit(false, radius, start, delta),
+                  sweep_hit(true, radius, start, delta));
+    const az_vector_t spin_center = random_point(seed, 600.0, 400.0);
+    const double spin_angle = 4.0 * az_rand_sdouble(seed);
+    ASSERT_INT_EQ(arc_hit(false, radius, start, spin_center, spin_angle),
+                  arc_hit(true, radius, start, spin_center, spin_angle));
+  }
+}
+
+void test_wall_grid(void) {
+  az_random_seed_t seed = {1, 1};
+  // An empty grid should never report any walls.
+  AZ_ZERO_ARRAY(walls);
+  az_build_wall_grid(&grid, walls);
+  az_wall_set_t set;
+  az_wall_grid_sweep(&grid, 10.0, (az_vector_t){-100, -100},
+                     (az_vector_t){200, 200}, &set);
+  EXPECT_INT_EQ(-1, az_wall_set_next(&set, 0));
+  // Scatter some walls around, and check that using the grid gives the same
+  // answers as checking every wall.
+  for (int i = 0; i < 60; ++i) {
+    randomize_wall(&seed, &walls[3 * i], 600.0, 400.0);
+  }
+  az_build_wall_grid(&grid, walls);
+  check_queries(&seed);
+  RETURN_IF_FAILED();
+  // Move, remove, and add some walls (including moving some walls well
+  // outside the original grid), and check again.
+  for (int i = 0; i < 60; ++i) {
+    az_wall_t *wall = &walls[az_rand_uint32(&seed) % AZ_MAX_NUM_WALLS];
+    if (wall->kind == AZ_WALL_NOTHING) {
+      wall->kind = AZ_WALL_INDESTRUCTIBLE;
+      wall->data = az_get_wall_data(0);
+    } else if (i % 4 == 0) {
+      wall->kind = AZ_WALL_NOTHING;
+    }
+    wall->position = az_vmul(random_point(&seed, 600.0, 400.0),
+                             (i % 10 == 0 ? 2.0 : 1.0));
+    az_update_wall_grid(&grid, walls, wall - walls);
+  }
+  check_queries(&seed);
+}
+
+/*===========================================================================*/